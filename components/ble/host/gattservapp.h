@@ -311,6 +311,19 @@ typedef struct
     uint16 value;         //!< attribute new value
 } gattClientCharCfgUpdatedEvent_t;
 
+/**
+    GATT Server App ATT request processing statistics, collected when
+    GATT_SERV_PROC_STAT is defined.
+*/
+typedef struct
+{
+    uint32 numReqs;      //!< Number of ATT requests processed
+    uint32 totalTime;    //!< Total processing time in microseconds
+    uint32 maxTime;      //!< Longest processing time in microseconds
+    uint16 numServices;  //!< Services registered with callbacks
+    uint16 numAttrs;     //!< Attributes in those services
+} gattServProcStat_t;
+
 
 
 typedef void (*gattServMsgCB_t)( gattMsgEvent_t* pMsg);
@@ -616,6 +629,20 @@ extern void GATTServApp_SetParamValue( uint16 value );
 */
 extern uint16 GATTServApp_GetParamValue( void );
 
+#if defined ( GATT_SERV_PROC_STAT )
+/**
+    @brief   Get the ATT request processing time statistics together with
+            the number of registered services and attributes, to compare
+            the request processing time against the database size.
+
+    @param   pStat - pointer to statistics (to be returned)
+    @param   reset - TRUE to restart the time statistics
+
+    @return  void
+*/
+extern void GATTServApp_GetProcStat( gattServProcStat_t* pStat, uint8 reset );
+#endif
+
 /*  -------------------------------------------------------------------
     TASK API - These functions must only be called by OSAL.
 */
@@ -170,6 +170,11 @@ int hal_dma_config_channel(DMA_CH_t ch, DMA_CH_CFG_t* cfg)
     AP_DMA_INT->ClearTfr = DMA_DMACIntTfrClr_Ch(ch);
     // UnMask interrupt
     AP_DMA_INT->MaskTfr = DMA_DMACCxIntMask_E(ch);
+    // single block, hal_dma_config_ring turns the block interrupt on
+    AP_DMA_INT->ClearBlock = DMA_DMACIntBlockClr_Ch(ch);
+    AP_DMA_INT->MaskBlock = DMA_DMACCxIntMask_E(ch);
+    pctx->ring_lli = NULL;
+    pctx->blk_handler = NULL;
     src_conn = get_src_conn(cfg->src_addr);
     dst_conn = get_dst_conn(cfg->dst_addr);
 
@@ -247,6 +252,126 @@ int hal_dma_config_channel(DMA_CH_t ch, DMA_CH_CFG_t* cfg)
     return PPlus_SUCCESS;
 }
 
+// Circular transfer: cfg->dst_addr .. cfg->dst_addr + cfg->transf_size is split into
+// 'blocks' equal blocks chained in a loop, so the channel never completes. blk_handler
+// runs at the end of every block. lli must hold blocks + 1 items, the spare one is used
+// by hal_dma_ring_resume. Meant for a peripheral source, only the destination moves.
+int hal_dma_config_ring(DMA_CH_t ch, DMA_CH_CFG_t* cfg, DMA_LLI_t* lli, uint8_t blocks, DMA_Hdl_t blk_handler)
+{
+    DMA_CH_Ctx_t* pctx;
+    DMA_CH_CFG_t blk_cfg;
+    uint32_t blk_size;
+    uint32_t cctrl;
+    uint8_t i;
+    int ret;
+
+    if((lli == NULL) || (blocks < 2) || (cfg->transf_size % blocks))
+        return PPlus_ERR_INVALID_PARAM;
+
+    blk_size = cfg->transf_size / blocks;
+
+    //each block is one hardware transfer, the size field would wrap above the channel limit
+    if((blk_size == 0) || (blk_size > DMA_GET_MAX_TRANSPORT_SIZE(ch)))
+        return PPlus_ERR_INVALID_PARAM;
+
+    blk_cfg = *cfg;
+    blk_cfg.transf_size = blk_size;
+    blk_cfg.enable_int = false;
+    ret = hal_dma_config_channel(ch, &blk_cfg);
+
+    if(ret != PPlus_SUCCESS)
+        return ret;
+
+    cctrl = AP_DMA_CH_CFG(ch)->CTL | DMA_DMACCxControl_LLP_DST_EN | DMA_DMACCxControl_LLP_SRC_EN;
+
+    for(i = 0; i < blocks; i++)
+    {
+        lli[i].sar = cfg->src_addr;
+        lli[i].dar = cfg->dst_addr + i * blk_size;
+        lli[i].llp = (uint32_t)&lli[(i + 1) % blocks];
+        lli[i].ctl = cctrl;
+        lli[i].ctl_h = DMA_DMACCxControl_TransferSize(blk_size);
+    }
+
+    // first block is fetched from lli[0] as well
+    AP_DMA_CH_CFG(ch)->CTL = cctrl;
+    AP_DMA_CH_CFG(ch)->LLP = (uint32_t)&lli[0];
+    AP_DMA_INT->ClearBlock = DMA_DMACIntBlockClr_Ch(ch);
+    AP_DMA_INT->MaskBlock = DMA_DMACCxConfig_E(ch) | BIT(ch);
+    pctx = &s_dma_ctx.dma_ch_ctx[ch];
+    pctx->ring_lli = lli;
+    pctx->ring_blocks = blocks;
+    pctx->blk_handler = blk_handler;
+    pctx->interrupt = true;
+    return PPlus_SUCCESS;
+}
+
+// Stops a ring channel between two bursts and gives the next destination address.
+// The channel is still held (busy, power locked) for hal_dma_ring_resume.
+int hal_dma_ring_halt(DMA_CH_t ch, uint32_t* dst_addr)
+{
+    if(!s_dma_ctx.init_flg)
+        return PPlus_ERR_NOT_REGISTED;
+
+    if((ch >= DMA_CH_NUM) || (s_dma_ctx.dma_ch_ctx[ch].ring_lli == NULL))
+        return PPlus_ERR_INVALID_PARAM;
+
+    AP_DMA_CH_CFG(ch)->CFG |= DMA_DMACCxConfig_CH_SUSP;
+    HAL_WAIT_CONDITION_TIMEOUT_WO_RETURN((AP_DMA_CH_CFG(ch)->CFG & DMA_DMACCxConfig_FIFO_EMPTY), 1000);
+    AP_DMA_MISC->ChEnReg = DMA_DMACCxConfig_E(ch);
+    HAL_WAIT_CONDITION_TIMEOUT_WO_RETURN(!(AP_DMA_MISC->ChEnReg & DMA_DMACEnbldChns_Ch(ch)), 1000);
+    AP_DMA_CH_CFG(ch)->CFG &= ~DMA_DMACCxConfig_CH_SUSP;
+
+    if(AP_DMA_MISC->ChEnReg & DMA_DMACEnbldChns_Ch(ch))
+        return PPlus_ERR_TIMEOUT;
+
+    *dst_addr = AP_DMA_CH_CFG(ch)->DAR;
+    return PPlus_SUCCESS;
+}
+
+// Restarts a halted ring channel at dst_addr. The rest of that block runs from the
+// spare LLI, which then links back into the ring.
+int hal_dma_ring_resume(DMA_CH_t ch, uint32_t dst_addr)
+{
+    DMA_CH_Ctx_t* pctx;
+    DMA_LLI_t* lli;
+    DMA_LLI_t* spare;
+    uint32_t blk_size;
+    uint32_t offset;
+    uint8_t i;
+
+    if(!s_dma_ctx.init_flg)
+        return PPlus_ERR_NOT_REGISTED;
+
+    if(ch >= DMA_CH_NUM)
+        return PPlus_ERR_INVALID_PARAM;
+
+    pctx = &s_dma_ctx.dma_ch_ctx[ch];
+    lli = pctx->ring_lli;
+
+    if((lli == NULL) || (dst_addr < lli[0].dar))
+        return PPlus_ERR_INVALID_PARAM;
+
+    blk_size = DMA_DMACCxControl_TransferSize(lli[0].ctl_h);
+    offset = (dst_addr - lli[0].dar) % (blk_size * pctx->ring_blocks);
+    i = offset / blk_size;
+    spare = &lli[pctx->ring_blocks];
+    spare->sar = lli[i].sar;
+    spare->dar = lli[0].dar + offset;
+    spare->llp = lli[i].llp;
+    spare->ctl = lli[i].ctl;
+    spare->ctl_h = blk_size - (offset % blk_size);
+    AP_DMA_CH_CFG(ch)->CTL = spare->ctl;
+    AP_DMA_CH_CFG(ch)->LLP = (uint32_t)spare;
+    AP_DMA_MISC->ChEnReg = DMA_DMACCxConfig_E(ch) | BIT(ch);
+    return PPlus_SUCCESS;
+}
+
+uint32_t hal_dma_get_dst_addr(DMA_CH_t ch)
+{
+    return AP_DMA_CH_CFG(ch)->DAR;
+}
+
 int hal_dma_start_channel(DMA_CH_t ch)
 {
     DMA_CH_Ctx_t* pctx;
@@ -296,6 +421,15 @@ int hal_dma_stop_channel(DMA_CH_t ch)
     // UnMask interrupt
 //    AP_DMA_INT->MaskTfr = DMA_DMACCxIntMask_E(ch);
     AP_DMA_MISC->ChEnReg = DMA_DMACCxConfig_E(ch);
+
+    if(pctx->ring_lli)
+    {
+        AP_DMA_INT->MaskBlock = DMA_DMACCxIntMask_E(ch);
+        AP_DMA_INT->ClearBlock = DMA_DMACIntBlockClr_Ch(ch);
+        pctx->ring_lli = NULL;
+        pctx->blk_handler = NULL;
+    }
+
     pctx->xmit_busy = FALSE;
     hal_pwrmgr_unlock(MOD_DMA);
     return PPlus_SUCCESS;
@@ -379,8 +513,30 @@ void __attribute__((used)) hal_DMA_IRQHandler(void)
 {
     DMA_CH_t ch;
 
+    DMA_CH_Ctx_t* pctx;
+    uint8_t i;
+
     for(ch = DMA_CH_0; ch < DMA_CH_NUM; ch++)
     {
+        pctx = &s_dma_ctx.dma_ch_ctx[ch];
+
+        if(AP_DMA_INT->StatusBlock & BIT(ch))
+        {
+            AP_DMA_INT->ClearBlock = DMA_DMACIntBlockClr_Ch(ch);
+
+            if(pctx->ring_lli)
+            {
+                // drop the DONE bit written back into the finished item
+                for(i = 0; i < pctx->ring_blocks; i++)
+                    pctx->ring_lli[i].ctl_h = DMA_DMACCxControl_TransferSize(pctx->ring_lli[i].ctl_h);
+            }
+
+            if(pctx->blk_handler != NULL)
+            {
+                pctx->blk_handler(ch);
+            }
+        }
+
         if(AP_DMA_INT->StatusTfr & BIT(ch))
         {
             hal_dma_stop_channel(ch);
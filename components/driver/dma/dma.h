@@ -252,6 +252,10 @@ typedef enum
 #define DMA_DMACCxControl_SInc(n)       (((n&0x03)<<9))
 /** Destination increment*/
 #define DMA_DMACCxControl_DInc(n)       (((n&0x03)<<7))
+/** Block chaining enable on destination side*/
+#define DMA_DMACCxControl_LLP_DST_EN    ((1UL<<27))
+/** Block chaining enable on source side*/
+#define DMA_DMACCxControl_LLP_SRC_EN    ((1UL<<28))
 
 /*********************************************************************//**
     Macro defines for DMA Channel Configuration registers
@@ -279,6 +283,10 @@ typedef enum
 #define DMA_DMACCxConfig_H                      ((1UL<<18))
 /** DMAC Channel Configuration registers bit mask */
 #define DMA_DMACCxConfig_BITMASK                ((0x7FFFF))
+/** Channel suspend, CFG register*/
+#define DMA_DMACCxConfig_CH_SUSP                ((1UL<<8))
+/** Channel FIFO empty, CFG register*/
+#define DMA_DMACCxConfig_FIFO_EMPTY             ((1UL<<9))
 
 /**
     @}
@@ -339,14 +347,16 @@ typedef enum
 } DMA_CH_t;
 
 /**
-    @brief DMAC Linker List Item structure type definition
+    @brief DMAC Linker List Item structure type definition, loaded by the
+    DMAC into SAR, DAR, LLP, CTL and CTL_H at the start of each block
 */
 typedef struct
 {
-    uint32_t  src_addr; /**< Source Address */
-    uint32_t  dst_addr; /**< Destination address */
-    uint32_t  lli;      /**< Next LLI address, otherwise set to '0' */
-    uint32_t  ctrl;     /**< GPDMA Control of this LLI */
+    uint32_t  sar;      /**< Source Address */
+    uint32_t  dar;      /**< Destination address */
+    uint32_t  llp;      /**< Next LLI address, otherwise set to '0' */
+    uint32_t  ctl;      /**< Channel control of this block */
+    uint32_t  ctl_h;    /**< Block transfer size */
 } DMA_LLI_t;
 
 /**
@@ -367,6 +377,9 @@ typedef struct
     uint8_t     xmit_busy;
     uint8_t     xmit_flash;
     DMA_Hdl_t   evt_handler;
+    uint8_t     ring_blocks;
+    DMA_LLI_t*  ring_lli;
+    DMA_Hdl_t   blk_handler;
 } DMA_CH_Ctx_t;
 
 int hal_dma_init_channel(HAL_DMA_t cfg);
@@ -375,6 +388,10 @@ int hal_dma_start_channel(DMA_CH_t ch);
 int hal_dma_stop_channel(DMA_CH_t ch);
 int hal_dma_wait_channel_complete(DMA_CH_t ch);
 int hal_dma_status_control(DMA_CH_t ch);
+int hal_dma_config_ring(DMA_CH_t ch, DMA_CH_CFG_t* cfg, DMA_LLI_t* lli, uint8_t blocks, DMA_Hdl_t blk_handler);
+int hal_dma_ring_halt(DMA_CH_t ch, uint32_t* dst_addr);
+int hal_dma_ring_resume(DMA_CH_t ch, uint32_t dst_addr);
+uint32_t hal_dma_get_dst_addr(DMA_CH_t ch);
 int hal_dma_init(void);
 int hal_dma_deinit(void);
 void __attribute__((used)) hal_DMA_IRQHandler(void);
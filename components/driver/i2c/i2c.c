@@ -64,10 +64,43 @@
 #include "error.h"
 #include "OSAL.h"
 #include "pwrmgr.h"
+#include "timer.h"
+#include "jump_function.h"
+#include <string.h>
 
 #define I2C_OP_TIMEOUT  100   //100ms for an Byte operation
 extern  uint32_t pclk;
 
+#define I2C_XFER_RX_TL          3     //rx interrupt at 4 bytes, leaves 4 read commands on bus
+#define I2C_XFER_TX_TL          2     //refill before the tx fifo runs empty and stops the bus
+#define I2C_TIME_DELTA(t0, t1)  (((t1) >= (t0)) ? ((t1) - (t0)) : (BASE_TIME_UNITS - (t0) + (t1)))
+#define I2C_XFER_TIMEOUT(size)  (I2C_OP_TIMEOUT + ((size) >> 3))   //ms, slower than 8 bytes/ms is hung
+
+typedef struct
+{
+    i2c_xfer_t*     xfer;       //transfer on bus
+    i2c_xfer_t*     head;       //transfers waiting
+    i2c_xfer_t*     tail;
+    uint16_t        done;       //data bytes written, or read back from rx fifo
+    uint16_t        issued;     //data bytes or read commands put in tx fifo
+    uint8_t         waiting;
+    bool            pwr_registered;
+    #if(I2C_USE_TIMEOUT == 1)
+    int             t_start;    //systick when xfer went on bus
+    uint8_t         task_id;    //watchdog timer, set by hal_i2c_xfer_timer_init
+    uint16_t        timeout_event;
+    #endif
+    //bus setup, replayed on wakeup
+    bool            pin_set;
+    bool            clock_set;
+    gpio_pin_e      pin_sda;
+    gpio_pin_e      pin_clk;
+    I2C_CLOCK_e     clock;
+    i2c_xfer_stat_t stat;
+} i2c_xfer_ctx_t;
+
+static i2c_xfer_ctx_t s_i2c_xfer[2];
+
 
 /**************************************************************************************
     @fn          hal_master_send_read_cmd
@@ -211,6 +244,8 @@ void* hal_i2c_init(i2c_dev_t dev, I2C_CLOCK_e i2c_clock_rate)
         return NULL;
     }
 
+    s_i2c_xfer[dev].clock = i2c_clock_rate;
+    s_i2c_xfer[dev].clock_set = TRUE;
     pi2cdev->IC_ENABLE=0;
     pi2cdev->IC_CON=0x61;
 
@@ -340,6 +375,9 @@ int hal_i2c_pin_init(i2c_dev_t dev, gpio_pin_e pin_sda, gpio_pin_e pin_clk)
         return PPlus_ERR_INVALID_PARAM;
     }
 
+    s_i2c_xfer[dev].pin_sda = pin_sda;
+    s_i2c_xfer[dev].pin_clk = pin_clk;
+    s_i2c_xfer[dev].pin_set = TRUE;
     hal_gpio_pull_set(pin_sda,GPIO_PULL_UP_S);
     hal_gpio_pull_set(pin_clk,GPIO_PULL_UP_S);
 
@@ -399,73 +437,616 @@ int hal_i2c_addr_update(void* pi2c, uint8_t addr)
 }
 
 
-int _hal_i2c_read_s(void* pi2c, uint8_t slave_addr, uint8_t reg, uint8_t* data, uint8_t size)
+/**************************************************************************************
+    @fn          hal_i2c_read
+
+    @brief       This function reads size bytes from register reg on, in one transfer:
+                register address, repeated start, then all data.
+
+    input parameters
+
+    @param       void* pi2c: AP_I2C0 or AP_I2C1
+                uint8_t slave_addr: 7 bit slave address
+                uint8_t reg: first register
+                uint8_t* data: read buffer
+                uint8_t size: read length
+
+    output parameters
+
+    @param       None.
+
+    @return      PPlus_SUCCESS, PPlus_ERR_IO_FAIL on slave nack, PPlus_ERR_TIMEOUT.
+ **************************************************************************************/
+int hal_i2c_read(
+    void* pi2c,
+    uint8_t slave_addr,
+    uint8_t reg,
+    uint8_t* data,
+    uint8_t size)
 {
-    I2C_INIT_TOUT(to);
+    i2c_xfer_t xfer;
+    xfer.slave_addr = slave_addr;
+    xfer.reg = reg;
+    xfer.dir = I2C_XFER_READ;
+    xfer.flags = 0;
+    xfer.data = data;
+    xfer.size = size;
+    xfer.cb = NULL;
+    xfer.arg = NULL;
+    return hal_i2c_xfer(pi2c, &xfer);
+}
+
+
+/**************************************************************************************
+    @fn          hal_i2c_xfer_fill
+
+    @brief       Put data bytes or read commands in tx fifo. Read commands in flight are
+                kept within the rx fifo depth, so that rx fifo never overflows; when
+                that limit is hit, the rx interrupt refills instead of tx empty.
+ **************************************************************************************/
+static void hal_i2c_xfer_fill(AP_I2C_TypeDef* pi2cdev, i2c_xfer_ctx_t* pctx)
+{
+    i2c_xfer_t* xfer = pctx->xfer;
+    bool rx_limit = FALSE;
+
+    while((pctx->issued < xfer->size) && I2C_TX_FIFO_NOT_FULL(pi2cdev))
+    {
+        if(xfer->dir == I2C_XFER_READ)
+        {
+            if((pctx->issued - pctx->done) >= I2C_FIFO_DEPTH)
+            {
+                rx_limit = TRUE;
+                break;
+            }
+
+            I2C_READ_CMD(pi2cdev);
+        }
+        else
+        {
+            _hal_i2c_send_byte(pi2cdev, xfer->data[pctx->issued]);
+        }
+
+        pctx->issued++;
+    }
+
+    if((pctx->issued == xfer->size) || rx_limit)
+    {
+        pi2cdev->IC_INTR_MASK &= ~I2C_MASK_TX_EMPTY;
+    }
+    else
+    {
+        pi2cdev->IC_INTR_MASK |= I2C_MASK_TX_EMPTY;
+    }
+}
+
+static void hal_i2c_xfer_drain(AP_I2C_TypeDef* pi2cdev, i2c_xfer_ctx_t* pctx)
+{
+    i2c_xfer_t* xfer = pctx->xfer;
+
+    while(I2C_RX_FIFO_NOT_EMPTY(pi2cdev))
+    {
+        if(pctx->done < xfer->size)
+        {
+            xfer->data[pctx->done++] = (uint8_t)(pi2cdev->IC_DATA_CMD & 0xff);
+        }
+        else
+        {
+            (void)pi2cdev->IC_DATA_CMD;
+        }
+    }
+}
+
+//bus stopped early: start over from the first register, so a burst stays one coherent
+//read; a fixed register (fifo port) is addressed again and goes on where it stopped
+static void hal_i2c_xfer_restart(AP_I2C_TypeDef* pi2cdev, i2c_xfer_ctx_t* pctx)
+{
+    pctx->stat.restarts++;
+
+    if((pctx->xfer->flags & I2C_XFER_FIXED_REG) == 0)
+        pctx->done = 0;
+
+    pctx->issued = pctx->done;
+    _hal_i2c_send_byte(pi2cdev, pctx->xfer->reg);
+    hal_i2c_xfer_fill(pi2cdev, pctx);
+}
+
+static void hal_i2c0_xfer_irq_handler(void);
+static void hal_i2c1_xfer_irq_handler(void);
+
+//put pctx->xfer on bus, called with interrupts off
+static void hal_i2c_xfer_start(AP_I2C_TypeDef* pi2cdev, i2c_xfer_ctx_t* pctx)
+{
+    i2c_xfer_t* xfer = pctx->xfer;
+    int irqid = (pi2cdev == AP_I2C0) ? I2C0_IRQ : I2C1_IRQ;
+    //bus clock stays on till the stop
+    hal_pwrmgr_lock((pi2cdev == AP_I2C0) ? MOD_I2C0 : MOD_I2C1);
+    pctx->done = 0;
+    pctx->issued = 0;
+    #if(I2C_USE_TIMEOUT == 1)
+    pctx->t_start = hal_systick();
+
+    if(pctx->timeout_event)
+        osal_start_timerEx(pctx->task_id, pctx->timeout_event, I2C_XFER_TIMEOUT(xfer->size) + 1);
+
+    #endif
+
+    if(pi2cdev == AP_I2C0)
+    {
+        JUMP_FUNCTION(I2C0_IRQ_HANDLER) = (uint32_t)&hal_i2c0_xfer_irq_handler;
+    }
+    else
+    {
+        JUMP_FUNCTION(I2C1_IRQ_HANDLER) = (uint32_t)&hal_i2c1_xfer_irq_handler;
+    }
+
+    pi2cdev->IC_ENABLE = 0;
+    pi2cdev->IC_TAR = xfer->slave_addr;
+    pi2cdev->IC_RX_TL = I2C_XFER_RX_TL;
+    pi2cdev->IC_TX_TL = I2C_XFER_TX_TL;
+    pi2cdev->IC_INTR_MASK = 0;
+    pi2cdev->IC_ENABLE = 1;
+    (void)pi2cdev->IC_CLR_INTR;
+    NVIC_SetPriority((IRQn_Type)irqid, IRQ_PRIO_HAL);
+    NVIC_EnableIRQ((IRQn_Type)irqid);
+    _hal_i2c_send_byte(pi2cdev, xfer->reg);
+    hal_i2c_xfer_fill(pi2cdev, pctx);
+    pi2cdev->IC_INTR_MASK |= I2C_MASK_TX_ABRT | I2C_MASK_STOP_DET |
+                             ((xfer->dir == I2C_XFER_READ) ? I2C_MASK_RX_FULL : 0);
+}
+
+//take the bus from pctx->xfer, and give it to the next transfer waiting
+static void hal_i2c_xfer_next(AP_I2C_TypeDef* pi2cdev, i2c_xfer_ctx_t* pctx)
+{
+    i2c_xfer_t* xfer = pctx->xfer;
+    pi2cdev->IC_INTR_MASK = 0;
+    pctx->stat.xfers++;
+    pctx->stat.bytes += pctx->done;
+
+    if(xfer->status != PPlus_ERR_BUSY && xfer->status != PPlus_SUCCESS)
+        pctx->stat.errors++;
+
+    pctx->xfer = pctx->head;
+    hal_pwrmgr_unlock((pi2cdev == AP_I2C0) ? MOD_I2C0 : MOD_I2C1);
+
+    if(pctx->xfer != NULL)
+    {
+        pctx->head = pctx->xfer->next;
+
+        if(pctx->head == NULL)
+            pctx->tail = NULL;
+
+        pctx->waiting--;
+        hal_i2c_xfer_start(pi2cdev, pctx);
+    }
+
+    #if(I2C_USE_TIMEOUT == 1)
+    else if(pctx->timeout_event)
+    {
+        osal_stop_timerEx(pctx->task_id, pctx->timeout_event);
+    }
+
+    #endif
+}
+
+static void hal_i2c_xfer_complete(AP_I2C_TypeDef* pi2cdev, i2c_xfer_ctx_t* pctx, uint32_t t0)
+{
+    i2c_xfer_t* xfer = pctx->xfer;
+    uint32_t cpu_us;
+    hal_i2c_xfer_next(pi2cdev, pctx);
+    cpu_us = I2C_TIME_DELTA(t0, read_current_fine_time());
+    xfer->cpu_us += cpu_us;
+    pctx->stat.cpu_us += xfer->cpu_us;
+
+    if(xfer->status == PPlus_ERR_BUSY)
+        xfer->status = PPlus_SUCCESS;
+
+    if(xfer->cb)
+        xfer->cb(xfer);
+}
+
+//end pctx->xfer with status, called with interrupts off
+static void hal_i2c_xfer_abort(AP_I2C_TypeDef* pi2cdev, i2c_xfer_ctx_t* pctx, int status)
+{
+    pi2cdev->IC_INTR_MASK = 0;
+    pi2cdev->IC_ENABLE = 0;     //flush fifos, the next transfer sets the bus up again
+    (void)pi2cdev->IC_CLR_INTR;
+    pi2cdev->IC_ENABLE = 1;
+    pctx->xfer->status = status;
+    hal_i2c_xfer_complete(pi2cdev, pctx, read_current_fine_time());
+}
+
+#if(I2C_USE_TIMEOUT == 1)
+//end the transfer on bus if it ran over its time, so the ones queued behind it
+//still run; called with interrupts off
+static bool hal_i2c_xfer_check(AP_I2C_TypeDef* pi2cdev, i2c_xfer_ctx_t* pctx)
+{
+    if((pctx->xfer != NULL) && (hal_ms_intv(pctx->t_start) > I2C_XFER_TIMEOUT(pctx->xfer->size)))
+    {
+        LOG("I2C XFER TO\n");
+        hal_i2c_xfer_abort(pi2cdev, pctx, PPlus_ERR_TIMEOUT);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+#endif
+
+static void hal_i2c_xfer_irq_handler(AP_I2C_TypeDef* pi2cdev, i2c_xfer_ctx_t* pctx)
+{
+    uint32_t t0 = read_current_fine_time();
+    uint32_t int_status = pi2cdev->IC_INTR_STAT;
+    i2c_xfer_t* xfer = pctx->xfer;
+
+    if(xfer == NULL)
+    {
+        pi2cdev->IC_INTR_MASK = 0;
+        (void)pi2cdev->IC_CLR_INTR;
+        return;
+    }
+
+    if(int_status & I2C_MASK_TX_ABRT)
+    {
+        //no ack from slave, master flushes tx fifo and stops
+        (void)pi2cdev->IC_CLR_TX_ABRT;
+        xfer->status = PPlus_ERR_IO_FAIL;
+    }
+
+    if(xfer->dir == I2C_XFER_READ)
+    {
+        hal_i2c_xfer_drain(pi2cdev, pctx);
+    }
+
+    if(int_status & I2C_MASK_STOP_DET)
+    {
+        (void)pi2cdev->IC_CLR_STOP_DET;
+
+        if(xfer->dir == I2C_XFER_WRITE)
+        {
+            pctx->done = pctx->issued;
+        }
+
+        if((xfer->status == PPlus_ERR_BUSY) && (pctx->done < xfer->size))
+        {
+            //tx fifo ran empty in between
+            hal_i2c_xfer_restart(pi2cdev, pctx);
+        }
+        else
+        {
+            hal_i2c_xfer_complete(pi2cdev, pctx, t0);
+            return;
+        }
+    }
+    else if(xfer->status == PPlus_ERR_BUSY)
+    {
+        //tx empty, or rx drained below the limit
+        hal_i2c_xfer_fill(pi2cdev, pctx);
+    }
+
+    xfer->cpu_us += I2C_TIME_DELTA(t0, read_current_fine_time());
+}
+
+static void hal_i2c0_xfer_irq_handler(void)
+{
+    hal_i2c_xfer_irq_handler(AP_I2C0, &s_i2c_xfer[0]);
+}
+
+static void hal_i2c1_xfer_irq_handler(void)
+{
+    hal_i2c_xfer_irq_handler(AP_I2C1, &s_i2c_xfer[1]);
+}
+
+//registers are lost in sleep, set the bus up again; a transfer cut by sleep never ends
+static void hal_i2c_wakeup(i2c_dev_t dev)
+{
+    i2c_xfer_ctx_t* pctx = &s_i2c_xfer[dev];
+    AP_I2C_TypeDef* pi2cdev = (dev == I2C_0) ? AP_I2C0 : AP_I2C1;
+
+    if(pctx->pin_set)
+        hal_i2c_pin_init(dev, pctx->pin_sda, pctx->pin_clk);
+
+    if(pctx->clock_set)
+        hal_i2c_init(dev, pctx->clock);
+
+    HAL_ENTER_CRITICAL_SECTION();
+
+    if(pctx->xfer != NULL)
+        hal_i2c_xfer_abort(pi2cdev, pctx, PPlus_ERR_IO_FAIL);
+
+    HAL_EXIT_CRITICAL_SECTION();
+}
+
+static void hal_i2c0_wakeup_handler(void)
+{
+    hal_i2c_wakeup(I2C_0);
+}
+
+static void hal_i2c1_wakeup_handler(void)
+{
+    hal_i2c_wakeup(I2C_1);
+}
+
+//transfer on bus or waiting, called with interrupts off
+static bool hal_i2c_xfer_pending(i2c_xfer_ctx_t* pctx, i2c_xfer_t* xfer)
+{
+    i2c_xfer_t* p;
+
+    if(pctx->xfer == xfer)
+        return TRUE;
+
+    for(p = pctx->head; p != NULL; p = p->next)
+    {
+        if(p == xfer)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**************************************************************************************
+    @fn          hal_i2c_xfer_async
+
+    @brief       This function submits a register addressed transfer and returns at once;
+                the transfer is run from the i2c interrupt, after the transfers submitted
+                before it. xfer->status stays PPlus_ERR_BUSY until the transfer ends,
+                then xfer->cb is called from the interrupt. A transfer on bus past its
+                time ends with PPlus_ERR_TIMEOUT, and its cb is called from the caller that
+                found it: this function, hal_i2c_xfer or hal_i2c_xfer_timeout_handler.
+                The bus must have been set up by hal_i2c_pin_init and hal_i2c_init.
+
+    input parameters
+
+    @param       void* pi2c: AP_I2C0 or AP_I2C1
+                i2c_xfer_t* xfer: transfer, kept by the caller until it ends
+
+    output parameters
+
+    @param       None.
+
+    @return      PPlus_SUCCESS, PPlus_ERR_BUSY if xfer is already submitted.
+ **************************************************************************************/
+int hal_i2c_xfer_async(void* pi2c, i2c_xfer_t* xfer)
+{
+    uint32_t t0 = read_current_fine_time();
     AP_I2C_TypeDef* pi2cdev = (AP_I2C_TypeDef*)pi2c;
+    i2c_xfer_ctx_t* pctx;
 
     if(pi2cdev != AP_I2C0 && pi2cdev != AP_I2C1)
     {
         return PPlus_ERR_INVALID_PARAM;
     }
 
-    hal_i2c_addr_update(pi2c, slave_addr);
+    if(xfer == NULL || xfer->size == 0 || xfer->data == NULL)
+    {
+        return PPlus_ERR_INVALID_PARAM;
+    }
+
+    pctx = (pi2cdev == AP_I2C0) ? &s_i2c_xfer[0] : &s_i2c_xfer[1];
+
+    if(pctx->pwr_registered == FALSE)
+    {
+        if(pi2cdev == AP_I2C0)
+            hal_pwrmgr_register(MOD_I2C0, NULL, hal_i2c0_wakeup_handler);
+        else
+            hal_pwrmgr_register(MOD_I2C1, NULL, hal_i2c1_wakeup_handler);
+
+        pctx->pwr_registered = TRUE;
+    }
+
     HAL_ENTER_CRITICAL_SECTION();
-    hal_i2c_tx_start(pi2c);
-    _hal_i2c_send_byte(pi2c, reg);
-    hal_master_send_read_cmd(pi2c, size);
-    HAL_EXIT_CRITICAL_SECTION();
+    #if(I2C_USE_TIMEOUT == 1)
+    //without a watchdog timer, a hung transfer is found here
+    hal_i2c_xfer_check(pi2cdev, pctx);
+    #endif
 
-    while(1)
+    if(hal_i2c_xfer_pending(pctx, xfer))
     {
-        if(I2C_RX_FIFO_NOT_EMPTY(pi2cdev))
-        {
-            *data = (pi2cdev->IC_DATA_CMD&0xff);
-            data++;
-            size --;
+        HAL_EXIT_CRITICAL_SECTION();
+        return PPlus_ERR_BUSY;
+    }
 
-            if(size == 0)
-                break;
-        }
+    xfer->next = NULL;
+    xfer->status = PPlus_ERR_BUSY;
+    xfer->cpu_us = 0;
 
-        I2C_CHECK_TOUT(to, I2C_OP_TIMEOUT*size, "I2C RD TO\n");
+    if(pctx->xfer == NULL)
+    {
+        pctx->xfer = xfer;
+        hal_i2c_xfer_start(pi2cdev, pctx);
     }
+    else
+    {
+        if(pctx->tail)
+            pctx->tail->next = xfer;
+        else
+            pctx->head = xfer;
+
+        pctx->tail = xfer;
+        pctx->waiting++;
+        pctx->stat.queued++;
 
+        if(pctx->waiting > pctx->stat.queue_max)
+            pctx->stat.queue_max = pctx->waiting;
+    }
+
+    xfer->cpu_us += I2C_TIME_DELTA(t0, read_current_fine_time());
+    HAL_EXIT_CRITICAL_SECTION();
     return PPlus_SUCCESS;
 }
 
+/**************************************************************************************
+    @fn          hal_i2c_xfer
 
+    @brief       This function runs a register addressed transfer and waits for its end.
+                Reads and writes are not limited by the fifo depth.
+                Must not be called with interrupts off.
 
-int hal_i2c_read(
-    void* pi2c,
-    uint8_t slave_addr,
-    uint8_t reg,
-    uint8_t* data,
-    uint8_t size)
+    input parameters
+
+    @param       void* pi2c: AP_I2C0 or AP_I2C1
+                i2c_xfer_t* xfer: transfer
+
+    output parameters
+
+    @param       None.
+
+    @return      PPlus_SUCCESS, PPlus_ERR_IO_FAIL on slave nack, PPlus_ERR_TIMEOUT.
+ **************************************************************************************/
+int hal_i2c_xfer(void* pi2c, i2c_xfer_t* xfer)
 {
-    uint8_t cnt;
-    int ret = PPlus_SUCCESS;
+    #if(I2C_USE_TIMEOUT == 1)
     AP_I2C_TypeDef* pi2cdev = (AP_I2C_TypeDef*)pi2c;
+    i2c_xfer_ctx_t* pctx;
+    #endif
+    int ret;
+    ret = hal_i2c_xfer_async(pi2c, xfer);
+
+    if(ret != PPlus_SUCCESS)
+        return ret;
+
+    #if(I2C_USE_TIMEOUT == 1)
+    pctx = (pi2cdev == AP_I2C0) ? &s_i2c_xfer[0] : &s_i2c_xfer[1];
+    #endif
+
+    //transfers queued ahead each get their own time on bus, a hung one is aborted
+    //and the queue moves on to this one
+    while(xfer->status == PPlus_ERR_BUSY)
+    {
+        #if(I2C_USE_TIMEOUT == 1)
+        HAL_ENTER_CRITICAL_SECTION();
+        hal_i2c_xfer_check(pi2cdev, pctx);
+        HAL_EXIT_CRITICAL_SECTION();
+        #endif
+    }
+
+    return xfer->status;
+}
+
+/**************************************************************************************
+    @fn          hal_i2c_xfer_stat
+
+    @brief       This function reads the transfer statistics of one bus.
+
+    input parameters
+
+    @param       void* pi2c: AP_I2C0 or AP_I2C1
+                bool reset: clear the statistics after reading
+
+    output parameters
+
+    @param       i2c_xfer_stat_t* stat: statistics, may be NULL to only reset.
+
+    @return      PPlus_SUCCESS, PPlus_ERR_INVALID_PARAM.
+ **************************************************************************************/
+int hal_i2c_xfer_stat(void* pi2c, i2c_xfer_stat_t* stat, bool reset)
+{
+    AP_I2C_TypeDef* pi2cdev = (AP_I2C_TypeDef*)pi2c;
+    i2c_xfer_ctx_t* pctx;
 
     if(pi2cdev != AP_I2C0 && pi2cdev != AP_I2C1)
     {
         return PPlus_ERR_INVALID_PARAM;
     }
 
-    while(size)
+    pctx = (pi2cdev == AP_I2C0) ? &s_i2c_xfer[0] : &s_i2c_xfer[1];
+    HAL_ENTER_CRITICAL_SECTION();
+
+    if(stat)
+        *stat = pctx->stat;
+
+    if(reset)
     {
-        cnt = (size >7) ? 7 : size;
-        size -= cnt;
-        ret = _hal_i2c_read_s(pi2c, slave_addr, reg, data, cnt);
+        memset(&pctx->stat, 0, sizeof(i2c_xfer_stat_t));
+        pctx->stat.queue_max = pctx->waiting;
+    }
 
-        if(ret != PPlus_SUCCESS)
-            break;
+    HAL_EXIT_CRITICAL_SECTION();
+    return PPlus_SUCCESS;
+}
+
+/**************************************************************************************
+    @fn          hal_i2c_xfer_timer_init
+
+    @brief       This function gives the bus a watchdog timer. The OSAL timer event is
+                started for every transfer put on bus; the task calls
+                hal_i2c_xfer_timeout_handler on it. Without the timer, a hung transfer
+                is only ended when another transfer is submitted or waited for.
+
+    input parameters
+
+    @param       void* pi2c: AP_I2C0 or AP_I2C1
+                uint8 task_id: task of the event
+                uint16 event: timeout event
+
+    output parameters
+
+    @param       None.
 
-        data += cnt;
+    @return      PPlus_SUCCESS, PPlus_ERR_INVALID_PARAM, PPlus_ERR_NOT_SUPPORTED without
+                I2C_USE_TIMEOUT.
+ **************************************************************************************/
+int hal_i2c_xfer_timer_init(void* pi2c, uint8 task_id, uint16 event)
+{
+    AP_I2C_TypeDef* pi2cdev = (AP_I2C_TypeDef*)pi2c;
+
+    if(pi2cdev != AP_I2C0 && pi2cdev != AP_I2C1)
+    {
+        return PPlus_ERR_INVALID_PARAM;
     }
 
-    return ret;
+    #if(I2C_USE_TIMEOUT == 1)
+    i2c_xfer_ctx_t* pctx = (pi2cdev == AP_I2C0) ? &s_i2c_xfer[0] : &s_i2c_xfer[1];
+    HAL_ENTER_CRITICAL_SECTION();
+    pctx->task_id = task_id;
+    pctx->timeout_event = event;
+    HAL_EXIT_CRITICAL_SECTION();
+    return PPlus_SUCCESS;
+    #else
+    (void)task_id;
+    (void)event;
+    return PPlus_ERR_NOT_SUPPORTED;
+    #endif
 }
 
+/**************************************************************************************
+    @fn          hal_i2c_xfer_timeout_handler
+
+    @brief       This function processes the watchdog timer event. A transfer on bus past
+                its time is ended with PPlus_ERR_TIMEOUT, its callback is called, and the
+                next transfer waiting is started.
+
+    input parameters
+
+    @param       void* pi2c: AP_I2C0 or AP_I2C1
+
+    output parameters
+
+    @param       None.
 
+    @return      None.
+ **************************************************************************************/
+void hal_i2c_xfer_timeout_handler(void* pi2c)
+{
+    #if(I2C_USE_TIMEOUT == 1)
+    AP_I2C_TypeDef* pi2cdev = (AP_I2C_TypeDef*)pi2c;
+    i2c_xfer_ctx_t* pctx;
 
+    if(pi2cdev != AP_I2C0 && pi2cdev != AP_I2C1)
+    {
+        return;
+    }
+
+    pctx = (pi2cdev == AP_I2C0) ? &s_i2c_xfer[0] : &s_i2c_xfer[1];
+    HAL_ENTER_CRITICAL_SECTION();
+
+    //event of an earlier transfer, wait for the rest of this one
+    if((hal_i2c_xfer_check(pi2cdev, pctx) == FALSE) && (pctx->xfer != NULL) && pctx->timeout_event)
+    {
+        osal_start_timerEx(pctx->task_id, pctx->timeout_event,
+                           I2C_XFER_TIMEOUT(pctx->xfer->size) + 1 - hal_ms_intv(pctx->t_start));
+    }
+
+    HAL_EXIT_CRITICAL_SECTION();
+    #else
+    (void)pi2c;
+    #endif
+}
@@ -199,6 +199,47 @@ typedef enum
     I2C_TX_STATE_ERR
 } I2C_STATE;
 
+/*******************************************************************************
+    @ Module               :  Asynchronous Transfer
+    @ Description    :  Register addressed transfer run from the i2c interrupt:
+                     slave address, register, then data written or read back
+                     after a repeated start. Transfers submitted while the bus
+                     is busy are queued and run in order.
+*******************************************************************************/
+#define I2C_XFER_WRITE          0x00
+#define I2C_XFER_READ           0x01
+
+#define I2C_XFER_FIXED_REG      0x01    //flags: reg is a fifo port, not incremented by slave
+
+struct _i2c_xfer_t;
+typedef void (*i2c_xfer_cb_t)(struct _i2c_xfer_t* xfer);
+
+typedef struct _i2c_xfer_t
+{
+    struct _i2c_xfer_t* next;       //queue link, used by driver
+    uint8_t         slave_addr;     //7 bit slave address
+    uint8_t         reg;            //first register, auto incremented by slave
+    uint8_t         dir;            //I2C_XFER_WRITE or I2C_XFER_READ
+    uint8_t         flags;          //I2C_XFER_FIXED_REG
+    uint8_t*        data;
+    uint16_t        size;
+    i2c_xfer_cb_t   cb;             //called in interrupt context, may be NULL
+    void*           arg;
+    volatile int    status;         //PPlus_ERR_BUSY until the transfer ends
+    uint32_t        cpu_us;         //CPU time spent by the driver on this transfer
+} i2c_xfer_t;
+
+typedef struct
+{
+    uint32_t        xfers;          //transfers ended
+    uint32_t        errors;         //transfers ended on nack or timeout
+    uint32_t        bytes;          //data bytes written or read
+    uint32_t        restarts;       //readdressed after the bus stopped early
+    uint32_t        queued;         //transfers submitted while the bus was busy
+    uint32_t        queue_max;      //most transfers waiting at once
+    uint32_t        cpu_us;         //CPU time spent by the driver
+} i2c_xfer_stat_t;
+
 /*******************************************************************************
     @ Module               :  Function declaration
     @ Description    :  None
@@ -211,6 +252,11 @@ int hal_i2c_addr_update(void* pi2c, uint8_t addr);
 int hal_i2c_wait_tx_completed(void* pi2c);
 int hal_i2c_tx_start(void* pi2c);
 int hal_i2c_read(void* pi2c,uint8_t slave_addr,uint8_t reg,uint8_t* data,uint8_t size);
+int hal_i2c_xfer_async(void* pi2c, i2c_xfer_t* xfer);
+int hal_i2c_xfer(void* pi2c, i2c_xfer_t* xfer);
+int hal_i2c_xfer_stat(void* pi2c, i2c_xfer_stat_t* stat, bool reset);
+int hal_i2c_xfer_timer_init(void* pi2c, uint8 task_id, uint16 event);
+void hal_i2c_xfer_timeout_handler(void* pi2c);
 
 #ifdef __cplusplus
 }
@@ -57,13 +57,18 @@ typedef struct
     bool            enable;
     kscan_Cfg_t     cfg;
     uint16_t        key_state[MULTI_KEY_NUM<<1];
+    uint16_t        key_rpt[MULTI_KEY_NUM<<1];      //keys taken by the event handler
+    bool            evt_defer;                      //event handler did not take the batch
+    uint16_t        dbc_cnt0[MULTI_KEY_NUM<<1];     //debounce vertical counter, bit 0
+    uint16_t        dbc_cnt1[MULTI_KEY_NUM<<1];     //debounce vertical counter, bit 1
     uint8_t         pin_state[NUM_KEY_ROWS];
     uint8_t         kscan_task_id;
     uint16_t        timeout_event;
 } kscan_Ctx_t;
 
 static kscan_Ctx_t m_kscanCtx;
-static kscan_Key_t m_keys[MAX_KEY_NUM];
+static kscan_Key_t m_keys[KSCAN_EVT_FIFO_SIZE][MAX_KEY_NUM];   //one slot per key batch
+static uint8_t m_keys_wr = 0;                                   //slot of the next batch
 
 static uint8_t reScan_flag=0;
 
@@ -76,7 +81,9 @@ static void kscan_sleep_handler(void);
 static void kscan_wakeup_handler(void);
 static void get_key_matrix(uint16_t* key_matrix);
 static void rmv_ghost_key(uint16_t* key_matrix);
-static kscan_Evt_t  kscan_compare_key(uint16_t* key_pre, uint16_t* key_nxt);
+static void kscan_debounce(uint16_t* key_matrix);
+static bool kscan_report(uint16_t* key_pre, kscan_Evt_t* evt);
+static uint8_t kscan_compare_key(uint16_t* key_pre, uint16_t* key_nxt, bool notify_empty);
 static void hal_kscan_clear_config(void);
 extern void hal_gpioin_set_flag(gpio_pin_e pin);
 
@@ -148,15 +155,10 @@ void __attribute__((used)) hal_KSCAN_IRQHandler()
     if(m_kscanCtx.cfg.ghost_key_state == IGNORE_GHOST_KEY)
         rmv_ghost_key(key_nxt);
 
-    if(m_kscanCtx.cfg.evt_handler)
-    {
-        kscan_Evt_t evt = kscan_compare_key(m_kscanCtx.key_state, key_nxt);
-
-        if(evt.num>0)
-            m_kscanCtx.cfg.evt_handler(&evt);
-    }
-
+    kscan_debounce(key_nxt);
     memcpy(m_kscanCtx.key_state, key_nxt, sizeof(uint16_t)*(MULTI_KEY_NUM<<1));
+    //changes the event handler deferred are reported again with this scan
+    kscan_compare_key(m_kscanCtx.key_rpt, m_kscanCtx.key_state, FALSE);
     osal_start_timerEx(m_kscanCtx.kscan_task_id, m_kscanCtx.timeout_event, (2*m_kscanCtx.cfg.interval+TIMEOUT_DELTA));//todo
 }
 
@@ -174,26 +176,56 @@ void hal_kscan_timeout_handler()
     {
         //LOG("kscan_timeout_handler\n\r");
         osal_stop_timerEx(m_kscanCtx.kscan_task_id, m_kscanCtx.timeout_event);
-        uint16_t key_nxt[MULTI_KEY_NUM<<1];
-        memset(&key_nxt[0],0,sizeof(uint16_t)*(MULTI_KEY_NUM<<1)); //all register must be 0.teedy add 2019/01/23
-
-        //get_key_matrix(key_nxt); //no need to read the register,because keyScan didn't update the register .teedy add 2019/01/23
-
-        if(m_kscanCtx.cfg.ghost_key_state == IGNORE_GHOST_KEY)
-            rmv_ghost_key(key_nxt);
-
-        if(m_kscanCtx.cfg.evt_handler)
+        //the rescan still runs, keep its interrupt out of the report
+        NVIC_DisableIRQ((IRQn_Type)KSCAN_IRQn);
+
+        //no scan interrupt since the last one: a change still counting in the debounce
+        //was seen on every scan until all keys went up, so a short tap is reported here
+        for(uint8_t i=0; i<MAX_KEY_COLS; i++)
+            m_kscanCtx.key_state[i] ^= (m_kscanCtx.dbc_cnt0[i] | m_kscanCtx.dbc_cnt1[i]);
+
+        kscan_compare_key(m_kscanCtx.key_rpt, m_kscanCtx.key_state, FALSE);
+        //no scan runs any more, so every key is released without debounce
+        memset(m_kscanCtx.key_state, 0, sizeof(m_kscanCtx.key_state));
+        memset(m_kscanCtx.dbc_cnt0, 0, sizeof(m_kscanCtx.dbc_cnt0));
+        memset(m_kscanCtx.dbc_cnt1, 0, sizeof(m_kscanCtx.dbc_cnt1));
+        kscan_compare_key(m_kscanCtx.key_rpt, m_kscanCtx.key_state, TRUE);
+        NVIC_EnableIRQ((IRQn_Type)KSCAN_IRQn);
+
+        //event handler is full, report the releases left later
+        if(m_kscanCtx.evt_defer)
         {
-            kscan_Evt_t evt = kscan_compare_key(m_kscanCtx.key_state, key_nxt);
-            m_kscanCtx.cfg.evt_handler(&evt);
+            osal_start_timerEx(m_kscanCtx.kscan_task_id, m_kscanCtx.timeout_event, m_kscanCtx.cfg.interval+TIMEOUT_DELTA);
+            return;
         }
 
-        memcpy(m_kscanCtx.key_state, key_nxt, sizeof(uint16_t)*(MULTI_KEY_NUM<<1));
         reScan_flag=0;
         hal_pwrmgr_unlock(MOD_KSCAN);
     }
 }
 
+/**************************************************************************************
+    @fn          hal_kscan_evt_defer
+
+    @brief       This function is called from the event handler when it has no room for
+                 the batch. The batch and the key changes after it are reported again with
+                 the next scan, or by the timeout handler once all keys are up.
+
+    input parameters
+
+    @param       None.
+
+    output parameters
+
+    @param       None.
+
+    @return      None.
+ **************************************************************************************/
+void hal_kscan_evt_defer(void)
+{
+    m_kscanCtx.evt_defer = TRUE;
+}
+
 static void kscan_hw_config(void)
 {
     kscan_Cfg_t* cfg = &(m_kscanCtx.cfg);
@@ -368,7 +400,10 @@ static void get_key_matrix(uint16_t* key_matrix)
 /**************************************************************************************
     @fn          rmv_ghost_key
 
-    @brief       This function process for removing ghost key
+    @brief       This function process for removing ghost key. A key whose row and
+                 column both hold another pressed key may be a ghost, so it is dropped.
+                 Rows used by two or more columns are counted for all rows at once,
+                 which keeps the cost linear in the number of columns.
 
     input parameters
 
@@ -382,54 +417,167 @@ static void get_key_matrix(uint16_t* key_matrix)
  **************************************************************************************/
 static void rmv_ghost_key(uint16_t* key_matrix)
 {
-    uint16_t mix_final = 0;
+    uint16_t row_once = 0;
+    uint16_t row_multi = 0;
 
     for (uint8_t i=0; i<MAX_KEY_COLS; ++i)
     {
-        for (uint8_t j=i+1; j<MAX_KEY_ROWS; ++j)
-        {
-            uint16_t mix = key_matrix[i] & key_matrix[j];
-            uint8_t bit_is_pow2 = (mix&(mix-1)) == 0;
-
-            if (mix && !bit_is_pow2)
-                mix_final |= mix;
-        }
+        row_multi |= row_once & key_matrix[i];
+        row_once |= key_matrix[i];
+    }
 
-        key_matrix[i] &= ~mix_final;
+    for (uint8_t i=0; i<MAX_KEY_COLS; ++i)
+    {
+        //two or more keys in this column
+        if (key_matrix[i] & (key_matrix[i]-1))
+            key_matrix[i] &= ~row_multi;
     }
 }
 
-static kscan_Evt_t kscan_compare_key(uint16_t* key_pre, uint16_t* key_nxt)
-{
-    uint16_t multi_key_num = 0;
+/**************************************************************************************
+    @fn          kscan_debounce
 
+    @brief       This function process for key debounce. Every key has a 2 bit counter
+                 of the scans it differed from the reported state, kept as two bit planes
+                 so all keys of a column are counted at once. A key changes state after
+                 KSCAN_DEBOUNCE_CNT scans in a row, a scan that agrees restarts it.
+                 The scan interrupt comes once per scan interval while any key is down
+                 and stops when all keys are up, so a held key is counted every
+                 interval. Changes still counting when the interrupts stop are confirmed
+                 by hal_kscan_timeout_handler.
+
+    input parameters
+
+    @param       uint16_t* key_matrix - scanned keys
+
+    output parameters
+
+    @param       uint16_t* key_matrix - debounced keys
+
+    @return      None.
+ **************************************************************************************/
+static void kscan_debounce(uint16_t* key_matrix)
+{
     for(uint8_t i=0; i<MAX_KEY_COLS; i++)
     {
-        uint16_t chg_key = key_pre[i] ^ key_nxt[i];
-        uint16_t key_sta = chg_key & key_nxt[i];
+        uint16_t delta = key_matrix[i] ^ m_kscanCtx.key_state[i];
+        uint16_t cnt0 = m_kscanCtx.dbc_cnt0[i];
+        uint16_t cnt1 = m_kscanCtx.dbc_cnt1[i];
+        uint16_t done;
+        cnt1 = (cnt1 ^ cnt0) & delta;
+        cnt0 = ~cnt0 & delta;
+        done = delta & ((KSCAN_DEBOUNCE_CNT & 1) ? cnt0 : ~cnt0) & ((KSCAN_DEBOUNCE_CNT & 2) ? cnt1 : ~cnt1);
+        m_kscanCtx.dbc_cnt0[i] = cnt0 & ~done;
+        m_kscanCtx.dbc_cnt1[i] = cnt1 & ~done;
+        key_matrix[i] = m_kscanCtx.key_state[i] ^ done;
+    }
+}
+
+/**************************************************************************************
+    @fn          kscan_report
+
+    @brief       This function process for passing a key batch to the event handler.
+                 A batch taken moves the reported keys on and keeps its slot of the key
+                 fifo. A batch deferred by hal_kscan_evt_defer changes nothing, its keys
+                 are reported again later.
+
+    input parameters
+
+    @param       uint16_t* key_pre - reported keys
+    @param       kscan_Evt_t* evt - key batch
+
+    output parameters
+
+    @param       uint16_t* key_pre - reported keys
+
+    @return      TRUE if the batch was taken.
+ **************************************************************************************/
+static bool kscan_report(uint16_t* key_pre, kscan_Evt_t* evt)
+{
+    m_kscanCtx.evt_defer = FALSE;
+
+    if(m_kscanCtx.cfg.evt_handler)
+        m_kscanCtx.cfg.evt_handler(evt);
+
+    if(m_kscanCtx.evt_defer)
+        return FALSE;
+
+    for(uint8_t k=0; k<evt->num; k++)
+        key_pre[evt->keys[k].col] ^= (uint16_t)(1 << evt->keys[k].row);
+
+    m_keys_wr = (m_keys_wr + 1) % KSCAN_EVT_FIFO_SIZE;
+    return TRUE;
+}
+
+/**************************************************************************************
+    @fn          kscan_compare_key
+
+    @brief       This function process for reporting key changes. Releases are reported
+                 before presses, and the changes are passed to the event handler in
+                 batches of up to MAX_KEY_NUM keys so none of a large chord is lost.
+                 Each batch has its own slot of the key fifo, so a handler may keep
+                 evt->keys and process it later from its task. When the handler defers
+                 a batch, it and the changes after it stay unreported.
 
-        if(chg_key != 0)
+    input parameters
+
+    @param       uint16_t* key_pre - reported keys
+    @param       uint16_t* key_nxt - new keys
+    @param       bool notify_empty - call the event handler even without a change
+
+    output parameters
+
+    @param       uint16_t* key_pre - reported keys
+
+    @return      number of key changes taken by the event handler.
+ **************************************************************************************/
+static uint8_t kscan_compare_key(uint16_t* key_pre, uint16_t* key_nxt, bool notify_empty)
+{
+    kscan_Evt_t evt;
+    uint8_t total = 0;
+    m_kscanCtx.evt_defer = FALSE;
+    evt.keys = m_keys[m_keys_wr];
+    evt.num = 0;
+
+    for(uint8_t pressed=0; pressed<2; pressed++)
+    {
+        for(uint8_t i=0; i<MAX_KEY_COLS; i++)
         {
-            for(uint8_t j=0; j<MAX_KEY_ROWS; j++)
+            uint16_t chg_key = (key_pre[i] ^ key_nxt[i]) & (pressed ? key_nxt[i] : key_pre[i]);
+
+            for(uint8_t j=0; chg_key != 0; j++, chg_key >>= 1)
             {
-                if((chg_key & BIT(j)) != 0)
+                if((chg_key & 1) == 0)
+                    continue;
+
+                evt.keys[evt.num].row = j;
+                evt.keys[evt.num].col = i;
+                evt.keys[evt.num].type = pressed ? KEY_PRESSED:KEY_RELEASED;
+                evt.num++;
+
+                if(evt.num == MAX_KEY_NUM)
                 {
-                    kscan_Key_t key_param;
-                    key_param.row = j;
-                    key_param.col = i;
-                    key_param.type = (key_sta & BIT(j)) ? KEY_PRESSED:KEY_RELEASED;
-                    m_keys[multi_key_num] = key_param;
-                    multi_key_num++;
-                }
+                    if(kscan_report(key_pre, &evt) == FALSE)
+                        return total;
 
-                if(multi_key_num == MAX_KEY_NUM)
-                    break;
+                    total += evt.num;
+                    evt.keys = m_keys[m_keys_wr];
+                    evt.num = 0;
+                }
             }
         }
     }
 
-    kscan_Evt_t evt;
-    evt.keys = m_keys;
-    evt.num  = multi_key_num;
-    return evt;
+    if(evt.num > 0)
+    {
+        if(kscan_report(key_pre, &evt))
+            total += evt.num;
+    }
+    else if((total == 0) && notify_empty && m_kscanCtx.cfg.evt_handler)
+    {
+        m_kscanCtx.cfg.evt_handler(&evt);
+        m_kscanCtx.evt_defer = FALSE;
+    }
+
+    return total;
 }
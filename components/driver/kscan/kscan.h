@@ -95,6 +95,20 @@ const static uint8_t KSCAN_COL_GPIO[12] =
 
 #define KSCAN_ALL_ROW_NUM 11
 #define KSCAN_ALL_COL_NUM 12
+
+//scans in a row a key change must be seen before it is reported, 1 to 3
+#ifndef KSCAN_DEBOUNCE_CNT
+    #define KSCAN_DEBOUNCE_CNT  2
+#endif
+#if (KSCAN_DEBOUNCE_CNT < 1) || (KSCAN_DEBOUNCE_CNT > 3)
+    #error "KSCAN_DEBOUNCE_CNT must be 1 to 3"
+#endif
+
+//key batches kept for event handlers that defer; evt->keys stays valid until this
+//many more batches are taken by the handler
+#ifndef KSCAN_EVT_FIFO_SIZE
+    #define KSCAN_EVT_FIFO_SIZE 4
+#endif
 /*************************************************************
     @brief      enum variable used for setting rows
 
@@ -220,6 +234,7 @@ typedef struct
 //PUBLIC FUNCTIONS
 int  hal_kscan_init(kscan_Cfg_t cfg, uint8 task_id, uint16 event);
 void hal_kscan_timeout_handler(void);
+void hal_kscan_evt_defer(void);
 void __attribute__((weak)) hal_KSCAN_IRQHandler(void);
 
 #ifdef __cplusplus
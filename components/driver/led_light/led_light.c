@@ -56,9 +56,8 @@ void light_reflash(void)
     pwm_ch[0].cmpVal = s_light[0];
     pwm_ch[1].cmpVal = s_light[1];
     pwm_ch[2].cmpVal = s_light[2];
-    hal_pwm_ch_start(pwm_ch[0]);
-    hal_pwm_ch_start(pwm_ch[1]);
-    hal_pwm_ch_start(pwm_ch[2]);
+    //all channels change on the same pwm period, no color tearing
+    hal_pwm_ch_update(pwm_ch, 3);
 
     if(s_light[LIGHT_RED] + s_light[LIGHT_GREEN] + s_light[LIGHT_BLUE])
     {
@@ -189,11 +189,74 @@ void hal_pwm_set_count_val(PWMN_e pwmN, uint16_t cmpVal, uint16_t cntTopVal)
         return;
 
     PWM_NO_LOAD_CH(pwmN);
+    //back to instant load in case the channel was staged for hal_pwm_commit
+    PWM_INSTANT_LOAD_CH(pwmN);
     PWM_SET_CMP_VAL(pwmN, cmpVal);
     PWM_SET_TOP_VAL(pwmN, cntTopVal);
     PWM_LOAD_CH(pwmN);
 }
 
+/**************************************************************************************
+    @fn          hal_pwm_stage_count_val
+
+    @brief       This function writes pwm count value to the shadow registers, the
+                new value takes effect at the end of period after hal_pwm_commit.
+                The channel leaves instant load mode set by hal_pwm_init, the next
+                hal_pwm_set_count_val on it restores that mode.
+
+    input parameters
+
+    @param       PWMN_e pwmN                     : pwm channel
+                uint16_t cmpVal                 : the compare value of PWM channel
+                uint16_t cntTopVal              : the counter top value of PWM channel
+
+    output parameters
+
+    @param       None.
+
+    @return      None.
+ **************************************************************************************/
+void hal_pwm_stage_count_val(PWMN_e pwmN, uint16_t cmpVal, uint16_t cntTopVal)
+{
+    if(cmpVal > cntTopVal)
+        return;
+
+    PWM_NO_INSTANT_LOAD_CH(pwmN);
+    PWM_NO_LOAD_CH(pwmN);
+    PWM_SET_CMP_VAL(pwmN, cmpVal);
+    PWM_SET_TOP_VAL(pwmN, cntTopVal);
+}
+
+/**************************************************************************************
+    @fn          hal_pwm_commit
+
+    @brief       This function requests load of the staged count values of all
+                channels in chMask, so they change on the same period boundary
+
+    input parameters
+
+    @param       uint8_t chMask                  : bit n for PWM channel n
+
+    output parameters
+
+    @param       None.
+
+    @return      None.
+ **************************************************************************************/
+void hal_pwm_commit(uint8_t chMask)
+{
+    int i;
+    HAL_ENTER_CRITICAL_SECTION();
+
+    for(i = 0; i < 6; i++)
+    {
+        if(chMask & BIT(i))
+            PWM_LOAD_CH((PWMN_e)i);
+    }
+
+    HAL_EXIT_CRITICAL_SECTION();
+}
+
 static unsigned int pwm_en = 0;
 void hal_pwm_start(void)
 {
@@ -300,6 +363,41 @@ void hal_pwm_ch_start(pwm_ch_t ch)
         pwmCtx.ch_en[ch.pwmN] = TRUE;
         hal_pwm_start();
     }
+
+    pwmCtx.ch[ch.pwmN] = ch;
+}
+
+void hal_pwm_ch_update(pwm_ch_t* ch, uint8_t num)
+{
+    int i;
+    uint8_t chMask = 0;
+    pwm_ch_t* cur;
+
+    if(pwmCtx.enable == FALSE)
+        return;
+
+    for(i = 0; i < num; i++)
+    {
+        cur = &pwmCtx.ch[ch[i].pwmN];
+
+        if(pwmCtx.ch_en[ch[i].pwmN] == FALSE)
+        {
+            hal_pwm_ch_start(ch[i]);
+            continue;
+        }
+
+        //skip channels whose count value is not changed
+        if((cur->cmpVal == ch[i].cmpVal) && (cur->cntTopVal == ch[i].cntTopVal))
+            continue;
+
+        hal_pwm_stage_count_val(ch[i].pwmN,ch[i].cmpVal,ch[i].cntTopVal);
+        cur->cmpVal = ch[i].cmpVal;
+        cur->cntTopVal = ch[i].cntTopVal;
+        chMask |= BIT(ch[i].pwmN);
+    }
+
+    if(chMask)
+        hal_pwm_commit(chMask);
 }
 
 void hal_pwm_ch_stop(pwm_ch_t ch)
@@ -260,6 +260,46 @@ void hal_pwm_destroy(PWMN_e pwmN);
  **************************************************************************************/
 void hal_pwm_set_count_val(PWMN_e pwmN, uint16_t cmpVal, uint16_t cntTopVal);
 
+/**************************************************************************************
+    @fn          hal_pwm_stage_count_val
+
+    @brief       This function writes pwm count value to the shadow registers, the
+                new value takes effect at the end of period after hal_pwm_commit.
+                The channel leaves instant load mode set by hal_pwm_init, the next
+                hal_pwm_set_count_val on it restores that mode.
+
+    input parameters
+
+    @param       PWMN_e pwmN                     : pwm channel
+                uint16_t cmpVal                 : the compare value of PWM channel
+                uint16_t cntTopVal              : the counter top value of PWM channel
+
+    output parameters
+
+    @param       None.
+
+    @return      None.
+ **************************************************************************************/
+void hal_pwm_stage_count_val(PWMN_e pwmN, uint16_t cmpVal, uint16_t cntTopVal);
+
+/**************************************************************************************
+    @fn          hal_pwm_commit
+
+    @brief       This function requests load of the staged count values of all
+                channels in chMask, so they change on the same period boundary
+
+    input parameters
+
+    @param       uint8_t chMask                  : bit n for PWM channel n
+
+    output parameters
+
+    @param       None.
+
+    @return      None.
+ **************************************************************************************/
+void hal_pwm_commit(uint8_t chMask);
+
 /**************************************************************************************
     @fn          hal_pwm_start
 
@@ -375,6 +415,26 @@ void hal_pwm_ch_start(pwm_ch_t ch);
  **************************************************************************************/
 void hal_pwm_ch_stop(pwm_ch_t ch);
 
+/**************************************************************************************
+    @fn          hal_pwm_ch_update
+
+    @brief       update count value of several pwm channels at once, the channels
+                already working are staged and committed together so they change
+                on the same period boundary, unchanged channels are skipped
+
+    input parameters
+
+    @param       pwm_ch_t* ch: pwm channel array
+                uint8_t num: number of channels in array
+
+    output parameters
+
+    @param       None.
+
+    @return      None.
+ **************************************************************************************/
+void hal_pwm_ch_update(pwm_ch_t* ch, uint8_t num);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,12 +49,32 @@
 #include "pwrmgr.h"
 #include "error.h"
 #include "jump_function.h"
+#if DMAC_USE
+    #include "dma.h"
+#endif
 
 #define UART_TX_BUFFER_SIZE   256
 
+#if DMAC_USE
+#define UART_RX_DMA_CH        DMA_CH_0  //only channel 0 takes blocks over 32 bytes
+#define UART_RX_DMA_BLOCKS    2         //half and full
+
+typedef struct _uart_rx_dma_t
+{
+    UART_INDEX_e      uart_index;
+    uint8_t*          ring;
+    uint16_t          size;
+    uart_rx_dma_hdl_t handler;
+    DMA_LLI_t         lli[UART_RX_DMA_BLOCKS + 1];
+} uart_rx_dma_t;
+
+static uart_rx_dma_t m_uartRxDma;
+#endif
+
 typedef struct _uart_Context
 {
     bool          enable;
+    bool          rx_dma;
 
     uint8_t       tx_state;
     uart_Tx_Buf_t tx_buf;
@@ -143,6 +163,45 @@ static int txmit_buf_polling(UART_INDEX_e uart_index,uint8_t* buf,uint16_t len)
     return PPlus_SUCCESS;;
 }
 
+#if DMAC_USE
+static void __ATTR_SECTION_SRAM__  irq_rx_dma_idle(UART_INDEX_e uart_index)
+{
+    uart_rx_dma_t* prx = &m_uartRxDma;
+    AP_UART_TypeDef* cur_uart = (AP_UART_TypeDef*)AP_UART0_BASE;
+    uint32_t dst;
+    uint16_t pos;
+
+    if(uart_index == UART1)
+        cur_uart = (AP_UART_TypeDef*) AP_UART1_BASE;
+
+    if(hal_dma_ring_halt(UART_RX_DMA_CH, &dst) != PPlus_SUCCESS)
+        return;
+
+    pos = (uint16_t)((dst - (uint32_t)prx->ring) % prx->size);
+
+    //less than a dma burst is left in the fifo, move it in behind the dma
+    while(cur_uart->LSR & LSR_DR)
+    {
+        prx->ring[pos] = (uint8_t)(cur_uart->RBR & 0xff);
+        pos = (pos + 1) % prx->size;
+    }
+
+    hal_dma_ring_resume(UART_RX_DMA_CH, (uint32_t)prx->ring + pos);
+
+    if(prx->handler)
+        prx->handler(uart_index, UART_RX_DMA_EVT_IDLE, pos);
+}
+
+static void __ATTR_SECTION_SRAM__  uart_rx_dma_blk_handler(DMA_CH_t ch)
+{
+    uart_rx_dma_t* prx = &m_uartRxDma;
+    uint16_t pos = hal_uart_rx_dma_pos(prx->uart_index);
+
+    if(prx->handler)
+        prx->handler(prx->uart_index, (pos >= prx->size / 2) ? UART_RX_DMA_EVT_HALF : UART_RX_DMA_EVT_FULL, pos);
+}
+#endif
+
 static void __ATTR_SECTION_SRAM__  irq_rx_handler(UART_INDEX_e uart_index,uint8_t flg)
 {
     int i;
@@ -155,6 +214,19 @@ static void __ATTR_SECTION_SRAM__  irq_rx_handler(UART_INDEX_e uart_index,uint8_
         cur_uart = (AP_UART_TypeDef*) AP_UART1_BASE;
     }
 
+    #if DMAC_USE
+
+    if(m_uartCtx[uart_index].rx_dma)
+    {
+        //fifo is drained by dma, only the timeout tail is left to the cpu
+        if(flg == UART_EVT_TYPE_RX_DATA_TO)
+            irq_rx_dma_idle(uart_index);
+
+        return;
+    }
+
+    #endif
+
     if(m_uartCtx[uart_index].cfg.use_fifo)
     {
         len = cur_uart->RFL;
@@ -466,6 +538,12 @@ int hal_uart_init(uart_Cfg_t cfg,UART_INDEX_e uart_index)
 
 int hal_uart_deinit(UART_INDEX_e uart_index)
 {
+    #if DMAC_USE
+
+    if(m_uartCtx[uart_index].rx_dma)
+        hal_uart_rx_dma_stop(uart_index);
+
+    #endif
     uart_hw_deinit(uart_index);
     memset(&(m_uartCtx[uart_index]), 0, sizeof(uart_Ctx_t));
     m_uartCtx[uart_index].enable = FALSE;
@@ -534,3 +612,101 @@ int hal_uart_send_byte(UART_INDEX_e uart_index,unsigned char data)
     HAL_WAIT_CONDITION_TIMEOUT((cur_uart->LSR & LSR_TEMT), 10000);
     return PPlus_SUCCESS;
 }
+
+#if DMAC_USE
+/**************************************************************************************
+    @fn          hal_uart_rx_dma_start
+
+    @brief       Receive into a ring through a circular dma transfer. The dma takes
+                bursts at the rx fifo trigger level and never stops; handler gets
+                the ring position when each half is filled and when the line goes
+                idle with a tail left in the fifo. The dma controller and channel 0
+                must be set up with hal_dma_init and hal_dma_init_channel first.
+
+    input parameters
+
+    @param       uart_index - uart port, with use_fifo set.
+                ring - receive ring, owned by the driver until hal_uart_rx_dma_stop.
+                size - ring size, even and at most 4094, twice the channel 0 block limit.
+                handler - progress callback, runs in interrupt context.
+
+    output parameters
+
+    @param       None.
+
+    @return      PPlus_SUCCESS or an error code.
+ **************************************************************************************/
+int hal_uart_rx_dma_start(UART_INDEX_e uart_index, uint8_t* ring, uint16_t size, uart_rx_dma_hdl_t handler)
+{
+    DMA_CH_CFG_t cfg;
+    AP_UART_TypeDef* cur_uart = AP_UART0;
+    int ret;
+
+    if(m_uartCtx[uart_index].enable == FALSE || m_uartCtx[uart_index].rx_dma)
+        return PPlus_ERR_INVALID_STATE;
+
+    if(m_uartCtx[uart_index].cfg.use_fifo == FALSE)
+        return PPlus_ERR_NOT_SUPPORTED;
+
+    //two equal halves, each within one channel 0 block
+    if(ring == NULL || size == 0 || (size % UART_RX_DMA_BLOCKS) ||
+            size > UART_RX_DMA_BLOCKS * DMA_GET_MAX_TRANSPORT_SIZE(UART_RX_DMA_CH))
+        return PPlus_ERR_INVALID_PARAM;
+
+    if(uart_index == UART1)
+        cur_uart = AP_UART1;
+
+    m_uartRxDma.uart_index = uart_index;
+    m_uartRxDma.ring = ring;
+    m_uartRxDma.size = size;
+    m_uartRxDma.handler = handler;
+    cfg.transf_size = size;
+    cfg.sinc = DMA_INC_NCHG;
+    cfg.src_tr_width = DMA_WIDTH_BYTE;
+    cfg.src_msize = DMA_BSIZE_4;
+    cfg.src_addr = (uint32_t)&(cur_uart->RBR);
+    cfg.dinc = DMA_INC_INC;
+    cfg.dst_tr_width = DMA_WIDTH_BYTE;
+    cfg.dst_msize = DMA_BSIZE_4;
+    cfg.dst_addr = (uint32_t)ring;
+    cfg.enable_int = true;
+    ret = hal_dma_config_ring(UART_RX_DMA_CH, &cfg, m_uartRxDma.lli, UART_RX_DMA_BLOCKS, uart_rx_dma_blk_handler);
+
+    if(ret != PPlus_SUCCESS)
+        return ret;
+
+    HAL_ENTER_CRITICAL_SECTION();
+    m_uartCtx[uart_index].rx_dma = TRUE;
+    //burst request at 4 characters matches DMA_BSIZE_4, fewer raise the char timeout
+    cur_uart->FCR = FCR_FIFO_ENABLE|FCR_DMA_MODE|FCR_RX_TRIGGER_01|UART_FIFO_TX_TRIGGER;
+    hal_dma_start_channel(UART_RX_DMA_CH);
+    HAL_EXIT_CRITICAL_SECTION();
+    return PPlus_SUCCESS;
+}
+
+int hal_uart_rx_dma_stop(UART_INDEX_e uart_index)
+{
+    AP_UART_TypeDef* cur_uart = AP_UART0;
+
+    if(m_uartCtx[uart_index].rx_dma == FALSE)
+        return PPlus_ERR_INVALID_STATE;
+
+    if(uart_index == UART1)
+        cur_uart = AP_UART1;
+
+    HAL_ENTER_CRITICAL_SECTION();
+    hal_dma_stop_channel(UART_RX_DMA_CH);
+    m_uartCtx[uart_index].rx_dma = FALSE;
+    cur_uart->FCR = FCR_FIFO_ENABLE|UART_FIFO_RX_TRIGGER|UART_FIFO_TX_TRIGGER;
+    HAL_EXIT_CRITICAL_SECTION();
+    return PPlus_SUCCESS;
+}
+
+uint16_t hal_uart_rx_dma_pos(UART_INDEX_e uart_index)
+{
+    if(m_uartCtx[uart_index].rx_dma == FALSE)
+        return 0;
+
+    return (uint16_t)((hal_dma_get_dst_addr(UART_RX_DMA_CH) - (uint32_t)m_uartRxDma.ring) % m_uartRxDma.size);
+}
+#endif
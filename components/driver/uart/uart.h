@@ -69,6 +69,7 @@ extern "C" {
 #define FCR_TX_TRIGGER_11 0x30
 #define FCR_TX_FIFO_RESET 0x04
 #define FCR_RX_FIFO_RESET 0x02
+#define FCR_DMA_MODE      0x08
 #define FCR_FIFO_ENABLE   0x01
 
 
@@ -140,6 +141,16 @@ typedef enum
 
 typedef void (*uart_Hdl_t)(uart_Evt_t* pev);
 
+/*rx dma ring events, pos is the ring offset the next byte goes to*/
+typedef enum
+{
+    UART_RX_DMA_EVT_HALF = 1,   //first half of the ring filled
+    UART_RX_DMA_EVT_FULL,       //second half filled, dma wrapped to the start
+    UART_RX_DMA_EVT_IDLE,       //line idle for 4 characters, fifo tail moved in
+} uart_rx_dma_evt_t;
+
+typedef void (*uart_rx_dma_hdl_t)(UART_INDEX_e uart_index, uint8_t evt, uint16_t pos);
+
 typedef struct _uart_Cfg_t
 {
     gpio_pin_e  tx_pin;
@@ -175,6 +186,11 @@ int hal_uart_set_tx_buf(UART_INDEX_e uart_index,uint8_t* buf, uint16_t size);
 int hal_uart_get_tx_ready(UART_INDEX_e uart_index);
 int hal_uart_send_buff(UART_INDEX_e uart_index,uint8_t* buff,uint16_t len);
 int hal_uart_send_byte(UART_INDEX_e uart_index,unsigned char data);
+#if DMAC_USE
+int hal_uart_rx_dma_start(UART_INDEX_e uart_index, uint8_t* ring, uint16_t size, uart_rx_dma_hdl_t handler);
+int hal_uart_rx_dma_stop(UART_INDEX_e uart_index);
+uint16_t hal_uart_rx_dma_pos(UART_INDEX_e uart_index);
+#endif
 void __attribute__((weak)) hal_UART0_IRQHandler(void);
 void __attribute__((weak)) hal_UART1_IRQHandler(void);
 
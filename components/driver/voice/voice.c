@@ -51,11 +51,20 @@
 #include "log.h"
 #include "voice.h"
 #include "jump_function.h"
+#if DMAC_USE
+    #include "dma.h"
+#endif
 
 static voice_Ctx_t mVoiceCtx;
 
+static voice_Ring_t mVoiceRing;
+
 static uint32_t voice_data[HALF_VOICE_WORD_SIZE];
 
+#if DMAC_USE
+    static bool voice_dma_init = FALSE;
+#endif
+
 // Enable voice core
 void hal_voice_enable(void)
 {
@@ -185,6 +194,91 @@ static void set_voice_amute_cfg(
 
 
 
+// INTERNAL: Half buffer is in the ring, let the task process it
+static void voice_ring_commit(void)
+{
+    mVoiceRing.head += HALF_VOICE_WORD_SIZE;
+
+    if (mVoiceCtx.evt_handler)
+    {
+        voice_Evt_t evt;
+        evt.type = HAL_VOICE_EVT_RING;
+        evt.data = NULL;
+        evt.size = mVoiceRing.head - mVoiceRing.tail;
+        mVoiceCtx.evt_handler(&evt);
+    }
+}
+
+#if DMAC_USE
+// INTERNAL: Half buffer copy done
+static void voice_dma_handler(DMA_CH_t ch)
+{
+    if(mVoiceRing.dma_busy == FALSE)
+        return;
+
+    mVoiceRing.dma_busy = FALSE;
+    voice_ring_commit();
+}
+#endif
+
+// INTERNAL: Move a half buffer into the ring, by dma when it is available
+static void voice_ring_push(uint32_t src)
+{
+    uint32_t* dst;
+    int n;
+
+    if (mVoiceRing.dma_busy || (mVoiceRing.head - mVoiceRing.tail > mVoiceRing.size - HALF_VOICE_WORD_SIZE))
+    {
+        mVoiceRing.overrun++;
+
+        if (mVoiceCtx.evt_handler)
+        {
+            voice_Evt_t evt;
+            evt.type = HAL_VOICE_EVT_OVERRUN;
+            evt.data = NULL;
+            evt.size = mVoiceRing.overrun;
+            mVoiceCtx.evt_handler(&evt);
+        }
+
+        return;
+    }
+
+    //the ring size is a multiple of the half buffer, so a half buffer never wraps
+    dst = &mVoiceRing.buf[mVoiceRing.head % mVoiceRing.size];
+    #if DMAC_USE
+
+    if (mVoiceRing.dma)
+    {
+        DMA_CH_CFG_t cfg;
+        cfg.transf_size = HALF_VOICE_WORD_SIZE;
+        cfg.sinc = DMA_INC_INC;
+        cfg.src_tr_width = DMA_WIDTH_WORD;
+        cfg.src_msize = DMA_BSIZE_4;
+        cfg.src_addr = src;
+        cfg.dinc = DMA_INC_INC;
+        cfg.dst_tr_width = DMA_WIDTH_WORD;
+        cfg.dst_msize = DMA_BSIZE_4;
+        cfg.dst_addr = (uint32_t)dst;
+        cfg.enable_int = true;
+
+        if (hal_dma_config_channel(VOICE_DMA_CH, &cfg) == PPlus_SUCCESS)
+        {
+            mVoiceRing.dma_busy = TRUE;
+            hal_dma_start_channel(VOICE_DMA_CH);
+            return;
+        }
+    }
+
+    #endif
+
+    for (n = 0; n < HALF_VOICE_WORD_SIZE; n++)
+    {
+        dst[n] = (uint32_t)(read_reg(src + n * 4));
+    }
+
+    voice_ring_commit();
+}
+
 /**************************************************************************************
     @fn          hal_VOICE_IRQHandler
 
@@ -207,7 +301,14 @@ void __attribute__((used)) hal_ADC_IRQHandler(void)
 //  LOG("Voice interrupt processing\n");
     MASK_VOICE_INT;
 
-    if (voice_int_status & BIT(8))
+    if ((voice_int_status & BIT(8)) && mVoiceRing.buf)
+    {
+        voice_ring_push(VOICE_BASE);
+        CLEAR_VOICE_HALF_INT;
+
+        while (IS_CLAER_VOICE_HALF_INT) {}
+    }
+    else if (voice_int_status & BIT(8))
     {
         int n;
 
@@ -233,7 +334,14 @@ void __attribute__((used)) hal_ADC_IRQHandler(void)
         }
     }
 
-    if (voice_int_status & BIT(9))
+    if ((voice_int_status & BIT(9)) && mVoiceRing.buf)
+    {
+        voice_ring_push(VOICE_MID_BASE);
+        CLEAR_VOICE_FULL_INT;
+
+        while (IS_CLAER_VOICE_FULL_INT) {}
+    }
+    else if (voice_int_status & BIT(9))
     {
         int n;
 
@@ -355,6 +463,9 @@ int hal_voice_start(void)
 {
     hal_clk_gate_enable(MOD_ADCC);
     mVoiceCtx.enable = TRUE;
+    //each capture starts with an empty ring
+    mVoiceRing.head = 0;
+    mVoiceRing.tail = 0;
     hal_pwrmgr_lock(MOD_ADCC);
     hal_pwrmgr_lock(MOD_VOC);
 
@@ -393,6 +504,15 @@ int hal_voice_stop(void)
         AP_PCRM->ANA_CTL &= ~BIT(16);   //Power off PGA
     }
 
+    #if DMAC_USE
+
+    if (mVoiceRing.dma_busy)
+    {
+        hal_dma_stop_channel(VOICE_DMA_CH);
+        mVoiceRing.dma_busy = FALSE;
+    }
+
+    #endif
     //Enable sleep
     hal_pwrmgr_unlock(MOD_VOC);
     hal_pwrmgr_unlock(MOD_ADCC);
@@ -418,7 +538,85 @@ int hal_voice_clear(void)
 
     //clk_gate_disable(MOD_ADCC);//disable I2C clk gated
     memset(&mVoiceCtx, 0, sizeof(mVoiceCtx));
+    memset(&mVoiceRing, 0, sizeof(mVoiceRing));
     //enableSleep();
     hal_pwrmgr_unlock(MOD_VOC);
     return 0;
 }
+
+/**************************************************************************************
+    @fn          hal_voice_ring_config
+
+    @brief       Capture into a ring instead of reporting each half buffer with
+                HAL_VOICE_EVT_DATA. The half buffers are moved into the ring by dma
+                when DMAC_USE is set and VOICE_DMA_CH is free, otherwise by the cpu,
+                and HAL_VOICE_EVT_RING is reported. The handler should only signal
+                the task, which takes the samples with hal_voice_ring_peek and
+                hal_voice_ring_release. Call between hal_voice_config and
+                hal_voice_start.
+
+    input parameters
+
+    @param       ring - capture ring, owned by the driver until hal_voice_clear.
+                        NULL goes back to the half buffer events.
+                words - ring size in words, a multiple of HALF_VOICE_WORD_SIZE
+                        and at least twice of it.
+
+    output parameters
+
+    @param       None.
+
+    @return      PPlus_SUCCESS or an error code.
+ **************************************************************************************/
+int hal_voice_ring_config(uint32_t* ring, uint16_t words)
+{
+    if(mVoiceCtx.enable)
+        return PPlus_ERR_BUSY;
+
+    if(ring && ((words % HALF_VOICE_WORD_SIZE) || (words < 2 * HALF_VOICE_WORD_SIZE)))
+        return PPlus_ERR_INVALID_PARAM;
+
+    memset(&mVoiceRing, 0, sizeof(mVoiceRing));
+    mVoiceRing.buf = ring;
+    mVoiceRing.size = words;
+    #if DMAC_USE
+
+    if(ring && voice_dma_init == FALSE)
+    {
+        HAL_DMA_t ch_cfg;
+        ch_cfg.dma_channel = VOICE_DMA_CH;
+        ch_cfg.evt_handler = voice_dma_handler;
+        //fails when the dma is not initialized or the channel is taken, then the cpu copies
+        voice_dma_init = (hal_dma_init_channel(ch_cfg) == PPlus_SUCCESS);
+    }
+
+    mVoiceRing.dma = voice_dma_init;
+    #endif
+    return PPlus_SUCCESS;
+}
+
+uint16_t hal_voice_ring_peek(uint32_t** ppdata)
+{
+    uint32_t words;
+    uint16_t rd;
+
+    if(mVoiceRing.buf == NULL)
+        return 0;
+
+    rd = mVoiceRing.tail % mVoiceRing.size;
+    words = mVoiceRing.head - mVoiceRing.tail;
+
+    if(words > (uint32_t)(mVoiceRing.size - rd))
+        words = mVoiceRing.size - rd;
+
+    *ppdata = &mVoiceRing.buf[rd];
+    return (uint16_t)words;
+}
+
+void hal_voice_ring_release(uint16_t words)
+{
+    if(words > mVoiceRing.head - mVoiceRing.tail)
+        words = mVoiceRing.head - mVoiceRing.tail;
+
+    mVoiceRing.tail += words;
+}
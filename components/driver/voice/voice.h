@@ -164,9 +164,16 @@ typedef enum
 enum
 {
     HAL_VOICE_EVT_DATA = 1,
+    HAL_VOICE_EVT_RING = 2,     //half buffer moved into the ring, size is the words ready
+    HAL_VOICE_EVT_OVERRUN = 3,  //ring full and half buffer dropped, size is the halves dropped so far
     HAL_VOICE_EVT_FAIL = 0xff
 };
 
+//only channel 0 takes a half buffer of HALF_VOICE_WORD_SIZE words in one block
+#ifndef VOICE_DMA_CH
+#define VOICE_DMA_CH          DMA_CH_0
+#endif
+
 // Voice configuration structure
 typedef struct _voice_Cfg_t
 {
@@ -198,6 +205,18 @@ typedef struct _voice_Contex_t
     voice_Hdl_t       evt_handler;
 } voice_Ctx_t;
 
+// Voice capture ring, written in interrupt context and read in task context
+typedef struct _voice_Ring_t
+{
+    uint32_t*         buf;
+    uint16_t          size;       //words, a multiple of HALF_VOICE_WORD_SIZE
+    volatile uint32_t head;       //words written
+    volatile uint32_t tail;       //words read
+    volatile uint8_t  dma_busy;   //half buffer copy in progress
+    uint8_t           dma;        //copy by dma
+    uint32_t          overrun;    //half buffers dropped
+} voice_Ring_t;
+
 
 // Enable voice core
 void hal_voice_enable(void);
@@ -283,6 +302,15 @@ int hal_voice_stop(void);
 // Clear memory and power manager for voice
 int hal_voice_clear(void);
 
+// Capture into a ring, processed in task context
+int hal_voice_ring_config(uint32_t* ring, uint16_t words);
+
+// Get the captured words at the read position of the ring, without wrapping
+uint16_t hal_voice_ring_peek(uint32_t** ppdata);
+
+// Give words back to the ring after processing
+void hal_voice_ring_release(uint16_t words);
+
 #ifdef __cplusplus
 }
 #endif
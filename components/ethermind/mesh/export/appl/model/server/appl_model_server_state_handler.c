@@ -295,6 +295,704 @@ static API_RESULT appl_model_state_is_diff_in_range
     return retval;
 }
 
+/** ---------------- Transition Engine ---- */
+/**
+    State transitions share one tick timer. Each tick interpolates the
+    light output of the running transitions and updates the PWM once.
+*/
+#ifndef APPL_TRANSITION_TICK_MS
+    #define APPL_TRANSITION_TICK_MS          20
+#endif /* APPL_TRANSITION_TICK_MS */
+
+#define APPL_TRANSITION_MAX                  8
+#define APPL_TRANSITION_HANDLE_INVALID       0xFFFF
+#define APPL_TRANSITION_HANDLE_SLOT(h)       ((h) & 0x0F)
+
+/* Light Output channels */
+#define APPL_LIGHT_OUT_LIGHTNESS             0
+#define APPL_LIGHT_OUT_TEMPERATURE           1
+#define APPL_LIGHT_OUT_HUE                   2
+#define APPL_LIGHT_OUT_SATURATION            3
+#define APPL_LIGHT_OUT_NUM                   4
+
+#define APPL_LIGHT_OUT_MASK(ch)              (1 << (ch))
+#define APPL_LIGHT_OUT_HSL_MASK              (APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS) | \
+                                              APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_HUE) | \
+                                              APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_SATURATION))
+#define APPL_LIGHT_OUT_CTL_MASK              (APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS) | \
+                                              APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_TEMPERATURE))
+
+/* Light Output modes, Keep to not change the mode */
+#define APPL_LIGHT_MODE_KEEP                 0x00
+#define APPL_LIGHT_MODE_WHITE                0x01
+#define APPL_LIGHT_MODE_CTL                  0x02
+#define APPL_LIGHT_MODE_HSL                  0x03
+
+#define APPL_TRANSITION_IDLE                 0x00
+#define APPL_TRANSITION_DELAY                0x01
+#define APPL_TRANSITION_RUN                  0x02
+
+typedef struct _APPL_TRANSITION
+{
+    void (* transition_start_cb)(void*);
+
+    void (* transition_complete_cb)(void*);
+
+    void* blob;
+
+    UINT32 delay_ms;
+
+    UINT32 duration_ms;
+
+    UINT32 elapsed_ms;
+
+    /* Light Output at start and end, of channels in mask */
+    UINT16 from[APPL_LIGHT_OUT_NUM];
+
+    UINT16 to[APPL_LIGHT_OUT_NUM];
+
+    UINT16 handle;
+
+    UINT8  mask;
+
+    UINT8  mode;
+
+    UINT8  state;
+
+} APPL_TRANSITION;
+
+typedef struct _APPL_LIGHT_OUTPUT
+{
+    UINT16 value[APPL_LIGHT_OUT_NUM];
+
+    UINT8  mode;
+
+} APPL_LIGHT_OUTPUT;
+
+static APPL_TRANSITION appl_transition[APPL_TRANSITION_MAX];
+static EM_timer_handle appl_transition_timer = EM_TIMER_HANDLE_INIT_VAL;
+static UINT16          appl_transition_seq;
+
+static APPL_LIGHT_OUTPUT appl_light_out =
+{
+    { 0x0000, LIGHT_CTL_TEMPERATURE_T_MIN, 0x8000, 0x8000 },
+    APPL_LIGHT_MODE_WHITE
+};
+
+/* Transitions without own handle in the model state */
+static UINT16 appl_light_lightness_linear_transition_handle = APPL_TRANSITION_HANDLE_INVALID;
+static UINT16 appl_light_ctl_transition_handle = APPL_TRANSITION_HANDLE_INVALID;
+static UINT16 appl_light_ctl_temperature_transition_handle = APPL_TRANSITION_HANDLE_INVALID;
+static UINT16 appl_light_lc_onoff_transition_handle = APPL_TRANSITION_HANDLE_INVALID;
+
+static void appl_transition_timeout_handler(void* args, UINT16 size);
+
+static UINT32 appl_transition_time_in_ms(UINT8 transition_time)
+{
+    /* Step Resolution: 100ms, 1s, 10s, 10min */
+    DECL_CONST UINT32 resolution[4] = { 100, 1000, 10000, 600000 };
+    return (UINT32)(transition_time & 0x3F) * resolution[transition_time >> 6];
+}
+
+static APPL_TRANSITION* appl_transition_search(UINT16 handle)
+{
+    APPL_TRANSITION* t;
+
+    if (APPL_TRANSITION_HANDLE_INVALID == handle)
+    {
+        return NULL;
+    }
+
+    t = &appl_transition[APPL_TRANSITION_HANDLE_SLOT(handle)];
+
+    if ((APPL_TRANSITION_IDLE == t->state) || (handle != t->handle))
+    {
+        return NULL;
+    }
+
+    return t;
+}
+
+static void appl_light_output_apply(void)
+{
+    UINT16* value;
+    value = appl_light_out.value;
+
+    /* Output is gamma corrected by the platform */
+    switch (appl_light_out.mode)
+    {
+    case APPL_LIGHT_MODE_CTL:
+        light_ctl_lightness_set_pl
+        (
+            value[APPL_LIGHT_OUT_LIGHTNESS],
+            value[APPL_LIGHT_OUT_TEMPERATURE]
+        );
+        break;
+
+    case APPL_LIGHT_MODE_HSL:
+        light_hsl_set_pl
+        (
+            value[APPL_LIGHT_OUT_HUE],
+            value[APPL_LIGHT_OUT_SATURATION],
+            value[APPL_LIGHT_OUT_LIGHTNESS]
+        );
+        break;
+
+    default:
+        light_lightness_set_pl(value[APPL_LIGHT_OUT_LIGHTNESS]);
+        break;
+    }
+}
+
+/* Channels in mask are no more driven by running transitions */
+static void appl_light_output_release(UINT8 mask)
+{
+    UINT32 index;
+
+    for (index = 0; index < APPL_TRANSITION_MAX; index++)
+    {
+        appl_transition[index].mask &= (UINT8)~mask;
+    }
+}
+
+static void appl_light_output_set(UINT8 mode, UINT8 mask, UINT16* value)
+{
+    UINT32 ch;
+    appl_light_output_release(mask);
+
+    for (ch = 0; ch < APPL_LIGHT_OUT_NUM; ch++)
+    {
+        if (0 != (mask & APPL_LIGHT_OUT_MASK(ch)))
+        {
+            appl_light_out.value[ch] = value[ch];
+        }
+    }
+
+    if (APPL_LIGHT_MODE_KEEP != mode)
+    {
+        appl_light_out.mode = mode;
+    }
+
+    appl_light_output_apply();
+}
+
+static void appl_transition_run(APPL_TRANSITION* t)
+{
+    t->state = APPL_TRANSITION_RUN;
+    t->elapsed_ms = 0;
+    EM_mem_copy(t->from, appl_light_out.value, sizeof(t->from));
+    /* Take the channels, continuing from present output */
+    appl_light_output_release(t->mask);
+
+    if (APPL_LIGHT_MODE_KEEP != t->mode)
+    {
+        appl_light_out.mode = t->mode;
+    }
+
+    if (NULL != t->transition_start_cb)
+    {
+        t->transition_start_cb(t->blob);
+    }
+}
+
+static void appl_transition_timer_start(void)
+{
+    if (EM_TIMER_HANDLE_INIT_VAL != appl_transition_timer)
+    {
+        return;
+    }
+
+    if (EM_SUCCESS != EM_start_timer
+            (
+                &appl_transition_timer,
+                (EM_TIMEOUT_MILLISEC | APPL_TRANSITION_TICK_MS),
+                appl_transition_timeout_handler,
+                NULL,
+                0
+            ))
+    {
+        appl_transition_timer = EM_TIMER_HANDLE_INIT_VAL;
+    }
+}
+
+/* Linear in perceptual lightness, Q15 progress */
+static UINT16 appl_transition_interpolate(UINT32 ch, UINT16 from, UINT16 to, UINT32 progress)
+{
+    INT32 delta;
+
+    if (APPL_LIGHT_OUT_HUE == ch)
+    {
+        /* Hue is circular, take the shorter way */
+        delta = (INT16)(to - from);
+    }
+    else
+    {
+        delta = (INT32)to - (INT32)from;
+    }
+
+    return (UINT16)(from + ((delta * (INT32)progress) >> 15));
+}
+
+static void appl_transition_timeout_handler(void* args, UINT16 size)
+{
+    APPL_TRANSITION* t;
+    void (* complete_cb[APPL_TRANSITION_MAX])(void*);
+    void* blob[APPL_TRANSITION_MAX];
+    UINT32 index, ch, count;
+    UINT32 elapsed, duration, progress;
+    UCHAR  update, active;
+    MS_IGNORE_UNUSED_PARAM(args);
+    MS_IGNORE_UNUSED_PARAM(size);
+    appl_transition_timer = EM_TIMER_HANDLE_INIT_VAL;
+    update = MS_FALSE;
+    active = MS_FALSE;
+    count = 0;
+
+    for (index = 0; index < APPL_TRANSITION_MAX; index++)
+    {
+        t = &appl_transition[index];
+
+        if (APPL_TRANSITION_DELAY == t->state)
+        {
+            if (t->delay_ms > APPL_TRANSITION_TICK_MS)
+            {
+                t->delay_ms -= APPL_TRANSITION_TICK_MS;
+                active = MS_TRUE;
+                continue;
+            }
+
+            t->delay_ms = 0;
+            appl_transition_run(t);
+            update = MS_TRUE;
+        }
+
+        if (APPL_TRANSITION_RUN != t->state)
+        {
+            continue;
+        }
+
+        t->elapsed_ms += APPL_TRANSITION_TICK_MS;
+
+        if (t->elapsed_ms >= t->duration_ms)
+        {
+            t->elapsed_ms = t->duration_ms;
+        }
+
+        /* Scale to 16 bits to have Q15 progress in 32 bits */
+        elapsed = t->elapsed_ms;
+        duration = t->duration_ms;
+
+        while (duration > 0xFFFF)
+        {
+            elapsed >>= 1;
+            duration >>= 1;
+        }
+
+        progress = (0 == duration) ? 0x8000 : ((elapsed << 15) / duration);
+
+        for (ch = 0; ch < APPL_LIGHT_OUT_NUM; ch++)
+        {
+            if (0 != (t->mask & APPL_LIGHT_OUT_MASK(ch)))
+            {
+                appl_light_out.value[ch] = appl_transition_interpolate(ch, t->from[ch], t->to[ch], progress);
+                update = MS_TRUE;
+            }
+        }
+
+        if (t->elapsed_ms == t->duration_ms)
+        {
+            complete_cb[count] = t->transition_complete_cb;
+            blob[count] = t->blob;
+            count++;
+            t->state = APPL_TRANSITION_IDLE;
+            t->handle = APPL_TRANSITION_HANDLE_INVALID;
+            t->mask = 0;
+        }
+        else
+        {
+            active = MS_TRUE;
+        }
+    }
+
+    /* One PWM update for all channels */
+    if (MS_TRUE == update)
+    {
+        appl_light_output_apply();
+    }
+
+    if (MS_TRUE == active)
+    {
+        appl_transition_timer_start();
+    }
+
+    for (index = 0; index < count; index++)
+    {
+        if (NULL != complete_cb[index])
+        {
+            complete_cb[index](blob[index]);
+        }
+    }
+}
+
+/* Stop a transition, light output stays at the present value */
+static void appl_transition_stop(UINT16 handle)
+{
+    APPL_TRANSITION* t;
+    t = appl_transition_search(handle);
+
+    if (NULL != t)
+    {
+        t->state = APPL_TRANSITION_IDLE;
+        t->handle = APPL_TRANSITION_HANDLE_INVALID;
+        t->mask = 0;
+    }
+}
+
+/**
+    Start a transition replacing the one in handle. Light output
+    channels in mask move to target, other fields follow MS_common
+    transition timer.
+*/
+static API_RESULT appl_transition_start
+(
+    /* IN */    MS_ACCESS_STATE_TRANSITION_TYPE* transition,
+    /* IN */    UINT8                            mode,
+    /* IN */    UINT8                            mask,
+    /* IN */    UINT16*                          target,
+    /* INOUT */ UINT16*                          handle
+)
+{
+    APPL_TRANSITION* t;
+    UINT32 index, ch;
+    appl_transition_stop(*handle);
+    *handle = APPL_TRANSITION_HANDLE_INVALID;
+    t = NULL;
+
+    for (index = 0; index < APPL_TRANSITION_MAX; index++)
+    {
+        if (APPL_TRANSITION_IDLE == appl_transition[index].state)
+        {
+            t = &appl_transition[index];
+            break;
+        }
+    }
+
+    if (NULL == t)
+    {
+        /* No free transition, change at once */
+        CONSOLE_OUT("Transition Engine Full\n");
+
+        if (NULL != transition->transition_start_cb)
+        {
+            transition->transition_start_cb(transition->blob);
+        }
+
+        if (0 != mask)
+        {
+            appl_light_output_set(mode, mask, target);
+        }
+
+        if (NULL != transition->transition_complete_cb)
+        {
+            transition->transition_complete_cb(transition->blob);
+        }
+
+        return API_FAILURE;
+    }
+
+    /* Handle has a sequence number so that stale handles are not valid */
+    appl_transition_seq++;
+
+    if (0x0FFF <= appl_transition_seq)
+    {
+        appl_transition_seq = 1;
+    }
+
+    t->handle = (UINT16)((appl_transition_seq << 4) | index);
+    t->transition_start_cb = transition->transition_start_cb;
+    t->transition_complete_cb = transition->transition_complete_cb;
+    t->blob = transition->blob;
+    t->delay_ms = (UINT32)transition->delay * 5;
+    t->duration_ms = appl_transition_time_in_ms(transition->transition_time);
+    t->elapsed_ms = 0;
+    t->mask = mask;
+    t->mode = mode;
+
+    for (ch = 0; ch < APPL_LIGHT_OUT_NUM; ch++)
+    {
+        t->to[ch] = (NULL != target) ? target[ch] : 0;
+    }
+
+    *handle = t->handle;
+
+    if (0 == t->delay_ms)
+    {
+        appl_transition_run(t);
+    }
+    else
+    {
+        t->state = APPL_TRANSITION_DELAY;
+    }
+
+    appl_transition_timer_start();
+    return API_SUCCESS;
+}
+
+static API_RESULT appl_transition_get_remaining(UINT16 handle, UINT8* remaining_transition_time)
+{
+    APPL_TRANSITION* t;
+    t = appl_transition_search(handle);
+
+    if (NULL == t)
+    {
+        return API_FAILURE;
+    }
+
+    return MS_common_get_transition_time_from_ms
+           (
+               t->delay_ms + (t->duration_ms - t->elapsed_ms),
+               remaining_transition_time
+           );
+}
+
+/** ---------------- Publication Scheduler ---- */
+/**
+    State changes are published through the scheduler. The first change
+    of a state goes out at once, later changes within the minimum interval
+    are coalesced and the state at the end of the interval is published,
+    so the final state is always sent. Once a state settles, it is
+    published again as per the retransmit policy.
+*/
+#ifndef APPL_PUBLISH_TICK_MS
+    #define APPL_PUBLISH_TICK_MS             50
+#endif /* APPL_PUBLISH_TICK_MS */
+
+#ifndef APPL_PUBLISH_MIN_INTERVAL_MS
+    #define APPL_PUBLISH_MIN_INTERVAL_MS     300
+#endif /* APPL_PUBLISH_MIN_INTERVAL_MS */
+
+#ifndef APPL_PUBLISH_RETX_COUNT
+    #define APPL_PUBLISH_RETX_COUNT          1
+#endif /* APPL_PUBLISH_RETX_COUNT */
+
+#ifndef APPL_PUBLISH_RETX_INTERVAL_MS
+    #define APPL_PUBLISH_RETX_INTERVAL_MS    1000
+#endif /* APPL_PUBLISH_RETX_INTERVAL_MS */
+
+#define APPL_PUBLISH_MAX                     8
+
+typedef void (* APPL_PUBLISH_FN)(UINT8 state_type, UINT16 state_inst);
+
+typedef struct _APPL_PUBLISH
+{
+    /* Server publish function, NULL if slot is free */
+    APPL_PUBLISH_FN publish;
+
+    UINT16 state_inst;
+
+    UINT8  state_type;
+
+    /* State changed since the last publish */
+    UINT8  pending;
+
+    /* Retransmissions left of the last published state */
+    UINT8  retx_left;
+
+    /* Time since the state was last published */
+    UINT32 elapsed_ms;
+
+} APPL_PUBLISH;
+
+static APPL_PUBLISH appl_publish[APPL_PUBLISH_MAX];
+static EM_timer_handle appl_publish_timer = EM_TIMER_HANDLE_INIT_VAL;
+static APPL_MODEL_PUBLISH_POLICY appl_publish_policy =
+{
+    APPL_PUBLISH_MIN_INTERVAL_MS,
+    APPL_PUBLISH_RETX_INTERVAL_MS,
+    APPL_PUBLISH_RETX_COUNT
+};
+static APPL_MODEL_PUBLISH_STATS appl_publish_stats;
+
+static void appl_publish_timeout_handler(void* args, UINT16 size);
+
+static void appl_publish_timer_start(void)
+{
+    if (EM_TIMER_HANDLE_INIT_VAL != appl_publish_timer)
+    {
+        return;
+    }
+
+    if (EM_SUCCESS != EM_start_timer
+            (
+                &appl_publish_timer,
+                (EM_TIMEOUT_MILLISEC | APPL_PUBLISH_TICK_MS),
+                appl_publish_timeout_handler,
+                NULL,
+                0
+            ))
+    {
+        appl_publish_timer = EM_TIMER_HANDLE_INIT_VAL;
+    }
+}
+
+static void appl_publish_send(APPL_PUBLISH* p)
+{
+    p->pending = MS_FALSE;
+    p->retx_left = appl_publish_policy.retx_count;
+    p->elapsed_ms = 0;
+    appl_publish_stats.sent++;
+    /* Publish function reads the present state */
+    p->publish(p->state_type, p->state_inst);
+}
+
+static void appl_publish_timeout_handler(void* args, UINT16 size)
+{
+    APPL_PUBLISH* p;
+    UINT32 index;
+    UCHAR  active;
+    MS_IGNORE_UNUSED_PARAM(args);
+    MS_IGNORE_UNUSED_PARAM(size);
+    appl_publish_timer = EM_TIMER_HANDLE_INIT_VAL;
+    active = MS_FALSE;
+
+    for (index = 0; index < APPL_PUBLISH_MAX; index++)
+    {
+        p = &appl_publish[index];
+
+        if (NULL == p->publish)
+        {
+            continue;
+        }
+
+        p->elapsed_ms += APPL_PUBLISH_TICK_MS;
+
+        if (MS_TRUE == p->pending)
+        {
+            if (p->elapsed_ms >= appl_publish_policy.min_interval_ms)
+            {
+                /* Latest of the coalesced changes */
+                appl_publish_send(p);
+            }
+        }
+        else if (0 != p->retx_left)
+        {
+            if (p->elapsed_ms >= appl_publish_policy.retx_interval_ms)
+            {
+                p->retx_left--;
+                p->elapsed_ms = 0;
+                appl_publish_stats.retransmitted++;
+                p->publish(p->state_type, p->state_inst);
+            }
+        }
+        else if (p->elapsed_ms >= appl_publish_policy.min_interval_ms)
+        {
+            /* Settled, free the slot */
+            p->publish = NULL;
+            continue;
+        }
+
+        active = MS_TRUE;
+    }
+
+    if (MS_TRUE == active)
+    {
+        appl_publish_timer_start();
+    }
+}
+
+/* Publish now, or on the tick after the minimum interval */
+static void appl_publish_schedule(APPL_PUBLISH_FN publish, UINT8 state_type, UINT16 state_inst)
+{
+    APPL_PUBLISH* p;
+    UINT32 index;
+    appl_publish_stats.requested++;
+    p = NULL;
+
+    for (index = 0; index < APPL_PUBLISH_MAX; index++)
+    {
+        if ((publish == appl_publish[index].publish) &&
+                (state_type == appl_publish[index].state_type) &&
+                (state_inst == appl_publish[index].state_inst))
+        {
+            p = &appl_publish[index];
+            break;
+        }
+
+        if ((NULL == p) && (NULL == appl_publish[index].publish))
+        {
+            p = &appl_publish[index];
+        }
+    }
+
+    if ((NULL == p) || (0 == appl_publish_policy.min_interval_ms))
+    {
+        /* No coalescing */
+        appl_publish_stats.sent++;
+        publish(state_type, state_inst);
+        return;
+    }
+
+    if (NULL == p->publish)
+    {
+        p->publish = publish;
+        p->state_type = state_type;
+        p->state_inst = state_inst;
+        p->pending = MS_FALSE;
+        p->elapsed_ms = appl_publish_policy.min_interval_ms;
+    }
+
+    /* A newer state replaces retransmissions of the older one */
+    p->retx_left = 0;
+
+    if ((MS_TRUE != p->pending) && (p->elapsed_ms >= appl_publish_policy.min_interval_ms))
+    {
+        appl_publish_send(p);
+    }
+    else if (MS_TRUE == p->pending)
+    {
+        appl_publish_stats.suppressed++;
+    }
+    else
+    {
+        p->pending = MS_TRUE;
+    }
+
+    appl_publish_timer_start();
+}
+
+static void appl_publish_initialization(void)
+{
+    EM_mem_set(appl_publish, 0, sizeof(appl_publish));
+    EM_mem_set(&appl_publish_stats, 0, sizeof(appl_publish_stats));
+}
+
+/**
+    \brief Set the publication policy of state changes.
+
+    \param [in] policy    Minimum interval and retransmit policy.
+                          Minimum interval 0 disables coalescing.
+*/
+void appl_model_publish_set_policy(/* IN */ APPL_MODEL_PUBLISH_POLICY* policy)
+{
+    appl_publish_policy = *policy;
+}
+
+/**
+    \brief Get the publication counters.
+
+    \param [out] stats    Publication counters.
+    \param [in]  reset    MS_TRUE to clear counters after reading.
+*/
+void appl_model_publish_get_stats(/* OUT */ APPL_MODEL_PUBLISH_STATS* stats, /* IN */ UCHAR reset)
+{
+    *stats = appl_publish_stats;
+
+    if (MS_TRUE == reset)
+    {
+        EM_mem_set(&appl_publish_stats, 0, sizeof(appl_publish_stats));
+    }
+}
+
 /** ---------------- Model Binding ---- */
 static void appl_set_generic_level(UINT16 state_inst, UINT16 level, UINT8 propagate, UCHAR is_calculated);
 
@@ -318,7 +1016,7 @@ static void appl_set_generic_power_level_actual(UINT16 state_inst, UINT16 actual
         appl_generic_power_level[state_inst].generic_power_last.power_last = actual;
         appl_generic_power_level[state_inst].generic_power_actual.power_actual = actual;
         /* Publish State Change */
-        appl_generic_power_level_server_publish(MS_STATE_GENERIC_POWER_ACTUAL_T, state_inst);
+        appl_publish_schedule(appl_generic_power_level_server_publish, MS_STATE_GENERIC_POWER_ACTUAL_T, state_inst);
         appl_light_lightness_set_actual(state_inst, actual, MS_FALSE);
         /* Light HSL Lightness = Light Lightness Actual */
         appl_light_hsl[state_inst].hsl_lightness = actual;
@@ -372,7 +1070,7 @@ static void appl_set_generic_power_level_default(UINT16 state_inst, UINT16 actua
     if (actual != appl_generic_power_level[state_inst].generic_power_default.power_default)
     {
         appl_generic_power_level[state_inst].generic_power_default.power_default = actual;
-        appl_generic_power_level_server_publish(MS_STATE_GENERIC_POWER_DEFAULT_T, state_inst);
+        appl_publish_schedule(appl_generic_power_level_server_publish, MS_STATE_GENERIC_POWER_DEFAULT_T, state_inst);
         /* Propagate to Generic Power Actual */
         /* appl_set_generic_power_level_actual(state_inst, actual, MS_TRUE); */
     }
@@ -405,7 +1103,7 @@ static void appl_set_generic_level(UINT16 state_inst, UINT16 level, UINT8 propag
         appl_generic_level_info[state_inst].generic_level.level = level;
         appl_generic_level_info[state_inst].generic_level.target_level = 0;
         appl_generic_level_info[state_inst].generic_level.delta_level = 0;
-        appl_generic_level_server_publish(MS_STATE_GENERIC_LEVEL_T, state_inst);
+        appl_publish_schedule(appl_generic_level_server_publish, MS_STATE_GENERIC_LEVEL_T, state_inst);
 
         /* Set Power Actual and rest will be set */
         if (MS_TRUE == propagate)
@@ -453,6 +1151,26 @@ static void appl_generic_onoff_transition_complete_cb(void* blob)
     appl_generic_onoff[0].target_onoff = 0;
 }
 
+/* Light Lightness of the Light Output for Generic OnOff */
+static UINT16 appl_generic_onoff_to_lightness(UINT16 state_inst, UINT8 onoff)
+{
+    UINT16 actual;
+
+    if (0x00 == onoff)
+    {
+        return 0x0000;
+    }
+
+    actual = appl_light_lightness[state_inst].light_lightness_default.lightness_default;
+
+    if (0x0000 == actual)
+    {
+        actual = appl_light_lightness[state_inst].light_lightness_last.lightness_last;
+    }
+
+    return (0x0000 != actual) ? actual : 0xFFFF;
+}
+
 /* Generic OnOff Model Get Handlers */
 static API_RESULT appl_model_generic_onoff_state_get(UINT16 state_t, UINT16 state_inst, void* param, UINT8 direction)
 {
@@ -472,7 +1190,7 @@ static API_RESULT appl_model_generic_onoff_state_get(UINT16 state_t, UINT16 stat
 
         if (0 != param_p->transition_time)
         {
-            ret = MS_common_get_remaining_transition_time
+            ret = appl_transition_get_remaining
                   (
                       appl_generic_onoff[0].transition_time_handle,
                       &transition_time
@@ -506,8 +1224,10 @@ static API_RESULT appl_model_generic_onoff_state_set(UINT16 state_t, UINT16 stat
     case MS_STATE_GENERIC_ONOFF_T:
     {
         MS_STATE_GENERIC_ONOFF_STRUCT* param_p;
+        UINT16                          target[APPL_LIGHT_OUT_NUM];
         param_p = (MS_STATE_GENERIC_ONOFF_STRUCT*)param;
         CONSOLE_OUT("Generic OnOff State Set: 0x%02X\n", param_p->onoff);
+        target[APPL_LIGHT_OUT_LIGHTNESS] = appl_generic_onoff_to_lightness(0, param_p->onoff);
 
         /* Check if state transition is specified */
         if (0 != param_p->transition_time)
@@ -522,9 +1242,12 @@ static API_RESULT appl_model_generic_onoff_state_set(UINT16 state_t, UINT16 stat
             transition.transition_start_cb = appl_generic_onoff_transition_start_cb;
             transition.transition_complete_cb = appl_generic_onoff_transition_complete_cb;
             *param_p = appl_generic_onoff[0];
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
+                APPL_LIGHT_MODE_KEEP,
+                APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS),
+                target,
                 &appl_generic_onoff[0].transition_time_handle
             );
             /* Return value to indicate not sending status right now */
@@ -535,14 +1258,13 @@ static API_RESULT appl_model_generic_onoff_state_set(UINT16 state_t, UINT16 stat
             /* Instantaneous Change */
             appl_set_generic_onoff(state_inst, param_p->onoff, MS_FALSE);
             *param_p = appl_generic_onoff[0];
+            appl_light_output_set(APPL_LIGHT_MODE_KEEP, APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS), target);
         }
 
         CONSOLE_OUT("[state] current: 0x%02X\n", appl_generic_onoff[0].onoff);
         CONSOLE_OUT("[state] target: 0x%02X\n", appl_generic_onoff[0].target_onoff);
         CONSOLE_OUT("[state] remaining_time: 0x%02X\n", appl_generic_onoff[0].transition_time);
         /* Ignoring Instance and direction right now */
-        /* Call platform specific handling for generic set */
-        generic_onoff_set_pl (appl_generic_onoff[0].onoff);
     }
     break;
 
@@ -649,7 +1371,7 @@ static API_RESULT appl_model_generic_level_state_get(UINT16 state_t, UINT16 stat
 
         if (0 != param_p->transition_time)
         {
-            ret = MS_common_get_remaining_transition_time
+            ret = appl_transition_get_remaining
                   (
                       appl_generic_level_info[0].transition_time_handle,
                       &transition_time
@@ -680,7 +1402,11 @@ static API_RESULT appl_model_generic_level_state_set(UINT16 state_t, UINT16 stat
         2 : End of Transaction
     */
     UINT8                           transaction_state;
+    UINT16                          target[APPL_LIGHT_OUT_NUM];
+    UINT8                           mask;
     param_p = (MS_STATE_GENERIC_LEVEL_STRUCT*)param;
+    /* Move has no target, its transition must not pick up stack garbage */
+    EM_mem_set(target, 0, sizeof(target));
 
     switch (state_t)
     {
@@ -689,13 +1415,15 @@ static API_RESULT appl_model_generic_level_state_set(UINT16 state_t, UINT16 stat
         /* Ignoring Instance and direction right now */
         /* TODO: Not handling transaction state */
         {
-            MS_common_stop_transition_timer(appl_generic_level_info[0].transition_time_handle);
+            appl_transition_stop(appl_generic_level_info[0].transition_time_handle);
             appl_generic_level_info[0].transition_time_handle = 0xFFFF;
             appl_generic_level_info[0].generic_level.transition_time = 0x00;
 
             if (0 == param_p->transition_time)
             {
                 appl_set_generic_level(0, param_p->level, MS_TRUE, MS_FALSE);
+                target[APPL_LIGHT_OUT_LIGHTNESS] = (UINT16)(param_p->level + 32768);
+                appl_light_output_set(APPL_LIGHT_MODE_KEEP, APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS), target);
             }
             else
             {
@@ -713,7 +1441,7 @@ static API_RESULT appl_model_generic_level_state_set(UINT16 state_t, UINT16 stat
         {
             transaction_state = 0x00;
             /* Stop associated Transaction Timer, if any */
-            MS_common_stop_transition_timer(appl_generic_level_info[0].transition_time_handle);
+            appl_transition_stop(appl_generic_level_info[0].transition_time_handle);
             appl_generic_level_info[0].transition_time_handle = 0xFFFF;
             appl_generic_level_info[0].generic_level.transition_time = 0x00;
             appl_generic_level_info[0].operation_type = state_t;
@@ -727,7 +1455,7 @@ static API_RESULT appl_model_generic_level_state_set(UINT16 state_t, UINT16 stat
         {
             transaction_state = 0x02;
             /* Stop associated Transaction Timer, if any */
-            MS_common_stop_transition_timer(appl_generic_level_info[0].transition_time_handle);
+            appl_transition_stop(appl_generic_level_info[0].transition_time_handle);
             appl_generic_level_info[0].transition_time_handle = 0xFFFF;
             appl_generic_level_info[0].generic_level.transition_time = 0x00;
             appl_generic_level_info[0].operation_type = state_t;
@@ -776,9 +1504,21 @@ static API_RESULT appl_model_generic_level_state_set(UINT16 state_t, UINT16 stat
         transition.blob = (void*)(intptr_t)state_t;
         transition.transition_start_cb = appl_generic_level_transition_start_cb;
         transition.transition_complete_cb = appl_generic_level_transition_complete_cb;
-        MS_common_start_transition_timer
+        /* Generic Level is bound to Light Lightness, Move has no target */
+        mask = 0;
+
+        if (MS_STATE_MOVE_LEVEL_T != state_t)
+        {
+            target[APPL_LIGHT_OUT_LIGHTNESS] = (UINT16)(appl_generic_level_info[0].generic_level.target_level + 32768);
+            mask = APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS);
+        }
+
+        appl_transition_start
         (
             &transition,
+            APPL_LIGHT_MODE_KEEP,
+            mask,
+            target,
             &appl_generic_level_info[0].transition_time_handle
         );
     }
@@ -923,7 +1663,7 @@ static API_RESULT appl_model_generic_power_level_state_get(UINT16 state_t, UINT1
 
         if (0 != param_p->transition_time)
         {
-            ret = MS_common_get_remaining_transition_time
+            ret = appl_transition_get_remaining
                   (
                       appl_generic_power_level[0].generic_power_actual.transition_time_handle,
                       &transition_time
@@ -981,7 +1721,10 @@ static API_RESULT appl_model_generic_power_level_state_set(UINT16 state_t, UINT1
     case MS_STATE_GENERIC_POWER_ACTUAL_T:
     {
         MS_STATE_GENERIC_POWER_ACTUAL_STRUCT* param_p;
+        UINT16                                target[APPL_LIGHT_OUT_NUM];
         param_p = (MS_STATE_GENERIC_POWER_ACTUAL_STRUCT*)param;
+        /* Generic Power Actual is bound to Light Lightness */
+        target[APPL_LIGHT_OUT_LIGHTNESS] = param_p->power_actual;
 
         /* Check if state transition is specified */
         if (0 != param_p->transition_time)
@@ -994,9 +1737,12 @@ static API_RESULT appl_model_generic_power_level_state_set(UINT16 state_t, UINT1
             transition.blob = NULL;
             transition.transition_start_cb = appl_generic_power_level_transition_start_cb;
             transition.transition_complete_cb = appl_generic_power_level_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
+                APPL_LIGHT_MODE_KEEP,
+                APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS),
+                target,
                 &appl_generic_power_level[state_inst].generic_power_actual.transition_time_handle
             );
             /* Return value to indicate not sending status right now */
@@ -1007,6 +1753,7 @@ static API_RESULT appl_model_generic_power_level_state_set(UINT16 state_t, UINT1
             /* Instantaneous Change */
             /* Ignoring Instance and direction right now */
             appl_power_level_set_actual(0, param_p->power_actual);
+            appl_light_output_set(APPL_LIGHT_MODE_KEEP, APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS), target);
         }
 
         *param_p = appl_generic_power_level[0].generic_power_actual;
@@ -1936,7 +2683,7 @@ static void appl_light_lightness_set_actual(UINT16 state_inst, UINT16 actual, UC
     {
         appl_light_lightness[state_inst].light_lightness_actual.lightness_actual = actual;
         /* Publish State Change */
-        appl_light_lightness_server_publish(MS_STATE_LIGHT_LIGHTNESS_ACTUAL_T, state_inst);
+        appl_publish_schedule(appl_light_lightness_server_publish, MS_STATE_LIGHT_LIGHTNESS_ACTUAL_T, state_inst);
 
         /* If Lightness Actual is non-zero, save as Lightness Last */
         if (0x0000 != actual)
@@ -1952,7 +2699,7 @@ static void appl_light_lightness_set_actual(UINT16 state_inst, UINT16 actual, UC
     else if (MS_TRUE == forced_publish)
     {
         /* Publish State Change */
-        appl_light_lightness_server_publish(MS_STATE_LIGHT_LIGHTNESS_ACTUAL_T, state_inst);
+        appl_publish_schedule(appl_light_lightness_server_publish, MS_STATE_LIGHT_LIGHTNESS_ACTUAL_T, state_inst);
     }
 }
 
@@ -1993,7 +2740,7 @@ static void appl_set_generic_onoff(UINT16 state_inst, UINT8 onoff, UINT8 forced_
         /* TODO: See if this to be stored */
         APPL_GENERIC_ONOFF_SET(state_inst, onoff);
         /* Publish State Change */
-        appl_generic_onoff_server_publish(MS_STATE_GENERIC_ONOFF_T, 0x00);
+        appl_publish_schedule(appl_generic_onoff_server_publish, MS_STATE_GENERIC_ONOFF_T, 0x00);
         appl_light_lc_onoff[state_inst].present_light_onoff = onoff;
 
         /* Binding */
@@ -2036,7 +2783,7 @@ static void appl_set_generic_onoff(UINT16 state_inst, UINT8 onoff, UINT8 forced_
     else if (MS_TRUE == forced_publish)
     {
         /* Publish State Change */
-        appl_generic_onoff_server_publish(MS_STATE_GENERIC_ONOFF_T, 0x00);
+        appl_publish_schedule(appl_generic_onoff_server_publish, MS_STATE_GENERIC_ONOFF_T, 0x00);
     }
 }
 
@@ -2085,7 +2832,7 @@ static API_RESULT appl_model_light_lightness_state_get(UINT16 state_t, UINT16 st
 
         if (0 != param_p->light_lightness_actual.transition_time)
         {
-            ret = MS_common_get_remaining_transition_time
+            ret = appl_transition_get_remaining
                   (
                       param_p->light_lightness_actual.transition_time_handle,
                       &transition_time
@@ -2112,6 +2859,7 @@ static API_RESULT appl_model_light_lightness_state_set(UINT16 state_t, UINT16 st
 {
     API_RESULT retval;
     MS_STATE_LIGHT_LIGHTNESS_STRUCT* param_p;
+    UINT16                           target[APPL_LIGHT_OUT_NUM];
     param_p = (MS_STATE_LIGHT_LIGHTNESS_STRUCT*)param;
     retval = API_SUCCESS;
 
@@ -2149,10 +2897,12 @@ static API_RESULT appl_model_light_lightness_state_set(UINT16 state_t, UINT16 st
 
     case MS_STATE_LIGHT_LIGHTNESS_LINEAR_T:
     {
+        /* Light Lightness actual = sqrt(Linear * 65535) */
+        target[APPL_LIGHT_OUT_LIGHTNESS] = (UINT16)sqrt((UINT32)param_p->light_lightness_linear.lightness_linear * 65535);
+
         if (0 != param_p->light_lightness_linear.transition_time)
         {
             MS_ACCESS_STATE_TRANSITION_TYPE   transition;
-            UINT16                            transition_time_handle;
             appl_light_lightness[0].light_lightness_linear.lightness_target = param_p->light_lightness_linear.lightness_linear;
             appl_light_lightness[0].light_lightness_linear.transition_time = param_p->light_lightness_linear.transition_time;
             transition.delay = param_p->light_lightness_linear.delay;
@@ -2160,10 +2910,13 @@ static API_RESULT appl_model_light_lightness_state_set(UINT16 state_t, UINT16 st
             transition.blob = NULL;
             transition.transition_start_cb = appl_light_lightness_linear_transition_start_cb;
             transition.transition_complete_cb = appl_light_lightness_linear_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
-                &transition_time_handle
+                APPL_LIGHT_MODE_KEEP,
+                APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS),
+                target,
+                &appl_light_lightness_linear_transition_handle
             );
             /* Return value to indicate not sending status right now */
             retval = API_FAILURE;
@@ -2173,6 +2926,7 @@ static API_RESULT appl_model_light_lightness_state_set(UINT16 state_t, UINT16 st
             /* Instantaneous Change */
             /* appl_generic_onoff[0].onoff = param_p->onoff; */
             appl_light_lightness_set_linear(0, param_p->light_lightness_linear.lightness_linear);
+            appl_light_output_set(APPL_LIGHT_MODE_KEEP, APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS), target);
         }
 
         *param_p = appl_light_lightness[0];
@@ -2193,6 +2947,7 @@ static API_RESULT appl_model_light_lightness_state_set(UINT16 state_t, UINT16 st
     case MS_STATE_LIGHT_LIGHTNESS_ACTUAL_T:
     {
         printf("**** MS_STATE_LIGHT_LIGHTNESS_ACTUAL_T ***\n");
+        target[APPL_LIGHT_OUT_LIGHTNESS] = param_p->light_lightness_actual.lightness_actual;
 
         if (0 != param_p->light_lightness_actual.transition_time)
         {
@@ -2204,9 +2959,12 @@ static API_RESULT appl_model_light_lightness_state_set(UINT16 state_t, UINT16 st
             transition.blob = NULL;
             transition.transition_start_cb = appl_light_lightness_transition_start_cb;
             transition.transition_complete_cb = appl_light_lightness_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
+                APPL_LIGHT_MODE_KEEP,
+                APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS),
+                target,
                 &appl_light_lightness[0].light_lightness_actual.transition_time_handle
             );
             /* Return value to indicate not sending status right now */
@@ -2217,6 +2975,7 @@ static API_RESULT appl_model_light_lightness_state_set(UINT16 state_t, UINT16 st
             /* Instantaneous Change */
             /* appl_generic_onoff[0].onoff = param_p->onoff; */
             appl_light_lightness_set_actual(0, param_p->light_lightness_actual.lightness_actual, MS_FALSE);
+            appl_light_output_set(APPL_LIGHT_MODE_KEEP, APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_LIGHTNESS), target);
         }
 
         *param_p = appl_light_lightness[0];
@@ -2265,13 +3024,13 @@ static void appl_light_ctl_lightness_set_actual(UINT16 state_inst, UINT16 lightn
         appl_light_ctl[state_inst].ctl_lightness = lightness;
         appl_light_ctl_temp_set_actual(state_inst, temperature, delta_uv, MS_FALSE);
         /* Publish State Change */
-        appl_light_ctl_server_publish(MS_STATE_LIGHT_CTL_T, state_inst);
+        appl_publish_schedule(appl_light_ctl_server_publish, MS_STATE_LIGHT_CTL_T, state_inst);
         appl_light_lightness_set_actual(state_inst, lightness, MS_FALSE);
     }
     else if (MS_TRUE == forced_publish)
     {
         /* Publish State Change */
-        appl_light_ctl_server_publish(MS_STATE_LIGHT_CTL_T, state_inst);
+        appl_publish_schedule(appl_light_ctl_server_publish, MS_STATE_LIGHT_CTL_T, state_inst);
     }
 }
 
@@ -2305,7 +3064,7 @@ static void appl_light_ctl_temp_set_actual(UINT16 state_inst, UINT16 actual, UIN
         appl_light_ctl[state_inst].ctl_delta_uv = delta_uv;
         appl_light_ctl_temperature[state_inst].ctl_temperature = actual;
         appl_light_ctl_temperature[state_inst].ctl_delta_uv = delta_uv;
-        appl_light_ctl_temperature_server_publish(MS_STATE_LIGHT_CTL_TEMPERATURE_T, state_inst);
+        appl_publish_schedule(appl_light_ctl_temperature_server_publish, MS_STATE_LIGHT_CTL_TEMPERATURE_T, state_inst);
 
         /* Check min and max are not the same */
         if (max != min)
@@ -2432,13 +3191,15 @@ static API_RESULT appl_model_light_ctl_state_set(UINT16 state_t, UINT16 state_in
     case MS_STATE_LIGHT_CTL_T:
     {
         MS_STATE_LIGHT_CTL_STRUCT* param_p;
+        UINT16                     target[APPL_LIGHT_OUT_NUM];
         param_p = (MS_STATE_LIGHT_CTL_STRUCT*)param;
+        target[APPL_LIGHT_OUT_LIGHTNESS] = param_p->ctl_lightness;
+        target[APPL_LIGHT_OUT_TEMPERATURE] = param_p->ctl_temperature;
 
         /* Check if state transition is specified */
         if (0 != param_p->transition_time)
         {
             MS_ACCESS_STATE_TRANSITION_TYPE   transition;
-            UINT16                            transition_time_handle;
             appl_light_ctl[0].target_ctl_lightness = param_p->ctl_lightness;
             appl_light_ctl[0].target_ctl_temperature = param_p->ctl_temperature;
             appl_light_ctl[0].ctl_delta_uv = param_p->ctl_delta_uv;
@@ -2448,10 +3209,13 @@ static API_RESULT appl_model_light_ctl_state_set(UINT16 state_t, UINT16 state_in
             transition.blob = NULL;
             transition.transition_start_cb = appl_light_ctl_transition_start_cb;
             transition.transition_complete_cb = appl_light_ctl_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
-                &transition_time_handle
+                APPL_LIGHT_MODE_CTL,
+                APPL_LIGHT_OUT_CTL_MASK,
+                target,
+                &appl_light_ctl_transition_handle
             );
             /* Return value to indicate not sending status right now */
             retval = API_FAILURE;
@@ -2466,6 +3230,7 @@ static API_RESULT appl_model_light_ctl_state_set(UINT16 state_t, UINT16 state_in
             appl_light_ctl[0].tid = param_p->tid;
             appl_light_lightness[state_inst].light_lightness_actual.lightness_actual = param_p->ctl_lightness;
             /* appl_light_ctl[state_inst].ctl_lightness = param_p->ctl_lightness; */
+            appl_light_output_set(APPL_LIGHT_MODE_CTL, APPL_LIGHT_OUT_CTL_MASK, target);
         }
 
         *param_p = appl_light_ctl[0];
@@ -2491,14 +3256,15 @@ static API_RESULT appl_model_light_ctl_state_set(UINT16 state_t, UINT16 state_in
     case MS_STATE_LIGHT_CTL_TEMPERATURE_T:
     {
         MS_STATE_LIGHT_CTL_TEMPERATURE_STRUCT* param_p;
+        UINT16                                 target[APPL_LIGHT_OUT_NUM];
         param_p = (MS_STATE_LIGHT_CTL_TEMPERATURE_STRUCT*)param;
         printf("Set MS_STATE_LIGHT_CTL_TEMPERATURE_T: 0x%04X\n", param_p->ctl_temperature);
+        target[APPL_LIGHT_OUT_TEMPERATURE] = param_p->ctl_temperature;
 
         /* Check if state transition is specified */
         if (0 != param_p->transition_time)
         {
             MS_ACCESS_STATE_TRANSITION_TYPE   transition;
-            UINT16                            transition_time_handle;
             appl_light_ctl_temperature[0].target_ctl_temperature = param_p->ctl_temperature;
             appl_light_ctl_temperature[0].target_ctl_delta_uv = param_p->ctl_delta_uv;
             appl_light_ctl_temperature[0].transition_time = param_p->transition_time;
@@ -2507,10 +3273,13 @@ static API_RESULT appl_model_light_ctl_state_set(UINT16 state_t, UINT16 state_in
             transition.blob = NULL;
             transition.transition_start_cb = appl_light_ctl_temperature_transition_start_cb;
             transition.transition_complete_cb = appl_light_ctl_temperature_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
-                &transition_time_handle
+                APPL_LIGHT_MODE_CTL,
+                APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_TEMPERATURE),
+                target,
+                &appl_light_ctl_temperature_transition_handle
             );
             /* Return value to indicate not sending status right now */
             retval = API_FAILURE;
@@ -2520,6 +3289,7 @@ static API_RESULT appl_model_light_ctl_state_set(UINT16 state_t, UINT16 state_in
             /* Instantaneous Change */
             /* appl_light_ctl_temperature[0] = *param_p; */
             appl_light_ctl_temp_set_actual(0, param_p->ctl_temperature, param_p->ctl_delta_uv, MS_FALSE);
+            appl_light_output_set(APPL_LIGHT_MODE_CTL, APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_TEMPERATURE), target);
         }
 
         *param_p = appl_light_ctl_temperature[0];
@@ -2575,7 +3345,7 @@ static void appl_light_hsl_set_actual(UINT16 state_inst, UINT16 lightness, UINT1
         appl_light_hsl[state_inst].hsl_lightness = lightness;
         appl_light_hsl[state_inst].hsl_hue = hue;
         appl_light_hsl[state_inst].hsl_saturation = saturation;
-        appl_light_hsl_server_publish(MS_STATE_LIGHT_HSL_T, state_inst);
+        appl_publish_schedule(appl_light_hsl_server_publish, MS_STATE_LIGHT_HSL_T, state_inst);
         /* appl_light_lightness[state_inst].light_lightness_actual.lightness_actual = param_p->hsl_lightness; */
         appl_light_lightness_set_actual(state_inst, lightness, MS_FALSE);
     }
@@ -2584,7 +3354,7 @@ static void appl_light_hsl_set_actual(UINT16 state_inst, UINT16 lightness, UINT1
         appl_light_hsl[state_inst].hsl_lightness = lightness;
         appl_light_hsl[state_inst].hsl_hue = hue;
         appl_light_hsl[state_inst].hsl_saturation = saturation;
-        appl_light_hsl_server_publish(MS_STATE_LIGHT_HSL_T, state_inst);
+        appl_publish_schedule(appl_light_hsl_server_publish, MS_STATE_LIGHT_HSL_T, state_inst);
     }
 }
 
@@ -2612,7 +3382,7 @@ static void appl_light_hsl_set_hue(UINT16 state_inst, UINT16 actual)
     if (actual != appl_light_hsl[state_inst].hsl_hue)
     {
         appl_light_hsl[state_inst].hsl_hue = actual;
-        appl_light_hsl_hue_server_publish(MS_STATE_LIGHT_HSL_HUE_T, state_inst);
+        appl_publish_schedule(appl_light_hsl_hue_server_publish, MS_STATE_LIGHT_HSL_HUE_T, state_inst);
         appl_set_generic_level(state_inst, actual - 32768, MS_TRUE, MS_FALSE);
     }
 
@@ -2637,7 +3407,7 @@ static void appl_light_hsl_set_saturation(UINT16 state_inst, UINT16 actual)
     if (actual != appl_light_hsl[state_inst].hsl_saturation)
     {
         appl_light_hsl[state_inst].hsl_saturation = actual;
-        appl_light_hsl_saturation_server_publish(MS_STATE_LIGHT_HSL_SATURATION_T, state_inst);
+        appl_publish_schedule(appl_light_hsl_saturation_server_publish, MS_STATE_LIGHT_HSL_SATURATION_T, state_inst);
         /* Generic Level = (Light CTL Temperature - T _MIN) * 65535 / (T_MAX - T_MIN) - 32768 */
         appl_set_generic_level(state_inst, actual - 32768, MS_TRUE, MS_FALSE);
     }
@@ -2721,7 +3491,7 @@ static API_RESULT appl_model_light_hsl_state_get(UINT16 state_t, UINT16 state_in
 
         if (0 != param_p->transition_time)
         {
-            ret = MS_common_get_remaining_transition_time
+            ret = appl_transition_get_remaining
                   (
                       param_p->transition_time_handle,
                       &transition_time
@@ -2771,7 +3541,7 @@ static API_RESULT appl_model_light_hsl_state_get(UINT16 state_t, UINT16 state_in
 
         if (0 != param_p->transition_time)
         {
-            ret = MS_common_get_remaining_transition_time
+            ret = appl_transition_get_remaining
                   (
                       param_p->transition_time_handle,
                       &transition_time
@@ -2794,7 +3564,7 @@ static API_RESULT appl_model_light_hsl_state_get(UINT16 state_t, UINT16 state_in
 
         if (0 != param_p->transition_time)
         {
-            ret = MS_common_get_remaining_transition_time
+            ret = appl_transition_get_remaining
                   (
                       param_p->transition_time_handle,
                       &transition_time
@@ -2818,6 +3588,7 @@ static API_RESULT appl_model_light_hsl_state_get(UINT16 state_t, UINT16 state_in
 static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_inst, void* param, UINT8 direction)
 {
     API_RESULT retval;
+    UINT16     target[APPL_LIGHT_OUT_NUM];
     retval = API_SUCCESS;
 
     switch(state_t)
@@ -2826,6 +3597,9 @@ static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_in
     {
         MS_STATE_LIGHT_HSL_STRUCT* param_p;
         param_p = (MS_STATE_LIGHT_HSL_STRUCT*)param;
+        target[APPL_LIGHT_OUT_LIGHTNESS] = param_p->hsl_lightness;
+        target[APPL_LIGHT_OUT_HUE] = param_p->hsl_hue;
+        target[APPL_LIGHT_OUT_SATURATION] = param_p->hsl_saturation;
 
         /* Check if state transition is specified */
         if (0 != param_p->transition_time)
@@ -2840,9 +3614,12 @@ static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_in
             transition.blob = (void*)((intptr_t)state_t);
             transition.transition_start_cb = appl_light_hsl_transition_start_cb;
             transition.transition_complete_cb = appl_light_hsl_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
+                APPL_LIGHT_MODE_HSL,
+                APPL_LIGHT_OUT_HSL_MASK,
+                target,
                 &appl_light_hsl[0].transition_time_handle
             );
             /* Return value to indicate not sending status right now */
@@ -2863,6 +3640,7 @@ static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_in
             appl_light_hsl[0].tid = param_p->tid;
             /* appl_light_lightness[state_inst].light_lightness_actual.lightness_actual = param_p->hsl_lightness; */
             appl_light_xyl[state_inst].xyl_lightness = param_p->hsl_lightness;
+            appl_light_output_set(APPL_LIGHT_MODE_HSL, APPL_LIGHT_OUT_HSL_MASK, target);
         }
 
         *param_p = appl_light_hsl[0];
@@ -2900,6 +3678,7 @@ static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_in
     {
         MS_STATE_LIGHT_HSL_STRUCT* param_p;
         param_p = (MS_STATE_LIGHT_HSL_STRUCT*)param;
+        target[APPL_LIGHT_OUT_HUE] = param_p->hsl_hue;
 
         if (0 != param_p->transition_time)
         {
@@ -2911,9 +3690,12 @@ static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_in
             transition.blob = (void*)((intptr_t)state_t);
             transition.transition_start_cb = appl_light_hsl_transition_start_cb;
             transition.transition_complete_cb = appl_light_hsl_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
+                APPL_LIGHT_MODE_HSL,
+                APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_HUE),
+                target,
                 &appl_light_hsl[0].transition_time_handle
             );
             /* Return value to indicate not sending status right now */
@@ -2923,6 +3705,7 @@ static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_in
         {
             /* Ignoring Instance and direction right now */
             appl_light_hsl_set_hue(0, param_p->hsl_hue);
+            appl_light_output_set(APPL_LIGHT_MODE_HSL, APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_HUE), target);
         }
 
         *param_p = appl_light_hsl[0];
@@ -2936,12 +3719,12 @@ static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_in
     {
         MS_STATE_LIGHT_HSL_STRUCT* param_p;
         param_p = (MS_STATE_LIGHT_HSL_STRUCT*)param;
+        target[APPL_LIGHT_OUT_SATURATION] = param_p->hsl_saturation;
 
         /* Check if state transition is specified */
         if (0 != param_p->transition_time)
         {
             MS_ACCESS_STATE_TRANSITION_TYPE   transition;
-            UINT16                            transition_time_handle;
             appl_light_hsl[0].target_hsl_saturation = param_p->hsl_saturation;
             appl_light_hsl[0].transition_time = param_p->transition_time;
             transition.delay = param_p->delay;
@@ -2949,10 +3732,13 @@ static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_in
             transition.blob = (void*)((intptr_t)state_t);
             transition.transition_start_cb = appl_light_hsl_transition_start_cb;
             transition.transition_complete_cb = appl_light_hsl_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
-                &transition_time_handle
+                APPL_LIGHT_MODE_HSL,
+                APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_SATURATION),
+                target,
+                &appl_light_hsl[0].transition_time_handle
             );
             /* Return value to indicate not sending status right now */
             retval = API_FAILURE;
@@ -2961,6 +3747,7 @@ static API_RESULT appl_model_light_hsl_state_set(UINT16 state_t, UINT16 state_in
         {
             /* Ignoring Instance and direction right now */
             appl_light_hsl_set_saturation(0, param_p->hsl_saturation);
+            appl_light_output_set(APPL_LIGHT_MODE_HSL, APPL_LIGHT_OUT_MASK(APPL_LIGHT_OUT_SATURATION), target);
         }
 
         *param_p = appl_light_hsl[0];
@@ -3045,7 +3832,7 @@ static void appl_light_xyl_set_actual(UINT16 state_inst, UINT16 xyl_lightness, U
         appl_light_xyl_set_x(state_inst, xyl_x);
         appl_light_xyl_set_y(state_inst, xyl_y);
         /* Publish */
-        appl_light_xyl_server_publish(MS_STATE_LIGHT_XYL_T, 0);
+        appl_publish_schedule(appl_light_xyl_server_publish, MS_STATE_LIGHT_XYL_T, 0);
     }
 }
 
@@ -3116,7 +3903,7 @@ static API_RESULT appl_model_light_xyl_state_get(UINT16 state_t, UINT16 state_in
 
         if (0 != param_p->transition_time)
         {
-            ret = MS_common_get_remaining_transition_time
+            ret = appl_transition_get_remaining
                   (
                       param_p->transition_time_handle,
                       &transition_time
@@ -3181,9 +3968,12 @@ static API_RESULT appl_model_light_xyl_state_set(UINT16 state_t, UINT16 state_in
             transition.blob = (void*)((intptr_t)(state_t));
             transition.transition_start_cb = appl_light_xyl_transition_start_cb;
             transition.transition_complete_cb = appl_light_xyl_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
+                APPL_LIGHT_MODE_KEEP,
+                0,
+                NULL,
                 &appl_light_xyl[0].transition_time_handle
             );
             /* Return value to indicate not sending status right now */
@@ -3475,7 +4265,6 @@ static API_RESULT appl_model_light_lc_state_set(UINT16 state_t, UINT16 state_ins
         if (0 != param_p->transition_time)
         {
             MS_ACCESS_STATE_TRANSITION_TYPE   transition;
-            UINT16                            transition_time_handle;
             appl_light_lc_onoff[0].target_light_onoff = param_p->target_light_onoff;
             appl_light_lc_onoff[0].transition_time = param_p->transition_time;
             transition.delay = param_p->delay;
@@ -3483,10 +4272,13 @@ static API_RESULT appl_model_light_lc_state_set(UINT16 state_t, UINT16 state_ins
             transition.blob = NULL;
             transition.transition_start_cb = appl_light_lc_onoff_transition_start_cb;
             transition.transition_complete_cb = appl_light_lc_onoff_transition_complete_cb;
-            MS_common_start_transition_timer
+            appl_transition_start
             (
                 &transition,
-                &transition_time_handle
+                APPL_LIGHT_MODE_KEEP,
+                0,
+                NULL,
+                &appl_light_lc_onoff_transition_handle
             );
             /* Return value to indicate not sending status right now */
             retval = API_FAILURE;
@@ -3561,6 +4353,8 @@ void appl_model_states_initialization(void)
     appl_model_light_lc_states_initialization();
     /* Initialize Persistent Storage for application */
     appl_ps_init();
+    /* Publication Scheduler */
+    appl_publish_initialization();
     /* Load from Persistent Storage */
     appl_ps_load(MS_PS_APPL_ALL_RECORDS);
     appl_in_transtion = 0x00;
@@ -20,11 +20,43 @@
 
 
 /* --------------------------------------------- Data Types/ Structures */
+/** Publication policy of state changes */
+typedef struct _APPL_MODEL_PUBLISH_POLICY
+{
+    /** Minimum interval between publishes of a state, changes within are coalesced */
+    UINT32 min_interval_ms;
+
+    /** Interval between retransmissions of a settled state */
+    UINT32 retx_interval_ms;
+
+    /** Retransmissions of a settled state */
+    UINT8  retx_count;
+
+} APPL_MODEL_PUBLISH_POLICY;
+
+/** Publication counters */
+typedef struct _APPL_MODEL_PUBLISH_STATS
+{
+    /** State changes to be published */
+    UINT32 requested;
+
+    /** Publishes sent for state changes */
+    UINT32 sent;
+
+    /** State changes replaced by a later one before publish */
+    UINT32 suppressed;
+
+    /** Retransmissions of settled states */
+    UINT32 retransmitted;
+
+} APPL_MODEL_PUBLISH_STATS;
 
 
 /* --------------------------------------------- Function */
 void appl_model_states_initialization(void);
 API_RESULT appl_model_state_get(UINT16 state_t, UINT16 state_inst, void* param, UINT8 direction);
 API_RESULT appl_model_state_set(UINT16 state_t, UINT16 state_inst, void* param, UINT8 direction);
+void appl_model_publish_set_policy(/* IN */ APPL_MODEL_PUBLISH_POLICY* policy);
+void appl_model_publish_get_stats(/* OUT */ APPL_MODEL_PUBLISH_STATS* stats, /* IN */ UCHAR reset);
 
 #endif /*_H_APPL_MODEL_SERVER_STATE_HANDLER_ */
@@ -47,12 +47,14 @@
 #include "MS_brr_api.h"
 #include "MS_prov_api.h"
 #include "MS_access_api.h"
+#include "net_internal.h"
 #include "blebrr.h"
 #include "ll.h"
 #include "MS_trn_api.h"
 #include "pwrmgr.h"
 #include "ll_sleep.h"
 #include "led_light.h"
+#include "timer.h"
 
 
 
@@ -61,6 +63,8 @@
 /* --------------------------------------------- Global Definitions */
 #define BLEBRR_MAX_ADV_FILTER_LIST_COUNT    100
 #define BLEBRR_MAX_ADV_DATA_SIZE            31
+/* Open addressing table of filter list, power of 2 and larger than list count */
+#define BLEBRR_ADV_FILTER_HASH_SIZE         128
 
 #define BLEBRR_BCON_ELEMENTS                2
 #define BLEBRR_ACTIVEADV_TIMEOUT            1 /* Second */
@@ -78,6 +82,20 @@
 #define BLEBRR_SKIP_BEACON_QUEUE_DEPTH      0
 #define BLEBRR_BCON_READY_TIME              10
 
+/** Relay fast path buffers for relayed Network PDUs */
+#define BLEBRR_RELAY_POOL_SIZE              8
+/** Pending relay is cancelled when this many copies are heard from neighbours */
+#define BLEBRR_RELAY_SUPPRESS_COUNT         2
+/** Offset of SRC in the Network PDU header, after IVI/NID, CTL/TTL and SEQ */
+#define BLEBRR_NET_SRC_OFFSET               5
+/** Network PDU with the smallest Transport PDU and 32 bit NetMIC */
+#define BLEBRR_NET_MIN_PDU_LEN              14
+
+/** Relay buffer states */
+#define BLEBRR_RELAY_FREE                   0x00
+#define BLEBRR_RELAY_QUEUED                 0x01
+#define BLEBRR_RELAY_ACTIVE                 0x02
+
 /** Bearer Queue defines */
 #define BLEBRR_QTYPE_DATA                   0x00
 #define BLEBRR_QTYPE_BEACON                 0x01
@@ -136,6 +154,9 @@ typedef struct _BLEBRR_Q_ELEMENT
     /* Type of data element */
     UCHAR type;
 
+    /* Relay buffer index + 1 holding the data, 0 if data is allocated */
+    UCHAR relay;
+
 } BLEBRR_Q_ELEMENT;
 
 /** BLEBRR Data Queue */
@@ -163,6 +184,64 @@ typedef struct _BLEBRR_GAP_ADV_DATA
 
 } BLEBRR_GAP_ADV_DATA;
 
+/** Relay fast path buffer */
+typedef struct _BLEBRR_RELAY_BUF
+{
+    /** Length and AD Type headers followed by the Network PDU */
+    UCHAR data[BLEBRR_GAP_ADVDATA_LEN];
+
+    /** Digest of the Network PDU */
+    UINT16 digest;
+
+    /** Network PDU length */
+    UCHAR datalen;
+
+    /** Copies heard from neighbours */
+    UCHAR heard;
+
+    /** Buffer state */
+    UCHAR state;
+
+} BLEBRR_RELAY_BUF;
+
+#ifdef BLEBRR_NET_CACHE
+/** Network PDU cache entry */
+typedef struct _BLEBRR_NET_CACHE_ENTRY
+{
+    /** Hash of Network PDU, 0 for empty entry */
+    UINT32 hash;
+
+    /** Last 4 bytes of Network PDU, from NetMIC */
+    UINT32 mic;
+
+} BLEBRR_NET_CACHE_ENTRY;
+#endif /* BLEBRR_NET_CACHE */
+
+#ifdef BLEBRR_FILTER_DUPLICATE_PACKETS
+/** Duplicate Filter entry, one for each peer device */
+typedef struct _BLEBRR_ADV_FILTER_ENTRY
+{
+    /** Address type and BD Address */
+    UCHAR addr[1 + B_ADDR_LEN];
+
+    /** Home slot in hash table */
+    UCHAR home;
+
+    /** Referenced since last eviction sweep */
+    UCHAR ref;
+
+    /** Length of last ADV data */
+    UCHAR datalen;
+
+    /** Digest of last ADV data */
+    UINT16 digest;
+
+    /** Last ADV data */
+    UCHAR data[BLEBRR_MAX_ADV_DATA_SIZE];
+
+} BLEBRR_ADV_FILTER_ENTRY;
+#endif /* BLEBRR_FILTER_DUPLICATE_PACKETS */
+
 
 /* --------------------------------------------- Global Variables */
 #ifdef BLEBRR_LP_SUPPORT
@@ -170,10 +249,27 @@ typedef struct _BLEBRR_GAP_ADV_DATA
 
 #endif
 #ifdef BLEBRR_FILTER_DUPLICATE_PACKETS
-    DECL_STATIC UCHAR blebrr_adv_list[BLEBRR_MAX_ADV_FILTER_LIST_COUNT][BLEBRR_MAX_ADV_DATA_SIZE];
-    DECL_STATIC UCHAR blebrr_adv_list_inser_index = 0;
+    DECL_STATIC BLEBRR_ADV_FILTER_ENTRY blebrr_adv_list[BLEBRR_MAX_ADV_FILTER_LIST_COUNT];
+    /* Index + 1 of filter list entry, 0 for empty slot */
+    DECL_STATIC UCHAR blebrr_adv_hash[BLEBRR_ADV_FILTER_HASH_SIZE];
+    DECL_STATIC UCHAR blebrr_adv_list_count = 0;
+    DECL_STATIC UCHAR blebrr_adv_list_clock = 0;
+    DECL_STATIC BLEBRR_ADV_FILTER_STAT blebrr_adv_filter_stat;
 #endif /* BLEBRR_FILTER_DUPLICATE_PACKETS */
 
+DECL_STATIC BLEBRR_RELAY_BUF blebrr_relay_pool[BLEBRR_RELAY_POOL_SIZE];
+/* Relay buffer index + 1 of data being advertised, 0 if none */
+DECL_STATIC UCHAR blebrr_relay_active;
+DECL_STATIC BLEBRR_RELAY_STAT blebrr_relay_stat;
+
+#ifdef BLEBRR_NET_CACHE
+    /* Set associative, one set of entries is 32 bytes */
+    DECL_STATIC BLEBRR_NET_CACHE_ENTRY blebrr_net_cache[BLEBRR_NET_CACHE_SETS][BLEBRR_NET_CACHE_WAYS];
+    /* Next entry to replace in each set */
+    DECL_STATIC UCHAR blebrr_net_cache_victim[BLEBRR_NET_CACHE_SETS];
+    DECL_STATIC BLEBRR_NET_CACHE_STAT blebrr_net_cache_stat;
+#endif /* BLEBRR_NET_CACHE */
+
 BRR_BEARER_INFO blebrr_adv;  //HZF
 
 DECL_STATIC BRR_HANDLE blebrr_advhandle;
@@ -296,9 +392,23 @@ extern uint32_t osal_sys_tick;
 /* ------------------------------- Functions */
 void blebrr_handle_evt_adv_complete (UINT8 enable);
 DECL_STATIC void blebrr_timer_start (UINT32 timeout);
+DECL_STATIC void blebrr_send_start(void);
 
 API_RESULT blebrr_queue_depth_check(void);
 
+/* djb2 hash, shift and add only for M0 */
+DECL_STATIC UINT32 blebrr_adv_hash_bytes(/* IN */ UCHAR* pdata, /* IN */ UCHAR datalen)
+{
+    UINT32 h = 5381;
+
+    while (datalen--)
+    {
+        h = ((h << 5) + h) ^ (*pdata++);
+    }
+
+    return h ^ (h >> 16);
+}
+
 /**
     \brief
 
@@ -548,6 +658,211 @@ API_RESULT blebrr_queue_depth_check(void)
     return retval;
 }
 
+/**
+    \brief Check if a Network PDU is relayed by this node
+
+    \par Description
+    The network layer queues relays with its own PDUs and sends them,
+    and their retransmits, later from its Tx queue. So a relay is told
+    from the PDU itself: the header is de-obfuscated with the Privacy Key
+    of the subnet and the source is checked against the local elements.
+
+    \param pdata     Network PDU
+    \param pdatalen  Network PDU length
+
+    \return MS_TRUE if the source is not a local element, MS_FALSE otherwise
+*/
+DECL_STATIC UCHAR blebrr_relay_check(/* IN */ UCHAR* pdata, /* IN */ UINT16 pdatalen)
+{
+    MS_SUBNET_HANDLE subnet_handle;
+    MS_NET_ADDR src, addr;
+    UINT32 iv_index;
+    UCHAR privacy_key[16];
+    UCHAR encrypt_key[16];
+    UCHAR pecb_input[16];
+    UCHAR pecb_output[16];
+    UCHAR hdr[BLEBRR_NET_MIN_PDU_LEN];
+    UCHAR count;
+
+    if (BLEBRR_NET_MIN_PDU_LEN > pdatalen)
+    {
+        return MS_FALSE;
+    }
+
+    subnet_handle = MS_INVALID_SUBNET_HANDLE;
+
+    if ((API_SUCCESS != MS_access_cm_lookup_nid((pdata[0] & 0x7F), &subnet_handle, privacy_key, encrypt_key)) ||
+            (API_SUCCESS != MS_access_cm_get_iv_index_by_ivi((pdata[0] >> 7), &iv_index)) ||
+            (API_SUCCESS != MS_access_cm_get_primary_unicast_address(&addr)) ||
+            (API_SUCCESS != MS_access_cm_get_element_count(&count)))
+    {
+        return MS_FALSE;
+    }
+
+    /* PECB input is taken from the bytes after the obfuscated header */
+    EM_mem_copy(hdr, pdata, BLEBRR_NET_MIN_PDU_LEN);
+    net_create_pecb_input(iv_index, hdr, pecb_input);
+    net_de_obfuscate(hdr, privacy_key, pecb_input, pecb_output);
+    src = ((MS_NET_ADDR)hdr[BLEBRR_NET_SRC_OFFSET] << 8) | hdr[BLEBRR_NET_SRC_OFFSET + 1];
+    return ((src >= addr) && (src < (addr + count)))? MS_FALSE: MS_TRUE;
+}
+
+DECL_STATIC UCHAR blebrr_relay_alloc(void)
+{
+    UCHAR i;
+
+    for (i = 0; i < BLEBRR_RELAY_POOL_SIZE; i++)
+    {
+        if (BLEBRR_RELAY_FREE == blebrr_relay_pool[i].state)
+        {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+DECL_STATIC void blebrr_relay_release(/* IN */ UCHAR relay)
+{
+    if (0 != relay)
+    {
+        blebrr_relay_pool[relay - 1].state = BLEBRR_RELAY_FREE;
+    }
+}
+
+DECL_STATIC UCHAR blebrr_relay_suppressed(/* IN */ UCHAR relay)
+{
+    return ((0 != relay) &&
+            (BLEBRR_RELAY_SUPPRESS_COUNT <= blebrr_relay_pool[relay - 1].heard))? MS_TRUE: MS_FALSE;
+}
+
+/**
+    \brief Count copies of pending relays heard from neighbours
+
+    \par Description
+    Neighbours relaying the same Network PDU at the same hop send the
+    same bytes. Once enough copies are heard, the pending relay adds
+    no coverage and is cancelled.
+
+    \param pdata     Network PDU
+    \param pdatalen  Network PDU length
+
+    \return void
+*/
+DECL_STATIC void blebrr_relay_heard(/* IN */ UCHAR* pdata, /* IN */ UINT16 pdatalen)
+{
+    BLEBRR_RELAY_BUF* buf;
+    UINT16 digest;
+    UCHAR i;
+
+    if (BLEBRR_GAP_ADVDATA_LEN - BLEBRR_NCON_ADVTYPE_OFFSET < pdatalen)
+    {
+        return;
+    }
+
+    digest = (UINT16)blebrr_adv_hash_bytes(pdata, (UCHAR)pdatalen);
+
+    for (i = 0; i < BLEBRR_RELAY_POOL_SIZE; i++)
+    {
+        buf = &blebrr_relay_pool[i];
+
+        if ((BLEBRR_RELAY_FREE != buf->state) &&
+                (buf->datalen == pdatalen) && (buf->digest == digest) &&
+                (0 == EM_mem_cmp(buf->data + BLEBRR_NCON_ADVTYPE_OFFSET, pdata, pdatalen)))
+        {
+            if (BLEBRR_RELAY_SUPPRESS_COUNT > buf->heard)
+            {
+                buf->heard++;
+            }
+
+            break;
+        }
+    }
+}
+
+#ifdef BLEBRR_NET_CACHE
+/**
+    \brief Check Network PDU against the recently received ones
+
+    \par Description
+    Copies of a Network PDU heard from several relays carry the same
+    bytes. They are dropped here, before the network layer decrypts
+    them and searches its own cache. Lookup is one set of the cache,
+    whatever the capacity.
+
+    \param pdata     Network PDU
+    \param pdatalen  Network PDU length
+
+    \return API_SUCCESS if the PDU is a copy, API_FAILURE otherwise
+*/
+DECL_STATIC API_RESULT blebrr_net_cache_check(/* IN */ UCHAR* pdata, /* IN */ UINT16 pdatalen)
+{
+    BLEBRR_NET_CACHE_ENTRY* entry;
+    UINT32 hash, mic;
+    UCHAR set, way;
+
+    if ((4 > pdatalen) || (BLEBRR_MAX_ADV_DATA_SIZE < pdatalen))
+    {
+        return API_FAILURE;
+    }
+
+    hash = blebrr_adv_hash_bytes(pdata, (UCHAR)pdatalen);
+    hash = (0 == hash)? 1: hash;
+    pdata += pdatalen - 4;
+    mic = ((UINT32)pdata[0] << 24) | ((UINT32)pdata[1] << 16) |
+          ((UINT32)pdata[2] << 8) | pdata[3];
+    set = (UCHAR)(hash & (BLEBRR_NET_CACHE_SETS - 1));
+    entry = blebrr_net_cache[set];
+
+    for (way = 0; way < BLEBRR_NET_CACHE_WAYS; way++)
+    {
+        if ((entry[way].hash == hash) && (entry[way].mic == mic))
+        {
+            blebrr_net_cache_stat.hits++;
+            return API_SUCCESS;
+        }
+    }
+
+    /* Replace the oldest entry of the set */
+    way = blebrr_net_cache_victim[set];
+    blebrr_net_cache_victim[set] = (way + 1) & (BLEBRR_NET_CACHE_WAYS - 1);
+
+    if (0 != entry[way].hash)
+    {
+        blebrr_net_cache_stat.evictions++;
+    }
+
+    entry[way].hash = hash;
+    entry[way].mic = mic;
+    blebrr_net_cache_stat.misses++;
+    return API_FAILURE;
+}
+
+/**
+    \brief Get Network PDU cache statistics
+
+    \param stat  Statistics
+
+    \return void
+*/
+void blebrr_net_cache_get_stat(/* OUT */ BLEBRR_NET_CACHE_STAT* stat)
+{
+    *stat = blebrr_net_cache_stat;
+}
+#endif /* BLEBRR_NET_CACHE */
+
+/**
+    \brief Get Relay statistics
+
+    \param stat  Statistics
+
+    \return void
+*/
+void blebrr_relay_get_stat(/* OUT */ BLEBRR_RELAY_STAT* stat)
+{
+    *stat = blebrr_relay_stat;
+}
+
 extern uint8             llState, llSecondaryState;
 /**
     \brief
@@ -570,6 +885,10 @@ DECL_STATIC API_RESULT blebrr_update_advdata(void)
     //ZQY skip bcon adv when queue is not empty
 //    printf("blebrr_get_queue_depth:%d\n",blebrr_get_queue_depth());
 
+    /* Relay advertised last is done with its repeats */
+    blebrr_relay_release(blebrr_relay_active);
+    blebrr_relay_active = 0;
+
     if(blebrr_update_advcount < BLEBRR_BCON_READY_TIME)
     {
         is_proxy_beacon = 0;
@@ -609,6 +928,17 @@ DECL_STATIC API_RESULT blebrr_update_advdata(void)
     if (!is_proxy_beacon && NULL == elt)
     {
         elt = blebrr_dequeue();
+
+        /* Skip relays already heard enough times from neighbours */
+        while ((NULL != elt) && (MS_TRUE == blebrr_relay_suppressed(elt->relay)))
+        {
+            blebrr_relay_stat.suppressed++;
+            blebrr_relay_release(elt->relay);
+            elt->relay = 0;
+            elt->pdatalen = 0;
+            elt = blebrr_dequeue();
+        }
+
         is_proxy_beacon = 1;
     }
 
@@ -630,7 +960,18 @@ DECL_STATIC API_RESULT blebrr_update_advdata(void)
         blebrr_beacon = 0;
         #endif
         /* Yes, Free the element */
-        EM_free_mem(elt->pdata);
+        if (0 != elt->relay)
+        {
+            /* Relay buffer is kept for suppression of the repeats */
+            blebrr_relay_pool[elt->relay - 1].state = BLEBRR_RELAY_ACTIVE;
+            blebrr_relay_active = elt->relay;
+            elt->relay = 0;
+        }
+        else
+        {
+            EM_free_mem(elt->pdata);
+        }
+
         elt->pdatalen = 0;
     }
 
@@ -670,7 +1011,6 @@ DECL_STATIC API_RESULT blebrr_send
     BLEBRR_Q_ELEMENT* elt
 )
 {
-    API_RESULT retval;
     UCHAR* data;
     UINT16 packet_len;
     UCHAR offset;
@@ -704,6 +1044,21 @@ DECL_STATIC API_RESULT blebrr_send
     /* Update the data and datalen */
     EM_mem_copy((elt->pdata + offset), data, datalen);
     elt->pdatalen = packet_len;
+    blebrr_send_start();
+    return API_SUCCESS;
+}
+
+/**
+    \brief
+
+    \par Description
+    Start the alternating Adv/Scan procedure for the queued data
+
+    \return void
+*/
+DECL_STATIC void blebrr_send_start(void)
+{
+    API_RESULT retval;
 
     /* Is the Adv/Scan timer running? */
     if (EM_TIMER_HANDLE_INIT_VAL != blebrr_timer_handle)
@@ -756,7 +1111,55 @@ DECL_STATIC API_RESULT blebrr_send
             }
         }
     }
+}
+
+/**
+    \brief Relay fast path
+
+    \par Description
+    Relayed Network PDU is placed in a static relay buffer instead of
+    allocated memory, and can be cancelled while pending.
+
+    \param pdata    Network PDU
+    \param datalen  Network PDU length
+    \param elt      Queue element
+
+    \return API_SUCCESS or API_FAILURE if no relay buffer is free
+*/
+DECL_STATIC API_RESULT blebrr_relay_send
+(
+    UCHAR* pdata,
+    UINT16 datalen,
+    BLEBRR_Q_ELEMENT* elt
+)
+{
+    BLEBRR_RELAY_BUF* buf;
+    UCHAR relay;
 
+    if (BLEBRR_GAP_ADVDATA_LEN - BLEBRR_NCON_ADVTYPE_OFFSET < datalen)
+    {
+        return API_FAILURE;
+    }
+
+    relay = blebrr_relay_alloc();
+
+    if (0 == relay)
+    {
+        return API_FAILURE;
+    }
+
+    buf = &blebrr_relay_pool[relay - 1];
+    buf->data[0] = (UCHAR)(datalen + 1);
+    buf->data[1] = MESH_AD_TYPE_PKT;
+    EM_mem_copy(buf->data + BLEBRR_NCON_ADVTYPE_OFFSET, pdata, datalen);
+    buf->datalen = (UCHAR)datalen;
+    buf->digest = (UINT16)blebrr_adv_hash_bytes(pdata, (UCHAR)datalen);
+    buf->heard = 0;
+    buf->state = BLEBRR_RELAY_QUEUED;
+    elt->pdata = buf->data;
+    elt->pdatalen = datalen + BLEBRR_NCON_ADVTYPE_OFFSET;
+    elt->relay = relay;
+    blebrr_send_start();
     return API_SUCCESS;
 }
 
@@ -938,6 +1341,7 @@ DECL_STATIC API_RESULT blebrr_adv_send(BRR_HANDLE* handle, UCHAR type, void* pda
 {
     API_RESULT retval;
     BLEBRR_Q_ELEMENT* elt;
+    UCHAR relay;
 
     /* Validate handle */
     if (*handle != blebrr_advhandle)
@@ -951,6 +1355,8 @@ DECL_STATIC API_RESULT blebrr_adv_send(BRR_HANDLE* handle, UCHAR type, void* pda
         return API_FAILURE;
     }
 
+    relay = (MESH_AD_TYPE_PKT == type)? blebrr_relay_check((UCHAR*)pdata, datalen): MS_FALSE;
+
     /* Enable interleaving */
     blebrr_scan_interleave = MS_TRUE;
     blebrr_update_advcount = BLEBRR_BCON_READY_TIME;    //send beacon immediately
@@ -983,6 +1389,11 @@ DECL_STATIC API_RESULT blebrr_adv_send(BRR_HANDLE* handle, UCHAR type, void* pda
     if (NULL == elt)
     {
         /* Unlock */
+        if (MS_TRUE == relay)
+        {
+            blebrr_relay_stat.dropped++;
+        }
+
         BLEBRR_UNLOCK();
         BLEBRR_LOG("Queue Full! blebrr_advscan_timeout_count = %d, ble state = %d,depth %d llstate %02x llsec %02x\r\n", blebrr_advscan_timeout_count, BLEBRR_GET_STATE(),blebrr_get_queue_depth(),llState,llSecondaryState);
         blebrr_scan_pl(FALSE);    // HZF
@@ -991,20 +1402,45 @@ DECL_STATIC API_RESULT blebrr_adv_send(BRR_HANDLE* handle, UCHAR type, void* pda
 
     /* Update element type */
     elt->type = BRR_BCON_COUNT;
-    /* Schedule to send */
-    retval = blebrr_send
-             (
-                 type,
-                 pdata,
-                 datalen,
-                 elt
-             );
+    elt->relay = 0;
+    retval = API_FAILURE;
+
+    if (MS_TRUE == relay)
+    {
+        retval = blebrr_relay_send(pdata, datalen, elt);
+    }
+
+    /* Schedule to send, relays fall back here when no relay buffer is free */
+    if (API_SUCCESS != retval)
+    {
+        retval = blebrr_send
+                 (
+                     type,
+                     pdata,
+                     datalen,
+                     elt
+                 );
+    }
 
     if(retval == API_FAILURE)
+    {
         blebrr_dequeue_manual();
+
+        if (MS_TRUE == relay)
+        {
+            blebrr_relay_stat.dropped++;
+        }
+    }
     else
+    {
         blebrr_datacount++;
 
+        if (MS_TRUE == relay)
+        {
+            blebrr_relay_stat.relayed++;
+        }
+    }
+
     /* Unlock */
     BLEBRR_UNLOCK();
     return API_SUCCESS;
@@ -1474,6 +1910,14 @@ void blebrr_pl_advertise_setup (UCHAR enable)
         {
             adv_repeat_count = (blebrr_prov_started == MS_TRUE)?BLEBRR_ADVREPEAT_PRO_COUNT:BLEBRR_ADVREPEAT_NET_COUNT;
 
+            /* Neighbours already relayed it, skip the remaining repeats */
+            if ((adv_repeat_count > blebrr_advrepeat_count) &&
+                    (MS_TRUE == blebrr_relay_suppressed(blebrr_relay_active)))
+            {
+                blebrr_relay_stat.repeats_skipped += (adv_repeat_count - blebrr_advrepeat_count);
+                blebrr_advrepeat_count = adv_repeat_count;
+            }
+
             if (/*blebrr_beacon && */(adv_repeat_count > blebrr_advrepeat_count))
             {
                 blebrr_advrepeat_count++;
@@ -1524,74 +1968,192 @@ void blebrr_pl_advertise_end (void)
 }
 
 #ifdef BLEBRR_FILTER_DUPLICATE_PACKETS
+/* Remove the entry from hash table, shift back the entries probed over it */
+DECL_STATIC void blebrr_adv_hash_remove(/* IN */ UCHAR index)
+{
+    UCHAR slot, next, home;
+    slot = blebrr_adv_list[index].home;
+
+    while ((index + 1) != blebrr_adv_hash[slot])
+    {
+        slot = (slot + 1) & (BLEBRR_ADV_FILTER_HASH_SIZE - 1);
+    }
+
+    next = slot;
+
+    while (1)
+    {
+        next = (next + 1) & (BLEBRR_ADV_FILTER_HASH_SIZE - 1);
+
+        if (0 == blebrr_adv_hash[next])
+        {
+            break;
+        }
+
+        home = blebrr_adv_list[blebrr_adv_hash[next] - 1].home;
+
+        /* Entry at next can move to slot if its home is not in (slot, next] */
+        if (((UCHAR)(next - home) & (BLEBRR_ADV_FILTER_HASH_SIZE - 1)) >=
+                ((UCHAR)(next - slot) & (BLEBRR_ADV_FILTER_HASH_SIZE - 1)))
+        {
+            blebrr_adv_hash[slot] = blebrr_adv_hash[next];
+            slot = next;
+        }
+    }
+
+    blebrr_adv_hash[slot] = 0;
+}
+
+/* Pick an entry to reuse by clock sweep, entries hit since last sweep get a second chance */
+DECL_STATIC UCHAR blebrr_adv_list_evict(void)
+{
+    UCHAR index;
+
+    while (1)
+    {
+        index = blebrr_adv_list_clock;
+        blebrr_adv_list_clock++;
+
+        if (BLEBRR_MAX_ADV_FILTER_LIST_COUNT <= blebrr_adv_list_clock)
+        {
+            blebrr_adv_list_clock = 0;
+        }
+
+        if (0 == blebrr_adv_list[index].ref)
+        {
+            break;
+        }
+
+        blebrr_adv_list[index].ref = 0;
+    }
+
+    blebrr_adv_hash_remove(index);
+    blebrr_adv_filter_stat.evictions++;
+    return index;
+}
+
 /**
-    \brief
+    \brief Check ADV packet against the last one from the same peer device
 
     \par Description
+    Filter list keeps the last ADV data of each peer device, found by hash
+    of BD Address. The packet is duplicate if it is the same as the last one.
 
+    \param addr_type  Peer address type
+    \param bd_addr    Peer BD Address
+    \param pdata      ADV data
+    \param datalen    ADV data length
 
-    \param p_adv_data_with_bd_addr
-
-    \return void
+    \return API_SUCCESS if the packet is duplicate, API_FAILURE otherwise
 */
-DECL_STATIC API_RESULT blebrr_adv_duplicate_filter(/* IN */ UCHAR* p_adv_data_with_bd_addr)
+API_RESULT blebrr_adv_duplicate_check
+(
+    /* IN */ UCHAR addr_type,
+    /* IN */ UCHAR* bd_addr,
+    /* IN */ UCHAR* pdata,
+    /* IN */ UCHAR datalen
+)
 {
-    UCHAR length, index;
-    /* Get the ADV data packet length */
-    length = p_adv_data_with_bd_addr[1 + BT_BD_ADDR_SIZE];
+    BLEBRR_ADV_FILTER_ENTRY* entry;
+    API_RESULT retval;
+    UCHAR key[1 + B_ADDR_LEN];
+    UCHAR home, slot, index;
+    UINT16 digest;
+    UINT32 start;
+    start = read_current_fine_time();
+    key[0] = addr_type;
+    EM_mem_copy(&key[1], bd_addr, B_ADDR_LEN);
+
+    if (BLEBRR_MAX_ADV_DATA_SIZE < datalen)
+    {
+        datalen = BLEBRR_MAX_ADV_DATA_SIZE;
+    }
+
+    digest = (UINT16)blebrr_adv_hash_bytes(pdata, datalen);
+    home = (UCHAR)(blebrr_adv_hash_bytes(key, sizeof(key)) & (BLEBRR_ADV_FILTER_HASH_SIZE - 1));
+    slot = home;
+    blebrr_adv_filter_stat.reports++;
 
-    for (index = 0; index < BLEBRR_MAX_ADV_FILTER_LIST_COUNT; index++)
+    /* First Match BD Addr */
+    while (0 != blebrr_adv_hash[slot])
     {
-        /* First Match BD Addr */
-        if (0 == EM_mem_cmp
-                (
-                    &blebrr_adv_list[index][0],
-                    p_adv_data_with_bd_addr,
-                    1 + BT_BD_ADDR_SIZE
-                ))
+        blebrr_adv_filter_stat.probes++;
+        entry = &blebrr_adv_list[blebrr_adv_hash[slot] - 1];
+
+        if (0 == EM_mem_cmp(entry->addr, key, sizeof(key)))
         {
-            /* Check Data Length */
-            if (blebrr_adv_list[index][1 + BT_BD_ADDR_SIZE] == p_adv_data_with_bd_addr[1 + BT_BD_ADDR_SIZE])
-            {
-                if (0 == EM_mem_cmp
-                        (
-                            &blebrr_adv_list[index][1 + BT_BD_ADDR_SIZE + 1],
-                            &p_adv_data_with_bd_addr[1 + BT_BD_ADDR_SIZE + 1],
-                            length
-                        ))
-                {
-                    return API_SUCCESS;
-                }
-            }
+            break;
+        }
+
+        slot = (slot + 1) & (BLEBRR_ADV_FILTER_HASH_SIZE - 1);
+    }
+
+    if (0 != blebrr_adv_hash[slot])
+    {
+        entry->ref = 1;
 
+        /* Digest rejects most of the new packets, data is compared only when it matches */
+        if ((entry->datalen == datalen) && (entry->digest == digest) &&
+                (0 == EM_mem_cmp(entry->data, pdata, datalen)))
+        {
+            blebrr_adv_filter_stat.duplicates++;
+            retval = API_SUCCESS;
+        }
+        else
+        {
             /* Update Adv data */
-            EM_mem_copy
-            (
-                &blebrr_adv_list[index][1 + BT_BD_ADDR_SIZE],
-                &p_adv_data_with_bd_addr[1 + BT_BD_ADDR_SIZE],
-                length + 1
-            );
-            return API_FAILURE;
+            entry->datalen = datalen;
+            entry->digest = digest;
+            EM_mem_copy(entry->data, pdata, datalen);
+            retval = API_FAILURE;
         }
     }
+    else
+    {
+        /* New peer device. Add */
+        if (BLEBRR_MAX_ADV_FILTER_LIST_COUNT > blebrr_adv_list_count)
+        {
+            index = blebrr_adv_list_count++;
+        }
+        else
+        {
+            index = blebrr_adv_list_evict();
 
-    /* Find out the suitable location to save the most recent ADV packet */
-    /* New peer device. Add */
-    EM_mem_copy
-    (
-        &blebrr_adv_list[blebrr_adv_list_inser_index][0],
-        p_adv_data_with_bd_addr,
-        length + 1 + BT_BD_ADDR_SIZE + 1
-    );
-    /* Increment and Wrap (if required) */
-    blebrr_adv_list_inser_index++;
+            /* Removal may shift entries, find the free slot again */
+            slot = home;
 
-    if (BLEBRR_MAX_ADV_FILTER_LIST_COUNT <= blebrr_adv_list_inser_index)
-    {
-        blebrr_adv_list_inser_index = 0;
+            while (0 != blebrr_adv_hash[slot])
+            {
+                slot = (slot + 1) & (BLEBRR_ADV_FILTER_HASH_SIZE - 1);
+            }
+        }
+
+        entry = &blebrr_adv_list[index];
+        EM_mem_copy(entry->addr, key, sizeof(key));
+        entry->home = home;
+        entry->ref = 0;
+        entry->datalen = datalen;
+        entry->digest = digest;
+        EM_mem_copy(entry->data, pdata, datalen);
+        blebrr_adv_hash[slot] = index + 1;
+        retval = API_FAILURE;
     }
 
-    return API_FAILURE;
+    blebrr_adv_filter_stat.time_us += LL_TIME_DELTA(start, read_current_fine_time());
+    return retval;
+}
+
+/**
+    \brief Get Duplicate Filter statistics
+
+    \param stat  Statistics, hit rate is duplicates/reports and average
+                 cost of a report is time_us/reports
+
+    \return void
+*/
+void blebrr_adv_filter_get_stat(/* OUT */ BLEBRR_ADV_FILTER_STAT* stat)
+{
+    *stat = blebrr_adv_filter_stat;
 }
 #endif /* BLEBRR_FILTER_DUPLICATE_PACKETS */
 
@@ -1613,17 +2175,6 @@ extern uint8  osal_memory_audit(void* ptr);
 void blebrr_pl_recv_advpacket (UCHAR type, UCHAR* pdata, UINT16 pdatalen, UCHAR rssi)
 {
     MS_BUFFER info;
-    #ifdef BLEBRR_FILTER_DUPLICATE_PACKETS
-    /* Duplicate Filtering */
-    retval = blebrr_adv_duplicate_filter(p_adv_data_with_bd_addr);
-
-    /* If found the ADV packet as duplicate, drop the ADV packet */
-    if (API_SUCCESS == retval)
-    {
-        return API_FAILURE;
-    }
-
-    #endif /* BLEBRR_FILTER_DUPLICATE_PACKETS */
 
     /* Handle only if Non-Connectable (Passive) Advertising */
     if (BRR_BCON_PASSIVE != type)
@@ -1631,6 +2182,20 @@ void blebrr_pl_recv_advpacket (UCHAR type, UCHAR* pdata, UINT16 pdatalen, UCHAR
         return;
     }
 
+    /* Copies of pending relays heard from neighbours */
+    if ((MESH_AD_TYPE_PKT == pdata[0]) && (1 < pdatalen))
+    {
+        blebrr_relay_heard(pdata + 1, pdatalen - 1);
+        #ifdef BLEBRR_NET_CACHE
+
+        if (API_SUCCESS == blebrr_net_cache_check(pdata + 1, pdatalen - 1))
+        {
+            return;
+        }
+
+        #endif /* BLEBRR_NET_CACHE */
+    }
+
     /* Pack the RSSI as metadata */
     info.payload = &rssi;
     info.length = sizeof(UCHAR);
@@ -69,6 +69,24 @@ extern UCHAR blebrr_state;
 
 //#define BLEBRR_LP_SUPPORT
 
+/*
+    Per peer ADV duplicate filter, opt-in: no project enables it. Copies of
+    Network PDUs are already dropped by BLEBRR_NET_CACHE, define this (here or
+    in the project) to also drop repeated identical reports of any AD type.
+*/
+//#define BLEBRR_FILTER_DUPLICATE_PACKETS
+
+/* Drop copies of received Network PDUs before the network layer decrypts them */
+#define BLEBRR_NET_CACHE
+
+#ifdef BLEBRR_NET_CACHE
+    /* Network PDU cache sets, power of 2. Capacity is sets * ways */
+    #ifndef BLEBRR_NET_CACHE_SETS
+        #define BLEBRR_NET_CACHE_SETS           16
+    #endif
+    #define BLEBRR_NET_CACHE_WAYS               4
+#endif
+
 #ifdef BLEBRR_LP_SUPPORT
     #define BLEBRR_LP_OFF                           1
     #define BLEBRR_LP_SLEEP                         2
@@ -86,6 +104,61 @@ typedef void (* BLEBRR_GATT_IFACE_EVENT_PL_CB)
     UCHAR ev_name,
     UCHAR ev_param
 );
+
+/** Relay statistics */
+typedef struct _BLEBRR_RELAY_STAT
+{
+    /** Relayed Network PDUs queued, network layer retransmits included */
+    UINT32 relayed;
+
+    /** Relays cancelled before sent, copies heard from neighbours */
+    UINT32 suppressed;
+
+    /** Repeats skipped for relays heard from neighbours while sent */
+    UINT32 repeats_skipped;
+
+    /** Relayed Network PDUs dropped for full queue */
+    UINT32 dropped;
+
+} BLEBRR_RELAY_STAT;
+
+#ifdef BLEBRR_NET_CACHE
+/** Network PDU cache statistics */
+typedef struct _BLEBRR_NET_CACHE_STAT
+{
+    /** Copies of cached Network PDUs dropped */
+    UINT32 hits;
+
+    /** Network PDUs not in cache, passed to network layer */
+    UINT32 misses;
+
+    /** Entries replaced for new Network PDUs */
+    UINT32 evictions;
+
+} BLEBRR_NET_CACHE_STAT;
+#endif /* BLEBRR_NET_CACHE */
+
+#ifdef BLEBRR_FILTER_DUPLICATE_PACKETS
+/** Duplicate Filter statistics */
+typedef struct _BLEBRR_ADV_FILTER_STAT
+{
+    /** ADV reports checked */
+    UINT32 reports;
+
+    /** Duplicate ADV reports dropped */
+    UINT32 duplicates;
+
+    /** Hash table slots probed */
+    UINT32 probes;
+
+    /** Entries evicted for new peer devices */
+    UINT32 evictions;
+
+    /** Time spent in filter, in microseconds */
+    UINT32 time_us;
+
+} BLEBRR_ADV_FILTER_STAT;
+#endif /* BLEBRR_FILTER_DUPLICATE_PACKETS */
 /* --------------------------------------------- Macros */
 
 /* --------------------------------------------- Internal Functions */
@@ -108,6 +181,11 @@ void blebrr_pl_scan_setup (UCHAR enable);
 void blebrr_pl_advertise_setup (UCHAR enable);
 void blebrr_pl_recv_advpacket(UCHAR type, UCHAR* pdata, UINT16 pdatalen, UCHAR rssi);
 
+#ifdef BLEBRR_FILTER_DUPLICATE_PACKETS
+API_RESULT blebrr_adv_duplicate_check(UCHAR addr_type, UCHAR* bd_addr, UCHAR* pdata, UCHAR datalen);
+void blebrr_adv_filter_get_stat(BLEBRR_ADV_FILTER_STAT* stat);
+#endif /* BLEBRR_FILTER_DUPLICATE_PACKETS */
+
 API_RESULT blebrr_gatt_send_pl(BRR_HANDLE* handle, UCHAR* data, UINT16 datalen);
 API_RESULT blebrr_pl_gatt_connection (BRR_HANDLE* handle, UCHAR role, UCHAR mode, UINT16 mtu);
 API_RESULT blebrr_pl_gatt_disconnection (BRR_HANDLE* handle);
@@ -143,6 +221,11 @@ void blebrr_lp_stop(void);
 
 
 UCHAR blebrr_get_queue_depth(void);
+void blebrr_relay_get_stat(BLEBRR_RELAY_STAT* stat);
+
+#ifdef BLEBRR_NET_CACHE
+void blebrr_net_cache_get_stat(BLEBRR_NET_CACHE_STAT* stat);
+#endif /* BLEBRR_NET_CACHE */
 
 #endif /* _H_BLEBRR_ */
 
@@ -23,8 +23,10 @@
 /* ----------------------------------------------- Global Definitions */
 /* Timer Elements */
 EXT_CBTIMER_ENTITY ext_cbtimer_entity[EXT_CBTIMER_MAX_ENTITIES];
-EXT_CBTIMER_ENTITY* ext_cbtimer_q_start = NULL;
-EXT_CBTIMER_ENTITY* ext_cbtimer_q_end   = NULL;
+
+/* Handles of free Timer Elements */
+DECL_STATIC UINT8 ext_cbtimer_free_list[EXT_CBTIMER_MAX_ENTITIES];
+DECL_STATIC UINT8 ext_cbtimer_free_count;
 
 #if 0
     /* Timer Library Mutex */
@@ -79,11 +81,6 @@ uint16 extbaseTaskID = TASK_NO_TASK;
 */
 EM_RESULT ext_timer_init_entity (EXT_CBTIMER_ENTITY* timer);
 
-EM_RESULT ext_timer_search_entity_timer_id
-(
-    EXT_CBTIMER_ENTITY** timer,
-    UINT8          handle
-);
 EM_RESULT ext_timer_del_entity
 (
     EXT_CBTIMER_ENTITY* timer,
@@ -93,13 +90,7 @@ EM_RESULT ext_timer_search_entity ( EXT_CBTIMER_ENTITY* timer );
 
 EM_RESULT ext_timer_add_entity ( EXT_CBTIMER_ENTITY* timer );
 
-#ifdef EXT_CBTIMER_SUPPORT_REMAINING_TIME
-
-    /*
-    This function returns elapsed time in microsecond since system power on.
-    */
-    UINT64 ext_cbtimer_get_ms_timestamp(void);
-#endif
+void ext_cbtimer_timeout_handler (EM_TWHEEL_NODE* node);
 
 /*********************************************************************
     @fn          CbTimerInit
@@ -302,8 +293,6 @@ Status_t CbTimerStop( uint8 timerId )
 void EXT_cbtimer_init (void)
 {
     UINT16 index;
-//    EM_TIMER_TRC(
-//    "Initializing EtherMind Timer Library Module ...\n");
     #if 0
     /* Initialize Timer Mutex */
     EM_thread_mutex_init(&timer_mutex, NULL);
@@ -313,35 +302,17 @@ void EXT_cbtimer_init (void)
     for (index = 0; index < EXT_CBTIMER_MAX_ENTITIES; index ++)
     {
         ext_timer_init_entity(&ext_cbtimer_entity[index]);
-        ext_cbtimer_entity[index].timer_id = EXT_PHYOS_INVALID_TIMER_ID;
         ext_cbtimer_entity[index].handle = index;
+        ext_cbtimer_free_list[index] = (UINT8)(EXT_CBTIMER_MAX_ENTITIES - 1 - index);
     }
 
+    ext_cbtimer_free_count = EXT_CBTIMER_MAX_ENTITIES;
     return;
 }
 
 
 void ext_cbtimer_em_init ( void )
 {
-    EXT_CBTIMER_ENTITY* timer;
-    UINT16 index;
-
-    /* Lock Timer */
-//    timer_lock();
-
-//    EM_TIMER_TRC(
-//    "Stack ON Initialization for Timer Library ...\n");
-
-    /* Initialize Timer Entities */
-    for (index = 0; index < EXT_CBTIMER_MAX_ENTITIES; index ++)
-    {
-        timer = &ext_cbtimer_entity[index];
-        timer->timer_id = EXT_PHYOS_INVALID_TIMER_ID;
-    }
-
-    /* Initialize Timer Q */
-    ext_cbtimer_q_start = ext_cbtimer_q_end = NULL;
-//    timer_unlock();
     return;
 }
 
@@ -357,25 +328,15 @@ EM_RESULT EXT_cbtimer_start_timer
     UCHAR* data_ptr = NULL;
     EM_RESULT retval;
     EXT_CBTIMER_ENTITY current_timer;
-    // HZF
-    osalTimeUpdate();
 
     if (NULL == handle)
     {
-//        EM_TIMER_ERR(
-//        "NULL Argument Unacceptable for Timer Handles.\n");
         return EXT_CBTIMER_HANDLE_IS_NULL;
     }
 
-//    EM_TIMER_TRC(
-//    "Preparing to Add New Timer Entity. Timeout = %d, Data Size = %d.\n",
-//    timeout, data_length);
-
     /* Timer Library expects to have a valid callback */
     if (NULL == callback)
     {
-//        EM_TIMER_ERR(
-//        "FAILED to Add New Timer Element. NULL Callback.\n");
         return EXT_CBTIMER_CALLBACK_IS_NULL;
     }
 
@@ -387,8 +348,6 @@ EM_RESULT EXT_cbtimer_start_timer
 
             if (NULL == data_ptr)
             {
-//                EM_TIMER_ERR(
-//                "FAILED to allocate Memory for Timer Handler Argument.\n");
                 return EXT_CBTIMER_MEMORY_ALLOCATION_FAILED;
             }
 
@@ -407,31 +366,21 @@ EM_RESULT EXT_cbtimer_start_timer
     current_timer.callback = callback;
     current_timer.data_length = data_length;
     current_timer.timeout = timeout;
-    /* Lock Timer */
-//    timer_lock();
-    /* Insert this Timer Entity into the List */
+    /* Insert this Timer Entity into the Wheel */
     retval = ext_timer_add_entity(&current_timer);
 
     if (EM_SUCCESS != retval)
     {
-//        EM_TIMER_ERR(
-//        "FAILED to Add New Timer to Timer Queue. Error Code = 0x%04X\n",
-//        retval);
         if (current_timer.data_length > EXT_CBTIMER_STATIC_DATA_SIZE)
         {
             ext_timer_free (current_timer.allocated_data);
         }
 
-//        timer_unlock();
         return retval;
     }
 
     /* Store the Handle */
     *handle = current_timer.handle;
-//    printf(
-//    "Successfully Added EXT New Timer to Timer Queue. Handle = 0x%02X\n",
-//    *handle);
-//    timer_unlock();
     return EM_SUCCESS;
 }
 
@@ -441,10 +390,6 @@ void ext_cbtimer_em_shutdown ( void )
 {
     UINT16 index;
     EXT_CBTIMER_ENTITY* timer;
-    /* Lock Timer */
-//    timer_lock();
-    /* Initialize Timer Q */
-    ext_cbtimer_q_start = ext_cbtimer_q_end = NULL;
 
     /* Initialize Timer Entities */
     for (index = 0; index < EXT_CBTIMER_MAX_ENTITIES; index++)
@@ -454,86 +399,22 @@ void ext_cbtimer_em_shutdown ( void )
         if (EXT_CBTIMER_ENTITY_IN_USE == timer->in_use)
         {
             /* Stop Timer */
-            CbTimerStop(timer->timer_id);
-
-            if (timer->data_length > EXT_CBTIMER_STATIC_DATA_SIZE)
-            {
-                ext_timer_free(timer->allocated_data);
-            }
-
-            ext_timer_init_entity(timer);
-            timer->timer_id = EXT_PHYOS_INVALID_TIMER_ID;
+            ext_timer_del_entity(timer, 0x01);
         }
     }
 
-//    EM_TIMER_TRC(
-//    "Stack OFF on Timer Library Module ...\n");
-//    timer_unlock();
     return;
 }
 
-//Status_t osal_CbTimerStart32( pfnCbTimer_t pfnCbTimer, uint8 *pData,
-//                           uint32 timeout, uint8 *pTimerId )
-//{
-//  uint8 i;
-//
-//  // Validate input parameters
-//  if ( pfnCbTimer == NULL )
-//  {
-//    return ( INVALIDPARAMETER );
-//  }
-
-//  // Look for an unused timer first
-//  for ( i = 0; i < NUM_CBTIMERS32; i++ )
-//  {
-//    if ( cbTimers[i].pfnCbTimer == NULL )
-//    {
-//      // Start the OSAL event timer first
-//      if ( osal_start_timerEx( TASK_ID32( i ), EVENT_ID32( i ), timeout ) == SUCCESS )
-//      {
-//        // Set up the callback timer
-//        cbTimers[i].pfnCbTimer = pfnCbTimer;
-//        cbTimers[i].pData = pData;
-
-//        if ( pTimerId != NULL )
-//        {
-//          // Caller is intreseted in the timer id
-//          *pTimerId = i;
-//        }
-
-//        return ( SUCCESS );
-//      }
-//    }
-//  }
-
-//  // No timer available
-//  return ( NO_TIMER_AVAIL );
-//}
-
-
-/* Callback registered with timer module */
-void ext_cbtimer_timeout_handler (UINT8* handle)
+
+/* Callback registered with timer wheel */
+void ext_cbtimer_timeout_handler (EM_TWHEEL_NODE* node)
 {
-    EM_RESULT retval;
     EXT_CBTIMER_ENTITY* timer;
-//    EM_TIMER_TRC (
-//    "In Timer handler (Timer Handle: 0x%02X)\n", *handle);
-    /* Lock Timer */
-//    timer_lock();
-    /* Get the appropriate timer entity */
-    retval = ext_timer_search_entity_timer_id (&timer, *handle);
-
-    if (EM_SUCCESS != retval)
-    {
-//        EM_TIMER_ERR(
-//        "*** UNKNOWN Spurious Timeout Callback?!?!\n");
-        /* Unlock Timer */
-//        timer_unlock ();
-        return;
-    }
-
-    /* Unlock Timer */
-//    timer_unlock ();
+    /* Node is the first member of Timer Entity */
+    timer = (EXT_CBTIMER_ENTITY*)node;
+    /* Not active nor free while the callback runs */
+    timer->in_use = EXT_CBTIMER_ENTITY_IN_FREE;
 
     if (timer->data_length > EXT_CBTIMER_STATIC_DATA_SIZE)
     {
@@ -546,27 +427,8 @@ void ext_cbtimer_timeout_handler (UINT8* handle)
         timer->callback (timer->static_data, timer->data_length);
     }
 
-    /* Lock Timer */
-//    timer_lock ();
-    #if 0
-    /* Stop Timer */
-    xTimerStop  (timer->timer_id, 0);
-    #endif /* 0 */
     /* Free the Timer */
-    retval = ext_timer_del_entity (timer, 1);
-
-    if (EM_SUCCESS != retval)
-    {
-//        EM_TIMER_ERR(
-//        "FAILED to find Timer Element. Handle = 0x%02X. Error Code = 0x%04X\n",
-//        handle, retval);
-        printf(
-            "FAILED to find Timer Element. Handle = 0x%02X. Error Code = 0x%04X\n",
-            *handle, retval);
-    }
-
-    /* Unlock Timer */
-//    timer_unlock ();
+    ext_timer_del_entity (timer, 1);
     return;
 }
 
@@ -578,65 +440,21 @@ EM_RESULT EXT_cbtimer_stop_timer
 {
     EXT_CBTIMER_ENTITY* timer;
     EM_RESULT retval;
-    UINT8  timer_id;
-    UINT32 new_timeout;
-    Status_t status;
 
     if (EXT_CBTIMER_MAX_ENTITIES <= handle)
     {
-//        EM_TIMER_ERR(
-//        "NULL Argument Unacceptable for Timer Handles.\r\n");
         /* TODO: Use appropriate error value */
         return EXT_CBTIMER_HANDLE_IS_NULL;
     }
 
-    osalTimeUpdate();
-    retval = EM_FAILURE;
-    /* Lock Timer */
-//    timer_lock();
     timer = &ext_cbtimer_entity[handle];
-    /* Store the timer id before deleting entity */
-    timer_id = timer->timer_id;
-    new_timeout = 0x10;
+    retval = ext_timer_search_entity(timer);
 
-    if(ext_timer_search_entity(timer) == EM_SUCCESS)
+    if (EM_SUCCESS == retval)
     {
-        if(CbTimerUpdate(timer_id,new_timeout) == EM_SUCCESS
-                ||(osalFindTimer(EXT_TASK_ID( timer->timer_id ),EXT_EVENT_ID( timer->timer_id )) == NULL))
-        {
-            retval = ext_timer_del_entity(timer, 0x01);
-
-            if (EM_SUCCESS != retval)
-            {
-                //            EM_TIMER_ERR(
-                //            "FAILED to find Timer Element. Handle = 0x%02X. Error Code = 0x%04X\n",
-                //            handle, retval);
-                printf(
-                    "FAILED to find Timer Element. Handle = 0x%02X. Error Code = 0x%04X\n",
-                    handle, retval);
-            }
-            else
-            {
-                //            EM_TIMER_TRC(
-                //            "Successfully Deleted Timer Element for Handle 0x%02X.\n",
-                //            handle);
-                /* Stop Timer */
-                status = CbTimerStop(timer_id);
-                osal_clear_event(EXT_TASK_ID( timer->timer_id ),EXT_EVENT_ID( timer->timer_id ));
-
-                if (SUCCESS != status)
-                {
-                    retval = EM_FAILURE;
-                }
-
-                //            EM_TIMER_TRC("*** Stopped Timer [ID: %04X]\n",
-                //            timer_id);
-            }
-        }
+        retval = ext_timer_del_entity(timer, 0x01);
     }
 
-    /* Unlock Timer */
-//    timer_unlock();
     return retval;
 }
 
@@ -646,24 +464,13 @@ UINT32 EXT_cbtimer_get_remain_timer
     EXT_cbtimer_handle handle
 )
 {
-    EXT_CBTIMER_ENTITY* timer;
-    UINT32 remain_timeout;
-
     if (EXT_CBTIMER_MAX_ENTITIES <= handle)
     {
-//        EM_TIMER_ERR(
-//        "NULL Argument Unacceptable for Timer Handles.\r\n");
         /* TODO: Use appropriate error value */
         return EXT_CBTIMER_HANDLE_IS_NULL;
     }
 
-    /* Lock Timer */
-//    timer_lock();
-    timer = &ext_cbtimer_entity[handle];
-    remain_timeout = osal_get_timeoutEx(EXT_TASK_ID( timer->timer_id ),EXT_EVENT_ID( timer->timer_id ));
-    /* Unlock Timer */
-//    timer_unlock();
-    return remain_timeout;
+    return EM_twheel_remaining(&ext_cbtimer_entity[handle].node);
 }
 
 
@@ -679,28 +486,18 @@ EM_RESULT EXT_cbtimer_restart_timer
 
     if (EXT_CBTIMER_MAX_ENTITIES <= handle)
     {
-//        EM_TIMER_ERR(
-//        "NULL Argument Unacceptable for Timer Handles.\n");
         /* TODO: Use appropriate error value */
         return EXT_CBTIMER_HANDLE_IS_NULL;
     }
 
-//    timer_lock();
     timer = &ext_cbtimer_entity[handle];
     retval = ext_timer_search_entity(timer);
 
-    if (EM_SUCCESS != retval)
-    {
-//        EM_TIMER_ERR(
-//        "FAILED to Find Timer ELement for Handle 0x%02X. Error Code = 0x%04X\n",
-//        handle, retval);
-    }
-    else
+    if (EM_SUCCESS == retval)
     {
-        if(CbTimerUpdate(timer->timer_id,new_timeout) == EM_SUCCESS)
-        {
-            return ( SUCCESS );
-        }
+        /* New timeout in millisecond */
+        EM_twheel_start(&timer->node, new_timeout, timer->node.slack);
+        return ( SUCCESS );
     }
 
     // No timer available
@@ -712,128 +509,31 @@ EM_RESULT EXT_cbtimer_is_active_timer
     EXT_cbtimer_handle handle
 )
 {
-    EXT_CBTIMER_ENTITY* timer;
-    EM_RESULT retval;
-
     if (EXT_CBTIMER_MAX_ENTITIES <= handle)
     {
-//        EM_TIMER_ERR(
-//        "NULL Argument Unacceptable for Timer Handles.\n");
         /* TODO: Use appropriate error value */
         return EXT_CBTIMER_HANDLE_IS_NULL;
     }
 
-    /* Lock Timer */
-//    timer_lock();
-    timer = &ext_cbtimer_entity[handle];
-    retval = ext_timer_search_entity(timer);
-
-    if (EM_SUCCESS != retval)
-    {
-//        EM_TIMER_ERR(
-//        "FAILED to Find the Timer Entity for Handle 0x%02X. Error Code = 0x%04X\n",
-//        handle, retval);
-    }
-
-//    timer_unlock();
-    return retval;
+    return ext_timer_search_entity(&ext_cbtimer_entity[handle]);
 }
 
 
 EM_RESULT ext_timer_search_entity ( EXT_CBTIMER_ENTITY* timer )
 {
-    EXT_CBTIMER_ENTITY* current_timer;
-
-    /* Is Queue Empty */
-    if (NULL == ext_cbtimer_q_start)
-    {
-        return EXT_CBTIMER_QUEUE_EMPTY;
-    }
-
-    /* Handle the first Element */
-    if (timer == ext_cbtimer_q_start)
-    {
-        return EM_SUCCESS;
-    }
-
-    current_timer = ext_cbtimer_q_start->next;
-
-    while (NULL != current_timer)
-    {
-        if (timer == current_timer)
-        {
-            return EM_SUCCESS;
-        }
-
-        current_timer = current_timer->next;
-    }
-
-    return EXT_CBTIMER_ENTITY_SEARCH_FAILED;
-}
-
-/* Get the timer based on obtained timer id */
-EM_RESULT ext_timer_search_entity_timer_id
-(
-    EXT_CBTIMER_ENTITY** timer,
-    UINT8          handle
-)
-{
-    EXT_CBTIMER_ENTITY* current_timer;
-
-    /* Is Queue Empty */
-    if (NULL == ext_cbtimer_q_start)
-    {
-        return EXT_CBTIMER_QUEUE_EMPTY;
-    }
-
-    /* Handle the first Element */
-    if (handle == ext_cbtimer_q_start->handle)
+    if (EXT_CBTIMER_ENTITY_IN_USE != timer->in_use)
     {
-        /* Note the timer entity */
-        *timer = ext_cbtimer_q_start;
-        return EM_SUCCESS;
-    }
-
-    current_timer = ext_cbtimer_q_start->next;
-
-    while (NULL != current_timer)
-    {
-        if (handle == current_timer->handle)
-        {
-            /* Note the timer entity */
-            *timer = current_timer;
-            return EM_SUCCESS;
-        }
-
-        current_timer = current_timer->next;
+        return EXT_CBTIMER_ENTITY_SEARCH_FAILED;
     }
 
-    return EXT_CBTIMER_ENTITY_SEARCH_FAILED;
+    return EM_SUCCESS;
 }
 
 EM_RESULT ext_timer_add_entity ( EXT_CBTIMER_ENTITY* timer )
 {
-    UINT16 index;
-    Status_t   ret;
     EXT_CBTIMER_ENTITY* new_timer;
-    new_timer = NULL;
-
-    for (index = 0; index < EXT_CBTIMER_MAX_ENTITIES; index++)
-    {
-        new_timer = &ext_cbtimer_entity[index];
-
-        if (EXT_CBTIMER_ENTITY_FREE == new_timer->in_use)
-        {
-            new_timer->in_use = EXT_CBTIMER_ENTITY_IN_USE;
-            break;
-        }
-        else
-        {
-            new_timer = NULL;
-        }
-    }
 
-    if (NULL == new_timer)
+    if (0 == ext_cbtimer_free_count)
     {
         printf(
             "FAILED to Allocate EXT New Timer Entity. Timer List FULL !\n");
@@ -844,7 +544,9 @@ EM_RESULT ext_timer_add_entity ( EXT_CBTIMER_ENTITY* timer )
         return EXT_CBTIMER_QUEUE_FULL;
     }
 
-    new_timer->next = NULL;
+    ext_cbtimer_free_count --;
+    new_timer = &ext_cbtimer_entity[ext_cbtimer_free_list[ext_cbtimer_free_count]];
+    new_timer->in_use = EXT_CBTIMER_ENTITY_IN_USE;
     new_timer->timeout = timer->timeout;
     new_timer->callback = timer->callback;
     new_timer->data_length = timer->data_length;
@@ -863,42 +565,29 @@ EM_RESULT ext_timer_add_entity ( EXT_CBTIMER_ENTITY* timer )
         );
     }
 
-    /* Start the timer */
-    #ifdef EXT_CBTIMER_SUPPORT_REMAINING_TIME
-    new_timer->start_timestamp = ext_cbtimer_get_ms_timestamp();
-    #endif /* EM_TIMER_SUPPORT_REMAINING_TIME */
-    /* Start timer. Set Timeout. This will also start the timer. */
-    ret = CbTimerStart
-          (
-              ext_cbtimer_timeout_handler,
-              &new_timer->handle,
-              ((EXT_CBTIMEOUT_MILLISEC & new_timer->timeout) ?
-               (new_timer->timeout & (UINT32)~(EXT_CBTIMEOUT_MILLISEC)):
-               (new_timer->timeout * 1000)),
-              &new_timer->timer_id
-          );
-
-    if (SUCCESS != ret)
+    /* Start timer. Timers in seconds may be coalesced within the slack */
+    new_timer->node.expire = ext_cbtimer_timeout_handler;
+
+    if (EXT_CBTIMEOUT_MILLISEC & new_timer->timeout)
     {
-//        EM_TIMER_ERR("*** FAILED to Start timer\n");
-//      printf("*** FAILED to Start timer, ret = %d\r\n", ret);
-        return EXT_CBTIMER_FAILED_SET_TIME_EVENT;
+        EM_twheel_start
+        (
+            &new_timer->node,
+            new_timer->timeout & (UINT32)~(EXT_CBTIMEOUT_MILLISEC),
+            0
+        );
     }
-
-//    EM_TIMER_TRC("Successfully started Timer [ID: %02X]. Handle: 0x%02X\n",
-//    new_timer->timer_id, timer->handle);
-    timer->handle = new_timer->handle;
-    timer->timer_id = new_timer->timer_id;
-
-    /* If the Timer Q Empty */
-    if (NULL == ext_cbtimer_q_start)
+    else
     {
-        ext_cbtimer_q_start = ext_cbtimer_q_end = new_timer;
-        return EM_SUCCESS;
+        EM_twheel_start
+        (
+            &new_timer->node,
+            new_timer->timeout * 1000,
+            (new_timer->timeout * 1000) >> EM_TIMER_SLACK_SHIFT
+        );
     }
 
-    ext_cbtimer_q_end->next = new_timer;
-    ext_cbtimer_q_end = new_timer;
+    timer->handle = new_timer->handle;
     return EM_SUCCESS;
 }
 
@@ -909,67 +598,12 @@ EM_RESULT ext_timer_del_entity
     UCHAR free
 )
 {
-    EXT_CBTIMER_ENTITY* current_timer, *previous_timer;
-
-    /* Either None or One Element */
-    if (ext_cbtimer_q_start == ext_cbtimer_q_end)
+    if (EXT_CBTIMER_ENTITY_FREE == timer->in_use)
     {
-        if (NULL == ext_cbtimer_q_start)
-        {
-            /* Queue is Empty */
-            return EXT_CBTIMER_QUEUE_EMPTY;
-        }
-        else
-        {
-            if (timer == ext_cbtimer_q_start)
-            {
-                /* Queue has One Element */
-                ext_cbtimer_q_start = ext_cbtimer_q_end = NULL;
-            }
-            else
-            {
-                /* Match NOT found in the Only element in Timer Queue */
-                return EXT_CBTIMER_ENTITY_SEARCH_FAILED;
-            }
-        }
+        return EXT_CBTIMER_ENTITY_SEARCH_FAILED;
     }
-    else
-    {
-        /* Queue has more than One Element */
-        if (timer == ext_cbtimer_q_start)
-        {
-            /* Match in the First Element */
-            ext_cbtimer_q_start = ext_cbtimer_q_start->next;
-        }
-        else
-        {
-            previous_timer = ext_cbtimer_q_start;
-            current_timer = ext_cbtimer_q_start->next;
-
-            while (NULL != current_timer)
-            {
-                if (timer == current_timer)
-                {
-                    previous_timer->next = current_timer->next;
-
-                    if (current_timer == ext_cbtimer_q_end)
-                    {
-                        ext_cbtimer_q_end = previous_timer;
-                    }
-
-                    break;
-                }
 
-                previous_timer = current_timer;
-                current_timer  = current_timer->next;
-            }
-
-            if (NULL == current_timer)
-            {
-                return EXT_CBTIMER_ENTITY_SEARCH_FAILED;
-            }
-        }
-    }
+    EM_twheel_stop(&timer->node);
 
     /* Free Allocated Data */
     if ((0x01 == free) &&
@@ -979,6 +613,7 @@ EM_RESULT ext_timer_del_entity
     }
 
     ext_timer_init_entity(timer);
+    ext_cbtimer_free_list[ext_cbtimer_free_count ++] = timer->handle;
     return EM_SUCCESS;
 }
 
@@ -990,24 +625,13 @@ EM_RESULT ext_timer_init_entity (EXT_CBTIMER_ENTITY* timer)
     timer->callback = NULL;
     timer->allocated_data = NULL;
     timer->data_length = 0;
-    timer->next = NULL;
-    #ifdef EM_TIMER_SUPPORT_REMAINING_TIME
-    timer->start_timestamp = 0;
-    #endif /* EM_TIMER_SUPPORT_REMAINING_TIME */
+    timer->node.next = NULL;
+    timer->node.pprev = NULL;
     return EM_SUCCESS;
 }
 
 
 #ifdef EXT_CBTIMER_SUPPORT_REMAINING_TIME
-
-/*
-    This function returns elapsed time in microsecond since system power on.
-*/
-UINT64 ext_cbtimer_get_ms_timestamp(void)
-{
-    return osal_GetSystemClock();
-}
-
 EM_RESULT EXT_cbtimer_get_remaining_time
 (
     EXT_cbtimer_handle   handle,
@@ -1016,94 +640,49 @@ EM_RESULT EXT_cbtimer_get_remaining_time
 {
     EXT_CBTIMER_ENTITY* timer;
     EM_RESULT     retval;
-    UINT64        current_timestamp;
-    UINT32        time_ms;
 
-    if (NULL == handle)
+    if (EXT_CBTIMER_MAX_ENTITIES <= handle)
     {
-//        EM_TIMER_ERR(
-//        "NULL Argument Unacceptable for Timer Handles.\n");
         return EXT_CBTIMER_HANDLE_IS_NULL;
     }
 
-    /* Lock Timer */
-//    timer_lock();
-    timer = (EXT_CBTIMER_ENTITY*)handle;
+    timer = &ext_cbtimer_entity[handle];
     retval = ext_timer_search_entity(timer);
 
-    if (EM_SUCCESS != retval)
+    if (EM_SUCCESS == retval)
     {
-//        EM_TIMER_ERR(
-//        "FAILED to Find Timer ELement for Handle %p. Error Code = 0x%04X\n",
-//        (void *)handle, retval);
-    }
-    else
-    {
-        time_ms = ((EXT_CBTIMEOUT_MILLISEC & timer->timeout) ?
-                   (timer->timeout & (UINT32)~(EXT_CBTIMEOUT_MILLISEC)) :
-                   (timer->timeout * 1000));
-        /* Get Current Time */
-        /* Remaining Time = (Timeout in ms) - (Current Time - Timer Start Time) */
-        current_timestamp = ext_cbtimer_get_ms_timestamp();
-
-        if ((current_timestamp < timer->start_timestamp) ||
-                (time_ms < (current_timestamp - timer->start_timestamp))
-           )
-        {
-//            EM_TIMER_ERR(
-//            "FAILED to Find Remaining Time.TO:%d < (CurT:%lld - StartT:%lld\n",
-//            time_ms, current_timestamp, timer->start_timestamp);
-        }
-        else
-        {
-            time_ms -= (UINT32)(current_timestamp - timer->start_timestamp);
-            *remaining_time_ms = time_ms;
-//            EM_TIMER_TRC(
-//            "[EM_TIMER] Remaining Time (ms): %d\n", time_ms);
-            retval = EM_SUCCESS;
-        }
+        *remaining_time_ms = EM_twheel_remaining(&timer->node);
     }
 
-//    timer_unlock();
     return retval;
 }
-#endif /* EM_TIMER_SUPPORT_REMAINING_TIME */
+#endif /* EXT_CBTIMER_SUPPORT_REMAINING_TIME */
 
 EM_RESULT EXT_cbtimer_list_timer ( void )
 {
     #ifdef EM_TIMERL_DEBUG
-    UINT16 index, free;
+    UINT16 index;
     EXT_CBTIMER_ENTITY* timer;
     timer_lock();
     EM_TIMERL_TRC("\n");
     EM_TIMERL_TRC("========================================= \n");
-    EM_TIMERL_TRC("Start Q = %p\n", ext_cbtimer_q_start);
-    timer = ext_cbtimer_q_start;
-
-    while(NULL != timer)
-    {
-        EM_TIMERL_TRC("    Handle = 0x%02X",
-                      timer->handle);
-        timer = timer->next;
-    }
-
-    EM_TIMERL_TRC("End   Q = %p\n", ext_cbtimer_q_end);
-    free = 0;
 
     for (index = 0; index < EXT_CBTIMER_MAX_ENTITIES; index ++)
     {
-        if (EXT_CBTIMER_ENTITY_FREE == ext_cbtimer_entity[index].in_use)
+        timer = &ext_cbtimer_entity[index];
+
+        if (EXT_CBTIMER_ENTITY_IN_USE == timer->in_use)
         {
-            free ++;
+            EM_TIMERL_TRC("    Handle = 0x%02X, Remaining = %d ms\n",
+                          timer->handle, EM_twheel_remaining(&timer->node));
         }
     }
 
     EM_TIMERL_TRC("Max Q Entity = %d, Free = %d\n",
-                  EXT_CBTIMER_MAX_ENTITIES, free);
+                  EXT_CBTIMER_MAX_ENTITIES, ext_cbtimer_free_count);
     EM_TIMERL_TRC("========================================= \n");
     EM_TIMERL_TRC("\n");
     timer_unlock();
     #endif /* EM_TIMERL_DEBUG */
     return EM_SUCCESS;
 }
-
@@ -16,6 +16,7 @@
 
 /* --------------------------------------------------- Header File Inclusion */
 #include "EM_os.h"
+#include "EM_timer.h"
 #include "cbtimer.h"
 
 /* Enable support to get remaining time to expire of a timer entity */
@@ -71,6 +72,9 @@
 /* Timer Entity */
 typedef struct ext_cbtimer_entity_struct
 {
+    /* Timer Wheel Node, must be the first member */
+    EM_TWHEEL_NODE node;
+
     /* The Timer Handle - Index of the timer entity */
     UINT8 handle;
 
@@ -83,9 +87,6 @@ typedef struct ext_cbtimer_entity_struct
     */
     UCHAR*  allocated_data;
 
-    /* Next Element in the Timer Q */
-    struct ext_cbtimer_entity_struct* next;
-
     /**
         Timer Callback Parameter if
         data_length <= EM_TIMER_STATIC_DATA_SIZE
@@ -95,20 +96,12 @@ typedef struct ext_cbtimer_entity_struct
     /* Timeout Value asked by the User */
     UINT32 timeout;
 
-    #ifdef EXT_CBTIMER_SUPPORT_REMAINING_TIME
-    /* Start Time Stamp - used to calculate remaining time */
-    UINT64 start_timestamp;
-    #endif /* EM_TIMER_SUPPORT_REMAINING_TIME */
-
     /* Length of the data */
     UINT16 data_length;
 
     /* Is this Entity Allocated ? */
     UCHAR in_use;
 
-    /* PhyOS Timer ID */
-    UINT8 timer_id;
-
 } EXT_CBTIMER_ENTITY;
 
 typedef UINT8  EXT_cbtimer_handle;
@@ -14,6 +14,7 @@
 
 /* --------------------------------------------- Header File Inclusion */
 #include "vendormodel_client.h"
+#include "vendormodel_bulk.h"
 
 /* --------------------------------------------- Data Types/ Structures */
 
@@ -31,7 +32,10 @@ static DECL_CONST UINT32 vendormodel_client_opcode_list[] =
     MS_ACCESS_VENDORMODEL_STATUS_OPCODE,
     MS_ACCESS_VENDORMODEL_INDICATION_OPCODE,
     MS_ACCESS_VENDORMODEL_WRITECMD_OPCODE,
-    MS_ACCESS_VENDORMODEL_NOTIFY_OPCODE
+    MS_ACCESS_VENDORMODEL_NOTIFY_OPCODE,
+    MS_ACCESS_VENDORMODEL_BULK_START_OPCODE,
+    MS_ACCESS_VENDORMODEL_BULK_DATA_OPCODE,
+    MS_ACCESS_VENDORMODEL_BULK_ACK_OPCODE
 };
 
 static MS_ACCESS_MODEL_HANDLE           vendormodel_client_model_handle;
@@ -81,6 +85,13 @@ API_RESULT vendormodel_client_cb
     API_RESULT    retval;
     retval = API_SUCCESS;
     ext_params_p = NULL;
+
+    /* Bulk transfer is handled below the application callback */
+    if (API_SUCCESS == MS_vendormodel_bulk_handler(handle, saddr, opcode, data_param, data_len))
+    {
+        return retval;
+    }
+
     /* Request Context */
     req_context.handle = *handle;
     req_context.saddr  = saddr;
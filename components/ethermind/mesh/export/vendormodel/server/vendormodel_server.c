@@ -12,6 +12,7 @@
 
 /* --------------------------------------------- Header File Inclusion */
 #include "vendormodel_server.h"
+#include "vendormodel_bulk.h"
 
 
 /* --------------------------------------------- Data Types/ Structures */
@@ -28,7 +29,10 @@ static DECL_CONST UINT32 vendormodel_server_opcode_list[] =
     MS_ACCESS_VENDORMODEL_SET_UNACKNOWLEDGED_OPCODE,
     MS_ACCESS_VENDORMODEL_WRITECMD_OPCODE,
     MS_ACCESS_VENDORMODEL_CONFIRMATION_OPCODE,
-    MS_ACCESS_VENDORMODEL_NOTIFY_OPCODE
+    MS_ACCESS_VENDORMODEL_NOTIFY_OPCODE,
+    MS_ACCESS_VENDORMODEL_BULK_START_OPCODE,
+    MS_ACCESS_VENDORMODEL_BULK_DATA_OPCODE,
+    MS_ACCESS_VENDORMODEL_BULK_ACK_OPCODE
 };
 
 //static MS_ACCESS_MODEL_HANDLE       phy_model_server_model_handle;
@@ -163,6 +167,13 @@ __ATTR_SECTION_XIP__ API_RESULT vendormodel_server_cb
     retval = API_SUCCESS;
     ext_params_p = NULL;
     marker = 0;
+
+    /* Bulk transfer is handled below the application callback */
+    if (API_SUCCESS == MS_vendormodel_bulk_handler(handle, saddr, opcode, data_param, data_len))
+    {
+        return retval;
+    }
+
     /* Request Context */
     req_context.handle = *handle;
     req_context.saddr  = saddr;
@@ -0,0 +1,929 @@
+/**
+    \file vendormodel_bulk.c
+
+    \brief This file implements the bulk transfer layer carried over the
+    vendor model.
+
+    A blob is cut into chunks sized to fill whole lower transport segments.
+    The sender keeps a window of chunks on air and the receiver answers with
+    the next expected chunk and a bitmap of the chunks received beyond it, so
+    only the holes are sent again. The interval between chunks is adapted per
+    destination: it shrinks while windows arrive clean and grows on holes and
+    timeouts.
+
+    START  : SID(1) Length(4) Chunk Size(1) Window(1)
+    DATA   : SID(1) Sequence(2) Payload
+    ACK    : SID(1) Next Expected(2) Received Bitmap(4)
+*/
+
+/*
+    Copyright (C) 2020. phyplus Ltd.
+    All rights reserved.
+*/
+
+
+
+/* --------------------------------------------- Header File Inclusion */
+#include "vendormodel_bulk.h"
+#include "blebrr.h"
+#include "clock.h"
+
+/* --------------------------------------------- Data Types/ Structures */
+/** Pacing state of a destination */
+typedef struct _VENDORMODEL_BULK_PACE
+{
+    MS_NET_ADDR addr;
+
+    UINT16      pace_ms;
+
+} VENDORMODEL_BULK_PACE;
+
+/** Sender session */
+typedef struct _VENDORMODEL_BULK_TX
+{
+    MS_ACCESS_MODEL_HANDLE handle;
+
+    VENDORMODEL_BULK_PACE* pace;
+
+    UCHAR*      blob;
+
+    UINT32      length;
+
+    UINT32      start_tick;
+
+    MS_NET_ADDR dst_addr;
+
+    /** Chunks in the blob */
+    UINT16      num_chunks;
+
+    /** First chunk not yet acknowledged */
+    UINT16      base;
+
+    /** First chunk never sent */
+    UINT16      next;
+
+    /** Highest chunk reported received plus one */
+    UINT16      sack_high;
+
+    /** Chunks acknowledged, bit i for chunk base + i */
+    UINT32      acked;
+
+    /** Chunks to be sent again, bit i for chunk base + i */
+    UINT32      retx;
+
+    UINT16      chunks_sent;
+
+    UINT16      chunks_retx;
+
+    /** Chunks delivered and holes reported since the last pacing update */
+    UINT16      win_delivered;
+
+    UINT16      win_lost;
+
+    UCHAR       state;
+
+    UCHAR       sid;
+
+    UCHAR       retry;
+
+    /** Timer waits for an acknowledgement rather than pacing */
+    UCHAR       wait_ack;
+
+} VENDORMODEL_BULK_TX;
+
+/** Receiver session */
+typedef struct _VENDORMODEL_BULK_RX
+{
+    MS_ACCESS_MODEL_HANDLE handle;
+
+    UINT32      length;
+
+    UINT32      start_tick;
+
+    MS_NET_ADDR src_addr;
+
+    UINT16      num_chunks;
+
+    /** Next expected chunk */
+    UINT16      base;
+
+    /** Chunks received beyond base, bit i for chunk base + i */
+    UINT32      received;
+
+    UCHAR       state;
+
+    UCHAR       sid;
+
+    UCHAR       chunk_size;
+
+    UCHAR       window;
+
+    /** Chunks received since the last acknowledgement */
+    UCHAR       unacked;
+
+} VENDORMODEL_BULK_RX;
+
+
+/* --------------------------------------------- Global Definitions */
+/* Session states */
+#define VENDORMODEL_BULK_IDLE                           0x00
+#define VENDORMODEL_BULK_START                          0x01
+#define VENDORMODEL_BULK_DATA                           0x02
+#define VENDORMODEL_BULK_DONE                           0x03
+
+#define VENDORMODEL_BULK_HDR_LEN                        3
+#define VENDORMODEL_BULK_START_LEN                      7
+#define VENDORMODEL_BULK_ACK_LEN                        7
+
+
+/* --------------------------------------------- Static Global Variables */
+static MS_VENDORMODEL_BULK_CB           vendormodel_bulk_UI_cb;
+
+static VENDORMODEL_BULK_TX              vendormodel_bulk_tx;
+static VENDORMODEL_BULK_RX              vendormodel_bulk_rx;
+
+static VENDORMODEL_BULK_PACE            vendormodel_bulk_pace[MS_VENDORMODEL_BULK_PACE_SLOTS];
+static UCHAR                            vendormodel_bulk_pace_victim;
+
+static EM_timer_handle                  vendormodel_bulk_tx_timer = EM_TIMER_HANDLE_INIT_VAL;
+static EM_timer_handle                  vendormodel_bulk_rx_timer = EM_TIMER_HANDLE_INIT_VAL;
+static EM_timer_handle                  vendormodel_bulk_rx_idle_timer = EM_TIMER_HANDLE_INIT_VAL;
+
+static UCHAR                            vendormodel_bulk_sid;
+
+
+/* --------------------------------------------- Function */
+static void vendormodel_bulk_tx_timeout_handler(void* args, UINT16 size);
+static void vendormodel_bulk_rx_timeout_handler(void* args, UINT16 size);
+static void vendormodel_bulk_rx_idle_timeout_handler(void* args, UINT16 size);
+
+static API_RESULT vendormodel_bulk_send_pdu
+(
+    /* IN */ MS_ACCESS_MODEL_HANDLE*   handle,
+    /* IN */ UINT32                    opcode,
+    /* IN */ MS_NET_ADDR               dst_addr,
+    /* IN */ UCHAR*                    pdu,
+    /* IN */ UINT16                    pdu_len
+)
+{
+    MS_APPKEY_HANDLE key_handle;
+    MS_access_get_appkey_handle
+    (
+        handle,
+        &key_handle
+    );
+    /* End to end acknowledgement replaces the lower transport one */
+    return MS_access_raw_data
+           (
+               handle,
+               opcode,
+               dst_addr,
+               key_handle,
+               pdu,
+               pdu_len,
+               MS_FALSE
+           );
+}
+
+static VENDORMODEL_BULK_PACE* vendormodel_bulk_pace_get(MS_NET_ADDR addr)
+{
+    VENDORMODEL_BULK_PACE* pace;
+    UCHAR i;
+
+    for (i = 0; i < MS_VENDORMODEL_BULK_PACE_SLOTS; i++)
+    {
+        if (addr == vendormodel_bulk_pace[i].addr)
+        {
+            return &vendormodel_bulk_pace[i];
+        }
+    }
+
+    /* Unknown destination, start from the default interval */
+    pace = &vendormodel_bulk_pace[vendormodel_bulk_pace_victim];
+    vendormodel_bulk_pace_victim = (vendormodel_bulk_pace_victim + 1) % MS_VENDORMODEL_BULK_PACE_SLOTS;
+    pace->addr = addr;
+    pace->pace_ms = MS_VENDORMODEL_BULK_PACE_INIT;
+    return pace;
+}
+
+/**
+    Adapt the interval once per window of feedback. Isolated losses are
+    left to selective repeat, only a loss rate above a quarter of the
+    window, or repeated acknowledgement timeouts, mean the path is overrun.
+*/
+static void vendormodel_bulk_pace_update(VENDORMODEL_BULK_PACE* pace, UINT16 delivered, UINT16 lost)
+{
+    UINT32 pace_ms;
+    pace_ms = pace->pace_ms;
+
+    if (0 == lost)
+    {
+        /* Additive decrease of the interval while windows arrive clean */
+        pace_ms = (pace_ms > (MS_VENDORMODEL_BULK_PACE_MIN + MS_VENDORMODEL_BULK_PACE_STEP)) ?
+                  (pace_ms - MS_VENDORMODEL_BULK_PACE_STEP) : MS_VENDORMODEL_BULK_PACE_MIN;
+    }
+    else if ((lost << 2) > (delivered + lost))
+    {
+        /* Multiplicative increase on heavy loss */
+        pace_ms += (pace_ms >> 1);
+
+        if (MS_VENDORMODEL_BULK_PACE_MAX < pace_ms)
+        {
+            pace_ms = MS_VENDORMODEL_BULK_PACE_MAX;
+        }
+    }
+
+    pace->pace_ms = (UINT16)pace_ms;
+}
+
+static UCHAR vendormodel_bulk_bit_count(UINT32 bits)
+{
+    UCHAR count;
+    count = 0;
+
+    while (0 != bits)
+    {
+        bits &= (bits - 1);
+        count++;
+    }
+
+    return count;
+}
+
+static void vendormodel_bulk_tx_timer_start(UINT32 timeout_ms, UCHAR wait_ack)
+{
+    if (EM_TIMER_HANDLE_INIT_VAL != vendormodel_bulk_tx_timer)
+    {
+        EM_stop_timer(&vendormodel_bulk_tx_timer);
+        vendormodel_bulk_tx_timer = EM_TIMER_HANDLE_INIT_VAL;
+    }
+
+    vendormodel_bulk_tx.wait_ack = wait_ack;
+    EM_start_timer
+    (
+        &vendormodel_bulk_tx_timer,
+        (timeout_ms | EM_TIMEOUT_MILLISEC),
+        vendormodel_bulk_tx_timeout_handler,
+        NULL,
+        0
+    );
+}
+
+static void vendormodel_bulk_report(VENDORMODEL_BULK_TX* tx, MS_VENDORMODEL_BULK_REPORT* report)
+{
+    UINT32 delivered;
+    delivered = (UINT32)tx->base * MS_VENDORMODEL_BULK_CHUNK_SIZE;
+
+    if (delivered > tx->length)
+    {
+        delivered = tx->length;
+    }
+
+    report->length = tx->length;
+    report->elapsed_ms = hal_ms_intv(tx->start_tick);
+    report->goodput = (0 != report->elapsed_ms) ?
+                      (UINT32)(((UINT64)delivered * 1000) / report->elapsed_ms) : 0;
+    report->chunks_sent = tx->chunks_sent;
+    report->chunks_retx = tx->chunks_retx;
+    report->pace_ms = tx->pace->pace_ms;
+}
+
+static void vendormodel_bulk_tx_end(UCHAR event)
+{
+    MS_VENDORMODEL_BULK_REPORT report;
+    MS_VENDORMODEL_BULK_EVT    evt;
+
+    if (EM_TIMER_HANDLE_INIT_VAL != vendormodel_bulk_tx_timer)
+    {
+        EM_stop_timer(&vendormodel_bulk_tx_timer);
+        vendormodel_bulk_tx_timer = EM_TIMER_HANDLE_INIT_VAL;
+    }
+
+    vendormodel_bulk_report(&vendormodel_bulk_tx, &report);
+    vendormodel_bulk_tx.state = VENDORMODEL_BULK_IDLE;
+    EM_mem_set(&evt, 0, sizeof(evt));
+    evt.peer = vendormodel_bulk_tx.dst_addr;
+    evt.report = &report;
+
+    if (NULL != vendormodel_bulk_UI_cb)
+    {
+        vendormodel_bulk_UI_cb(event, &evt);
+    }
+}
+
+static void vendormodel_bulk_tx_send_start(void)
+{
+    UCHAR buffer[VENDORMODEL_BULK_START_LEN];
+    buffer[0] = vendormodel_bulk_tx.sid;
+    MS_PACK_LE_4_BYTE_VAL(&buffer[1], vendormodel_bulk_tx.length);
+    buffer[5] = MS_VENDORMODEL_BULK_CHUNK_SIZE;
+    buffer[6] = MS_VENDORMODEL_BULK_WINDOW;
+    vendormodel_bulk_send_pdu
+    (
+        &vendormodel_bulk_tx.handle,
+        MS_ACCESS_VENDORMODEL_BULK_START_OPCODE,
+        vendormodel_bulk_tx.dst_addr,
+        buffer,
+        sizeof(buffer)
+    );
+}
+
+/* Send one chunk, holes first, then new chunks while the window allows */
+static void vendormodel_bulk_tx_pump(void)
+{
+    VENDORMODEL_BULK_TX* tx;
+    UCHAR      buffer[VENDORMODEL_BULK_HDR_LEN + MS_VENDORMODEL_BULK_CHUNK_SIZE];
+    UINT32     offset;
+    UINT16     seq;
+    UINT16     len;
+    UCHAR      i;
+    tx = &vendormodel_bulk_tx;
+
+    /* Let the bearer drain before adding more segments */
+    if (blebrr_get_queue_depth() > (BLEBRR_QUEUE_SIZE >> 1))
+    {
+        vendormodel_bulk_tx_timer_start(tx->pace->pace_ms, MS_FALSE);
+        return;
+    }
+
+    if (0 != tx->retx)
+    {
+        i = 0;
+
+        while (0 == (tx->retx & (1UL << i)))
+        {
+            i++;
+        }
+
+        tx->retx &= ~(1UL << i);
+        seq = tx->base + i;
+        tx->chunks_retx++;
+    }
+    else if ((tx->next < tx->num_chunks) &&
+             (tx->next < (tx->base + MS_VENDORMODEL_BULK_WINDOW)))
+    {
+        seq = tx->next++;
+    }
+    else
+    {
+        /* Window used up, wait for the acknowledgement */
+        vendormodel_bulk_tx_timer_start(tx->pace->pace_ms + MS_VENDORMODEL_BULK_RTO, MS_TRUE);
+        return;
+    }
+
+    offset = (UINT32)seq * MS_VENDORMODEL_BULK_CHUNK_SIZE;
+    len = ((tx->length - offset) > MS_VENDORMODEL_BULK_CHUNK_SIZE) ?
+          MS_VENDORMODEL_BULK_CHUNK_SIZE : (UINT16)(tx->length - offset);
+    buffer[0] = tx->sid;
+    MS_PACK_LE_2_BYTE_VAL(&buffer[1], seq);
+    EM_mem_copy(&buffer[VENDORMODEL_BULK_HDR_LEN], &tx->blob[offset], len);
+    vendormodel_bulk_send_pdu
+    (
+        &tx->handle,
+        MS_ACCESS_VENDORMODEL_BULK_DATA_OPCODE,
+        tx->dst_addr,
+        buffer,
+        VENDORMODEL_BULK_HDR_LEN + len
+    );
+    tx->chunks_sent++;
+    vendormodel_bulk_tx_timer_start(tx->pace->pace_ms, MS_FALSE);
+}
+
+static void vendormodel_bulk_tx_timeout_handler(void* args, UINT16 size)
+{
+    VENDORMODEL_BULK_TX* tx;
+    MS_IGNORE_UNUSED_PARAM(args);
+    MS_IGNORE_UNUSED_PARAM(size);
+    vendormodel_bulk_tx_timer = EM_TIMER_HANDLE_INIT_VAL;
+    tx = &vendormodel_bulk_tx;
+
+    if (VENDORMODEL_BULK_IDLE == tx->state)
+    {
+        return;
+    }
+
+    if ((MS_TRUE == tx->wait_ack) || (VENDORMODEL_BULK_START == tx->state))
+    {
+        if (MS_VENDORMODEL_BULK_MAX_RETRY <= tx->retry)
+        {
+            vendormodel_bulk_tx_end(MS_VENDORMODEL_BULK_EVT_TX_FAIL);
+            return;
+        }
+
+        tx->retry++;
+
+        /* A single timeout is usually a lost acknowledgement */
+        if (1 < tx->retry)
+        {
+            vendormodel_bulk_pace_update(tx->pace, 0, 1);
+        }
+
+        if (VENDORMODEL_BULK_START == tx->state)
+        {
+            vendormodel_bulk_tx_send_start();
+            vendormodel_bulk_tx_timer_start(tx->pace->pace_ms + MS_VENDORMODEL_BULK_RTO, MS_TRUE);
+            return;
+        }
+
+        /* Probe with the oldest chunk, holes are reported afresh */
+        tx->retx |= 0x01;
+        tx->sack_high = tx->base;
+    }
+
+    vendormodel_bulk_tx_pump();
+}
+
+static void vendormodel_bulk_tx_ack(MS_NET_ADDR saddr, UCHAR* data_param, UINT16 data_len)
+{
+    VENDORMODEL_BULK_TX* tx;
+    UINT32     received;
+    UINT32     holes;
+    UINT16     delivered;
+    UINT16     base;
+    UINT16     high;
+    UINT16     shift;
+    UCHAR      i;
+    tx = &vendormodel_bulk_tx;
+
+    if ((VENDORMODEL_BULK_ACK_LEN > data_len) || (VENDORMODEL_BULK_IDLE == tx->state) ||
+            (saddr != tx->dst_addr) || (data_param[0] != tx->sid))
+    {
+        return;
+    }
+
+    MS_UNPACK_LE_2_BYTE(&base, &data_param[1]);
+    MS_UNPACK_LE_4_BYTE(&received, &data_param[3]);
+
+    /* Stale or out of range acknowledgement */
+    if ((base < tx->base) || (base > tx->next))
+    {
+        return;
+    }
+
+    tx->retry = 0;
+
+    if (VENDORMODEL_BULK_START == tx->state)
+    {
+        tx->state = VENDORMODEL_BULK_DATA;
+        tx->sack_high = 0;
+        vendormodel_bulk_tx_pump();
+        return;
+    }
+
+    /* Slide the window */
+    delivered = tx->base + vendormodel_bulk_bit_count(tx->acked);
+    shift = base - tx->base;
+    tx->acked = (32 <= shift) ? 0 : (tx->acked >> shift);
+    tx->retx = (32 <= shift) ? 0 : (tx->retx >> shift);
+    tx->base = base;
+    tx->acked |= received;
+    tx->retx &= ~tx->acked;
+    tx->win_delivered += (tx->base + vendormodel_bulk_bit_count(tx->acked)) - delivered;
+
+    if (tx->base == tx->num_chunks)
+    {
+        vendormodel_bulk_pace_update(tx->pace, tx->win_delivered, tx->win_lost);
+        vendormodel_bulk_tx_end(MS_VENDORMODEL_BULK_EVT_TX_DONE);
+        return;
+    }
+
+    /* Highest chunk the receiver has seen */
+    high = tx->base;
+
+    for (i = 0; i < 32; i++)
+    {
+        if (0 != (tx->acked & (1UL << i)))
+        {
+            high = tx->base + i + 1;
+        }
+    }
+
+    /* Chunks skipped below it are holes, each reported once per pass */
+    holes = 0;
+
+    for (i = 0; (tx->base + i) < high; i++)
+    {
+        if (((tx->base + i) >= tx->sack_high) && (0 == (tx->acked & (1UL << i))))
+        {
+            holes |= (1UL << i);
+        }
+    }
+
+    if (high > tx->sack_high)
+    {
+        tx->sack_high = high;
+    }
+
+    tx->retx |= holes;
+    tx->win_lost += vendormodel_bulk_bit_count(holes);
+
+    if ((tx->win_delivered + tx->win_lost) >= MS_VENDORMODEL_BULK_WINDOW)
+    {
+        vendormodel_bulk_pace_update(tx->pace, tx->win_delivered, tx->win_lost);
+        tx->win_delivered = 0;
+        tx->win_lost = 0;
+    }
+
+    /* Waiting for this acknowledgement, resume sending */
+    if (MS_TRUE == tx->wait_ack)
+    {
+        vendormodel_bulk_tx_pump();
+    }
+}
+
+static void vendormodel_bulk_rx_send_ack(void)
+{
+    UCHAR buffer[VENDORMODEL_BULK_ACK_LEN];
+    buffer[0] = vendormodel_bulk_rx.sid;
+    MS_PACK_LE_2_BYTE_VAL(&buffer[1], vendormodel_bulk_rx.base);
+    MS_PACK_LE_4_BYTE_VAL(&buffer[3], vendormodel_bulk_rx.received);
+    vendormodel_bulk_rx.unacked = 0;
+    vendormodel_bulk_send_pdu
+    (
+        &vendormodel_bulk_rx.handle,
+        MS_ACCESS_VENDORMODEL_BULK_ACK_OPCODE,
+        vendormodel_bulk_rx.src_addr,
+        buffer,
+        sizeof(buffer)
+    );
+}
+
+static void vendormodel_bulk_rx_timeout_handler(void* args, UINT16 size)
+{
+    MS_IGNORE_UNUSED_PARAM(args);
+    MS_IGNORE_UNUSED_PARAM(size);
+    vendormodel_bulk_rx_timer = EM_TIMER_HANDLE_INIT_VAL;
+
+    if (VENDORMODEL_BULK_DATA == vendormodel_bulk_rx.state)
+    {
+        vendormodel_bulk_rx_send_ack();
+    }
+}
+
+static void vendormodel_bulk_rx_idle_timer_start(void)
+{
+    if (EM_TIMER_HANDLE_INIT_VAL != vendormodel_bulk_rx_idle_timer)
+    {
+        EM_stop_timer(&vendormodel_bulk_rx_idle_timer);
+        vendormodel_bulk_rx_idle_timer = EM_TIMER_HANDLE_INIT_VAL;
+    }
+
+    EM_start_timer
+    (
+        &vendormodel_bulk_rx_idle_timer,
+        MS_VENDORMODEL_BULK_RX_TIMEOUT,
+        vendormodel_bulk_rx_idle_timeout_handler,
+        NULL,
+        0
+    );
+}
+
+/* Drop the session, a transfer still receiving is reported as failed */
+static void vendormodel_bulk_rx_end(void)
+{
+    MS_VENDORMODEL_BULK_REPORT report;
+    MS_VENDORMODEL_BULK_EVT    evt;
+    VENDORMODEL_BULK_RX*       rx;
+    UCHAR                      state;
+    rx = &vendormodel_bulk_rx;
+
+    if (EM_TIMER_HANDLE_INIT_VAL != vendormodel_bulk_rx_timer)
+    {
+        EM_stop_timer(&vendormodel_bulk_rx_timer);
+        vendormodel_bulk_rx_timer = EM_TIMER_HANDLE_INIT_VAL;
+    }
+
+    if (EM_TIMER_HANDLE_INIT_VAL != vendormodel_bulk_rx_idle_timer)
+    {
+        EM_stop_timer(&vendormodel_bulk_rx_idle_timer);
+        vendormodel_bulk_rx_idle_timer = EM_TIMER_HANDLE_INIT_VAL;
+    }
+
+    state = rx->state;
+    rx->state = VENDORMODEL_BULK_IDLE;
+
+    if ((VENDORMODEL_BULK_DATA == state) && (NULL != vendormodel_bulk_UI_cb))
+    {
+        EM_mem_set(&report, 0, sizeof(report));
+        report.length = rx->length;
+        report.elapsed_ms = hal_ms_intv(rx->start_tick);
+        EM_mem_set(&evt, 0, sizeof(evt));
+        evt.peer = rx->src_addr;
+        /* Blob octets received in order */
+        evt.offset = (UINT32)rx->base * rx->chunk_size;
+        evt.report = &report;
+        vendormodel_bulk_UI_cb(MS_VENDORMODEL_BULK_EVT_RX_FAIL, &evt);
+    }
+}
+
+static void vendormodel_bulk_rx_idle_timeout_handler(void* args, UINT16 size)
+{
+    MS_IGNORE_UNUSED_PARAM(args);
+    MS_IGNORE_UNUSED_PARAM(size);
+    vendormodel_bulk_rx_idle_timer = EM_TIMER_HANDLE_INIT_VAL;
+    vendormodel_bulk_rx_end();
+}
+
+static void vendormodel_bulk_rx_start
+(
+    MS_ACCESS_MODEL_HANDLE* handle,
+    MS_NET_ADDR saddr,
+    UCHAR* data_param,
+    UINT16 data_len
+)
+{
+    VENDORMODEL_BULK_RX*    rx;
+    MS_VENDORMODEL_BULK_EVT evt;
+    UINT32                  length;
+    rx = &vendormodel_bulk_rx;
+
+    if (VENDORMODEL_BULK_START_LEN > data_len)
+    {
+        return;
+    }
+
+    /* Repeated START, the acknowledgement was lost */
+    if ((VENDORMODEL_BULK_IDLE != rx->state) &&
+            (saddr == rx->src_addr) && (data_param[0] == rx->sid))
+    {
+        vendormodel_bulk_rx_send_ack();
+        vendormodel_bulk_rx_idle_timer_start();
+        return;
+    }
+
+    /* One blob is received at a time, a new one from the same sender replaces it */
+    if ((VENDORMODEL_BULK_DATA == rx->state) && (saddr != rx->src_addr))
+    {
+        return;
+    }
+
+    MS_UNPACK_LE_4_BYTE(&length, &data_param[1]);
+
+    if ((0 == data_param[5]) || (MS_VENDORMODEL_BULK_CHUNK_SIZE < data_param[5]) || (0 == length) ||
+            (((length + data_param[5] - 1) / data_param[5]) > 0xFFFF))
+    {
+        return;
+    }
+
+    /* The sender gave up on the previous blob */
+    if (VENDORMODEL_BULK_IDLE != rx->state)
+    {
+        vendormodel_bulk_rx_end();
+    }
+
+    EM_mem_set(&evt, 0, sizeof(evt));
+    evt.peer = saddr;
+    evt.offset = length;
+
+    if ((NULL != vendormodel_bulk_UI_cb) &&
+            (API_SUCCESS != vendormodel_bulk_UI_cb(MS_VENDORMODEL_BULK_EVT_RX_START, &evt)))
+    {
+        return;
+    }
+
+    EM_mem_set(rx, 0, sizeof(VENDORMODEL_BULK_RX));
+    rx->handle = *handle;
+    rx->src_addr = saddr;
+    rx->sid = data_param[0];
+    rx->length = length;
+    rx->chunk_size = data_param[5];
+    rx->window = (0 != data_param[6]) ? data_param[6] : 1;
+    rx->num_chunks = (UINT16)((length + rx->chunk_size - 1) / rx->chunk_size);
+    rx->start_tick = hal_systick();
+    rx->state = VENDORMODEL_BULK_DATA;
+    vendormodel_bulk_rx_send_ack();
+    vendormodel_bulk_rx_idle_timer_start();
+}
+
+static void vendormodel_bulk_rx_data(MS_NET_ADDR saddr, UCHAR* data_param, UINT16 data_len)
+{
+    VENDORMODEL_BULK_RX*       rx;
+    MS_VENDORMODEL_BULK_EVT    evt;
+    MS_VENDORMODEL_BULK_REPORT report;
+    UINT16                     seq;
+    UINT16                     offset;
+    UINT32                     chunk_len;
+    rx = &vendormodel_bulk_rx;
+
+    if ((VENDORMODEL_BULK_HDR_LEN >= data_len) || (VENDORMODEL_BULK_IDLE == rx->state) ||
+            (saddr != rx->src_addr) || (data_param[0] != rx->sid))
+    {
+        return;
+    }
+
+    vendormodel_bulk_rx_idle_timer_start();
+    MS_UNPACK_LE_2_BYTE(&seq, &data_param[1]);
+    offset = seq - rx->base;
+
+    /* Duplicate or beyond what the bitmap can hold, acknowledge to resync */
+    if ((VENDORMODEL_BULK_DONE == rx->state) || (seq < rx->base) ||
+            (32 <= offset) || (seq >= rx->num_chunks) ||
+            (0 != (rx->received & (1UL << offset))))
+    {
+        vendormodel_bulk_rx_send_ack();
+        return;
+    }
+
+    /* Every chunk is full except the last one, which holds the rest of the blob */
+    chunk_len = rx->length - ((UINT32)seq * rx->chunk_size);
+
+    if (chunk_len > rx->chunk_size)
+    {
+        chunk_len = rx->chunk_size;
+    }
+
+    if ((UINT32)(data_len - VENDORMODEL_BULK_HDR_LEN) != chunk_len)
+    {
+        return;
+    }
+
+    EM_mem_set(&evt, 0, sizeof(evt));
+    evt.peer = saddr;
+    evt.offset = (UINT32)seq * rx->chunk_size;
+    evt.data = &data_param[VENDORMODEL_BULK_HDR_LEN];
+    evt.data_len = data_len - VENDORMODEL_BULK_HDR_LEN;
+
+    if (NULL != vendormodel_bulk_UI_cb)
+    {
+        vendormodel_bulk_UI_cb(MS_VENDORMODEL_BULK_EVT_RX_DATA, &evt);
+    }
+
+    /* Mark and slide over the contiguous part */
+    rx->received |= (1UL << offset);
+
+    while (0 != (rx->received & 0x01))
+    {
+        rx->received >>= 1;
+        rx->base++;
+    }
+
+    rx->unacked++;
+
+    if (EM_TIMER_HANDLE_INIT_VAL != vendormodel_bulk_rx_timer)
+    {
+        EM_stop_timer(&vendormodel_bulk_rx_timer);
+        vendormodel_bulk_rx_timer = EM_TIMER_HANDLE_INIT_VAL;
+    }
+
+    if (rx->base == rx->num_chunks)
+    {
+        /* Keep the session to acknowledge retransmissions */
+        rx->state = VENDORMODEL_BULK_DONE;
+        vendormodel_bulk_rx_send_ack();
+        EM_mem_set(&report, 0, sizeof(report));
+        report.length = rx->length;
+        report.elapsed_ms = hal_ms_intv(rx->start_tick);
+        report.goodput = (0 != report.elapsed_ms) ?
+                         (UINT32)(((UINT64)rx->length * 1000) / report.elapsed_ms) : 0;
+        evt.offset = 0;
+        evt.data = NULL;
+        evt.data_len = 0;
+        evt.report = &report;
+
+        if (NULL != vendormodel_bulk_UI_cb)
+        {
+            vendormodel_bulk_UI_cb(MS_VENDORMODEL_BULK_EVT_RX_DONE, &evt);
+        }
+    }
+    else if (rx->unacked >= rx->window)
+    {
+        vendormodel_bulk_rx_send_ack();
+    }
+    else
+    {
+        EM_start_timer
+        (
+            &vendormodel_bulk_rx_timer,
+            (MS_VENDORMODEL_BULK_ACK_DELAY | EM_TIMEOUT_MILLISEC),
+            vendormodel_bulk_rx_timeout_handler,
+            NULL,
+            0
+        );
+    }
+}
+
+/**
+    \brief API to register the bulk transfer application callback
+
+    \param [in] bulk_cb    Application callback, NULL to accept and drop received blobs.
+
+    \return API_SUCCESS
+*/
+API_RESULT MS_vendormodel_bulk_register
+(
+    /* IN */ MS_VENDORMODEL_BULK_CB    bulk_cb
+)
+{
+    vendormodel_bulk_UI_cb = bulk_cb;
+    return API_SUCCESS;
+}
+
+/**
+    \brief API to stream a blob to a destination
+
+    \param [in] model_handle    Vendor model used to send the chunks.
+    \param [in] dst_addr        Unicast destination.
+    \param [in] blob            Data to be sent.
+    \param [in] length          Length of the blob.
+
+    \return API_SUCCESS or an error code indicating reason for failure
+*/
+API_RESULT MS_vendormodel_bulk_send
+(
+    /* IN */ MS_ACCESS_MODEL_HANDLE*   model_handle,
+    /* IN */ MS_NET_ADDR               dst_addr,
+    /* IN */ UCHAR*                    blob,
+    /* IN */ UINT32                    length
+)
+{
+    VENDORMODEL_BULK_TX* tx;
+    tx = &vendormodel_bulk_tx;
+
+    if ((NULL == model_handle) || (NULL == blob) || (0 == length) ||
+            (((length + MS_VENDORMODEL_BULK_CHUNK_SIZE - 1) / MS_VENDORMODEL_BULK_CHUNK_SIZE) > 0xFFFF) ||
+            (MS_NET_ADDR_TYPE_UNICAST != MS_net_get_address_type(dst_addr)))
+    {
+        return API_FAILURE;
+    }
+
+    if (VENDORMODEL_BULK_IDLE != tx->state)
+    {
+        return API_FAILURE;
+    }
+
+    EM_mem_set(tx, 0, sizeof(VENDORMODEL_BULK_TX));
+    tx->handle = *model_handle;
+    tx->dst_addr = dst_addr;
+    tx->blob = blob;
+    tx->length = length;
+    tx->num_chunks = (UINT16)((length + MS_VENDORMODEL_BULK_CHUNK_SIZE - 1) / MS_VENDORMODEL_BULK_CHUNK_SIZE);
+    tx->pace = vendormodel_bulk_pace_get(dst_addr);
+    tx->sid = ++vendormodel_bulk_sid;
+    tx->start_tick = hal_systick();
+    tx->state = VENDORMODEL_BULK_START;
+    vendormodel_bulk_tx_send_start();
+    vendormodel_bulk_tx_timer_start(tx->pace->pace_ms + MS_VENDORMODEL_BULK_RTO, MS_TRUE);
+    return API_SUCCESS;
+}
+
+/**
+    \brief API to stop the ongoing bulk transmission
+
+    \return API_SUCCESS or API_FAILURE if no transfer is ongoing
+*/
+API_RESULT MS_vendormodel_bulk_abort(void)
+{
+    if (VENDORMODEL_BULK_IDLE == vendormodel_bulk_tx.state)
+    {
+        return API_FAILURE;
+    }
+
+    vendormodel_bulk_tx_end(MS_VENDORMODEL_BULK_EVT_TX_FAIL);
+    return API_SUCCESS;
+}
+
+/**
+    \brief Bulk transfer opcode handler
+
+    \param [in] handle        Model Handle.
+    \param [in] saddr         16 bit Source Address.
+    \param [in] opcode        Opcode.
+    \param [in] data_param    Data associated with the opcode.
+    \param [in] data_len      Size of the data.
+
+    \return API_SUCCESS or an error code indicating reason for failure
+*/
+API_RESULT MS_vendormodel_bulk_handler
+(
+    /* IN */ MS_ACCESS_MODEL_HANDLE*   handle,
+    /* IN */ MS_NET_ADDR               saddr,
+    /* IN */ UINT32                    opcode,
+    /* IN */ UCHAR*                    data_param,
+    /* IN */ UINT16                    data_len
+)
+{
+    if (NULL == data_param)
+    {
+        return API_FAILURE;
+    }
+
+    switch (opcode)
+    {
+    case MS_ACCESS_VENDORMODEL_BULK_START_OPCODE:
+        vendormodel_bulk_rx_start(handle, saddr, data_param, data_len);
+        break;
+
+    case MS_ACCESS_VENDORMODEL_BULK_DATA_OPCODE:
+        vendormodel_bulk_rx_data(saddr, data_param, data_len);
+        break;
+
+    case MS_ACCESS_VENDORMODEL_BULK_ACK_OPCODE:
+        vendormodel_bulk_tx_ack(saddr, data_param, data_len);
+        break;
+
+    default:
+        return API_FAILURE;
+    }
+
+    return API_SUCCESS;
+}
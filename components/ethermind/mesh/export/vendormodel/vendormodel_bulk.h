@@ -0,0 +1,207 @@
+/**
+    \file vendormodel_bulk.h
+
+    \brief This file defines the bulk transfer layer carried over the
+    vendor model - window of segmented chunks, selective acknowledgement
+    and per destination pacing.
+*/
+
+/*
+    Copyright (C) 2020. phyplus Ltd.
+    All rights reserved.
+*/
+
+#ifndef _H_VENDORMODEL_BULK_
+#define _H_VENDORMODEL_BULK_
+
+
+/* --------------------------------------------- Header File Inclusion */
+#include "vendormodel_common.h"
+#include "MS_access_api.h"
+#include "access_extern.h"
+
+
+/* --------------------------------------------- Global Definitions */
+/**
+    Lower transport segments filled by one chunk. Each segment carries 12
+    octets of the access PDU, which also holds the 4 octet TransMIC, the 3
+    octet vendor opcode and the 3 octet chunk header.
+*/
+#ifndef MS_VENDORMODEL_BULK_SEGMENTS
+    #define MS_VENDORMODEL_BULK_SEGMENTS                4
+#endif
+
+/** Chunk payload size, fills MS_VENDORMODEL_BULK_SEGMENTS segments exactly */
+#define MS_VENDORMODEL_BULK_CHUNK_SIZE                  ((12 * MS_VENDORMODEL_BULK_SEGMENTS) - 10)
+
+/** Chunks sent ahead of the acknowledgement, at most 32 */
+#ifndef MS_VENDORMODEL_BULK_WINDOW
+    #define MS_VENDORMODEL_BULK_WINDOW                  8
+#endif
+
+/** Destinations whose pacing interval is remembered */
+#define MS_VENDORMODEL_BULK_PACE_SLOTS                  4
+
+/** Pacing interval between chunks, in milliseconds */
+#define MS_VENDORMODEL_BULK_PACE_INIT                   (20 * MS_VENDORMODEL_BULK_SEGMENTS)
+#define MS_VENDORMODEL_BULK_PACE_MIN                    (8 * MS_VENDORMODEL_BULK_SEGMENTS)
+#define MS_VENDORMODEL_BULK_PACE_MAX                    2000
+#define MS_VENDORMODEL_BULK_PACE_STEP                   5
+
+/** Sender wait for an acknowledgement beyond the pacing interval */
+#define MS_VENDORMODEL_BULK_RTO                         1000
+
+/** Consecutive acknowledgement timeouts before the transfer is dropped */
+#define MS_VENDORMODEL_BULK_MAX_RETRY                   6
+
+/** Receiver delay before acknowledging a partial window */
+#define MS_VENDORMODEL_BULK_ACK_DELAY                   150
+
+/**
+    Receiver drops a transfer when the sender is silent this long, in
+    seconds. Longer than a sender takes to give up after its retries.
+*/
+#define MS_VENDORMODEL_BULK_RX_TIMEOUT                  30
+
+/** Bulk transfer events */
+#define MS_VENDORMODEL_BULK_EVT_RX_START                0x01
+#define MS_VENDORMODEL_BULK_EVT_RX_DATA                 0x02
+#define MS_VENDORMODEL_BULK_EVT_RX_DONE                 0x03
+#define MS_VENDORMODEL_BULK_EVT_TX_DONE                 0x04
+#define MS_VENDORMODEL_BULK_EVT_TX_FAIL                 0x05
+#define MS_VENDORMODEL_BULK_EVT_RX_FAIL                 0x06
+
+
+/* --------------------------------------------- Data Types/ Structures */
+/** Transfer statistics, reported with the DONE and FAIL events */
+typedef struct _MS_VENDORMODEL_BULK_REPORT
+{
+    /** Blob length in octets */
+    UINT32 length;
+
+    /** Time from start to the last acknowledgement */
+    UINT32 elapsed_ms;
+
+    /** Delivered payload octets per second */
+    UINT32 goodput;
+
+    /** Chunks put on air, including retransmissions */
+    UINT16 chunks_sent;
+
+    /** Chunks sent again after a hole or a timeout */
+    UINT16 chunks_retx;
+
+    /** Pacing interval at the end of the transfer */
+    UINT16 pace_ms;
+
+} MS_VENDORMODEL_BULK_REPORT;
+
+/** Bulk transfer event parameters */
+typedef struct _MS_VENDORMODEL_BULK_EVT
+{
+    /** Address of the other end */
+    MS_NET_ADDR peer;
+
+    /**
+        RX_START: blob length. RX_DATA: offset of data in the blob.
+        RX_FAIL: octets received in order before the transfer was dropped.
+    */
+    UINT32 offset;
+
+    /** RX_DATA: chunk payload */
+    UCHAR* data;
+
+    /** RX_DATA: chunk payload length */
+    UINT16 data_len;
+
+    /** DONE and FAIL events: transfer statistics */
+    MS_VENDORMODEL_BULK_REPORT* report;
+
+} MS_VENDORMODEL_BULK_EVT;
+
+/**
+    Bulk transfer application Asynchronous Notification Callback.
+
+    RX_DATA chunks may arrive out of order, the offset places them in the blob.
+    Returning an error to RX_START refuses the transfer. RX_FAIL drops the
+    blob being received: the sender was silent for MS_VENDORMODEL_BULK_RX_TIMEOUT
+    or started a new one.
+
+    \param [in] event   Bulk transfer event.
+    \param [in] param   Event parameters.
+*/
+typedef API_RESULT (* MS_VENDORMODEL_BULK_CB)
+(
+    UCHAR                      event,
+    MS_VENDORMODEL_BULK_EVT*   param
+
+) DECL_REENTRANT;
+
+
+/* --------------------------------------------- Function */
+/**
+    \brief API to register the bulk transfer application callback
+
+    \param [in] bulk_cb    Application callback, NULL to accept and drop received blobs.
+
+    \return API_SUCCESS
+*/
+API_RESULT MS_vendormodel_bulk_register
+(
+    /* IN */ MS_VENDORMODEL_BULK_CB    bulk_cb
+);
+
+/**
+    \brief API to stream a blob to a destination
+
+    \par Description
+    The blob is sent in chunks of MS_VENDORMODEL_BULK_CHUNK_SIZE octets with
+    up to MS_VENDORMODEL_BULK_WINDOW chunks unacknowledged. The blob is not
+    copied and must stay valid until the TX_DONE or TX_FAIL event.
+
+    \param [in] model_handle    Vendor model used to send the chunks.
+    \param [in] dst_addr        Unicast destination.
+    \param [in] blob            Data to be sent.
+    \param [in] length          Length of the blob.
+
+    \return API_SUCCESS or an error code indicating reason for failure
+*/
+API_RESULT MS_vendormodel_bulk_send
+(
+    /* IN */ MS_ACCESS_MODEL_HANDLE*   model_handle,
+    /* IN */ MS_NET_ADDR               dst_addr,
+    /* IN */ UCHAR*                    blob,
+    /* IN */ UINT32                    length
+);
+
+/**
+    \brief API to stop the ongoing bulk transmission
+
+    \return API_SUCCESS or API_FAILURE if no transfer is ongoing
+*/
+API_RESULT MS_vendormodel_bulk_abort(void);
+
+/**
+    \brief Bulk transfer opcode handler
+
+    \par Description
+    Called by the vendor model client and server for the bulk opcodes.
+
+    \param [in] handle        Model Handle.
+    \param [in] saddr         16 bit Source Address.
+    \param [in] opcode        Opcode.
+    \param [in] data_param    Data associated with the opcode.
+    \param [in] data_len      Size of the data.
+
+    \return API_SUCCESS or an error code indicating reason for failure
+*/
+API_RESULT MS_vendormodel_bulk_handler
+(
+    /* IN */ MS_ACCESS_MODEL_HANDLE*   handle,
+    /* IN */ MS_NET_ADDR               saddr,
+    /* IN */ UINT32                    opcode,
+    /* IN */ UCHAR*                    data_param,
+    /* IN */ UINT16                    data_len
+);
+
+#endif /*_H_VENDORMODEL_BULK_ */
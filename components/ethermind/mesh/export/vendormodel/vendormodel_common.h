@@ -44,6 +44,9 @@
 #define MS_ACCESS_VENDORMODEL_CONFIRMATION_OPCODE                      0x00D50405
 #define MS_ACCESS_VENDORMODEL_WRITECMD_OPCODE                          0x00E00405
 #define MS_ACCESS_VENDORMODEL_NOTIFY_OPCODE                            0x00E10405
+#define MS_ACCESS_VENDORMODEL_BULK_START_OPCODE                        0x00E20405
+#define MS_ACCESS_VENDORMODEL_BULK_DATA_OPCODE                         0x00E30405
+#define MS_ACCESS_VENDORMODEL_BULK_ACK_OPCODE                          0x00E40405
 
 #define MS_MODEL_ID_VENDORMODEL_SERVER                                 0x00000504
 #define MS_MODEL_ID_VENDORMODEL_CLIENT                                 0x00010504
@@ -14,109 +14,340 @@
 /* ----------------------------------------------- Header File Inclusion */
 #include "EM_timer_internal.h"
 #include "OSAL_Clock.h"
+#include "OSAL_Timers.h"
 
 /* ----------------------------------------------- Global Definitions */
 /* Timer Elements */
 TIMER_ENTITY timer_entity[EM_TIMER_MAX_ENTITIES];
-TIMER_ENTITY* timer_q_start = NULL;
-TIMER_ENTITY* timer_q_end   = NULL;
+
+/* Handles of free Timer Elements */
+DECL_STATIC UINT8 timer_free_list[EM_TIMER_MAX_ENTITIES];
+DECL_STATIC UINT8 timer_free_count;
+DECL_STATIC UCHAR timer_free_ready = 0;
 
 #if 0
     /* Timer Library Mutex */
     EM_thread_mutex_type timer_mutex;
 #endif /* 0 */
 
-#if 1
-/* Timer */
-#if defined ( OSAL_CBTIMER_NUM_TASKS )
-    #include "osal_cbTimer.h"
-#endif
+/* ----------------------------------------------- Static Global Variables */
+/* Timer Wheel slots, Nodes are hashed by expiry time */
+DECL_STATIC EM_TWHEEL_NODE* em_twheel_slot[EM_TWHEEL_SLOTS];
 
+/* Time the wheel has been serviced up to */
+DECL_STATIC UINT32 em_twheel_run_time;
 
-/* ----------------------------------------------- Static Global Variables */
-/*********************************************************************
-    CONSTANTS
-*/
-// Number of callback timers supported per task (limited by the number of OSAL event timers)
-#define NUM_CBTIMERS_PER_TASK          15
+/* Deadline and Id of the PhyOS timer backing the wheel */
+DECL_STATIC UINT32 em_twheel_hw_deadline;
+DECL_STATIC UINT8  em_twheel_hw_id = PHYOS_INVALID_TIMER_ID;
 
-// Total number of callback timers
-#define NUM_CBTIMERS                   ( OSAL_CBTIMER_NUM_TASKS * NUM_CBTIMERS_PER_TASK )
+/* Set while expired Nodes are being called */
+DECL_STATIC UCHAR  em_twheel_in_service;
 
+DECL_STATIC EM_TWHEEL_STAT em_twheel_stat;
+DECL_STATIC UINT32 em_twheel_stat_time;
+DECL_STATIC UINT32 em_twheel_stat_wakeups;
 
-typedef struct
-{
-    pfnCbTimer_t pfnCbTimer; // callback function to be called when timer expires
-    uint8* pData;            // data to be passed in to callback function
-} cbTimer_t;
-
-extern cbTimer_t cbTimers[];
-
-extern uint16 baseTaskID;
-#define EVENT_ID( timerId )            ( 0x0001 << ( ( timerId ) % NUM_CBTIMERS_PER_TASK ) )
-
-// Find out task id using timer id
-#define TASK_ID( timerId )             ( ( ( timerId ) / NUM_CBTIMERS_PER_TASK ) + baseTaskID )
-
-// Find out bank task id using task id
-#define BANK_TASK_ID( taskId )         ( ( baseTaskID - ( taskId ) ) * NUM_CBTIMERS )
-
-
-//extern uint16 $Sub$$osal_CbTimerProcessEvent( uint8 taskId, uint16 events );
-//uint16 $Sub$$osal_CbTimerProcessEvent( uint8 taskId, uint16 events )
-//{
-//    if ( events & SYS_EVENT_MSG )
-//  {
-//    // Process OSAL messages
-
-//    // return unprocessed events
-//    return ( events ^ SYS_EVENT_MSG );
-//  }
-
-//  if ( events )
-//  {
-//    uint8 i;
-//    uint16 event;
-
-//    // Process event timers
-//    for ( i = 0; i < NUM_CBTIMERS_PER_TASK32; i++ )
-//    {
-//      if ( ( events >> i ) & 0x0001 )
-//      {
-//        cbTimer_t *pTimer = &cbTimers[BANK_TASK_ID32( taskId )+i];
-
-//        // Found the first event
-//        event =  0x0001 << i;
-
-//        // Timer expired, call the registered callback function
-//        if(pTimer->pfnCbTimer==NULL)
-//        {
-//        }
-//        pTimer->pfnCbTimer( pTimer->pData );
-
-//        // Mark entry as free
-//        pTimer->pfnCbTimer = NULL;
-//
-//        // Null out data pointer
-//        pTimer->pData = NULL;
-//
-//        // We only process one event at a time
-//        break;
-//      }
-//    }
-
-//    // return unprocessed events
-//    return ( events ^ event );
-//}
-//}
+#define EM_TWHEEL_SLOT(t)           (((t) >> EM_TWHEEL_SLOT_SHIFT) & (EM_TWHEEL_SLOTS - 1))
 
+/* Time a is before time b, system clock wraps */
+#define EM_TWHEEL_BEFORE(a, b)      ((INT32)((a) - (b)) < 0)
 
-#endif
+/* Millisecond of EM Timeout, with EM_TIMEOUT_MILLISEC or in seconds */
+#define EM_TIMEOUT_TO_MS(t)         ((EM_TIMEOUT_MILLISEC & (t)) ? \
+                                     ((t) & (UINT32)~(EM_TIMEOUT_MILLISEC)) : ((t) * 1000))
+#define EM_TIMEOUT_TO_SLACK(t)      ((EM_TIMEOUT_MILLISEC & (t)) ? 0 : \
+                                     (((t) * 1000) >> EM_TIMER_SLACK_SHIFT))
 
 #undef EM_RESTART_TIMER
 
+/* ----------------------------------------------- Timer Wheel */
+
+DECL_STATIC void em_twheel_link (EM_TWHEEL_NODE* node)
+{
+    EM_TWHEEL_NODE** head;
+    head = &em_twheel_slot[EM_TWHEEL_SLOT(node->expiry)];
+    node->next = *head;
+
+    if (NULL != node->next)
+    {
+        node->next->pprev = &node->next;
+    }
+
+    node->pprev = head;
+    *head = node;
+    em_twheel_stat.active ++;
+
+    if (em_twheel_stat.active_max < em_twheel_stat.active)
+    {
+        em_twheel_stat.active_max = em_twheel_stat.active;
+    }
+}
+
+DECL_STATIC void em_twheel_unlink (EM_TWHEEL_NODE* node)
+{
+    *node->pprev = node->next;
+
+    if (NULL != node->next)
+    {
+        node->next->pprev = node->pprev;
+    }
+
+    node->next = NULL;
+    node->pprev = NULL;
+    em_twheel_stat.active --;
+}
+
+DECL_STATIC void em_twheel_hw_expire (UINT8* pdata);
+
+/* Program the PhyOS timer to expire at deadline */
+DECL_STATIC void em_twheel_program (UINT32 deadline)
+{
+    UINT32 now;
+    UINT32 timeout;
+
+    if (PHYOS_INVALID_TIMER_ID != em_twheel_hw_id)
+    {
+        if (deadline == em_twheel_hw_deadline)
+        {
+            return;
+        }
+
+        osal_CbTimerStop(em_twheel_hw_id);
+        em_twheel_hw_id = PHYOS_INVALID_TIMER_ID;
+    }
+
+    now = osal_GetSystemClock();
+    timeout = EM_TWHEEL_BEFORE(now, deadline) ? (deadline - now) : 1;
+    em_twheel_hw_deadline = deadline;
+
+    if (SUCCESS != osal_CbTimerStart
+            (
+                em_twheel_hw_expire,
+                (UINT8*)&em_twheel_hw_deadline,
+                timeout,
+                &em_twheel_hw_id
+            ))
+    {
+        EM_TIMER_ERR("*** FAILED to Start timer wheel\n");
+        em_twheel_hw_id = PHYOS_INVALID_TIMER_ID;
+    }
+}
+
+/* Find the earliest deadline of all Nodes and program the PhyOS timer */
+DECL_STATIC void em_twheel_reprogram (void)
+{
+    EM_TWHEEL_NODE* node;
+    UINT32 deadline, d;
+    UINT16 index;
+    UCHAR  found;
+
+    if (0 == em_twheel_stat.active)
+    {
+        if (PHYOS_INVALID_TIMER_ID != em_twheel_hw_id)
+        {
+            osal_CbTimerStop(em_twheel_hw_id);
+            em_twheel_hw_id = PHYOS_INVALID_TIMER_ID;
+        }
+
+        return;
+    }
+
+    found = 0x00;
+    deadline = 0;
+
+    for (index = 0; index < EM_TWHEEL_SLOTS; index ++)
+    {
+        for (node = em_twheel_slot[index]; NULL != node; node = node->next)
+        {
+            d = node->expiry + node->slack;
+
+            if ((0x00 == found) || EM_TWHEEL_BEFORE(d, deadline))
+            {
+                deadline = d;
+                found = 0x01;
+            }
+        }
+    }
+
+    em_twheel_program(deadline);
+}
+
+/* Call the expired Nodes, in slots from last serviced time to now */
+DECL_STATIC void em_twheel_service (void)
+{
+    EM_TWHEEL_NODE* node;
+    UINT32 now;
+    UINT32 count, index, slot;
+    UINT32 expired;
+    osalTimeUpdate();
+    now = osal_GetSystemClock();
+    count = ((now >> EM_TWHEEL_SLOT_SHIFT) - (em_twheel_run_time >> EM_TWHEEL_SLOT_SHIFT)) + 1;
+
+    if (EM_TWHEEL_SLOTS < count)
+    {
+        count = EM_TWHEEL_SLOTS;
+    }
+
+    expired = 0;
+    em_twheel_in_service = 0x01;
+
+    for (index = 0; index < count; index ++)
+    {
+        slot = EM_TWHEEL_SLOT(em_twheel_run_time + (index << EM_TWHEEL_SLOT_SHIFT));
+        node = em_twheel_slot[slot];
+
+        while (NULL != node)
+        {
+            if (EM_TWHEEL_BEFORE(now, node->expiry))
+            {
+                node = node->next;
+                continue;
+            }
+
+            em_twheel_unlink(node);
+            expired ++;
+            node->expire(node);
+            /* Slot may be changed by the callback, walk it again */
+            node = em_twheel_slot[slot];
+        }
+    }
+
+    em_twheel_run_time = now;
+    em_twheel_in_service = 0x00;
+    em_twheel_stat.expired += expired;
+
+    if (1 < expired)
+    {
+        em_twheel_stat.coalesced += (expired - 1);
+    }
+
+    em_twheel_reprogram();
+}
+
+/* Callback registered with PhyOS timer */
+DECL_STATIC void em_twheel_hw_expire (UINT8* pdata)
+{
+    (void)pdata;
+    em_twheel_hw_id = PHYOS_INVALID_TIMER_ID;
+    em_twheel_stat.wakeups ++;
+    em_twheel_service();
+}
+
+void EM_twheel_start
+(
+    EM_TWHEEL_NODE* node,
+    UINT32 timeout_ms,
+    UINT32 slack_ms
+)
+{
+    UINT32 deadline;
+    UCHAR  reprogram;
+    reprogram = 0x00;
+
+    if (NULL != node->pprev)
+    {
+        /* Restart of the Node the PhyOS timer is waiting for */
+        reprogram = ((node->expiry + node->slack) == em_twheel_hw_deadline) ? 0x01 : 0x00;
+        em_twheel_unlink(node);
+    }
+
+    /* Nodes started in callbacks expire in next service */
+    if (0 == timeout_ms)
+    {
+        timeout_ms = 1;
+    }
+
+    osalTimeUpdate();
+    node->expiry = osal_GetSystemClock() + timeout_ms;
+    node->slack = slack_ms;
+    em_twheel_link(node);
+
+    if (0x00 != em_twheel_in_service)
+    {
+        return;
+    }
+
+    deadline = node->expiry + node->slack;
+
+    if (0x00 != reprogram)
+    {
+        em_twheel_reprogram();
+    }
+    else if ((PHYOS_INVALID_TIMER_ID == em_twheel_hw_id) ||
+             EM_TWHEEL_BEFORE(deadline, em_twheel_hw_deadline))
+    {
+        em_twheel_program(deadline);
+    }
+}
+
+void EM_twheel_stop ( EM_TWHEEL_NODE* node )
+{
+    UINT32 deadline;
+
+    if (NULL == node->pprev)
+    {
+        return;
+    }
+
+    deadline = node->expiry + node->slack;
+    em_twheel_unlink(node);
+
+    /* Keep the PhyOS timer unless it is for this Node */
+    if ((0x00 == em_twheel_in_service) &&
+            (PHYOS_INVALID_TIMER_ID != em_twheel_hw_id) &&
+            (deadline == em_twheel_hw_deadline))
+    {
+        em_twheel_reprogram();
+    }
+}
+
+UINT32 EM_twheel_remaining ( EM_TWHEEL_NODE* node )
+{
+    UINT32 now;
+
+    if (NULL == node->pprev)
+    {
+        return 0;
+    }
+
+    now = osal_GetSystemClock();
+    return EM_TWHEEL_BEFORE(now, node->expiry) ? (node->expiry - now) : 0;
+}
+
+void EM_twheel_get_stat ( EM_TWHEEL_STAT* stat )
+{
+    UINT32 now;
+    UINT32 elapsed;
+    now = osal_GetSystemClock();
+    elapsed = now - em_twheel_stat_time;
+
+    if (0 != elapsed)
+    {
+        em_twheel_stat.wakeups_per_sec =
+            ((em_twheel_stat.wakeups - em_twheel_stat_wakeups) * 1000) / elapsed;
+    }
+
+    em_twheel_stat_time = now;
+    em_twheel_stat_wakeups = em_twheel_stat.wakeups;
+    *stat = em_twheel_stat;
+}
+
 /* ----------------------------------------------- Functions */
 
+DECL_STATIC void timer_init_free_list (void)
+{
+    UINT16 index;
+
+    for (index = 0; index < EM_TIMER_MAX_ENTITIES; index ++)
+    {
+        timer_free_list[index] = (UINT8)(EM_TIMER_MAX_ENTITIES - 1 - index);
+    }
+
+    timer_free_count = EM_TIMER_MAX_ENTITIES;
+    timer_free_ready = 0x01;
+}
+
 void EM_timer_init (void)
 {
     UINT16 index;
@@ -131,32 +362,20 @@ void EM_timer_init (void)
     for (index = 0; index < EM_TIMER_MAX_ENTITIES; index ++)
     {
         timer_init_entity(&timer_entity[index]);
-        timer_entity[index].timer_id = PHYOS_INVALID_TIMER_ID;
         timer_entity[index].handle = index;
     }
 
+    timer_init_free_list();
     return;
 }
 
 
 void timer_em_init ( void )
 {
-    TIMER_ENTITY* timer;
-    UINT16 index;
     /* Lock Timer */
     timer_lock();
     EM_TIMER_TRC(
         "Stack ON Initialization for Timer Library ...\n");
-
-    /* Initialize Timer Entities */
-    for (index = 0; index < EM_TIMER_MAX_ENTITIES; index ++)
-    {
-        timer = &timer_entity[index];
-        timer->timer_id = PHYOS_INVALID_TIMER_ID;
-    }
-
-    /* Initialize Timer Q */
-    timer_q_start = timer_q_end = NULL;
     timer_unlock();
     return;
 }
@@ -168,8 +387,6 @@ void timer_em_shutdown ( void )
     TIMER_ENTITY* timer;
     /* Lock Timer */
     timer_lock();
-    /* Initialize Timer Q */
-    timer_q_start = timer_q_end = NULL;
 
     /* Initialize Timer Entities */
     for (index = 0; index < EM_TIMER_MAX_ENTITIES; index++)
@@ -179,15 +396,7 @@ void timer_em_shutdown ( void )
         if (TIMER_ENTITY_IN_USE == timer->in_use)
         {
             /* Stop Timer */
-            osal_CbTimerStop(timer->timer_id);
-
-            if (timer->data_length > EM_TIMER_STATIC_DATA_SIZE)
-            {
-                timer_free(timer->allocated_data);
-            }
-
-            timer_init_entity(timer);
-            timer->timer_id = PHYOS_INVALID_TIMER_ID;
+            timer_del_entity(timer, 0x01);
         }
     }
 
@@ -197,46 +406,6 @@ void timer_em_shutdown ( void )
     return;
 }
 
-#if 0
-Status_t osal_CbTimerStart32( pfnCbTimer_t pfnCbTimer, uint8* pData,
-                              uint32 timeout, uint8* pTimerId )
-{
-    uint8 i;
-
-    // Validate input parameters
-    if ( pfnCbTimer == NULL )
-    {
-        return ( INVALIDPARAMETER );
-    }
-
-    // Look for an unused timer first
-    for ( i = 0; i < NUM_CBTIMERS32; i++ )
-    {
-        if ( cbTimers[i].pfnCbTimer == NULL )
-        {
-            // Start the OSAL event timer first
-            if ( osal_start_timerEx( TASK_ID32( i ), EVENT_ID32( i ), timeout ) == SUCCESS )
-            {
-                // Set up the callback timer
-                cbTimers[i].pfnCbTimer = pfnCbTimer;
-                cbTimers[i].pData = pData;
-
-                if ( pTimerId != NULL )
-                {
-                    // Caller is intreseted in the timer id
-                    *pTimerId = i;
-                }
-
-                return ( SUCCESS );
-            }
-        }
-    }
-
-    // No timer available
-    return ( NO_TIMER_AVAIL );
-}
-#endif
-
 
 EM_RESULT EM_start_timer
 (
@@ -250,8 +419,6 @@ EM_RESULT EM_start_timer
     UCHAR* data_ptr = NULL;
     EM_RESULT retval;
     TIMER_ENTITY current_timer;
-    // HZF
-    osalTimeUpdate();
 
     if (NULL == handle)
     {
@@ -330,29 +497,16 @@ EM_RESULT EM_start_timer
 }
 
 
-/* Callback registered with timer module */
-void timer_timeout_handler (UINT8* handle)
+/* Callback registered with timer wheel */
+void timer_timeout_handler (EM_TWHEEL_NODE* node)
 {
-    EM_RESULT retval;
     TIMER_ENTITY* timer;
+    /* Node is the first member of Timer Entity */
+    timer = (TIMER_ENTITY*)node;
     EM_TIMER_TRC (
-        "In Timer handler (Timer Handle: 0x%02X)\n", *handle);
-    /* Lock Timer */
-    timer_lock();
-    /* Get the appropriate timer entity */
-    retval = timer_search_entity_timer_id (&timer, *handle);
-
-    if (EM_SUCCESS != retval)
-    {
-        EM_TIMER_ERR(
-            "*** UNKNOWN Spurious Timeout Callback?!?!\n");
-        /* Unlock Timer */
-        timer_unlock ();
-        return;
-    }
-
-    /* Unlock Timer */
-    timer_unlock ();
+        "In Timer handler (Timer Handle: 0x%02X)\n", timer->handle);
+    /* Not active nor free while the callback runs */
+    timer->in_use = TIMER_ENTITY_IN_FREE;
 
     if (timer->data_length > EM_TIMER_STATIC_DATA_SIZE)
     {
@@ -367,10 +521,6 @@ void timer_timeout_handler (UINT8* handle)
 
     /* Lock Timer */
     timer_lock ();
-    #if 0
-    /* Stop Timer */
-    xTimerStop  (timer->timer_id, 0);
-    #endif /* 0 */
     /* Free the Timer */
     timer_del_entity (timer, 1);
     /* Unlock Timer */
@@ -386,9 +536,6 @@ EM_RESULT EM_stop_timer
 {
     TIMER_ENTITY* timer;
     EM_RESULT retval;
-    UINT8  timer_id;
-    UINT32 new_timeout;
-    Status_t status;
 
     if (EM_TIMER_MAX_ENTITIES <= *handle)
     {
@@ -399,49 +546,17 @@ EM_RESULT EM_stop_timer
         return EM_TIMER_HANDLE_IS_NULL;
     }
 
-    osalTimeUpdate();
-    retval = EM_FAILURE;
     /* Lock Timer */
     timer_lock();
     timer = &timer_entity[*handle];
-    /* Store the timer id before deleting entity */
-    timer_id = timer->timer_id;
-    new_timeout = 0x10;
+    retval = timer_search_entity(timer);
 
-    if(timer_search_entity(timer) == EM_SUCCESS)
+    if (EM_SUCCESS == retval)
     {
-        if((osal_CbTimerUpdate(timer_id,new_timeout) == EM_SUCCESS)
-                || (osalFindTimer(TASK_ID( timer->timer_id ),EVENT_ID( timer->timer_id )) == NULL))
-        {
-            retval = timer_del_entity(timer, 0x01);
-
-            if (EM_SUCCESS != retval)
-            {
-                EM_TIMER_ERR(
-                    "FAILED to find Timer Element. Handle = 0x%02X. Error Code = 0x%04X\n",
-                    *handle, retval);
-            }
-            else
-            {
-                EM_TIMER_TRC(
-                    "Successfully Deleted Timer Element for Handle 0x%02X.\n",
-                    *handle);
-                /* Stop Timer */
-                status = osal_CbTimerStop(timer_id);
-                osal_clear_event(TASK_ID( timer->timer_id ),EVENT_ID( timer->timer_id ));
-
-                if (SUCCESS != status)
-                {
-                    retval = EM_FAILURE;
-                }
-                else
-                {
-                    retval = EM_SUCCESS;
-                    EM_TIMER_TRC("*** Stopped Timer [ID: %04X]\n",
-                                 timer_id);
-                }
-            }
-        }
+        retval = timer_del_entity(timer, 0x01);
+        EM_TIMER_TRC(
+            "Successfully Deleted Timer Element for Handle 0x%02X.\n",
+            *handle);
     }
 
     *handle = EM_TIMER_HANDLE_INIT_VAL;
@@ -470,7 +585,7 @@ UINT32 EM_get_remain_timer
     /* Lock Timer */
     timer_lock();
     timer = &timer_entity[handle];
-    remain_timeout = osal_get_timeoutEx(TASK_ID( timer->timer_id ),EVENT_ID( timer->timer_id ));
+    remain_timeout = EM_twheel_remaining(&timer->node);
     /* Unlock Timer */
     timer_unlock();
     return remain_timeout;
@@ -504,17 +619,15 @@ EM_RESULT EM_restart_timerEx
         EM_TIMER_ERR(
             "FAILED to Find Timer ELement for Handle 0x%02X. Error Code = 0x%04X\n",
             handle, retval);
-    }
-    else
-    {
-        if(osal_CbTimerUpdate(timer->timer_id,new_timeout) == EM_SUCCESS)
-        {
-            return ( SUCCESS );
-        }
+        timer_unlock();
+        // No timer available
+        return ( NO_TIMER_AVAIL );
     }
 
-    // No timer available
-    return ( NO_TIMER_AVAIL );
+    /* New timeout in millisecond */
+    EM_twheel_start(&timer->node, new_timeout, timer->node.slack);
+    timer_unlock();
+    return ( SUCCESS );
 }
 
 #ifdef EM_RESTART_TIMER
@@ -525,10 +638,7 @@ EM_RESULT EM_restart_timer
 )
 {
     TIMER_ENTITY* timer;
-    Status_t   ret;
     EM_RESULT retval;
-    // HZF
-    osalTimeUpdate();
 
     if (EM_TIMER_MAX_ENTITIES <= handle)
     {
@@ -552,28 +662,14 @@ EM_RESULT EM_restart_timer
     else
     {
         timer->timeout = new_timeout;
-        /* Stop the existing timer */
-        osal_CbTimerStop(timer->timer_id);
-        /* Start Timer. */
-        ret = osal_CbTimerStart
-              (
-                  timer_timeout_handler,
-                  &timer->handle,
-                  ((EM_TIMEOUT_MILLISEC & timer->timeout) ?
-                   (timer->timeout & (UINT32)~(EM_TIMEOUT_MILLISEC)):
-                   (timer->timeout * 1000)),
-                  &timer->timer_id
-              );
-
-        if (SUCCESS != ret)
-        {
-            EM_TIMER_ERR("*** FAILED to Restart timer\n");
-            timer_del_entity (timer, 0x01);
-            return EM_TIMER_FAILED_SET_TIME_EVENT;
-        }
-
+        EM_twheel_start
+        (
+            &timer->node,
+            EM_TIMEOUT_TO_MS(timer->timeout),
+            EM_TIMEOUT_TO_SLACK(timer->timeout)
+        );
         EM_TIMER_TRC(
-            "Successfully restarted Timer [ID: %02X]. Handle: 0x%02X\n", timer->timer_id, timer->handle);
+            "Successfully restarted Timer. Handle: 0x%02X\n", timer->handle);
     }
 
     timer_unlock();
@@ -616,33 +712,12 @@ EM_RESULT EM_is_active_timer
 
 EM_RESULT timer_search_entity ( TIMER_ENTITY* timer )
 {
-    TIMER_ENTITY* current_timer;
-
-    /* Is Queue Empty */
-    if (NULL == timer_q_start)
-    {
-        return EM_TIMER_QUEUE_EMPTY;
-    }
-
-    /* Handle the first Element */
-    if (timer == timer_q_start)
-    {
-        return EM_SUCCESS;
-    }
-
-    current_timer = timer_q_start->next;
-
-    while (NULL != current_timer)
+    if (TIMER_ENTITY_IN_USE != timer->in_use)
     {
-        if (timer == current_timer)
-        {
-            return EM_SUCCESS;
-        }
-
-        current_timer = current_timer->next;
+        return EM_TIMER_ENTITY_SEARCH_FAILED;
     }
 
-    return EM_TIMER_ENTITY_SEARCH_FAILED;
+    return EM_SUCCESS;
 }
 
 /* Get the timer based on obtained timer id */
@@ -652,67 +727,45 @@ EM_RESULT timer_search_entity_timer_id
     UINT8          handle
 )
 {
-    TIMER_ENTITY* current_timer;
-
-    /* Is Queue Empty */
-    if (NULL == timer_q_start)
+    if (EM_TIMER_MAX_ENTITIES <= handle)
     {
-        return EM_TIMER_QUEUE_EMPTY;
+        return EM_TIMER_ENTITY_SEARCH_FAILED;
     }
 
-    /* Handle the first Element */
-    if (handle == timer_q_start->handle)
-    {
-        /* Note the timer entity */
-        *timer = timer_q_start;
-        return EM_SUCCESS;
-    }
+    *timer = &timer_entity[handle];
+    return timer_search_entity(*timer);
+}
 
-    current_timer = timer_q_start->next;
+TIMER_ENTITY* timer_alloc_entity ( void )
+{
+    TIMER_ENTITY* timer;
 
-    while (NULL != current_timer)
+    if (0x00 == timer_free_ready)
     {
-        if (handle == current_timer->handle)
-        {
-            /* Note the timer entity */
-            *timer = current_timer;
-            return EM_SUCCESS;
-        }
+        timer_init_free_list();
+    }
 
-        current_timer = current_timer->next;
+    if (0 == timer_free_count)
+    {
+        return NULL;
     }
 
-    return EM_TIMER_ENTITY_SEARCH_FAILED;
+    timer_free_count --;
+    timer = &timer_entity[timer_free_list[timer_free_count]];
+    timer->handle = timer_free_list[timer_free_count];
+    timer->in_use = TIMER_ENTITY_IN_USE;
+    return timer;
 }
 
 EM_RESULT timer_add_entity ( TIMER_ENTITY* timer )
 {
-    UINT16 index;
-    Status_t   ret;
     TIMER_ENTITY* new_timer;
-    new_timer = NULL;
-
-    for (index = 0; index < EM_TIMER_MAX_ENTITIES; index++)
-    {
-        new_timer = &timer_entity[index];
-
-        if (TIMER_ENTITY_FREE == new_timer->in_use)
-        {
-            new_timer->in_use = TIMER_ENTITY_IN_USE;
-            break;
-        }
-        else
-        {
-            new_timer = NULL;
-        }
-    }
+    new_timer = timer_alloc_entity();
 
     if (NULL == new_timer)
     {
         EM_TIMER_ERR(
             "FAILED to Allocate New Timer Entity. Timer List FULL !\n");
-//        printf(
-//        "FAILED to Allocate New Timer Entity. Timer List FULL !\n");
         #ifdef EM_STATUS
         /* Timer List Full: Update EtherMind Status Flag */
         EM_status_set_bit (STATUS_BIT_TIMER_ENTITY_FULL, STATUS_BIT_SET);
@@ -720,7 +773,6 @@ EM_RESULT timer_add_entity ( TIMER_ENTITY* timer )
         return EM_TIMER_QUEUE_FULL;
     }
 
-    new_timer->next = NULL;
     new_timer->timeout = timer->timeout;
     new_timer->callback = timer->callback;
     new_timer->data_length = timer->data_length;
@@ -739,42 +791,17 @@ EM_RESULT timer_add_entity ( TIMER_ENTITY* timer )
         );
     }
 
-    /* Start the timer */
-    #ifdef EM_TIMER_SUPPORT_REMAINING_TIME
-    new_timer->start_timestamp = em_timer_get_ms_timestamp();
-    #endif /* EM_TIMER_SUPPORT_REMAINING_TIME */
     /* Start timer. Set Timeout. This will also start the timer. */
-    ret = osal_CbTimerStart
-          (
-              timer_timeout_handler,
-              &new_timer->handle,
-              ((EM_TIMEOUT_MILLISEC & new_timer->timeout) ?
-               (new_timer->timeout & (UINT32)~(EM_TIMEOUT_MILLISEC)):
-               (new_timer->timeout * 1000)),
-              &new_timer->timer_id
-          );
-
-    if (SUCCESS != ret)
-    {
-        EM_TIMER_ERR("*** FAILED to Start timer\n");
-//      printf("*** FAILED to Start timer, ret = %d\r\n", ret);
-        return EM_TIMER_FAILED_SET_TIME_EVENT;
-    }
-
-    EM_TIMER_TRC("Successfully started Timer [ID: %02X]. Handle: 0x%02X\n",
-                 new_timer->timer_id, timer->handle);
+    new_timer->node.expire = timer_timeout_handler;
+    EM_twheel_start
+    (
+        &new_timer->node,
+        EM_TIMEOUT_TO_MS(new_timer->timeout),
+        EM_TIMEOUT_TO_SLACK(new_timer->timeout)
+    );
+    EM_TIMER_TRC("Successfully started Timer. Handle: 0x%02X\n",
+                 new_timer->handle);
     timer->handle = new_timer->handle;
-    timer->timer_id = new_timer->timer_id;
-
-    /* If the Timer Q Empty */
-    if (NULL == timer_q_start)
-    {
-        timer_q_start = timer_q_end = new_timer;
-        return EM_SUCCESS;
-    }
-
-    timer_q_end->next = new_timer;
-    timer_q_end = new_timer;
     return EM_SUCCESS;
 }
 
@@ -785,67 +812,12 @@ EM_RESULT timer_del_entity
     UCHAR free
 )
 {
-    TIMER_ENTITY* current_timer, *previous_timer;
-
-    /* Either None or One Element */
-    if (timer_q_start == timer_q_end)
+    if (TIMER_ENTITY_FREE == timer->in_use)
     {
-        if (NULL == timer_q_start)
-        {
-            /* Queue is Empty */
-            return EM_TIMER_QUEUE_EMPTY;
-        }
-        else
-        {
-            if (timer == timer_q_start)
-            {
-                /* Queue has One Element */
-                timer_q_start = timer_q_end = NULL;
-            }
-            else
-            {
-                /* Match NOT found in the Only element in Timer Queue */
-                return EM_TIMER_ENTITY_SEARCH_FAILED;
-            }
-        }
+        return EM_TIMER_ENTITY_SEARCH_FAILED;
     }
-    else
-    {
-        /* Queue has more than One Element */
-        if (timer == timer_q_start)
-        {
-            /* Match in the First Element */
-            timer_q_start = timer_q_start->next;
-        }
-        else
-        {
-            previous_timer = timer_q_start;
-            current_timer = timer_q_start->next;
-
-            while (NULL != current_timer)
-            {
-                if (timer == current_timer)
-                {
-                    previous_timer->next = current_timer->next;
 
-                    if (current_timer == timer_q_end)
-                    {
-                        timer_q_end = previous_timer;
-                    }
-
-                    break;
-                }
-
-                previous_timer = current_timer;
-                current_timer  = current_timer->next;
-            }
-
-            if (NULL == current_timer)
-            {
-                return EM_TIMER_ENTITY_SEARCH_FAILED;
-            }
-        }
-    }
+    EM_twheel_stop(&timer->node);
 
     /* Free Allocated Data */
     if ((0x01 == free) &&
@@ -855,6 +827,7 @@ EM_RESULT timer_del_entity
     }
 
     timer_init_entity(timer);
+    timer_free_list[timer_free_count ++] = timer->handle;
     return EM_SUCCESS;
 }
 
@@ -866,10 +839,8 @@ EM_RESULT timer_init_entity (TIMER_ENTITY* timer)
     timer->callback = NULL;
     timer->allocated_data = NULL;
     timer->data_length = 0;
-    timer->next = NULL;
-    #ifdef EM_TIMER_SUPPORT_REMAINING_TIME
-    timer->start_timestamp = 0;
-    #endif /* EM_TIMER_SUPPORT_REMAINING_TIME */
+    timer->node.next = NULL;
+    timer->node.pprev = NULL;
     return EM_SUCCESS;
 }
 
@@ -892,10 +863,8 @@ EM_RESULT EM_timer_get_remaining_time
 {
     TIMER_ENTITY* timer;
     EM_RESULT     retval;
-    UINT64        current_timestamp;
-    UINT32        time_ms;
 
-    if (NULL == handle)
+    if (EM_TIMER_MAX_ENTITIES <= handle)
     {
         EM_TIMER_ERR(
             "NULL Argument Unacceptable for Timer Handles.\n");
@@ -904,40 +873,20 @@ EM_RESULT EM_timer_get_remaining_time
 
     /* Lock Timer */
     timer_lock();
-    timer = (TIMER_ENTITY*)handle;
+    timer = &timer_entity[handle];
     retval = timer_search_entity(timer);
 
     if (EM_SUCCESS != retval)
     {
         EM_TIMER_ERR(
-            "FAILED to Find Timer ELement for Handle %p. Error Code = 0x%04X\n",
-            (void*)handle, retval);
+            "FAILED to Find Timer ELement for Handle 0x%02X. Error Code = 0x%04X\n",
+            handle, retval);
     }
     else
     {
-        time_ms = ((EM_TIMEOUT_MILLISEC & timer->timeout) ?
-                   (timer->timeout & (UINT32)~(EM_TIMEOUT_MILLISEC)) :
-                   (timer->timeout * 1000));
-        /* Get Current Time */
-        /* Remaining Time = (Timeout in ms) - (Current Time - Timer Start Time) */
-        current_timestamp = em_timer_get_ms_timestamp();
-
-        if ((current_timestamp < timer->start_timestamp) ||
-                (time_ms < (current_timestamp - timer->start_timestamp))
-           )
-        {
-            EM_TIMER_ERR(
-                "FAILED to Find Remaining Time.TO:%d < (CurT:%lld - StartT:%lld\n",
-                time_ms, current_timestamp, timer->start_timestamp);
-        }
-        else
-        {
-            time_ms -= (UINT32)(current_timestamp - timer->start_timestamp);
-            *remaining_time_ms = time_ms;
-            EM_TIMER_TRC(
-                "[EM_TIMER] Remaining Time (ms): %d\n", time_ms);
-            retval = EM_SUCCESS;
-        }
+        *remaining_time_ms = EM_twheel_remaining(&timer->node);
+        EM_TIMER_TRC(
+            "[EM_TIMER] Remaining Time (ms): %d\n", *remaining_time_ms);
     }
 
     timer_unlock();
@@ -948,38 +897,30 @@ EM_RESULT EM_timer_get_remaining_time
 EM_RESULT EM_list_timer ( void )
 {
     #ifdef EM_TIMERL_DEBUG
-    UINT16 index, free;
+    UINT16 index;
     TIMER_ENTITY* timer;
     timer_lock();
     EM_TIMERL_TRC("\n");
     EM_TIMERL_TRC("========================================= \n");
-    EM_TIMERL_TRC("Start Q = %p\n", timer_q_start);
-    timer = timer_q_start;
-
-    while(NULL != timer)
-    {
-        EM_TIMERL_TRC("    Handle = 0x%02X",
-                      timer->handle);
-        timer = timer->next;
-    }
-
-    EM_TIMERL_TRC("End   Q = %p\n", timer_q_end);
-    free = 0;
 
     for (index = 0; index < EM_TIMER_MAX_ENTITIES; index ++)
     {
-        if (TIMER_ENTITY_FREE == timer_entity[index].in_use)
+        timer = &timer_entity[index];
+
+        if (TIMER_ENTITY_IN_USE == timer->in_use)
         {
-            free ++;
+            EM_TIMERL_TRC("    Handle = 0x%02X, Remaining = %d ms\n",
+                          timer->handle, EM_twheel_remaining(&timer->node));
         }
     }
 
     EM_TIMERL_TRC("Max Q Entity = %d, Free = %d\n",
-                  EM_TIMER_MAX_ENTITIES, free);
+                  EM_TIMER_MAX_ENTITIES, timer_free_count);
+    EM_TIMERL_TRC("Wheel Active = %d, Wakeups = %d, Coalesced = %d\n",
+                  em_twheel_stat.active, em_twheel_stat.wakeups, em_twheel_stat.coalesced);
     EM_TIMERL_TRC("========================================= \n");
     EM_TIMERL_TRC("\n");
     timer_unlock();
     #endif /* EM_TIMERL_DEBUG */
     return EM_SUCCESS;
 }
-
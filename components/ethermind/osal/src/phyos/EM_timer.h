@@ -66,11 +66,73 @@
 */
 #define PHYOS_INVALID_TIMER_ID                     0xFF
 
+/**
+    Timer wheel, all timers share one PhyOS callback timer programmed to
+    the earliest deadline. Timers are hashed to slots by expiry time.
+*/
+/* Number of wheel slots, power of 2 */
+#define EM_TWHEEL_SLOTS                            32
+
+/* Slot width is (1 << EM_TWHEEL_SLOT_SHIFT) millisecond */
+#define EM_TWHEEL_SLOT_SHIFT                       4
+
+/**
+    Timers in seconds can expire late by (timeout >> EM_TIMER_SLACK_SHIFT)
+    to share a wakeup with other timers. Millisecond timers are exact.
+*/
+#define EM_TIMER_SLACK_SHIFT                       5
+
 /* ----------------------------------------------- Structures/Data Types */
 
+/* Timer Wheel Node */
+typedef struct em_twheel_node_struct
+{
+    /* Next Node in the wheel slot */
+    struct em_twheel_node_struct* next;
+
+    /* Link to this Node in the wheel slot, NULL if not started */
+    struct em_twheel_node_struct** pprev;
+
+    /* Expiry time in millisecond of system clock */
+    UINT32 expiry;
+
+    /* Time in millisecond the expiry can be late */
+    UINT32 slack;
+
+    /* Called when the Node expires */
+    void (* expire) (struct em_twheel_node_struct* node);
+
+} EM_TWHEEL_NODE;
+
+/* Timer Wheel Statistics */
+typedef struct em_twheel_stat_struct
+{
+    /* Timers running */
+    UINT16 active;
+
+    /* Maximum of timers running */
+    UINT16 active_max;
+
+    /* Expiries of the PhyOS timer */
+    UINT32 wakeups;
+
+    /* Timers expired */
+    UINT32 expired;
+
+    /* Timers expired together with an earlier timer */
+    UINT32 coalesced;
+
+    /* Wakeups per second since the last read */
+    UINT32 wakeups_per_sec;
+
+} EM_TWHEEL_STAT;
+
 /* Timer Entity */
 typedef struct timer_entity_struct
 {
+    /* Timer Wheel Node, must be the first member */
+    EM_TWHEEL_NODE node;
+
     /* The Timer Handle - Index of the timer entity */
     UINT8 handle;
 
@@ -83,9 +145,6 @@ typedef struct timer_entity_struct
     */
     UCHAR*  allocated_data;
 
-    /* Next Element in the Timer Q */
-    struct timer_entity_struct* next;
-
     /**
         Timer Callback Parameter if
         data_length <= EM_TIMER_STATIC_DATA_SIZE
@@ -95,20 +154,12 @@ typedef struct timer_entity_struct
     /* Timeout Value asked by the User */
     UINT32 timeout;
 
-    #ifdef EM_TIMER_SUPPORT_REMAINING_TIME
-    /* Start Time Stamp - used to calculate remaining time */
-    UINT64 start_timestamp;
-    #endif /* EM_TIMER_SUPPORT_REMAINING_TIME */
-
     /* Length of the data */
     UINT16 data_length;
 
     /* Is this Entity Allocated ? */
     UCHAR in_use;
 
-    /* PhyOS Timer ID */
-    UINT8 timer_id;
-
 } TIMER_ENTITY;
 
 typedef UINT8  EM_timer_handle;
@@ -158,6 +209,20 @@ EM_RESULT EM_is_active_timer ( EM_timer_handle handle );
 /* Debug Routine - Internal Use Only */
 EM_RESULT EM_list_timer ( void );
 
+/* Timer Wheel, shared by the timer libraries */
+void EM_twheel_start
+(
+    EM_TWHEEL_NODE* node,
+    UINT32 timeout_ms,
+    UINT32 slack_ms
+);
+
+void EM_twheel_stop ( EM_TWHEEL_NODE* node );
+
+UINT32 EM_twheel_remaining ( EM_TWHEEL_NODE* node );
+
+void EM_twheel_get_stat ( EM_TWHEEL_STAT* stat );
+
 #ifdef __cplusplus
 };
 #endif
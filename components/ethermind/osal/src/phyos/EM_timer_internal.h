@@ -95,6 +95,7 @@ EM_RESULT timer_add_entity ( TIMER_ENTITY* timer );
 EM_RESULT timer_del_entity ( TIMER_ENTITY* timer, UCHAR free );
 EM_RESULT timer_search_entity ( TIMER_ENTITY* timer );
 EM_RESULT timer_init_entity ( TIMER_ENTITY* timer );
+TIMER_ENTITY* timer_alloc_entity ( void );
 
 /* Get the timer based on obtained timer id */
 EM_RESULT timer_search_entity_timer_id
@@ -103,8 +104,8 @@ EM_RESULT timer_search_entity_timer_id
     UINT8          timer_id
 );
 
-/* Callback registered with timer module */
-void timer_timeout_handler (UINT8* timer_id);
+/* Callback registered with timer wheel */
+void timer_timeout_handler (EM_TWHEEL_NODE* node);
 
 UINT64 em_timer_get_ms_timestamp(void);
 
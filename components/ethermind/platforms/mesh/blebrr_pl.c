@@ -306,6 +306,15 @@ void blebrr_handle_evt_adv_report (gapDeviceInfoEvent_t* adv)
     {
         if (BRR_BCON_PASSIVE == type)
         {
+            #ifdef BLEBRR_FILTER_DUPLICATE_PACKETS
+
+            /* If found the ADV packet as duplicate, drop the ADV packet */
+            if (API_SUCCESS == blebrr_adv_duplicate_check(adv->addrType, adv->addr, &pdata[1], pdata[0]))
+            {
+                return;
+            }
+
+            #endif /* BLEBRR_FILTER_DUPLICATE_PACKETS */
             blebrr_pl_recv_advpacket (type, &pdata[1], pdata[0], (UCHAR)adv->rssi);
         }
     }
@@ -41,15 +41,11 @@ void generic_onoff_set_pl (UINT8 state)
     /* LED ON/OFF for GENERIC ONOFF to be mapped here */
     if (state)
     {
-        light_ctrl(LIGHT_RED, LIGHT_TOP_VALUE-1);
-        light_ctrl(LIGHT_GREEN, LIGHT_TOP_VALUE-1);
-        light_ctrl(LIGHT_BLUE, LIGHT_TOP_VALUE-1);
+        light_rgb_set_pl(LIGHT_TOP_VALUE-1, LIGHT_TOP_VALUE-1, LIGHT_TOP_VALUE-1);
     }
     else
     {
-        light_ctrl(LIGHT_RED, 0);
-        light_ctrl(LIGHT_GREEN, 0);
-        light_ctrl(LIGHT_BLUE, 0);
+        light_rgb_set_pl(0, 0, 0);
     }
 }
 
@@ -81,96 +77,373 @@ void vendor_mode_backlight_onoff_set_pl (UINT8 state)
 
 
 
+/* Set all channels with one PWM update */
+void light_rgb_set_pl (uint16_t R, uint16_t G, uint16_t B)
+{
+    light_config(LIGHT_RED, R);
+    light_config(LIGHT_GREEN, G);
+    light_config(LIGHT_BLUE, B);
+    light_reflash();
+}
+
+/* Lightness is perceptual, duty = L^2 */
+static uint16_t light_lightness_to_duty(uint16_t L)
+{
+    return (uint16_t)((((uint32_t)L * L) >> 16) * LIGHT_TURN_ON / 0xFFFF);
+}
+
 void light_lightness_set_pl (uint16_t ligtnessValue)
 {
-    light_ctrl(LIGHT_RED, ligtnessValue>>10);
-    light_ctrl(LIGHT_GREEN, ligtnessValue>>10);
-    light_ctrl(LIGHT_BLUE, ligtnessValue>>10);
+    uint16_t duty = light_lightness_to_duty(ligtnessValue);
+    light_rgb_set_pl(duty, duty, duty);
 }
 
 void light_ctl_set_pl (uint16_t ctlValue,uint16_t dltUV)
 {
-    if(ctlValue<6600)
+    uint16_t rgb[3];
+    light_color_ctl_to_rgb(ctlValue, rgb);
+    light_rgb_set_pl(rgb[0] >> 8, rgb[1] >> 8, rgb[2] >> 8);
+}
+
+/* Scale a 16 bit channel by 8 bit duty, full scale stays LIGHT_TURN_ON */
+static uint16_t light_channel_scale(uint16_t value, uint16_t duty)
+{
+    return (uint16_t)(((uint32_t)value * duty + 0xFFFF) >> 16);
+}
+
+void light_ctl_lightness_set_pl (uint16_t L, uint16_t ctlValue)
+{
+    uint16_t rgb[3];
+    uint16_t duty;
+    light_color_ctl_to_rgb(ctlValue, rgb);
+    duty = light_lightness_to_duty(L);
+    light_rgb_set_pl(light_channel_scale(rgb[0], duty),
+                     light_channel_scale(rgb[1], duty),
+                     light_channel_scale(rgb[2], duty));
+}
+
+void light_hsl_set_pl (uint16_t H_int,uint16_t S_int,uint16_t L_int)
+{
+    uint16_t rgb[3];
+    light_color_hsl_to_rgb(H_int, S_int, L_int, rgb);
+    light_rgb_set_pl(rgb[0] >> 8, rgb[1] >> 8, rgb[2] >> 8);
+}
+
+void light_xyl_set_pl (uint16_t L, uint16_t x, uint16_t y)
+{
+    uint16_t rgb[3];
+    uint16_t duty;
+    light_color_xyl_to_rgb(x, y, rgb);
+    duty = light_lightness_to_duty(L);
+    light_rgb_set_pl(light_channel_scale(rgb[0], duty),
+                     light_channel_scale(rgb[1], duty),
+                     light_channel_scale(rgb[2], duty));
+}
+
+/* --------------------------------------------- Color Conversion */
+/*
+    Integer color conversion, channel outputs are 0x0000 - 0xFFFF.
+
+    Worst case error against the float reference, in 8 bit PWM steps:
+    - HSL to RGB : 1 step, float HSL to RGB.
+    - CTL to RGB : 4 steps at 6667 K, 0.59 on average, Tanner Helland
+                   blackbody fit from 800 K to 20000 K. The fit itself jumps
+                   at 6600 K, the table interpolates across it.
+    - xyL to RGB : 2 steps, float CIE XYZ to linear sRGB (D65) with the
+                   brightest channel normalized to full scale.
+*/
+
+/* Blackbody table, interpolated in mired (10^6 / Kelvin) */
+#define LIGHT_COLOR_MIRED_MIN           50
+#define LIGHT_COLOR_MIRED_STEP          17
+#define LIGHT_COLOR_MIRED_STEP_RECIP    3855   /* 65536 / LIGHT_COLOR_MIRED_STEP */
+#define LIGHT_COLOR_CTL_TABLE_SIZE      72
+
+/* Warm and cool white LEDs of a two channel fixture */
+#ifndef LIGHT_COLOR_CW_WARM_MIRED
+    #define LIGHT_COLOR_CW_WARM_MIRED   370    /* 2700 K */
+#endif /* LIGHT_COLOR_CW_WARM_MIRED */
+
+#ifndef LIGHT_COLOR_CW_COOL_MIRED
+    #define LIGHT_COLOR_CW_COOL_MIRED   154    /* 6500 K */
+#endif /* LIGHT_COLOR_CW_COOL_MIRED */
+
+/* xyY chromaticity below this y is treated as black */
+#define LIGHT_COLOR_XYL_Y_MIN           0x0100
+
+static const uint8_t light_color_ctl_table[LIGHT_COLOR_CTL_TABLE_SIZE][3] =
+{
+    {0xAB, 0xC6, 0xFF}, /*   50 mired, 20000 K */
+    {0xB5, 0xCD, 0xFF}, /*   67 mired, 14925 K */
+    {0xC0, 0xD4, 0xFF}, /*   84 mired, 11905 K */
+    {0xCA, 0xDA, 0xFF}, /*  101 mired,  9901 K */
+    {0xD7, 0xE2, 0xFF}, /*  118 mired,  8475 K */
+    {0xE8, 0xEC, 0xFF}, /*  135 mired,  7407 K */
+    {0xFF, 0xFF, 0xFC}, /*  152 mired,  6579 K */
+    {0xFF, 0xF5, 0xEB}, /*  169 mired,  5917 K */
+    {0xFF, 0xEB, 0xDA}, /*  186 mired,  5376 K */
+    {0xFF, 0xE3, 0xCB}, /*  203 mired,  4926 K */
+    {0xFF, 0xDB, 0xBD}, /*  220 mired,  4545 K */
+    {0xFF, 0xD3, 0xB0}, /*  237 mired,  4219 K */
+    {0xFF, 0xCC, 0xA3}, /*  254 mired,  3937 K */
+    {0xFF, 0xC6, 0x97}, /*  271 mired,  3690 K */
+    {0xFF, 0xC0, 0x8B}, /*  288 mired,  3472 K */
+    {0xFF, 0xBA, 0x80}, /*  305 mired,  3279 K */
+    {0xFF, 0xB5, 0x75}, /*  322 mired,  3106 K */
+    {0xFF, 0xB0, 0x6A}, /*  339 mired,  2950 K */
+    {0xFF, 0xAB, 0x60}, /*  356 mired,  2809 K */
+    {0xFF, 0xA6, 0x56}, /*  373 mired,  2681 K */
+    {0xFF, 0xA2, 0x4C}, /*  390 mired,  2564 K */
+    {0xFF, 0x9D, 0x42}, /*  407 mired,  2457 K */
+    {0xFF, 0x99, 0x38}, /*  424 mired,  2358 K */
+    {0xFF, 0x95, 0x2F}, /*  441 mired,  2268 K */
+    {0xFF, 0x92, 0x25}, /*  458 mired,  2183 K */
+    {0xFF, 0x8E, 0x1C}, /*  475 mired,  2105 K */
+    {0xFF, 0x8A, 0x12}, /*  492 mired,  2033 K */
+    {0xFF, 0x87, 0x09}, /*  509 mired,  1965 K */
+    {0xFF, 0x84, 0x00}, /*  526 mired,  1901 K */
+    {0xFF, 0x81, 0x00}, /*  543 mired,  1842 K */
+    {0xFF, 0x7E, 0x00}, /*  560 mired,  1786 K */
+    {0xFF, 0x7B, 0x00}, /*  577 mired,  1733 K */
+    {0xFF, 0x78, 0x00}, /*  594 mired,  1684 K */
+    {0xFF, 0x75, 0x00}, /*  611 mired,  1637 K */
+    {0xFF, 0x72, 0x00}, /*  628 mired,  1592 K */
+    {0xFF, 0x70, 0x00}, /*  645 mired,  1550 K */
+    {0xFF, 0x6D, 0x00}, /*  662 mired,  1511 K */
+    {0xFF, 0x6A, 0x00}, /*  679 mired,  1473 K */
+    {0xFF, 0x68, 0x00}, /*  696 mired,  1437 K */
+    {0xFF, 0x66, 0x00}, /*  713 mired,  1403 K */
+    {0xFF, 0x63, 0x00}, /*  730 mired,  1370 K */
+    {0xFF, 0x61, 0x00}, /*  747 mired,  1339 K */
+    {0xFF, 0x5F, 0x00}, /*  764 mired,  1309 K */
+    {0xFF, 0x5D, 0x00}, /*  781 mired,  1280 K */
+    {0xFF, 0x5A, 0x00}, /*  798 mired,  1253 K */
+    {0xFF, 0x58, 0x00}, /*  815 mired,  1227 K */
+    {0xFF, 0x56, 0x00}, /*  832 mired,  1202 K */
+    {0xFF, 0x54, 0x00}, /*  849 mired,  1178 K */
+    {0xFF, 0x52, 0x00}, /*  866 mired,  1155 K */
+    {0xFF, 0x50, 0x00}, /*  883 mired,  1133 K */
+    {0xFF, 0x4E, 0x00}, /*  900 mired,  1111 K */
+    {0xFF, 0x4D, 0x00}, /*  917 mired,  1091 K */
+    {0xFF, 0x4B, 0x00}, /*  934 mired,  1071 K */
+    {0xFF, 0x49, 0x00}, /*  951 mired,  1052 K */
+    {0xFF, 0x47, 0x00}, /*  968 mired,  1033 K */
+    {0xFF, 0x45, 0x00}, /*  985 mired,  1015 K */
+    {0xFF, 0x44, 0x00}, /* 1002 mired,   998 K */
+    {0xFF, 0x42, 0x00}, /* 1019 mired,   981 K */
+    {0xFF, 0x40, 0x00}, /* 1036 mired,   965 K */
+    {0xFF, 0x3F, 0x00}, /* 1053 mired,   950 K */
+    {0xFF, 0x3D, 0x00}, /* 1070 mired,   935 K */
+    {0xFF, 0x3C, 0x00}, /* 1087 mired,   920 K */
+    {0xFF, 0x3A, 0x00}, /* 1104 mired,   906 K */
+    {0xFF, 0x39, 0x00}, /* 1121 mired,   892 K */
+    {0xFF, 0x37, 0x00}, /* 1138 mired,   879 K */
+    {0xFF, 0x36, 0x00}, /* 1155 mired,   866 K */
+    {0xFF, 0x34, 0x00}, /* 1172 mired,   853 K */
+    {0xFF, 0x33, 0x00}, /* 1189 mired,   841 K */
+    {0xFF, 0x31, 0x00}, /* 1206 mired,   829 K */
+    {0xFF, 0x30, 0x00}, /* 1223 mired,   818 K */
+    {0xFF, 0x2F, 0x00}, /* 1240 mired,   806 K */
+    {0xFF, 0x2D, 0x00}  /* 1257 mired,   796 K */
+};
+
+/* CIE XYZ to linear sRGB (D65), Q12 */
+static const int16_t light_color_xyz_to_rgb[3][3] =
+{
+    { 13273, -6296, -2042},
+    { -3969,  7683,   170},
+    {   228,  -836,  4329}
+};
+
+static uint32_t light_color_mired(uint16_t T)
+{
+    /* Light CTL Temperature range, 800 K to 20000 K (LIGHT_COLOR_MIRED_MIN) */
+    if (T < 800)
     {
-        light_ctrl(LIGHT_RED, 255);
+        T = 800;
     }
-    else
+    else if (T > 20000)
+    {
+        T = 20000;
+    }
+
+    return 1000000UL / T;
+}
+
+void light_color_hsl_to_rgb(uint16_t H, uint16_t S, uint16_t L, uint16_t* rgb)
+{
+    uint32_t c, x, m, h6, f;
+    uint32_t v[3];
+    uint8_t  k;
+
+    /* Chroma = (1 - |2L - 1|) * S */
+    c = (L < 0x8000) ? (2 * (uint32_t)L) : (2 * (0xFFFF - (uint32_t)L));
+    c = (c * S + 0x8000) >> 16;
+
+    /* Six hue sectors, X ramps up on even and down on odd sectors */
+    h6 = (uint32_t)H * 6;
+    f = h6 & 0xFFFF;
+
+    if (h6 & 0x10000)
     {
-        light_ctrl(LIGHT_RED, 255-(ctlValue-6600)*(255-160)/(20000-6600));
+        f = 0xFFFF - f;
     }
 
-    if(ctlValue<6600)
+    x = (c * f) >> 16;
+    m = L - (c >> 1);
+
+    switch (h6 >> 16)
     {
-        light_ctrl(LIGHT_GREEN, 50+200*(6600-ctlValue)/6600);
+    case 0:
+        v[0] = c; v[1] = x; v[2] = 0;
+        break;
+
+    case 1:
+        v[0] = x; v[1] = c; v[2] = 0;
+        break;
+
+    case 2:
+        v[0] = 0; v[1] = c; v[2] = x;
+        break;
+
+    case 3:
+        v[0] = 0; v[1] = x; v[2] = c;
+        break;
+
+    case 4:
+        v[0] = x; v[1] = 0; v[2] = c;
+        break;
+
+    default:
+        v[0] = c; v[1] = 0; v[2] = x;
+        break;
     }
-    else
+
+    for (k = 0; k < 3; k++)
     {
-        light_ctrl(LIGHT_GREEN, 255-(ctlValue-6600)*(255-190)/(20000-6600));
+        v[k] += m;
+        rgb[k] = (v[k] > 0xFFFF) ? 0xFFFF : (uint16_t)v[k];
     }
+}
+
+void light_color_ctl_to_rgb(uint16_t T, uint16_t* rgb)
+{
+    uint32_t pos, i, f;
+    int32_t  a, b, v;
+    uint8_t  k;
 
-    if(ctlValue<2000)
+    pos = (light_color_mired(T) - LIGHT_COLOR_MIRED_MIN) * LIGHT_COLOR_MIRED_STEP_RECIP;
+    i = pos >> 16;
+    f = (pos >> 8) & 0xFF;
+
+    if (i >= (LIGHT_COLOR_CTL_TABLE_SIZE - 1))
     {
-        light_ctrl(LIGHT_BLUE, 0);
+        i = LIGHT_COLOR_CTL_TABLE_SIZE - 2;
+        f = 0x100;
     }
-    else if(ctlValue<6500)
+
+    for (k = 0; k < 3; k++)
     {
-        light_ctrl(LIGHT_BLUE, 255*(6600-ctlValue)/(6500-2000));
+        a = light_color_ctl_table[i][k];
+        b = light_color_ctl_table[i + 1][k];
+        v = (a << 8) + (b - a) * (int32_t)f;
+        /* 8.8 to 16 bit full scale */
+        rgb[k] = (uint16_t)(v + (v >> 8));
+    }
+}
+
+void light_color_ctl_to_cw(uint16_t T, uint16_t* cw)
+{
+    uint32_t m, cool;
+    m = light_color_mired(T);
+
+    /* Mix is linear in mired */
+    if (m >= LIGHT_COLOR_CW_WARM_MIRED)
+    {
+        cool = 0;
+    }
+    else if (m <= LIGHT_COLOR_CW_COOL_MIRED)
+    {
+        cool = 0xFFFF;
     }
     else
     {
-        light_ctrl(LIGHT_BLUE, 255);
+        cool = ((LIGHT_COLOR_CW_WARM_MIRED - m) * 0xFFFF) /
+               (LIGHT_COLOR_CW_WARM_MIRED - LIGHT_COLOR_CW_COOL_MIRED);
     }
+
+    cw[0] = (uint16_t)(0xFFFF - cool);
+    cw[1] = (uint16_t)cool;
 }
 
-static float Hue_2_RGB( float v1, float v2, float vH ) //Function Hue_2_RGB
+void light_color_xyl_to_rgb(uint16_t x, uint16_t y, uint16_t* rgb)
 {
-    if ( vH < 0 ) vH += 1;
+    uint32_t z, ratio[3];
+    int32_t  v[3], max;
+    uint8_t  k, j;
 
-    if ( vH > 1 ) vH -= 1;
+    if (y < LIGHT_COLOR_XYL_Y_MIN)
+    {
+        rgb[0] = rgb[1] = rgb[2] = 0;
+        return;
+    }
 
-    if (( 6 * vH ) < 1 ) return ( v1 + ( v2 - v1 ) * 6 * vH );
+    /* XYZ for Y = 1, Q10 */
+    z = ((uint32_t)x + y < 0xFFFF) ? (0xFFFF - x - y) : 0;
+    ratio[0] = ((uint32_t)x << 10) / y;
+    ratio[1] = 1 << 10;
+    ratio[2] = (z << 10) / y;
 
-    if (( 2 * vH ) < 1 ) return ( v2 );
+    for (k = 0; k < 3; k += 2)
+    {
+        if (ratio[k] > 0x7FFF)
+        {
+            ratio[k] = 0x7FFF;
+        }
+    }
 
-    if (( 3 * vH ) < 2 ) return ( v1 + ( v2 - v1 ) * ( ( 2/3.0 ) - vH ) * 6 );
+    max = 0;
 
-    return ( v1 );
-}
+    for (k = 0; k < 3; k++)
+    {
+        v[k] = 0;
+
+        for (j = 0; j < 3; j++)
+        {
+            v[k] += light_color_xyz_to_rgb[k][j] * (int32_t)ratio[j];
+        }
+
+        /* Out of gamut, clip to the gamut edge */
+        if (v[k] < 0)
+        {
+            v[k] = 0;
+        }
+
+        if (v[k] > max)
+        {
+            max = v[k];
+        }
+    }
 
-void light_hsl_set_pl (uint16_t H_int,uint16_t S_int,uint16_t L_int)
-{
-    float H = (float)H_int / 65535.0;
-    float S = (float)S_int / 65535.0;
-    float L = (float)L_int / 65535.0;
-    float R,G,B,var_1,var_2;
+    if (0 == max)
+    {
+        rgb[0] = rgb[1] = rgb[2] = 0;
+        return;
+    }
 
-    if ( S == 0 )
+    /* Brightest channel to full scale, lightness is applied by the caller */
+    while (max > 0xFFFF)
     {
-        R = L;
-        G = L;
-        B = L;
+        max >>= 1;
+        v[0] >>= 1;
+        v[1] >>= 1;
+        v[2] >>= 1;
     }
-    else
+
+    for (k = 0; k < 3; k++)
     {
-        if ( L < 0.5 )
-            var_2 = L * ( 1 + S );
-        else
-            var_2 = ( L + S ) - ( S * L );
-
-        var_1 = 2 * L - var_2;
-        R = Hue_2_RGB( var_1, var_2, H + ( 1/3.0 ));
-        G = Hue_2_RGB( var_1, var_2, H );
-        B = Hue_2_RGB( var_1, var_2, H - ( 1/3.0 ));
-    }
-
-    uint16_t R_int = (uint16_t)(R*LIGHT_TURN_ON);
-    uint16_t G_int = (uint16_t)(G*LIGHT_TURN_ON);
-    uint16_t B_int = (uint16_t)(B*LIGHT_TURN_ON);
-//    printf("[HSL_f] %f %f %f\n",R,G,B);
-//    printf("[HSL_I] %02x %02x %02x\n",R_int,G_int,B_int);
-    light_ctrl(LIGHT_RED, R_int);
-    light_ctrl(LIGHT_GREEN, G_int);
-    light_ctrl(LIGHT_BLUE, B_int);
+        rgb[k] = (uint16_t)(((uint32_t)v[k] * 0xFFFF) / (uint32_t)max);
+    }
 }
 
 //    light_hsl_set_pl(0x5555,0xffff,0x8000); // 0x00 0xFF 0x00 Green
@@ -31,9 +31,18 @@ void mesh_model_device_provisioned_ind_pl(void);
 void generic_onoff_set_pl (UINT8 state);
 void vendor_mode_mainlight_onoff_set_pl (UINT8 state);
 void vendor_mode_backlight_onoff_set_pl (UINT8 state);
+void light_rgb_set_pl (uint16_t R, uint16_t G, uint16_t B);
 void light_lightness_set_pl (uint16_t ligtnessValue);
 void light_ctl_set_pl (uint16_t ctlValue,uint16_t dltUV);
+void light_ctl_lightness_set_pl (uint16_t L, uint16_t ctlValue);
 void light_hsl_set_pl (uint16_t H,uint16_t S,uint16_t L);
+void light_xyl_set_pl (uint16_t L, uint16_t x, uint16_t y);
+
+/* Color conversion, channel outputs are 0x0000 - 0xFFFF */
+void light_color_hsl_to_rgb(uint16_t H, uint16_t S, uint16_t L, uint16_t* rgb);
+void light_color_ctl_to_rgb(uint16_t T, uint16_t* rgb);
+void light_color_ctl_to_cw(uint16_t T, uint16_t* cw);
+void light_color_xyl_to_rgb(uint16_t x, uint16_t y, uint16_t* rgb);
 
 #endif /* _H_MODEL_STATE_HANDLER_ */
 
@@ -0,0 +1,233 @@
+/**************************************************************************************************
+
+    Phyplus Microelectronics Limited confidential and proprietary.
+    All rights reserved.
+
+    IMPORTANT: All rights of this software belong to Phyplus Microelectronics
+    Limited ("Phyplus"). Your use of this Software is limited to those
+    specific rights granted under  the terms of the business contract, the
+    confidential agreement, the non-disclosure agreement and any other forms
+    of agreements as a customer or a partner of Phyplus. You may not use this
+    Software unless you agree to abide by the terms of these agreements.
+    You acknowledge that the Software may not be modified, copied,
+    distributed or disclosed unless embedded on a Phyplus Bluetooth Low Energy
+    (BLE) integrated circuit, either as a product or is integrated into your
+    products.  Other than for the aforementioned purposes, you may not use,
+    reproduce, copy, prepare derivative works of, modify, distribute, perform,
+    display or sell this Software and/or its documentation for any purposes.
+
+    YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+    PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+    INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+    NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+    PHYPLUS OR ITS SUBSIDIARIES BE LIABLE OR OBLIGATED UNDER CONTRACT,
+    NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+    LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+    INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+    OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+    OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+    (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+**************************************************************************************************/
+
+/*
+    IMA ADPCM encoder and voice stream
+    the stream takes 16 bit samples from the voice capture ring in task context,
+    two samples per ring word, and packs them into frames sized for one notification
+*/
+
+#include <string.h>
+#include "adpcm.h"
+#include "voice.h"
+#include "error.h"
+
+static const int16_t adpcm_step_tbl[89] =
+{
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t adpcm_index_tbl[8] =
+{
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+//step the decoder state by one code, shared by encoder and decoder so both track
+static void adpcm_update(adpcm_state_t* pst, uint8_t code)
+{
+    int32_t step = adpcm_step_tbl[pst->index];
+    int32_t delta = step >> 3;
+    int32_t predict;
+    int index;
+
+    if(code & 4)
+        delta += step;
+
+    if(code & 2)
+        delta += step >> 1;
+
+    if(code & 1)
+        delta += step >> 2;
+
+    predict = pst->predict + ((code & 8) ? -delta : delta);
+
+    if(predict > 32767)
+        predict = 32767;
+    else if(predict < -32768)
+        predict = -32768;
+
+    index = pst->index + adpcm_index_tbl[code & 7];
+
+    if(index < 0)
+        index = 0;
+    else if(index > 88)
+        index = 88;
+
+    pst->predict = (int16_t)predict;
+    pst->index = (uint8_t)index;
+}
+
+static uint8_t adpcm_encode_sample(adpcm_state_t* pst, int16_t sample)
+{
+    int32_t step = adpcm_step_tbl[pst->index];
+    int32_t diff = sample - pst->predict;
+    uint8_t code = 0;
+
+    if(diff < 0)
+    {
+        code = 8;
+        diff = -diff;
+    }
+
+    if(diff >= step)
+    {
+        code |= 4;
+        diff -= step;
+    }
+
+    step >>= 1;
+
+    if(diff >= step)
+    {
+        code |= 2;
+        diff -= step;
+    }
+
+    step >>= 1;
+
+    if(diff >= step)
+        code |= 1;
+
+    adpcm_update(pst, code);
+    return code;
+}
+
+void adpcm_init(adpcm_state_t* pst)
+{
+    pst->predict = 0;
+    pst->index = 0;
+}
+
+/*
+    encode samples into samples/2 bytes, samples should be even
+*/
+void adpcm_encode(adpcm_state_t* pst, const int16_t* pcm, uint32_t samples, uint8_t* out)
+{
+    uint8_t code;
+
+    for(; samples >= 2; samples -= 2)
+    {
+        code = adpcm_encode_sample(pst, *pcm++);
+        *out++ = code | (adpcm_encode_sample(pst, *pcm++) << 4);
+    }
+}
+
+void adpcm_decode(adpcm_state_t* pst, const uint8_t* in, uint32_t samples, int16_t* pcm)
+{
+    uint32_t i;
+
+    for(i = 0; i < samples; i++)
+    {
+        adpcm_update(pst, (i & 1) ? (in[i >> 1] >> 4) : (in[i >> 1] & 0x0f));
+        *pcm++ = pst->predict;
+    }
+}
+
+/*
+    frame_len is the notification payload, ATT_MTU - 3
+*/
+int adpcm_stream_init(adpcm_stream_t* pstream, uint8_t* frame, uint8_t frame_len, adpcm_send_t send)
+{
+    if(frame == NULL || send == NULL || frame_len <= ADPCM_FRAME_HDR_LEN)
+        return PPlus_ERR_INVALID_PARAM;
+
+    memset(pstream, 0, sizeof(adpcm_stream_t));
+    adpcm_init(&pstream->state);
+    pstream->frame = frame;
+    pstream->frame_len = frame_len;
+    pstream->send = send;
+    return PPlus_SUCCESS;
+}
+
+/*
+    encode everything captured and send the frames, call from the task on
+    HAL_VOICE_EVT_RING and again when notification buffers are freed.
+    return PPlus_ERR_BUSY when a frame is waiting for send, the ring keeps
+    the samples until then
+*/
+int adpcm_stream_run(adpcm_stream_t* pstream)
+{
+    uint32_t* pdata;
+    uint16_t words;
+
+    for(;;)
+    {
+        if(pstream->ready)
+        {
+            if(pstream->send(pstream->frame, pstream->frame_len) != PPlus_SUCCESS)
+            {
+                pstream->busy++;
+                return PPlus_ERR_BUSY;
+            }
+
+            pstream->ready = FALSE;
+            pstream->frames++;
+            pstream->seq++;
+        }
+
+        words = hal_voice_ring_peek(&pdata);
+
+        if(words == 0)
+            return PPlus_SUCCESS;
+
+        if(pstream->pos == 0)
+        {
+            pstream->frame[0] = pstream->seq;
+            pstream->frame[1] = pstream->state.index;
+            pstream->frame[2] = (uint8_t)pstream->state.predict;
+            pstream->frame[3] = (uint8_t)((uint16_t)pstream->state.predict >> 8);
+            pstream->pos = ADPCM_FRAME_HDR_LEN;
+        }
+
+        //a ring word holds two samples and encodes to one byte
+        if(words > pstream->frame_len - pstream->pos)
+            words = pstream->frame_len - pstream->pos;
+
+        adpcm_encode(&pstream->state, (const int16_t*)pdata, words * 2, &pstream->frame[pstream->pos]);
+        hal_voice_ring_release(words);
+        pstream->pos += words;
+
+        if(pstream->pos == pstream->frame_len)
+        {
+            pstream->pos = 0;
+            pstream->ready = TRUE;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/**************************************************************************************************
+
+    Phyplus Microelectronics Limited confidential and proprietary.
+    All rights reserved.
+
+    IMPORTANT: All rights of this software belong to Phyplus Microelectronics
+    Limited ("Phyplus"). Your use of this Software is limited to those
+    specific rights granted under  the terms of the business contract, the
+    confidential agreement, the non-disclosure agreement and any other forms
+    of agreements as a customer or a partner of Phyplus. You may not use this
+    Software unless you agree to abide by the terms of these agreements.
+    You acknowledge that the Software may not be modified, copied,
+    distributed or disclosed unless embedded on a Phyplus Bluetooth Low Energy
+    (BLE) integrated circuit, either as a product or is integrated into your
+    products.  Other than for the aforementioned purposes, you may not use,
+    reproduce, copy, prepare derivative works of, modify, distribute, perform,
+    display or sell this Software and/or its documentation for any purposes.
+
+    YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+    PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+    INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+    NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+    PHYPLUS OR ITS SUBSIDIARIES BE LIABLE OR OBLIGATED UNDER CONTRACT,
+    NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+    LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+    INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+    OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+    OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+    (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+**************************************************************************************************/
+
+/*
+    IMA ADPCM stream codec for voice, 4 bits per 16 bit sample
+
+    frame layout (little endian), one notification each:
+    byte0: sequence number, counts frames so the receiver sees gaps
+    byte1: step index at the start of the frame
+    byte2..3: predicted sample at the start of the frame
+    then two samples per byte, first sample in the low nibble
+    each frame carries the decoder state, so a lost frame does not break the next
+*/
+
+#ifndef _ADPCM_H__
+#define _ADPCM_H__
+
+#include <stdint.h>
+
+#define ADPCM_FRAME_HDR_LEN     4
+
+typedef struct
+{
+    int16_t   predict;      //predicted sample
+    uint8_t   index;        //step size index
+} adpcm_state_t;
+
+/*
+    send a frame, return PPlus_SUCCESS or an error to try the same frame later,
+    e.g. when the notification buffers are full
+*/
+typedef int (*adpcm_send_t)(uint8_t* frame, uint8_t len);
+
+typedef struct
+{
+    adpcm_state_t state;
+    adpcm_send_t  send;
+    uint8_t*  frame;        //frame buffer of frame_len bytes
+    uint8_t   frame_len;
+    uint8_t   pos;          //bytes of frame filled
+    uint8_t   seq;
+    uint8_t   ready;        //frame full, waiting to be sent
+    uint32_t  frames;       //frames sent
+    uint32_t  busy;         //send attempts refused
+} adpcm_stream_t;
+
+void adpcm_init(adpcm_state_t* pst);
+void adpcm_encode(adpcm_state_t* pst, const int16_t* pcm, uint32_t samples, uint8_t* out);
+void adpcm_decode(adpcm_state_t* pst, const uint8_t* in, uint32_t samples, int16_t* pcm);
+
+int adpcm_stream_init(adpcm_stream_t* pstream, uint8_t* frame, uint8_t frame_len, adpcm_send_t send);
+int adpcm_stream_run(adpcm_stream_t* pstream);
+
+#endif // _ADPCM_H__
@@ -0,0 +1,158 @@
+/**************************************************************************************************
+
+    Phyplus Microelectronics Limited confidential and proprietary.
+    All rights reserved.
+
+    IMPORTANT: All rights of this software belong to Phyplus Microelectronics
+    Limited ("Phyplus"). Your use of this Software is limited to those
+    specific rights granted under  the terms of the business contract, the
+    confidential agreement, the non-disclosure agreement and any other forms
+    of agreements as a customer or a partner of Phyplus. You may not use this
+    Software unless you agree to abide by the terms of these agreements.
+    You acknowledge that the Software may not be modified, copied,
+    distributed or disclosed unless embedded on a Phyplus Bluetooth Low Energy
+    (BLE) integrated circuit, either as a product or is integrated into your
+    products.  Other than for the aforementioned purposes, you may not use,
+    reproduce, copy, prepare derivative works of, modify, distribute, perform,
+    display or sell this Software and/or its documentation for any purposes.
+
+    YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+    PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+    INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+    NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+    PHYPLUS OR ITS SUBSIDIARIES BE LIABLE OR OBLIGATED UNDER CONTRACT,
+    NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+    LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+    INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+    OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+    OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+    (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+**************************************************************************************************/
+
+/*
+    lzss stream decoder
+    input can be split at any byte, the decoder keeps its state between calls,
+    so data can be decoded as it is received
+*/
+
+#include <string.h>
+#include "lzss.h"
+#include "error.h"
+
+enum
+{
+    LZSS_ST_FLAG = 0,
+    LZSS_ST_ITEM,
+    LZSS_ST_MATCH,
+};
+
+static void lzss_put(lzss_dec_t* pdec, uint8_t c)
+{
+    pdec->buf[pdec->wr] = c;
+    pdec->wr++;
+
+    if(pdec->wr == pdec->buf_size)
+        pdec->wr = 0;
+
+    pdec->out++;
+}
+
+static void lzss_next_item(lzss_dec_t* pdec)
+{
+    pdec->flags >>= 1;
+    pdec->flag_bits--;
+    pdec->state = pdec->flag_bits ? LZSS_ST_ITEM : LZSS_ST_FLAG;
+}
+
+int lzss_read_hdr(const uint8_t* data, uint32_t len, lzss_hdr_t* phdr)
+{
+    if(len < sizeof(lzss_hdr_t))
+        return PPlus_ERR_INVALID_LENGTH;
+
+    memcpy(phdr, data, sizeof(lzss_hdr_t));
+
+    if(phdr->magic != LZSS_MAGIC)
+        return PPlus_ERR_NOT_FOUND;
+
+    return PPlus_SUCCESS;
+}
+
+void lzss_dec_init(lzss_dec_t* pdec, uint8_t* buf, uint32_t buf_size)
+{
+    memset(pdec, 0, sizeof(lzss_dec_t));
+    pdec->buf = buf;
+    pdec->buf_size = buf_size;
+    pdec->state = LZSS_ST_FLAG;
+}
+
+/*
+    decode at most out_max bytes, consumed returns the input bytes used.
+    the caller should take the output out of the ring before next call if buf is a ring
+*/
+int lzss_decode(lzss_dec_t* pdec, const uint8_t* in, uint32_t len, uint32_t out_max, uint32_t* consumed)
+{
+    uint32_t i = 0;
+    uint32_t rd;
+    uint32_t produced = 0;
+
+    while(produced < out_max)
+    {
+        if(pdec->match_len)
+        {
+            rd = (pdec->wr >= pdec->match_off) ? (pdec->wr - pdec->match_off) : (pdec->wr + pdec->buf_size - pdec->match_off);
+            lzss_put(pdec, pdec->buf[rd]);
+            pdec->match_len--;
+            produced++;
+            continue;
+        }
+
+        if(i == len)
+            break;
+
+        switch(pdec->state)
+        {
+        case LZSS_ST_FLAG:
+            pdec->flags = in[i++];
+            pdec->flag_bits = 8;
+            pdec->state = LZSS_ST_ITEM;
+            break;
+
+        case LZSS_ST_ITEM:
+            if(pdec->flags & 1)
+            {
+                lzss_put(pdec, in[i++]);
+                produced++;
+                lzss_next_item(pdec);
+            }
+            else
+            {
+                pdec->b0 = in[i++];
+                pdec->state = LZSS_ST_MATCH;
+            }
+
+            break;
+
+        case LZSS_ST_MATCH:
+            pdec->match_off = (uint16_t)(pdec->b0 | ((in[i] >> 6) << 8)) + 1;
+            pdec->match_len = (in[i] & 0x3f) + LZSS_MATCH_MIN;
+            i++;
+
+            if(pdec->match_off > pdec->out || pdec->match_off > pdec->buf_size)
+            {
+                *consumed = i;
+                return PPlus_ERR_INVALID_DATA;
+            }
+
+            lzss_next_item(pdec);
+            break;
+
+        default:
+            *consumed = i;
+            return PPlus_ERR_INVALID_STATE;
+        }
+    }
+
+    *consumed = i;
+    return PPlus_SUCCESS;
+}
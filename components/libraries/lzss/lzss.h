@@ -0,0 +1,81 @@
+/**************************************************************************************************
+
+    Phyplus Microelectronics Limited confidential and proprietary.
+    All rights reserved.
+
+    IMPORTANT: All rights of this software belong to Phyplus Microelectronics
+    Limited ("Phyplus"). Your use of this Software is limited to those
+    specific rights granted under  the terms of the business contract, the
+    confidential agreement, the non-disclosure agreement and any other forms
+    of agreements as a customer or a partner of Phyplus. You may not use this
+    Software unless you agree to abide by the terms of these agreements.
+    You acknowledge that the Software may not be modified, copied,
+    distributed or disclosed unless embedded on a Phyplus Bluetooth Low Energy
+    (BLE) integrated circuit, either as a product or is integrated into your
+    products.  Other than for the aforementioned purposes, you may not use,
+    reproduce, copy, prepare derivative works of, modify, distribute, perform,
+    display or sell this Software and/or its documentation for any purposes.
+
+    YOU FURTHER ACKNOWLEDGE AND AGREE THAT THE SOFTWARE AND DOCUMENTATION ARE
+    PROVIDED AS IS WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED,
+    INCLUDING WITHOUT LIMITATION, ANY WARRANTY OF MERCHANTABILITY, TITLE,
+    NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT SHALL
+    PHYPLUS OR ITS SUBSIDIARIES BE LIABLE OR OBLIGATED UNDER CONTRACT,
+    NEGLIGENCE, STRICT LIABILITY, CONTRIBUTION, BREACH OF WARRANTY, OR OTHER
+    LEGAL EQUITABLE THEORY ANY DIRECT OR INDIRECT DAMAGES OR EXPENSES
+    INCLUDING BUT NOT LIMITED TO ANY INCIDENTAL, SPECIAL, INDIRECT, PUNITIVE
+    OR CONSEQUENTIAL DAMAGES, LOST PROFITS OR LOST DATA, COST OF PROCUREMENT
+    OF SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
+    (INCLUDING BUT NOT LIMITED TO ANY DEFENSE THEREOF), OR OTHER SIMILAR COSTS.
+
+**************************************************************************************************/
+
+/*
+    lzss stream codec for compressed OTA partition
+
+    stream layout (little endian):
+    lzss_hdr_t
+    flag byte, then 8 items, bit0 first: bit 1 is a literal byte,
+    bit 0 is a match of 2 bytes:
+        byte0: (offset-1) bit[7:0]
+        byte1: (offset-1) bit[9:8] << 6 | (length - LZSS_MATCH_MIN)
+    offset is counted back from the current output position, up to LZSS_WINDOW_SIZE
+*/
+
+#ifndef _LZSS_H__
+#define _LZSS_H__
+
+#include <stdint.h>
+
+#define LZSS_MAGIC          0x5a424c53  //"SLBZ"
+#define LZSS_WINDOW_SIZE    1024
+#define LZSS_MATCH_MIN      3
+#define LZSS_MATCH_MAX      (LZSS_MATCH_MIN + 0x3f)
+
+typedef struct
+{
+    uint32_t  magic;
+    uint32_t  raw_size;     //size of data after decoding
+    uint32_t  raw_crc;      //crc16 of data after decoding
+    uint32_t  reserved;
+} lzss_hdr_t;
+
+typedef struct
+{
+    uint8_t*  buf;          //output buffer, used as ring, keep at least LZSS_WINDOW_SIZE bytes of history
+    uint32_t  buf_size;
+    uint32_t  out;          //total output bytes
+    uint32_t  wr;           //write index of buf
+    uint16_t  match_off;
+    uint8_t   match_len;    //bytes left of current match
+    uint8_t   flags;
+    uint8_t   flag_bits;    //items left of current flag byte
+    uint8_t   state;
+    uint8_t   b0;
+} lzss_dec_t;
+
+int lzss_read_hdr(const uint8_t* data, uint32_t len, lzss_hdr_t* phdr);
+void lzss_dec_init(lzss_dec_t* pdec, uint8_t* buf, uint32_t buf_size);
+int lzss_decode(lzss_dec_t* pdec, const uint8_t* in, uint32_t len, uint32_t out_max, uint32_t* consumed);
+
+#endif // _LZSS_H__
@@ -87,6 +87,31 @@ extern uint8 osal_snv_read( osalSnvId_t id, osalSnvLen_t len, void* pBuf);
 */
 extern uint8 osal_snv_write( osalSnvId_t id, osalSnvLen_t len, void* pBuf);
 
+/*********************************************************************
+    @fn      osal_snv_write_deferred
+
+    @brief   Update a data item in the NV cache only. The item reaches
+            flash on osal_snv_flush(), or earlier when its cache slot
+            is needed. Meant for frequently updated items such as sign
+            counters and characteristic configuration.
+
+    @param   id  - Valid NV item Id.
+    @param   len - Length of data to write.
+    @param   *pBuf - Data to write.
+
+    @return  SUCCESS if successful, NV_OPER_FAILED if failed.
+*/
+extern uint8 osal_snv_write_deferred( osalSnvId_t id, osalSnvLen_t len, void* pBuf);
+
+/*********************************************************************
+    @fn      osal_snv_flush
+
+    @brief   Write all deferred data items to flash.
+
+    @return  SUCCESS if successful, NV_OPER_FAILED if an item failed.
+*/
+extern uint8 osal_snv_flush( void );
+
 /*********************************************************************
     @fn      osal_snv_compact
 
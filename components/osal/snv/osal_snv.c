@@ -76,19 +76,207 @@ uint8 osal_snv_compact( uint8 threshold )
     return SUCCESS;
 }
 
+uint8 osal_snv_write_deferred( osalSnvId_t id, osalSnvLen_t len, void* pBuf)
+{
+    return osal_snv_write(id, len, pBuf);
+}
+
+uint8 osal_snv_flush( void )
+{
+    return SUCCESS;
+}
+
 #else
 
+// Write-back cache in front of the fs. Bond records, keys, sign counters and
+// CCCD tables are small and read on every reconnection; the fs looks an item
+// up by scanning its log, so hits are served from RAM and ids known to be
+// missing are remembered in a bitmap. Items longer than
+// OSAL_SNV_CACHE_DATA_LEN bypass the cache. OSAL_SNV_CACHE_ITEMS 0 disables it.
+#ifndef OSAL_SNV_CACHE_ITEMS
+    #define OSAL_SNV_CACHE_ITEMS        16
+#endif
+#ifndef OSAL_SNV_CACHE_DATA_LEN
+    #define OSAL_SNV_CACHE_DATA_LEN     28
+#endif
+
+// ids below this have a "not in NV" bit
+#define SNV_ABSENT_IDS                  256
+
+#define SNV_CACHE_VALID                 0x01
+#define SNV_CACHE_DIRTY                 0x02
+
+#if (OSAL_SNV_CACHE_ITEMS > 0)
+typedef struct
+{
+    osalSnvId_t id;
+    uint8       len;
+    uint8       flags;
+    uint16      age;
+    uint8       data[OSAL_SNV_CACHE_DATA_LEN];
+} snvCacheItem_t;
+
+static snvCacheItem_t snvCache[OSAL_SNV_CACHE_ITEMS];
+static uint8 snvAbsent[SNV_ABSENT_IDS/8];
+static uint16 snvCacheAge;
+
+static void snv_set_absent(osalSnvId_t id, uint8 absent)
+{
+    if(id < SNV_ABSENT_IDS)
+    {
+        if(absent)
+            snvAbsent[id >> 3] |= BV(id & 7);
+        else
+            snvAbsent[id >> 3] &= ~BV(id & 7);
+    }
+}
+
+static uint8 snv_is_absent(osalSnvId_t id)
+{
+    return (id < SNV_ABSENT_IDS) && (snvAbsent[id >> 3] & BV(id & 7));
+}
+
+static snvCacheItem_t* snv_cache_find(osalSnvId_t id)
+{
+    for(uint8 i = 0; i < OSAL_SNV_CACHE_ITEMS; i++)
+    {
+        if((snvCache[i].flags & SNV_CACHE_VALID) && (snvCache[i].id == id))
+        {
+            snvCache[i].age = ++snvCacheAge;
+            return &snvCache[i];
+        }
+    }
+
+    return NULL;
+}
+#endif
+
+static uint8 snv_fs_write( osalSnvId_t id, osalSnvLen_t len, void* pBuf)
+{
+    int ret;
+
+    if(hal_fs_get_free_size() < len+32)
+    {
+        if(hal_fs_get_garbage_size(NULL) > len+32)
+        {
+            hal_fs_garbage_collect();
+        }
+        else
+        {
+            return NV_OPER_FAILED;
+        }
+    }
+
+    ret = hal_fs_item_write((uint16_t) id, (uint8_t*) pBuf, (uint16_t) len);
+
+    if(ret !=0)
+    {
+        LOG("wr_ret:%d\n",ret);
+        return NV_OPER_FAILED;
+    }
+
+    return SUCCESS;
+}
+
+#if (OSAL_SNV_CACHE_ITEMS > 0)
+// Get a free slot for id, evicting the least recently used clean item. When
+// every slot is dirty they are written out first.
+static snvCacheItem_t* snv_cache_alloc(osalSnvId_t id)
+{
+    snvCacheItem_t* pItem = NULL;
+
+    for(uint8 i = 0; i < OSAL_SNV_CACHE_ITEMS; i++)
+    {
+        if(!(snvCache[i].flags & SNV_CACHE_VALID))
+        {
+            pItem = &snvCache[i];
+            break;
+        }
+
+        if(!(snvCache[i].flags & SNV_CACHE_DIRTY) &&
+                (pItem == NULL || (uint16)(snvCacheAge - snvCache[i].age) > (uint16)(snvCacheAge - pItem->age)))
+        {
+            pItem = &snvCache[i];
+        }
+    }
+
+    if(pItem == NULL)
+    {
+        if(osal_snv_flush() != SUCCESS)
+            return NULL;
+
+        pItem = &snvCache[0];
+    }
+
+    pItem->id = id;
+    pItem->len = 0;
+    pItem->flags = 0;
+    pItem->age = ++snvCacheAge;
+    return pItem;
+}
+#endif
+
 uint8 osal_snv_init( void )
 {
     if(!hal_fs_initialized())
         return NV_OPER_FAILED;
 
+    #if (OSAL_SNV_CACHE_ITEMS > 0)
+    osal_memset(snvCache, 0, sizeof(snvCache));
+    osal_memset(snvAbsent, 0, sizeof(snvAbsent));
+    #endif
     return SUCCESS;
 }
 
 uint8 osal_snv_read( osalSnvId_t id, osalSnvLen_t len, void* pBuf)
 {
     int ret;
+    #if (OSAL_SNV_CACHE_ITEMS > 0)
+    snvCacheItem_t* pItem = snv_cache_find(id);
+    uint16_t rd_len = 0;
+
+    if(pItem != NULL)
+    {
+        if(len < pItem->len)
+            return NV_OPER_FAILED;
+
+        osal_memcpy(pBuf, pItem->data, pItem->len);
+        return SUCCESS;
+    }
+
+    if(snv_is_absent(id))
+        return NV_OPER_FAILED;
+
+    pItem = snv_cache_alloc(id);
+
+    if(pItem != NULL)
+    {
+        LOG("osal_snv_read:%x\n",id);
+        ret = hal_fs_item_read((uint16_t)id, pItem->data, OSAL_SNV_CACHE_DATA_LEN, &rd_len);
+
+        if(ret == PPlus_SUCCESS)
+        {
+            pItem->len = (uint8)rd_len;
+            pItem->flags = SNV_CACHE_VALID;
+
+            if(len < pItem->len)
+                return NV_OPER_FAILED;
+
+            osal_memcpy(pBuf, pItem->data, pItem->len);
+            LOG_DUMP_BYTE(pBuf, rd_len);
+            return SUCCESS;
+        }
+
+        if(ret == PPlus_ERR_FS_NOT_FIND_ID)
+        {
+            snv_set_absent(id, TRUE);
+            return NV_OPER_FAILED;
+        }
+
+        // too long to cache, or fs unavailable: read it directly
+    }
+
+    #endif
     LOG("osal_snv_read:%x\n",id);
     ret = hal_fs_item_read((uint16_t)id,(uint8_t*) pBuf, (uint16_t)len,NULL);
 
@@ -104,32 +292,100 @@ uint8 osal_snv_read( osalSnvId_t id, osalSnvLen_t len, void* pBuf)
 
 uint8 osal_snv_write( osalSnvId_t id, osalSnvLen_t len, void* pBuf)
 {
-    int ret = PPlus_SUCCESS;
+    uint8 ret;
+    #if (OSAL_SNV_CACHE_ITEMS > 0)
+    snvCacheItem_t* pItem = snv_cache_find(id);
+
+    // rewriting what is already in flash costs an fs item, skip it
+    if((pItem != NULL) && !(pItem->flags & SNV_CACHE_DIRTY) &&
+            (pItem->len == len) && osal_memcmp(pItem->data, pBuf, len))
+    {
+        return SUCCESS;
+    }
+
+    #endif
     LOG("osal_snv_write:%x,%d\n",id,len);
     LOG_DUMP_BYTE(pBuf, len);
+    ret = snv_fs_write(id, len, pBuf);
+    #if (OSAL_SNV_CACHE_ITEMS > 0)
 
-    if(hal_fs_get_free_size() < len+32)
+    if(ret == SUCCESS)
     {
-        if(hal_fs_get_garbage_size(NULL) > len+32)
+        snv_set_absent(id, FALSE);
+
+        if(len <= OSAL_SNV_CACHE_DATA_LEN)
         {
-            hal_fs_garbage_collect();
+            if(pItem == NULL)
+                pItem = snv_cache_alloc(id);
+
+            if(pItem != NULL)
+            {
+                osal_memcpy(pItem->data, pBuf, len);
+                pItem->len = (uint8)len;
+                pItem->flags = SNV_CACHE_VALID;
+            }
         }
-        else
+        else if(pItem != NULL)
         {
-            return NV_OPER_FAILED;
+            pItem->flags = 0;
         }
     }
 
-    ret = hal_fs_item_write((uint16_t) id, (uint8_t*) pBuf, (uint16_t) len);
+    #endif
+    return ret;
+}
 
-    if(ret !=0)
+uint8 osal_snv_write_deferred( osalSnvId_t id, osalSnvLen_t len, void* pBuf)
+{
+    #if (OSAL_SNV_CACHE_ITEMS > 0)
+    snvCacheItem_t* pItem;
+
+    if(len > OSAL_SNV_CACHE_DATA_LEN)
+        return osal_snv_write(id, len, pBuf);
+
+    pItem = snv_cache_find(id);
+
+    if((pItem != NULL) && (pItem->len == len) && osal_memcmp(pItem->data, pBuf, len))
+        return SUCCESS;
+
+    if(pItem == NULL)
     {
-        LOG("wr_ret:%d\n",ret);
-        return NV_OPER_FAILED;
+        pItem = snv_cache_alloc(id);
+
+        if(pItem == NULL)
+            return osal_snv_write(id, len, pBuf);
     }
 
-    //LOG("Success\n");
+    osal_memcpy(pItem->data, pBuf, len);
+    pItem->len = (uint8)len;
+    pItem->flags = SNV_CACHE_VALID | SNV_CACHE_DIRTY;
+    snv_set_absent(id, FALSE);
     return SUCCESS;
+    #else
+    return osal_snv_write(id, len, pBuf);
+    #endif
+}
+
+uint8 osal_snv_flush( void )
+{
+    uint8 ret = SUCCESS;
+    #if (OSAL_SNV_CACHE_ITEMS > 0)
+
+    for(uint8 i = 0; i < OSAL_SNV_CACHE_ITEMS; i++)
+    {
+        if((snvCache[i].flags & SNV_CACHE_DIRTY) == 0)
+            continue;
+
+        LOG("osal_snv_flush:%x,%d\n",snvCache[i].id,snvCache[i].len);
+
+        if(snv_fs_write(snvCache[i].id, snvCache[i].len, snvCache[i].data) == SUCCESS)
+            snvCache[i].flags &= ~SNV_CACHE_DIRTY;
+        else
+            ret = NV_OPER_FAILED;
+    }
+
+    #endif
+    return ret;
 }
 
 uint8 osal_snv_compact( uint8 threshold )
@@ -138,4 +394,3 @@ uint8 osal_snv_compact( uint8 threshold )
 }
 
 #endif
-
@@ -590,6 +590,51 @@ bStatus_t AudioProfile_Notify( uint8 param, uint8 len, void* value )
     return ( ret );
 }
 
+/*********************************************************************
+    @fn      AudioProfile_NotifyVoice
+
+    @brief   Send a voice frame as a characteristic 2 notification without
+            going through the characteristic value and the read callback.
+
+    @param   pFrame - voice frame
+    @param   len - frame length, at most ATT_MTU - 3
+
+    @return  SUCCESS, bleIncorrectMode if notifications are disabled,
+            bleInvalidRange if the frame does not fit, or the
+            GATT_Notification status. On MSG_BUFFER_NOT_AVAIL the frame
+            was not sent and should be offered again later.
+*/
+bStatus_t AudioProfile_NotifyVoice( uint8* pFrame, uint8 len )
+{
+    static attHandleValueNoti_t noti;
+    gattCharCfg_t* pItem = &AudioProfileChar2Config[0];
+    gattAttribute_t* pAttr;
+
+    if ( ( pItem->connHandle == INVALID_CONNHANDLE ) ||
+            !( pItem->value & GATT_CLIENT_CFG_NOTIFY ) )
+    {
+        return ( bleIncorrectMode );
+    }
+
+    if ( len > gAttMtuSize[pItem->connHandle] - 3 )
+    {
+        return ( bleInvalidRange );
+    }
+
+    pAttr = GATTServApp_FindAttr( AudioProfileAttrTbl, GATT_NUM_ATTRS( AudioProfileAttrTbl ),
+                                  AudioProfileChar2 );
+
+    if ( pAttr == NULL )
+    {
+        return ( INVALIDPARAMETER );
+    }
+
+    noti.handle = pAttr->handle;
+    noti.len = len;
+    VOID osal_memcpy( noti.value, pFrame, len );
+    return ( GATT_Notification( pItem->connHandle, &noti, FALSE ) );
+}
+
 bStatus_t AudioProfile_Write( uint16 connHandle, gattAttribute_t* pAttr,
                               uint8* pValue, uint8 len, uint16 offset )
 {
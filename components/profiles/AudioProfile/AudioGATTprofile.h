@@ -154,6 +154,13 @@ extern bStatus_t AudioProfile_GetParameter( uint8 param, void* value );
 
 extern bStatus_t AudioProfile_Notify( uint8 param, uint8 len, void* value );
 
+/*
+    AudioProfile_NotifyVoice - Send a voice frame of up to ATT_MTU - 3 bytes
+            as a characteristic 2 notification. Returns MSG_BUFFER_NOT_AVAIL
+            when the link buffers are full, the frame should then be sent again.
+*/
+extern bStatus_t AudioProfile_NotifyVoice( uint8* pFrame, uint8 len );
+
 extern bStatus_t AudioProfile_Read( uint16 connHandle, gattAttribute_t* pAttr,
                                     uint8* pValue, uint16* pLen, uint16 offset, uint8 maxLen );
 
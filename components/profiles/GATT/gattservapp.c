@@ -52,15 +52,33 @@
 #include "gatt.h"
 #include "gatt_uuid.h"
 #include "gattservapp.h"
+#include "ll.h"
 
+#if defined ( GATT_SERV_PROC_STAT )
+    #include "timer.h"
+#endif
 
 /*********************************************************************
     MACROS
 */
+#if defined ( GATT_SERV_PROC_STAT )
+// Elapsed fine time ticks (us) between two read_current_fine_time() samples
+#define GATT_SERV_TIME_DELTA( t0, t1 )  ( ( (t1) >= (t0) ) ? ( (t1) - (t0) ) : ( BASE_TIME_UNITS - (t0) + (t1) ) )
+#endif
 
 /*********************************************************************
     CONSTANTS
 */
+// Number of service records the service table grows by
+#define GATT_SERV_CBS_TBL_INC       4
+
+// Number of service discovery responses kept, 0 to disable the cache
+#ifndef GATT_DISC_CACHE_SIZE
+    #define GATT_DISC_CACHE_SIZE    8
+#endif
+
+// Length of the Database Hash value
+#define GATT_DATABASE_HASH_LEN      16
 
 /*********************************************************************
     TYPEDEFS
@@ -77,15 +95,37 @@ typedef struct
 typedef struct
 {
     uint16 handle;                // Service handle - assigned internally by GATT Server
+    uint16 endHandle;             // Handle of the last attribute in the service
+    gattAttribute_t* pAttrs;      // Service attribute records
+    uint16 numAttrs;              // Number of attribute records
     CONST gattServiceCBs_t* pCBs; // Service callback function pointers
 } gattServiceCBsInfo_t;
 
-// Service callbacks list item
-typedef struct _serviceCBsList
+#if ( GATT_DISC_CACHE_SIZE > 0 )
+// Service discovery response kept for a Read By Type or Read By Group Type
+// Request on one of the declaration types
+typedef struct
 {
-    struct _serviceCBsList* next;     // pointer to next service callbacks record
-    gattServiceCBsInfo_t serviceInfo; // service handle/callbacks
-} serviceCBsList_t;
+    uint8 method;         // Request opcode, 0 if the entry is unused
+    uint8 status;         // SUCCESS or error code sent for the request
+    uint16 uuid;          // Requested attribute type
+    uint16 startHandle;   // Requested starting handle
+    uint16 endHandle;     // Requested ending handle
+    uint16 mtu;           // ATT_MTU the response was built for
+    uint16 errHandle;     // Handle sent with the error response
+    uint16 len;           // Length of each response item
+    uint8 num;            // Number of response items
+    uint8* pData;         // Response items
+} gattDiscCacheItem_t;
+#endif
+
+// AES-CMAC state used to calculate the Database Hash
+typedef struct
+{
+    uint8 mac[16];        // Chained cipher block
+    uint8 block[16];      // Block not processed yet
+    uint8 len;            // Octets in block
+} gattServCmac_t;
 
 /*********************************************************************
     GLOBAL VARIABLES
@@ -115,8 +155,27 @@ static uint8 maxNumPrepareWrites = 0;
 #ifdef PREPARE_QUEUE_STATIC
     static attPrepareWriteReq_t prepareQueue[MAX_NUM_LL_CONN*GATT_MAX_NUM_PREPARE_WRITES];
 #endif
-// Callbacks for services
-static serviceCBsList_t* serviceCBsList = NULL;
+// Callbacks for services, sorted by service handle. The handle ranges of
+// the records never overlap so a handle is mapped to its service with a
+// binary search and to its attribute record by indexing.
+static gattServiceCBsInfo_t* serviceCBsTbl = NULL;
+static uint16 numServiceCBs = 0;
+static uint16 maxServiceCBs = 0;
+
+// Last attribute table and index found by GATTServApp_FindAttr
+static gattAttribute_t* pLastAttrTbl = NULL;
+static uint16 lastAttrIdx = 0;
+
+#if ( GATT_DISC_CACHE_SIZE > 0 )
+    // Service discovery responses and the next entry to be replaced
+    static gattDiscCacheItem_t discCache[GATT_DISC_CACHE_SIZE];
+    static uint8 discCacheNext = 0;
+#endif
+
+#if defined ( GATT_SERV_PROC_STAT )
+    // ATT request processing time statistics
+    static gattServProcStat_t procStat;
+#endif
 
 // Globals to be used for processing an incoming request
 //static uint8 attrLen;
@@ -132,8 +191,20 @@ static CONST gattAttrType_t gattService = { ATT_BT_UUID_SIZE, gattServiceUUID };
 #ifndef HID_VOICE_SPEC
     // Service Changed Characteristic Properties
     static uint8 serviceChangedCharProps = GATT_PROP_INDICATE;
+
+    // Database Hash Characteristic Properties and UUID
+    static uint8 databaseHashCharProps = GATT_PROP_READ;
+    static CONST uint8 databaseHashUUID[ATT_BT_UUID_SIZE] =
+    {
+        LO_UINT16( DATABASE_HASH_UUID ), HI_UINT16( DATABASE_HASH_UUID )
+    };
 #endif
 
+// Database Hash, little-endian as read by the clients. It is calculated on
+// the first read after the attribute database changes.
+static uint8 databaseHash[GATT_DATABASE_HASH_LEN];
+static uint8 databaseHashValid = FALSE;
+
 // Service Changed attribute (hidden). Set the affected Attribute Handle range
 // to 0x0001 to 0xFFFF to indicate to the client to rediscover the entire set
 // of Attribute Handles on the server.
@@ -185,6 +256,22 @@ static gattAttribute_t gattAttrTbl[] =
         GATT_PERMIT_READ | GATT_PERMIT_WRITE,
         0,
         (uint8*)indCharCfg
+    },
+
+    // Characteristic Declaration
+    {
+        { ATT_BT_UUID_SIZE, characterUUID },
+        GATT_PERMIT_READ,
+        0,
+        &databaseHashCharProps
+    },
+
+    // Database Hash
+    {
+        { ATT_BT_UUID_SIZE, databaseHashUUID },
+        GATT_PERMIT_READ,
+        0,
+        databaseHash
     }
     #endif
 };
@@ -204,11 +291,22 @@ static bStatus_t gattServApp_ProcessWriteReq( gattMsgEvent_t* pMsg, uint16* pErr
 static bStatus_t gattServApp_ProcessPrepareWriteReq( gattMsgEvent_t* pMsg, uint16* pErrHandle );
 static bStatus_t gattServApp_ProcessExecuteWriteReq( gattMsgEvent_t* pMsg, uint16* pErrHandle );
 
-static bStatus_t gattServApp_RegisterServiceCBs( uint16 handle, CONST gattServiceCBs_t* pServiceCBs );
+static bStatus_t gattServApp_RegisterServiceCBs( gattAttribute_t* pAttrs, uint16 numAttrs,
+                                                 CONST gattServiceCBs_t* pServiceCBs );
 static bStatus_t gattServApp_DeregisterServiceCBs( uint16 handle );
 static bStatus_t gattServApp_SetNumPrepareWrites( uint8 numPrepareWrites );
 static uint8 gattServApp_PrepareWriteQInUse( void );
 static CONST gattServiceCBs_t* gattServApp_FindServiceCBs( uint16 service );
+static gattServiceCBsInfo_t* gattServApp_FindServiceInfo( uint16 handle );
+static gattAttribute_t* gattServApp_FindHandle( uint16 handle, uint16* pHandle );
+static void gattServApp_DatabaseChanged( void );
+#if ( GATT_DISC_CACHE_SIZE > 0 )
+static uint8 gattServApp_ReadDiscCache( gattMsgEvent_t* pMsg, uint16 startHandle, uint16 endHandle,
+                                        attAttrType_t* pType, uint16* pErrHandle, uint8* pStatus );
+static void gattServApp_WriteDiscCache( gattMsgEvent_t* pMsg, uint16 startHandle, uint16 endHandle,
+                                        attAttrType_t* pType, uint8 status, uint16 errHandle,
+                                        uint16 len, uint8 num, uint8* pData );
+#endif
 static bStatus_t gattServApp_EnqueuePrepareWriteReq( uint16 connHandle, attPrepareWriteReq_t* pReq );
 static prepareWrites_t* gattServApp_FindPrepareWriteQ( uint16 connHandle );
 static gattCharCfg_t* gattServApp_FindCharCfgItem( uint16 connHandle,
@@ -223,6 +321,9 @@ static pfnGATTAuthorizeAttrCB_t gattServApp_FindAuthorizeAttrCB( uint16 handle )
 
 // GATT App Callback functions
 static void gattServApp_HandleConnStatusCB( uint16 connHandle, uint8 changeType );
+static bStatus_t gattServApp_ReadAttrCB( uint16 connHandle, gattAttribute_t* pAttr,
+                                         uint8* pValue, uint16* pLen, uint16 offset,
+                                         uint8 maxLen );
 static bStatus_t gattServApp_WriteAttrCB( uint16 connHandle, gattAttribute_t* pAttr,
                                           uint8* pValue, uint16 len, uint16 offset );
 
@@ -232,7 +333,7 @@ static bStatus_t gattServApp_WriteAttrCB( uint16 connHandle, gattAttribute_t* pA
 // GATT Service Callbacks
 CONST gattServiceCBs_t gattServiceCBs =
 {
-    NULL,                    // Read callback function pointer
+    gattServApp_ReadAttrCB,  // Read callback function pointer
     gattServApp_WriteAttrCB, // Write callback function pointer
     NULL                     // Authorization callback function pointer
 };
@@ -358,12 +459,14 @@ bStatus_t GATTServApp_RegisterService( gattAttribute_t* pAttrs, uint16 numAttrs,
         service.numAttrs = numAttrs;
         status = GATT_RegisterService( &service );
 
-        if ( ( status == SUCCESS ) && ( pServiceCBs != NULL ) )
+        if ( status == SUCCESS )
         {
-            // Register the service CBs with GATT Server Application
-            status = gattServApp_RegisterServiceCBs( GATT_SERVICE_HANDLE( pAttrs ),
-                                                     pServiceCBs );
+            // Register the service CBs with GATT Server Application. Services
+            // without CBs are recorded too, the Database Hash covers them.
+            status = gattServApp_RegisterServiceCBs( pAttrs, numAttrs, pServiceCBs );
         }
+
+        gattServApp_DatabaseChanged();
     }
     else
     {
@@ -399,6 +502,7 @@ bStatus_t GATTServApp_DeregisterService( uint16 handle, gattAttribute_t** p2pAtt
         gattService_t service;
         // Deregister the service attribute list with GATT Server
         status = GATT_DeregisterService( handle, &service );
+        gattServApp_DatabaseChanged();
 
         if ( status == SUCCESS )
         {
@@ -574,11 +678,21 @@ static bStatus_t gattServApp_SetNumPrepareWrites( uint8 numPrepareWrites )
 */
 gattAttribute_t* GATTServApp_FindAttr( gattAttribute_t* pAttrTbl, uint16 numAttrs, uint8* pValue )
 {
+    // Notifications are usually sent again and again for the same
+    // characteristic, so try the last record found first
+    if ( ( pAttrTbl == pLastAttrTbl ) && ( lastAttrIdx < numAttrs ) &&
+            ( pAttrTbl[lastAttrIdx].pValue == pValue ) )
+    {
+        return ( &(pAttrTbl[lastAttrIdx]) );
+    }
+
     for ( uint16 i = 0; i < numAttrs; i++ )
     {
         if ( pAttrTbl[i].pValue == pValue )
         {
             // Attribute record found
+            pLastAttrTbl = pAttrTbl;
+            lastAttrIdx = i;
             return ( &(pAttrTbl[i]) );
         }
     }
@@ -640,60 +754,67 @@ bStatus_t GATTServApp_DelService( uint32 services )
 /******************************************************************************
     @fn      gattServApp_RegisterServiceCBs
 
-    @brief   Register callback functions for a service.
+    @brief   Register callback functions for a service. The service record
+            is inserted into the service table in handle order.
 
-    @param   handle - handle of service being registered
+    @param   pAttrs - attribute records of the service being registered
+    @param   numAttrs - number of attribute records
     @param   pServiceCBs - pointer to service CBs to be registered
 
     @return  SUCCESS: Service CBs were registered successfully.
             INVALIDPARAMETER: Invalid service CB field.
             bleMemAllocError: Memory allocation error occurred.
 */
-static bStatus_t gattServApp_RegisterServiceCBs( uint16 handle,
+static bStatus_t gattServApp_RegisterServiceCBs( gattAttribute_t* pAttrs, uint16 numAttrs,
                                                  CONST gattServiceCBs_t* pServiceCBs )
 {
-    serviceCBsList_t* pNewItem;
+    gattServiceCBsInfo_t* pInfo;
+    uint16 handle = GATT_SERVICE_HANDLE( pAttrs );
+    uint16 i;
 
     // Make sure the service handle is specified
-    if ( handle == GATT_INVALID_HANDLE )
+    if ( ( handle == GATT_INVALID_HANDLE ) || ( numAttrs == 0 ) )
     {
         return ( INVALIDPARAMETER );
     }
 
-    // Fill in the new service list
-    pNewItem = (serviceCBsList_t*)osal_mem_alloc( sizeof( serviceCBsList_t ) );
-
-    if ( pNewItem == NULL )
+    // Grow the service table if it is full
+    if ( numServiceCBs == maxServiceCBs )
     {
-        // Not enough memory
-        return ( bleMemAllocError );
-    }
-
-    // Set up new service CBs item
-    pNewItem->next = NULL;
-    pNewItem->serviceInfo.handle = handle;
-    pNewItem->serviceInfo.pCBs = pServiceCBs;
+        gattServiceCBsInfo_t* pNewTbl;
+        pNewTbl = (gattServiceCBsInfo_t*)osal_mem_alloc( ( maxServiceCBs + GATT_SERV_CBS_TBL_INC ) *
+                                                         sizeof( gattServiceCBsInfo_t ) );
 
-    // Find spot in list
-    if ( serviceCBsList == NULL )
-    {
-        // First item in list
-        serviceCBsList = pNewItem;
-    }
-    else
-    {
-        serviceCBsList_t* pLoop = serviceCBsList;
+        if ( pNewTbl == NULL )
+        {
+            // Not enough memory
+            return ( bleMemAllocError );
+        }
 
-        // Look for end of list
-        while ( pLoop->next != NULL )
+        if ( serviceCBsTbl != NULL )
         {
-            pLoop = pLoop->next;
+            VOID osal_memcpy( pNewTbl, serviceCBsTbl, numServiceCBs * sizeof( gattServiceCBsInfo_t ) );
+            osal_mem_free( serviceCBsTbl );
         }
 
-        // Put new item at end of list
-        pLoop->next = pNewItem;
+        serviceCBsTbl = pNewTbl;
+        maxServiceCBs += GATT_SERV_CBS_TBL_INC;
     }
 
+    // Find spot in table; services are mostly registered in handle order
+    for ( i = numServiceCBs; ( i > 0 ) && ( serviceCBsTbl[i-1].handle > handle ); i-- )
+    {
+        serviceCBsTbl[i] = serviceCBsTbl[i-1];
+    }
+
+    // Set up new service CBs record
+    pInfo = &(serviceCBsTbl[i]);
+    pInfo->handle = handle;
+    pInfo->endHandle = pAttrs[numAttrs-1].handle;
+    pInfo->pAttrs = pAttrs;
+    pInfo->numAttrs = numAttrs;
+    pInfo->pCBs = pServiceCBs;
+    numServiceCBs++;
     return ( SUCCESS );
 }
 
@@ -709,36 +830,73 @@ static bStatus_t gattServApp_RegisterServiceCBs( uint16 handle,
 */
 static bStatus_t gattServApp_DeregisterServiceCBs( uint16 handle )
 {
-    serviceCBsList_t* pLoop = serviceCBsList;
-    serviceCBsList_t* pPrev = NULL;
+    gattServiceCBsInfo_t* pInfo = gattServApp_FindServiceInfo( handle );
 
-    // Look for service
-    while ( pLoop != NULL )
+    if ( ( pInfo == NULL ) || ( pInfo->handle != handle ) )
     {
-        if ( pLoop->serviceInfo.handle == handle )
-        {
-            // Service CBs found; unlink it
-            if ( pPrev == NULL )
-            {
-                // First item in list
-                serviceCBsList = pLoop->next;
-            }
-            else
-            {
-                pPrev->next = pLoop->next;
-            }
+        // Service CBs not found
+        return ( FAILURE );
+    }
 
-            // Free the service CB record
-            osal_mem_free( pLoop );
-            return ( SUCCESS );
-        }
+    if ( pLastAttrTbl == pInfo->pAttrs )
+    {
+        pLastAttrTbl = NULL;
+    }
+
+    // Close the gap in the service table
+    numServiceCBs--;
 
-        pPrev = pLoop;
-        pLoop = pLoop->next;
+    for ( ; pInfo < &(serviceCBsTbl[numServiceCBs]); pInfo++ )
+    {
+        pInfo[0] = pInfo[1];
     }
 
-    // Service CBs not found
-    return ( FAILURE );
+    if ( numServiceCBs == 0 )
+    {
+        // Free the service table
+        osal_mem_free( serviceCBsTbl );
+        serviceCBsTbl = NULL;
+        maxServiceCBs = 0;
+    }
+
+    return ( SUCCESS );
+}
+
+/*********************************************************************
+    @fn      gattServApp_FindServiceInfo
+
+    @brief   Find the service record whose handle range contains a
+            given attribute handle.
+
+    @param   handle - attribute handle
+
+    @return  Pointer to service record. NULL, otherwise.
+*/
+static gattServiceCBsInfo_t* gattServApp_FindServiceInfo( uint16 handle )
+{
+    uint16 low = 0;
+    uint16 high = numServiceCBs;
+
+    while ( low < high )
+    {
+        uint16 mid = ( low + high ) >> 1;
+        gattServiceCBsInfo_t* pInfo = &(serviceCBsTbl[mid]);
+
+        if ( handle < pInfo->handle )
+        {
+            high = mid;
+        }
+        else if ( handle > pInfo->endHandle )
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            return ( pInfo );
+        }
+    }
+
+    return ( (gattServiceCBsInfo_t*)NULL );
 }
 
 /*********************************************************************
@@ -752,22 +910,278 @@ static bStatus_t gattServApp_DeregisterServiceCBs( uint16 handle )
 */
 static CONST gattServiceCBs_t* gattServApp_FindServiceCBs( uint16 handle )
 {
-    serviceCBsList_t* pLoop = serviceCBsList;
+    gattServiceCBsInfo_t* pInfo = gattServApp_FindServiceInfo( handle );
 
-    while ( pLoop != NULL )
+    if ( ( pInfo != NULL ) && ( pInfo->handle == handle ) )
     {
-        if ( pLoop->serviceInfo.handle == handle )
+        return ( pInfo->pCBs );
+    }
+
+    return ( (gattServiceCBs_t*)NULL );
+}
+
+/*********************************************************************
+    @fn      gattServApp_FindHandle
+
+    @brief   Find the attribute record for a given handle. Attribute
+            handles are assigned consecutively within a service, so
+            the record is indexed directly from the service table.
+            Attributes not found there are looked up by GATT.
+
+    @param   handle - handle to look for
+    @param   pHandle - handle of owner of attribute (to be returned)
+
+    @return  Pointer to attribute record. NULL, otherwise.
+*/
+static gattAttribute_t* gattServApp_FindHandle( uint16 handle, uint16* pHandle )
+{
+    gattServiceCBsInfo_t* pInfo = gattServApp_FindServiceInfo( handle );
+
+    if ( pInfo != NULL )
+    {
+        uint16 i = handle - pInfo->handle;
+
+        if ( ( i < pInfo->numAttrs ) && ( pInfo->pAttrs[i].handle == handle ) )
+        {
+            if ( pHandle != NULL )
+            {
+                *pHandle = pInfo->handle;
+            }
+
+            return ( &(pInfo->pAttrs[i]) );
+        }
+    }
+
+    return ( GATT_FindHandle( handle, pHandle ) );
+}
+
+/*********************************************************************
+    @fn      gattServApp_DatabaseChanged
+
+    @brief   Drop everything derived from the attribute database after a
+            service is registered or deregistered.
+
+    @param   none
+
+    @return  none
+*/
+static void gattServApp_DatabaseChanged( void )
+{
+    databaseHashValid = FALSE;
+    #if ( GATT_DISC_CACHE_SIZE > 0 )
+
+    for ( uint8 i = 0; i < GATT_DISC_CACHE_SIZE; i++ )
+    {
+        if ( discCache[i].pData != NULL )
         {
-            return ( pLoop->serviceInfo.pCBs );
+            osal_mem_free( discCache[i].pData );
+            discCache[i].pData = NULL;
         }
 
-        // Try next service
-        pLoop = pLoop->next;
+        discCache[i].method = 0;
     }
 
-    return ( (gattServiceCBs_t*)NULL );
+    discCacheNext = 0;
+    #endif
+}
+
+#if ( GATT_DISC_CACHE_SIZE > 0 )
+/*********************************************************************
+    @fn      gattServApp_DiscCacheType
+
+    @brief   Check whether a requested attribute type is a declaration,
+            whose value only changes with the attribute database.
+
+    @param   pType - requested attribute type
+
+    @return  16-bit UUID of the declaration. 0, otherwise.
+*/
+static uint16 gattServApp_DiscCacheType( attAttrType_t* pType )
+{
+    if ( pType->len == ATT_BT_UUID_SIZE )
+    {
+        uint16 uuid = BUILD_UINT16( pType->uuid[0], pType->uuid[1] );
+
+        switch ( uuid )
+        {
+        case GATT_PRIMARY_SERVICE_UUID:
+        case GATT_SECONDARY_SERVICE_UUID:
+        case GATT_INCLUDE_UUID:
+        case GATT_CHARACTER_UUID:
+            return ( uuid );
+
+        default:
+            break;
+        }
+    }
+
+    return ( 0 );
+}
+
+/*********************************************************************
+    @fn      gattServApp_ReadDiscCache
+
+    @brief   Answer a service discovery request from the discovery
+            response cache.
+
+    @param   pMsg - pointer to received message
+    @param   startHandle - requested starting handle
+    @param   endHandle - requested ending handle
+    @param   pType - requested attribute type
+    @param   pErrHandle - attribute handle that generates an error
+    @param   pStatus - status of the request (to be returned)
+
+    @return  TRUE if the request was answered. FALSE, otherwise.
+*/
+static uint8 gattServApp_ReadDiscCache( gattMsgEvent_t* pMsg, uint16 startHandle, uint16 endHandle,
+                                        attAttrType_t* pType, uint16* pErrHandle, uint8* pStatus )
+{
+    uint16 uuid = gattServApp_DiscCacheType( pType );
+
+    if ( uuid == 0 )
+    {
+        return ( FALSE );
+    }
+
+    for ( uint8 i = 0; i < GATT_DISC_CACHE_SIZE; i++ )
+    {
+        gattDiscCacheItem_t* pItem = &(discCache[i]);
+
+        if ( ( pItem->method == pMsg->method ) && ( pItem->uuid == uuid )             &&
+                ( pItem->startHandle == startHandle ) && ( pItem->endHandle == endHandle ) &&
+                ( pItem->mtu == gAttMtuSize[pMsg->connHandle] ) )
+        {
+            *pStatus = pItem->status;
+
+            if ( pItem->status != SUCCESS )
+            {
+                *pErrHandle = pItem->errHandle;
+            }
+            else if ( pItem->method == ATT_READ_BY_TYPE_REQ )
+            {
+                attReadByTypeRsp_t* pRsp = &rsp.readByTypeRsp;
+                pRsp->len = pItem->len;
+                pRsp->numPairs = pItem->num;
+                VOID osal_memcpy( pRsp->dataList, pItem->pData, pItem->len * pItem->num );
+                VOID ATT_ReadByTypeRsp( pMsg->connHandle, pRsp );
+            }
+            else
+            {
+                attReadByGrpTypeRsp_t* pRsp = &rsp.readByGrpTypeRsp;
+                pRsp->len = pItem->len;
+                pRsp->numGrps = pItem->num;
+                VOID osal_memcpy( pRsp->dataList, pItem->pData, pItem->len * pItem->num );
+                VOID ATT_ReadByGrpTypeRsp( pMsg->connHandle, pRsp );
+            }
+
+            return ( TRUE );
+        }
+    }
+
+    return ( FALSE );
 }
 
+/*********************************************************************
+    @fn      gattServApp_WriteDiscCache
+
+    @brief   Keep the response to a service discovery request. Only
+            responses that every client would get are kept: the found
+            attributes need no security and the request either
+            succeeded or found nothing.
+
+    @param   pMsg - pointer to received message
+    @param   startHandle - requested starting handle
+    @param   endHandle - requested ending handle
+    @param   pType - requested attribute type
+    @param   status - status of the request
+    @param   errHandle - handle sent with the error response
+    @param   len - length of each response item
+    @param   num - number of response items
+    @param   pData - response items
+
+    @return  none
+*/
+static void gattServApp_WriteDiscCache( gattMsgEvent_t* pMsg, uint16 startHandle, uint16 endHandle,
+                                        attAttrType_t* pType, uint8 status, uint16 errHandle,
+                                        uint16 len, uint8 num, uint8* pData )
+{
+    gattDiscCacheItem_t* pItem = &(discCache[discCacheNext]);
+    uint16 uuid = gattServApp_DiscCacheType( pType );
+
+    if ( ( uuid == 0 ) || ( ( status != SUCCESS ) && ( status != ATT_ERR_ATTR_NOT_FOUND ) ) )
+    {
+        return;
+    }
+
+    // Replace the oldest entry
+    if ( pItem->pData != NULL )
+    {
+        osal_mem_free( pItem->pData );
+        pItem->pData = NULL;
+    }
+
+    pItem->method = 0;
+
+    if ( status == SUCCESS )
+    {
+        pItem->pData = osal_mem_alloc( len * num );
+
+        if ( pItem->pData == NULL )
+        {
+            return;
+        }
+
+        VOID osal_memcpy( pItem->pData, pData, len * num );
+    }
+
+    pItem->method = pMsg->method;
+    pItem->status = status;
+    pItem->uuid = uuid;
+    pItem->startHandle = startHandle;
+    pItem->endHandle = endHandle;
+    pItem->mtu = gAttMtuSize[pMsg->connHandle];
+    pItem->errHandle = errHandle;
+    pItem->len = len;
+    pItem->num = num;
+
+    if ( ++discCacheNext == GATT_DISC_CACHE_SIZE )
+    {
+        discCacheNext = 0;
+    }
+}
+#endif
+
+#if defined ( GATT_SERV_PROC_STAT )
+/*********************************************************************
+    @fn      GATTServApp_GetProcStat
+
+    @brief   Get the ATT request processing time statistics together
+            with the size of the registered attribute database.
+
+    @param   pStat - pointer to statistics (to be returned)
+    @param   reset - TRUE to restart the time statistics
+
+    @return  none
+*/
+void GATTServApp_GetProcStat( gattServProcStat_t* pStat, uint8 reset )
+{
+    procStat.numServices = numServiceCBs;
+    procStat.numAttrs = 0;
+
+    for ( uint16 i = 0; i < numServiceCBs; i++ )
+    {
+        procStat.numAttrs += serviceCBsTbl[i].numAttrs;
+    }
+
+    *pStat = procStat;
+
+    if ( reset == TRUE )
+    {
+        VOID osal_memset( &procStat, 0, sizeof( procStat ) );
+    }
+}
+#endif
+
 /*********************************************************************
     @fn          gattServApp_ProcessMsg
 
@@ -781,6 +1195,9 @@ static void gattServApp_ProcessMsg( gattMsgEvent_t* pMsg )
 {
     uint16 errHandle = GATT_INVALID_HANDLE;
     uint8 status;
+    #if defined ( GATT_SERV_PROC_STAT )
+    uint32 t0 = read_current_fine_time();
+    #endif
     #if defined ( TESTMODES )
 
     if ( paramValue == GATT_TESTMODE_NO_RSP )
@@ -857,6 +1274,19 @@ static void gattServApp_ProcessMsg( gattMsgEvent_t* pMsg )
         }
     }
 
+    #if defined ( GATT_SERV_PROC_STAT )
+    {
+        uint32 elapsed = GATT_SERV_TIME_DELTA( t0, read_current_fine_time() );
+        procStat.numReqs++;
+        procStat.totalTime += elapsed;
+
+        if ( elapsed > procStat.maxTime )
+        {
+            procStat.maxTime = elapsed;
+        }
+    }
+    #endif
+
     // Notify GATT that a message has been processed
     // Note: This call is optional if flow control is not used.
     GATT_AppCompletedMsg( pMsg );
@@ -992,6 +1422,17 @@ static bStatus_t gattServApp_ProcessReadByTypeReq( gattMsgEvent_t* pMsg, uint16*
     uint16 startHandle = pReq->startHandle;
     uint8 dataLen = 0;
     uint8 status = SUCCESS;
+    #if ( GATT_DISC_CACHE_SIZE > 0 )
+    uint8 cacheable = TRUE;
+
+    // Rediscovery of the services is answered from the cache
+    if ( gattServApp_ReadDiscCache( pMsg, pReq->startHandle, pReq->endHandle,
+                                    &pReq->type, pErrHandle, &status ) )
+    {
+        return ( status );
+    }
+
+    #endif
 
     // Only the attributes with attribute handles between and including the
     // Starting Handle and the Ending Handle with the attribute type that is
@@ -1014,6 +1455,17 @@ static bStatus_t gattServApp_ProcessReadByTypeReq( gattMsgEvent_t* pMsg, uint16*
 
         // Update start handle so it has the right value if we break from the loop
         startHandle = pAttr->handle;
+
+        #if ( GATT_DISC_CACHE_SIZE > 0 )
+
+        // The response depends on the link if the attribute needs security
+        if ( pAttr->permissions != GATT_PERMIT_READ )
+        {
+            cacheable = FALSE;
+        }
+
+        #endif
+
         // Make sure the attribute has sufficient permissions to allow reading
         status = GATT_VerifyReadPermissions( pMsg->connHandle, pAttr->permissions );
 
@@ -1075,6 +1527,15 @@ static bStatus_t gattServApp_ProcessReadByTypeReq( gattMsgEvent_t* pMsg, uint16*
     {
         // Set the number of attribute handle-value pairs found
         pRsp->numPairs = dataLen / pRsp->len;
+        #if ( GATT_DISC_CACHE_SIZE > 0 )
+
+        if ( cacheable == TRUE )
+        {
+            gattServApp_WriteDiscCache( pMsg, pReq->startHandle, pReq->endHandle, &pReq->type,
+                                        SUCCESS, 0, pRsp->len, pRsp->numPairs, pRsp->dataList );
+        }
+
+        #endif
         // Send a response back
         VOID ATT_ReadByTypeRsp( pMsg->connHandle, pRsp );
         return ( SUCCESS );
@@ -1087,6 +1548,15 @@ static bStatus_t gattServApp_ProcessReadByTypeReq( gattMsgEvent_t* pMsg, uint16*
     }
 
     *pErrHandle = startHandle;
+    #if ( GATT_DISC_CACHE_SIZE > 0 )
+
+    if ( cacheable == TRUE )
+    {
+        gattServApp_WriteDiscCache( pMsg, pReq->startHandle, pReq->endHandle, &pReq->type,
+                                    status, startHandle, 0, 0, NULL );
+    }
+
+    #endif
     return ( status );
 }
 
@@ -1106,7 +1576,7 @@ static bStatus_t gattServApp_ProcessReadReq( gattMsgEvent_t* pMsg, uint16* pErrH
     gattAttribute_t* pAttr;
     uint16 service;
     uint8 status;
-    pAttr = GATT_FindHandle( pReq->handle, &service );
+    pAttr = gattServApp_FindHandle( pReq->handle, &service );
 
     if ( pAttr != NULL )
     {
@@ -1152,7 +1622,7 @@ static bStatus_t gattServApp_ProcessReadBlobReq( gattMsgEvent_t* pMsg, uint16* p
     gattAttribute_t* pAttr;
     uint16 service;
     uint8 status;
-    pAttr = GATT_FindHandle( pReq->handle, &service );
+    pAttr = gattServApp_FindHandle( pReq->handle, &service );
 
     if ( pAttr != NULL )
     {
@@ -1203,7 +1673,7 @@ static bStatus_t gattServApp_ProcessReadMultiReq( gattMsgEvent_t* pMsg, uint16*
     {
         gattAttribute_t* pAttr;
         uint16 service;
-        pAttr = GATT_FindHandle( pReq->handle[i], &service );
+        pAttr = gattServApp_FindHandle( pReq->handle[i], &service );
 
         if ( pAttr == NULL )
         {
@@ -1264,6 +1734,17 @@ static bStatus_t gattServApp_ProcessReadByGrpTypeReq( gattMsgEvent_t* pMsg, uint
     gattAttribute_t* pAttr;
     uint16 dataLen = 0;
     uint8 status = SUCCESS;
+    #if ( GATT_DISC_CACHE_SIZE > 0 )
+    uint8 cacheable = TRUE;
+
+    // Rediscovery of the services is answered from the cache
+    if ( gattServApp_ReadDiscCache( pMsg, pReq->startHandle, pReq->endHandle,
+                                    &pReq->type, pErrHandle, &status ) )
+    {
+        return ( status );
+    }
+
+    #endif
     // Only the attributes with attribute handles between and including the
     // Starting Handle and the Ending Handle with the attribute type that is
     // the same as the Attribute Type given will be returned.
@@ -1276,6 +1757,17 @@ static bStatus_t gattServApp_ProcessReadByGrpTypeReq( gattMsgEvent_t* pMsg, uint
     while ( pAttr != NULL )
     {
         uint16 endGrpHandle;
+
+        #if ( GATT_DISC_CACHE_SIZE > 0 )
+
+        // The response depends on the link if the attribute needs security
+        if ( pAttr->permissions != GATT_PERMIT_READ )
+        {
+            cacheable = FALSE;
+        }
+
+        #endif
+
         // The service, include and characteristic declarations are readable and
         // require no authentication or authorization, therefore insufficient
         // authentication or read not permitted errors shall not occur.
@@ -1353,6 +1845,15 @@ static bStatus_t gattServApp_ProcessReadByGrpTypeReq( gattMsgEvent_t* pMsg, uint
     {
         // Set the number of attribute handle, end group handle and value sets found
         pRsp->numGrps = dataLen / pRsp->len;
+        #if ( GATT_DISC_CACHE_SIZE > 0 )
+
+        if ( cacheable == TRUE )
+        {
+            gattServApp_WriteDiscCache( pMsg, pReq->startHandle, pReq->endHandle, &pReq->type,
+                                        SUCCESS, 0, pRsp->len, pRsp->numGrps, pRsp->dataList );
+        }
+
+        #endif
         // Send a response back
         VOID ATT_ReadByGrpTypeRsp( pMsg->connHandle, pRsp );
         return ( SUCCESS );
@@ -1365,6 +1866,15 @@ static bStatus_t gattServApp_ProcessReadByGrpTypeReq( gattMsgEvent_t* pMsg, uint
     }
 
     *pErrHandle = pReq->startHandle;
+    #if ( GATT_DISC_CACHE_SIZE > 0 )
+
+    if ( cacheable == TRUE )
+    {
+        gattServApp_WriteDiscCache( pMsg, pReq->startHandle, pReq->endHandle, &pReq->type,
+                                    status, pReq->startHandle, 0, 0, NULL );
+    }
+
+    #endif
     return ( status );
 }
 
@@ -1387,7 +1897,7 @@ static bStatus_t gattServApp_ProcessWriteReq( gattMsgEvent_t* pMsg, uint16* pErr
     // No Error Response or Write Response shall be sent in response to Write
     // Command. If the server cannot write this attribute for any reason the
     // command shall be ignored.
-    pAttr = GATT_FindHandle( pReq->handle, &service );
+    pAttr = gattServApp_FindHandle( pReq->handle, &service );
 
     if ( pAttr != NULL )
     {
@@ -1455,7 +1965,7 @@ static bStatus_t gattServApp_ProcessPrepareWriteReq( gattMsgEvent_t* pMsg, uint1
     gattAttribute_t* pAttr;
     uint16 service;
     uint8 status = SUCCESS;
-    pAttr = GATT_FindHandle( pReq->handle, &service );
+    pAttr = gattServApp_FindHandle( pReq->handle, &service );
 
     if ( pAttr != NULL )
     {
@@ -1754,6 +2264,238 @@ static pfnGATTAuthorizeAttrCB_t gattServApp_FindAuthorizeAttrCB( uint16 handle )
     return ( ( pCBs == NULL ) ? NULL : pCBs->pfnAuthorizeAttrCB );
 }
 
+/*********************************************************************
+    @fn      gattServApp_CmacBlock
+
+    @brief   Encrypt a block in place with the all zero key used for
+            the Database Hash.
+
+    @param   pBlock - block to encrypt, most significant octet first
+
+    @return  none
+*/
+static void gattServApp_CmacBlock( uint8* pBlock )
+{
+    uint8 key[16];
+    uint8 out[16];
+    VOID osal_memset( key, 0, sizeof( key ) );
+    VOID LL_Encrypt( key, pBlock, out );
+    VOID osal_memcpy( pBlock, out, sizeof( out ) );
+}
+
+/*********************************************************************
+    @fn      gattServApp_CmacUpdate
+
+    @brief   Add octets to the AES-CMAC calculation (RFC 4493).
+
+    @param   pCtx - AES-CMAC state
+    @param   pData - octets to add
+    @param   len - number of octets
+
+    @return  none
+*/
+static void gattServApp_CmacUpdate( gattServCmac_t* pCtx, uint8* pData, uint16 len )
+{
+    while ( len > 0 )
+    {
+        // A full block is only chained once more data follows, the last
+        // block is finished with a subkey
+        if ( pCtx->len == 16 )
+        {
+            for ( uint8 i = 0; i < 16; i++ )
+            {
+                pCtx->mac[i] ^= pCtx->block[i];
+            }
+
+            gattServApp_CmacBlock( pCtx->mac );
+            pCtx->len = 0;
+        }
+
+        pCtx->block[pCtx->len++] = *pData++;
+        len--;
+    }
+}
+
+/*********************************************************************
+    @fn      gattServApp_CmacFinal
+
+    @brief   Finish the AES-CMAC calculation (RFC 4493).
+
+    @param   pCtx - AES-CMAC state
+    @param   pMac - AES-CMAC, most significant octet first (to be returned)
+
+    @return  none
+*/
+static void gattServApp_CmacFinal( gattServCmac_t* pCtx, uint8* pMac )
+{
+    uint8 subkey[16];
+    uint8 n = ( pCtx->len == 16 ) ? 1 : 2;
+    // K1 is L = AES-K(0) doubled in GF(2^128), K2 is K1 doubled
+    VOID osal_memset( subkey, 0, sizeof( subkey ) );
+    gattServApp_CmacBlock( subkey );
+
+    while ( n-- > 0 )
+    {
+        uint8 msb = subkey[0] & 0x80;
+
+        for ( uint8 i = 0; i < 15; i++ )
+        {
+            subkey[i] = ( subkey[i] << 1 ) | ( subkey[i+1] >> 7 );
+        }
+
+        subkey[15] <<= 1;
+
+        if ( msb )
+        {
+            subkey[15] ^= 0x87;
+        }
+    }
+
+    // Pad an incomplete last block
+    if ( pCtx->len < 16 )
+    {
+        pCtx->block[pCtx->len] = 0x80;
+        VOID osal_memset( &(pCtx->block[pCtx->len+1]), 0, 15 - pCtx->len );
+    }
+
+    for ( uint8 i = 0; i < 16; i++ )
+    {
+        pMac[i] = pCtx->mac[i] ^ pCtx->block[i] ^ subkey[i];
+    }
+
+    gattServApp_CmacBlock( pMac );
+}
+
+/*********************************************************************
+    @fn      gattServApp_CalcDatabaseHash
+
+    @brief   Calculate the Database Hash: AES-CMAC with a zero key over
+            the handle, type and value of the service, include,
+            characteristic and extended properties declarations, and
+            the handle and type of the other characteristic descriptors
+            defined by GATT, in handle order.
+
+    @param   none
+
+    @return  none
+*/
+static void gattServApp_CalcDatabaseHash( void )
+{
+    gattServCmac_t cmac;
+    uint8 mac[GATT_DATABASE_HASH_LEN];
+    VOID osal_memset( &cmac, 0, sizeof( cmac ) );
+
+    for ( uint16 i = 0; i < numServiceCBs; i++ )
+    {
+        gattServiceCBsInfo_t* pInfo = &(serviceCBsTbl[i]);
+
+        for ( uint16 j = 0; j < pInfo->numAttrs; j++ )
+        {
+            gattAttribute_t* pAttr = &(pInfo->pAttrs[j]);
+            uint8 value[2 + 2 + ATT_UUID_SIZE];
+            uint16 len = 0;
+            uint16 uuid;
+
+            if ( pAttr->type.len != ATT_BT_UUID_SIZE )
+            {
+                continue;
+            }
+
+            uuid = BUILD_UINT16( pAttr->type.uuid[0], pAttr->type.uuid[1] );
+
+            switch ( uuid )
+            {
+            case GATT_PRIMARY_SERVICE_UUID:
+            case GATT_SECONDARY_SERVICE_UUID:
+            case GATT_INCLUDE_UUID:
+            case GATT_CHARACTER_UUID:
+            case GATT_CHAR_EXT_PROPS_UUID:
+                if ( GATTServApp_ReadAttr( INVALID_CONNHANDLE, pAttr, pInfo->handle, value,
+                                           &len, 0, sizeof( value ) ) != SUCCESS )
+                {
+                    len = 0;
+                }
+
+            // fall through
+            case GATT_CHAR_USER_DESC_UUID:
+            case GATT_CLIENT_CHAR_CFG_UUID:
+            case GATT_SERV_CHAR_CFG_UUID:
+            case GATT_CHAR_FORMAT_UUID:
+            case GATT_CHAR_AGG_FORMAT_UUID:
+            {
+                uint8 hdr[4];
+                hdr[0] = LO_UINT16( pAttr->handle );
+                hdr[1] = HI_UINT16( pAttr->handle );
+                hdr[2] = pAttr->type.uuid[0];
+                hdr[3] = pAttr->type.uuid[1];
+                gattServApp_CmacUpdate( &cmac, hdr, sizeof( hdr ) );
+                gattServApp_CmacUpdate( &cmac, value, len );
+            }
+            break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    gattServApp_CmacFinal( &cmac, mac );
+
+    // The characteristic value is sent least significant octet first
+    for ( uint8 i = 0; i < GATT_DATABASE_HASH_LEN; i++ )
+    {
+        databaseHash[i] = mac[GATT_DATABASE_HASH_LEN - 1 - i];
+    }
+
+    databaseHashValid = TRUE;
+}
+
+/*********************************************************************
+    @fn      gattServApp_ReadAttrCB
+
+    @brief   Read an attribute of the GATT Service.
+
+    @param   connHandle - connection message was received on
+    @param   pAttr - pointer to attribute
+    @param   pValue - pointer to data to be read
+    @param   pLen - length of data to be read
+    @param   offset - offset of the first octet to be read
+    @param   maxLen - maximum length of data to be read
+
+    @return  Success or Failure
+*/
+static bStatus_t gattServApp_ReadAttrCB( uint16 connHandle, gattAttribute_t* pAttr,
+                                         uint8* pValue, uint16* pLen, uint16 offset,
+                                         uint8 maxLen )
+{
+    bStatus_t status = SUCCESS;
+
+    if ( ( pAttr->type.len == ATT_BT_UUID_SIZE ) &&
+            ( BUILD_UINT16( pAttr->type.uuid[0], pAttr->type.uuid[1] ) == DATABASE_HASH_UUID ) )
+    {
+        if ( offset > GATT_DATABASE_HASH_LEN )
+        {
+            return ( ATT_ERR_INVALID_OFFSET );
+        }
+
+        if ( databaseHashValid == FALSE )
+        {
+            gattServApp_CalcDatabaseHash();
+        }
+
+        *pLen = MIN( GATT_DATABASE_HASH_LEN - offset, maxLen );
+        VOID osal_memcpy( pValue, &(databaseHash[offset]), *pLen );
+    }
+    else
+    {
+        // Should never get here!
+        *pLen = 0;
+        status = ATT_ERR_ATTR_NOT_FOUND;
+    }
+
+    return ( status );
+}
+
 /*********************************************************************
     @fn      gattServApp_ValidateWriteAttrCB
 
@@ -1882,7 +2624,7 @@ uint8 GATTServApp_ReadAttr( uint16 connHandle, gattAttribute_t* pAttr,
                 pValue[0] = *pAttr->pValue; // Properties
                 // The Characteristic Value Attribute exists immediately following
                 // the Characteristic Declaration.
-                pCharValue = GATT_FindHandle( pAttr->handle+1, NULL );
+                pCharValue = gattServApp_FindHandle( pAttr->handle+1, NULL );
 
                 if ( pCharValue != NULL )
                 {
@@ -1926,7 +2668,7 @@ uint8 GATTServApp_ReadAttr( uint16 connHandle, gattAttribute_t* pAttr,
                 pValue[0] = LO_UINT16( handle );
                 pValue[1] = HI_UINT16( handle );
                 // Find the included service attribute record
-                pIncluded = GATT_FindHandle( handle, &servHandle );
+                pIncluded = gattServApp_FindHandle( handle, &servHandle );
 
                 if ( pIncluded != NULL )
                 {
@@ -2112,7 +2854,7 @@ uint8 GATTServApp_WriteAttr( uint16 connHandle, uint16 handle,
     gattAttribute_t* pAttr;
     bStatus_t status;
     // Find the owner of the attribute
-    pAttr = GATT_FindHandle( handle, &service );
+    pAttr = gattServApp_FindHandle( handle, &service );
 
     if ( pAttr != NULL )
     {
@@ -441,6 +441,49 @@ void HidDev_Report( uint8 id, uint8 type, uint8 len, uint8* pData )
     hidDevEnqueueReport( id, type, len, pData );
 }
 
+/*********************************************************************
+    @fn      HidDev_VoiceReport
+
+    @brief   Send a voice data input report right away. Unlike HidDev_Report
+            the report is not queued, so it may be longer than
+            HID_DEV_DATA_LEN and a full link buffer is returned to the caller.
+
+    @param   len - Length of report, at most ATT_MTU - 3.
+    @param   pData - Report data.
+
+    @return  SUCCESS, bleNotConnected, bleIncorrectMode if notifications are
+            disabled, bleInvalidRange, or the GATT_Notification status.
+*/
+bStatus_t HidDev_VoiceReport( uint8 len, uint8* pData )
+{
+    static attHandleValueNoti_t voiceNoti;
+    hidRptMap_t*           pRpt;
+    gattAttribute_t*       pAttr;
+    uint16                retHandle;
+
+    if ( ( hidDevGapState != GAPROLE_CONNECTED ) || !hidDevConnSecure )
+    {
+        return ( bleNotConnected );
+    }
+
+    if ( len > gAttMtuSize[gapConnHandle] - 3 )
+    {
+        return ( bleInvalidRange );
+    }
+
+    if ( ( (pRpt = hidDevRptById(HID_RPT_ID_VOICE_DATA_IN, HID_REPORT_TYPE_INPUT)) == NULL ) ||
+            ( (pAttr = GATT_FindHandle(pRpt->cccdHandle, &retHandle)) == NULL ) ||
+            !( GATTServApp_ReadCharCfg( gapConnHandle, (gattCharCfg_t*) pAttr->pValue ) & GATT_CLIENT_CFG_NOTIFY ) )
+    {
+        return ( bleIncorrectMode );
+    }
+
+    voiceNoti.handle = pRpt->handle;
+    voiceNoti.len = len;
+    osal_memcpy(voiceNoti.value, pData, len);
+    return ( GATT_Notification( gapConnHandle, &voiceNoti, FALSE ) );
+}
+
 /*********************************************************************
     @fn      HidDev_Close
 
@@ -316,6 +316,7 @@ extern uint16 HidDev_ProcessEvent( uint8 task_id, uint16 events );
 extern void HidDev_Register( hidDevCfg_t* pCfg, hidDevCB_t* pCBs );
 extern void HidDev_RegisterReports( uint8 numReports, hidRptMap_t* pRpt );
 extern void HidDev_Report( uint8 id, uint8 type, uint8 len, uint8* pData );
+extern bStatus_t HidDev_VoiceReport( uint8 len, uint8* pData );
 extern void HidDev_Close( void );
 extern bStatus_t HidDev_SetParameter( uint8 param, uint8 len, void* pValue );
 extern bStatus_t HidDev_GetParameter( uint8 param, void* pValue );
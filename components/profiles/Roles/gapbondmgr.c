@@ -1078,8 +1078,8 @@ uint8 GAPBondMgr_ProcessGAPMsg( gapEventHdr_t* pMsg )
 
         if ( idx < GAP_BONDINGS_MAX )
         {
-            // Save the sign counter
-            VOID osal_snv_write( devSignCounterNvID(idx), sizeof ( uint32 ), &(pPkt->signCounter) );
+            // Save the sign counter, it reaches flash when the link drops
+            VOID osal_snv_write_deferred( devSignCounterNvID(idx), sizeof ( uint32 ), &(pPkt->signCounter) );
         }
     }
     break;
@@ -1177,6 +1177,9 @@ uint8 GAPBondMgr_ProcessGAPMsg( gapEventHdr_t* pMsg )
     {
 //        gapTerminateLinkEvent_t* pPkt = (gapTerminateLinkEvent_t*)pMsg;
 //        gapAuthCompleteEvent_t* pAuthEvtTmp = NULL;
+        // Write out the sign counter and characteristic configuration
+        VOID osal_snv_flush();
+
         if ( GAP_NumActiveConnections() == 0 )
         {
             // See if we're asked to erase all bonding records
@@ -1335,7 +1338,7 @@ static uint8 gapBondMgrUpdateCharCfg( uint8 idx, uint16 attrHandle, uint16 value
             if ( update )
             {
                 gapBondMgrInvertCharCfgItem( charCfg );
-                VOID osal_snv_write( gattCfgNvID(idx), sizeof( charCfg ), charCfg );
+                VOID osal_snv_write_deferred( gattCfgNvID(idx), sizeof( charCfg ), charCfg );
             }
         }
 
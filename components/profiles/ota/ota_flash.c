@@ -150,6 +150,130 @@ int __attribute__((section("ota_app_loader_area"))) ota_flash_read(uint32_t* des
 }
 
 
+#if(CFG_OTA_BANK_MODE == OTA_DUAL_BANK)
+//crc16 of load address, first and last word of every partition, so a bank erased or
+//rewritten under an unchanged boot sector no longer matches the record
+static uint16_t __attribute__((section("ota_app_loader_area"))) ota_flash_vcache_probe(uint32_t partition_num, uint32_t bank_addr)
+{
+    int i;
+    uint32_t part[4];
+    uint32_t probe[3];
+    uint16_t crc = 0;
+
+    for(i = 1; i< partition_num+1; i++)
+    {
+        //flash addr, run addr, size, checksum
+        ota_flash_read(part, OTAF_2nd_BOOTINFO_ADDR + i*4*4, 16);
+
+        if((part[1]&0xffff0000) == 0xffff0000 || part[2] < 4 || part[2] == 0xffffffff)
+            continue;
+
+        probe[0] = (part[1] == part[0]) ? part[0] : (part[0] + bank_addr);
+        probe[1] = 0;
+        probe[2] = 0;
+        ota_flash_read(&probe[1], probe[0], 4);
+        ota_flash_read(&probe[2], probe[0] + ((part[2] - 4) & ~3), 4);
+        crc = crc16(crc, (const volatile void*)probe, 12);
+    }
+
+    return crc;
+}
+#endif
+
+static void __attribute__((section("ota_app_loader_area"))) ota_flash_vcache_record(uint32_t partition_num, uint32_t bank_addr, uint32_t* rec)
+{
+    rec[0] = OTA_VCACHE_MAGIC;
+    rec[1] = (uint32_t)crc16(0, (const volatile void*)OTAF_2nd_BOOTINFO_ADDR, (partition_num + 1)*16);
+    #if(CFG_OTA_BANK_MODE == OTA_DUAL_BANK)
+    //single bank upgrade always erases boot sector, dual bank one may only rewrite a bank
+    rec[1] |= (uint32_t)ota_flash_vcache_probe(partition_num, bank_addr) << 16;
+    #endif
+    rec[2] = partition_num;
+    rec[3] = (uint32_t)crc16(0, (const volatile void*)rec, 12);
+}
+
+//check if the partitions in boot sector have been verified
+static bool __attribute__((section("ota_app_loader_area"))) ota_flash_vcache_check(uint32_t partition_num, uint32_t bank_addr)
+{
+    int i;
+    uint32_t rec[4];
+    uint32_t slot[4];
+    ota_flash_vcache_record(partition_num, bank_addr, rec);
+
+    for(i = 0; i < OTAF_VCACHE_SLOT_NUM; i++)
+    {
+        ota_flash_read(slot, OTAF_2nd_BOOT_VCACHE + i*16, 16);
+
+        if(slot[0] == rec[0] && slot[1] == rec[1] && slot[2] == rec[2] && slot[3] == rec[3])
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void __attribute__((section("ota_app_loader_area"))) ota_flash_vcache_save(uint32_t partition_num, uint32_t bank_addr)
+{
+    int i;
+    uint32_t rec[4];
+    uint32_t magic;
+    ota_flash_vcache_record(partition_num, bank_addr, rec);
+
+    for(i = 0; i < OTAF_VCACHE_SLOT_NUM; i++)
+    {
+        ota_flash_read(&magic, OTAF_2nd_BOOT_VCACHE + i*16, 4);
+
+        if(magic == 0xffffffff)
+        {
+            hal_flash_write(OTAF_2nd_BOOT_VCACHE + i*16, (uint8_t*)rec, 16);
+            return;
+        }
+    }
+}
+
+/*
+    crc check of all partitions on flash, it is done before any partition is loaded to SRAM,
+    so the record can be saved safely. reboot to OTA mode if crc is incorrect
+*/
+static int __attribute__((section("ota_app_loader_area"))) ota_flash_verify_app(uint32_t partition_num, uint32_t bank_addr)
+{
+    int i;
+
+    for(i = 1; i< partition_num+1; i++)
+    {
+        ota_flash_read(&ota_load_flash_addr, OTAF_2nd_BOOTINFO_ADDR + i*4*4, 4);
+        ota_flash_read(&ota_load_run_addr,   OTAF_2nd_BOOTINFO_ADDR + i*4*4 + 4,  4);
+        ota_flash_read(&ota_load_size,       OTAF_2nd_BOOTINFO_ADDR + i*4*4 + 8,  4);
+        ota_flash_read(&ota_load_checksum,   OTAF_2nd_BOOTINFO_ADDR + i*4*4 + 12, 4);
+
+        if((ota_load_flash_addr==0xffffffff) || (ota_load_run_addr == 0xffffffff )||(ota_load_size == 0xffffffff )||(ota_load_checksum == 0xffffffff ))
+        {
+            return PPlus_ERR_OTA_NO_APP;
+        }
+
+        if(ota_load_run_addr == ota_load_flash_addr)
+        {
+            ota_load_crc = crc16(0, (const volatile void* )ota_load_flash_addr, ota_load_size);
+        }
+        else if((ota_load_run_addr&0xffff0000) == 0xffff0000)
+        {
+            continue;
+        }
+        else
+        {
+            ota_load_crc = crc16(0, (const volatile void* )(ota_load_flash_addr + bank_addr), ota_load_size);
+        }
+
+        if(ota_load_crc != (uint16)ota_load_checksum)
+        {
+            //if crc incorrect, reboot to OTA mode
+            write_reg(OTA_MODE_SELECT_REG, OTA_MODE_OTA);
+            hal_system_soft_reset();
+        }
+    }
+
+    return PPlus_SUCCESS;
+}
+
 int __attribute__((section("ota_app_loader_area"))) ota_flash_load_app(void)
 {
     int i,ret;
@@ -196,6 +320,29 @@ int __attribute__((section("ota_app_loader_area"))) ota_flash_load_app(void)
 
     ota_flash_read(&ota_boot_bypass_crc, OTAF_2nd_BOOT_FAST_BOOT, 4);
 
+    //crc check only once after upgrade, then trust the verified image cache
+    if(is_encrypt == FALSE && ota_boot_bypass_crc != OTA_FAST_BOOT_MAGIC)
+    {
+        #ifdef OTA_BOOT_TIME_DBG
+        DBG_BOOT_IO_TOGGLE;
+        #endif
+
+        if(ota_flash_vcache_check(partition_num, bank_addr) == FALSE)
+        {
+            ret = ota_flash_verify_app(partition_num, bank_addr);
+
+            if(ret != PPlus_SUCCESS)
+                return ret;
+
+            ota_flash_vcache_save(partition_num, bank_addr);
+        }
+
+        ota_boot_bypass_crc = OTA_FAST_BOOT_MAGIC;
+        #ifdef OTA_BOOT_TIME_DBG
+        DBG_BOOT_IO_TOGGLE;
+        #endif
+    }
+
     for(i = 1; i< partition_num+1; i++)
     {
 //    uint32_t flash_addr;
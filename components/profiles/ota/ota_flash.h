@@ -185,6 +185,29 @@ enum
 
 #define MAX_SECT_SUPPORT  32//16
 
+/*
+    verified image cache, in the tail of 2nd boot sector. Single bank upgrade erases it with boot
+    sector, dual bank upgrade may only erase and rewrite a bank, so dual bank builds also cover the
+    load address, first and last word of every partition. A record is saved after all partitions
+    pass crc check, the loader skips crc check while the record matches the boot sector and the
+    partitions. Several slots in case a write is broken.
+    record: magic, crc16 of boot sector table | crc16 of partition probe << 16 (dual bank only),
+            partition number, crc16 of first 3 words
+*/
+#define OTAF_2nd_BOOT_VCACHE    (OTAF_2nd_BOOTINFO_ADDR + 0xf00)
+#define OTAF_VCACHE_SLOT_NUM    4
+#define OTA_VCACHE_MAGIC        0x7e1f3c5d  //random data
+
+/*
+    resumable OTA record, in the middle of 2nd boot sector. It is kept while START_OTA erases
+    the boot sector and dropped when the new boot sector is written at OTA complete.
+    header: magic, partition number, bank address, bitmap of partitions (bit cleared when verified)
+    entry i: flash address, run address, size, checksum as received | checksum in flash << 16
+*/
+#define OTAF_2nd_BOOT_RESUME    (OTAF_2nd_BOOTINFO_ADDR + 0x800)
+#define OTAF_RESUME_SIZE        (16 + MAX_SECT_SUPPORT*16)
+#define OTA_RESUME_MAGIC        0x4d534552  //"RESM"
+
 
 typedef struct
 {
@@ -213,6 +236,7 @@ int ota_flash_write_partition(uint32 addr, uint32_t* p_sect, uint32_t size);
 int ota_flash_write_boot_sector(uint32_t* p_sect, uint32_t size, uint32_t offset);
 int ota_flash_erase(uint32_t addr);
 int ota_flash_erase_area(uint32_t flash_addr, uint32_t size);
+int ota_flash_read(uint32_t* dest, uint32_t addr, uint32_t size);
 int ota_flash_read_bootsector(uint32_t* bank_addr);
 
 #endif
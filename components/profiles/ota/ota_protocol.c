@@ -47,6 +47,9 @@
 #include "ota_flash.h"
 #include "flash.h"
 #include "crc16.h"
+#ifdef CFG_OTA_LZSS
+    #include "lzss.h"
+#endif
 #include "version.h"
 #include "log.h"
 #include "error.h"
@@ -66,6 +69,10 @@
 #define OTA_BLOCK_BURST_TIMEOUT   1000
 
 
+#if defined(CFG_OTA_RESUME) && defined(CFG_OTA_MESH)
+    #error "CFG_OTA_RESUME is not supported by OTA mesh"
+#endif
+
 #define Bytes2U32(u32val, b) {u32val = ((uint32_t)(b[0]&0xff)) | (((uint32_t)(b[1]&0xff))<<8)| (((uint32_t)(b[2]&0xff))<<16)| (((uint32_t)(b[3]&0xff))<<24);}
 
 #define Bytes2U16(u16val, b) {u16val = ((uint16_t)(b[0]&0xff)) | (((uint16_t)(b[1]&0xff))<<8);}
@@ -141,6 +148,20 @@ typedef struct
 
 
     uint8_t*  partition_buf;
+
+    #ifdef CFG_OTA_LZSS
+    bool        zstream;        //partition data is lzss compressed, decoded to partition_buf
+    uint16_t    zcrc;           //crc of received stream
+    uint16_t    zcrc_retry;
+    lzss_hdr_t  zhdr;
+    lzss_dec_t  zdec;
+    lzss_dec_t  zdec_retry;     //decoder state at block_offset_retry
+    #endif
+
+    #ifdef CFG_OTA_RESUME
+    uint32_t    resume_map;     //bit set: partition is verified in flash
+    uint32_t    resume_ent[4];  //resume entry of current partition
+    #endif
 } ota_context_t;
 
 #define OTA_PBUF_SIZE (16*1024+16)
@@ -408,6 +429,152 @@ static void handle_error(int error)
     }
 }
 
+#ifdef CFG_OTA_RESUME
+static void partition_complete(void);
+
+#define OTA_RESUME_OFFSET   (OTAF_2nd_BOOT_RESUME - OTAF_2nd_BOOTINFO_ADDR)
+
+/*
+    erase boot sector for a new OTA, the resume record of last OTA is kept when
+    it is for the same partition number. The record is loaded to partition buffer
+    before erase and written back with the entries of verified partitions.
+*/
+static void ota_resume_start(uint8_t part_num)
+{
+    uint32_t* rec = (uint32_t*)(s_ota_ctx.partition_buf);
+    uint32_t mask = (part_num >= 32) ? 0xffffffff : ((1u << part_num) - 1);
+    s_ota_ctx.resume_map = 0;
+    ota_flash_read(rec, OTAF_2nd_BOOT_RESUME, OTAF_RESUME_SIZE);
+    hal_flash_erase_sector(OTAF_2nd_BOOTINFO_ADDR);
+
+    //crypto app stores encrypted data, it can not be checked again
+    if(is_encrypt)
+        return;
+
+    if(rec[0] == OTA_RESUME_MAGIC && rec[1] == part_num &&
+            (rec[2] == OTAF_APP_BANK_0_ADDR || rec[2] == OTAF_APP_BANK_1_ADDR))
+    {
+        s_ota_ctx.resume_map = (~rec[3]) & mask;
+        s_ota_ctx.bank_addr = rec[2];
+
+        for(int i = 0; i < MAX_SECT_SUPPORT; i++)
+        {
+            if((s_ota_ctx.resume_map & BIT(i)) == 0)
+                osal_memset(rec + 4 + i*4, 0xff, 16);
+        }
+    }
+    else
+    {
+        osal_memset(rec, 0xff, OTAF_RESUME_SIZE);
+        rec[0] = OTA_RESUME_MAGIC;
+        rec[1] = part_num;
+        rec[2] = s_ota_ctx.bank_addr;
+    }
+
+    rec[3] = ~(s_ota_ctx.resume_map);
+    ota_flash_write_boot_sector(rec, OTAF_RESUME_SIZE, OTA_RESUME_OFFSET);
+    LOG("[OTA resume] %08x\n", s_ota_ctx.resume_map);
+}
+
+//check partition data already in flash against the entry of last OTA
+static bool ota_resume_check(uint8_t idx, ota_part_t* ppart)
+{
+    uint32_t ent[4];
+    uint32_t faddr;
+    uint32_t size = ppart->size;
+
+    if((s_ota_ctx.resume_map & BIT(idx)) == 0)
+        return FALSE;
+
+    ota_flash_read(ent, OTAF_2nd_BOOT_RESUME + 16 + idx*16, 16);
+
+    if(osal_memcmp(ent, s_ota_ctx.resume_ent, 12) == 0 || (uint16_t)ent[3] != (uint16_t)s_ota_ctx.resume_ent[3])
+        return FALSE;
+
+    if(finidv())
+        size -= 4;  //MIC is not stored
+
+    faddr = (ppart->flash_addr == ppart->run_addr) ? ppart->run_addr : ppart->flash_addr + s_ota_ctx.bank_addr;
+    if(ota_flash_read((uint32_t*)(s_ota_ctx.partition_buf), faddr, (size + 3) & ~3) != PPlus_SUCCESS)
+        return FALSE;
+
+    if(crc16(0, (void*)s_ota_ctx.partition_buf, size) != (uint16_t)(ent[3] >> 16))
+        return FALSE;
+
+    ppart->size = size;
+    ppart->checksum = (uint16_t)(ent[3] >> 16);
+    return TRUE;
+}
+
+//partition is programmed and verified, save entry and clear its bit
+static void ota_resume_mark(uint8_t idx, ota_part_t* ppart)
+{
+    uint32_t map;
+
+    if(s_ota_ctx.ota_resource || is_encrypt)
+        return;
+
+    //entry of a partition failed in resume check is not erased, keep it invalid
+    if(s_ota_ctx.resume_map & BIT(idx))
+        return;
+
+    s_ota_ctx.resume_ent[3] |= ((uint32_t)ppart->checksum) << 16;
+    ota_flash_write_boot_sector(s_ota_ctx.resume_ent, 16, OTA_RESUME_OFFSET + 16 + idx*16);
+    s_ota_ctx.resume_map |= BIT(idx);
+    map = ~(s_ota_ctx.resume_map);
+    ota_flash_write_boot_sector(&map, 4, OTA_RESUME_OFFSET + 12);
+}
+
+/*
+    partition shares its first sector with the previous one, the sector is not erased
+    by it. When previous partition is resumed, the rest of the sector must be blank.
+*/
+static bool ota_resume_head_blank(uint32_t flash_addr, uint32_t end)
+{
+    uint32_t buf[8];
+    uint32_t size;
+
+    if(s_ota_ctx.resume_map == 0)
+        return TRUE;
+
+    while(flash_addr < end)
+    {
+        size = (end - flash_addr > sizeof(buf)) ? sizeof(buf) : ((end - flash_addr + 3) & ~3);
+        ota_flash_read(buf, flash_addr, size);
+
+        for(int i = 0; i < size/4; i++)
+        {
+            if(buf[i] != 0xffffffff)
+            {
+                //drop the record, next OTA starts from scratch
+                buf[0] = 0;
+                ota_flash_write_boot_sector(buf, 4, OTA_RESUME_OFFSET);
+                return FALSE;
+            }
+        }
+
+        flash_addr += size;
+    }
+
+    return TRUE;
+}
+
+//start response carries the bitmap of verified partitions, the peer can skip them
+static void response_resume(int err)
+{
+    attHandleValueNoti_t notif;
+    osal_memset(&notif, 0, sizeof(notif));
+    notif.len = 6;
+    notif.value[0] = (uint8_t)err;
+    notif.value[1] = OTA_RSP_START_OTA;
+    notif.value[2] = (uint8_t)(s_ota_ctx.resume_map & 0xff);
+    notif.value[3] = (uint8_t)((s_ota_ctx.resume_map >> 8) & 0xff);
+    notif.value[4] = (uint8_t)((s_ota_ctx.resume_map >> 16) & 0xff);
+    notif.value[5] = (uint8_t)((s_ota_ctx.resume_map >> 24) & 0xff);
+    ota_Notify(&notif);
+}
+#endif
+
 void process_ctrl_cmd(uint8_t* cmdbuf, uint8_t size)
 {
     ota_cmd_t cmd;
@@ -574,7 +741,13 @@ void process_ctrl_cmd(uint8_t* cmdbuf, uint8_t size)
             }
 
             //ret = ota_flash_erase(s_ota_ctx.bank_addr);
+            #ifdef CFG_OTA_RESUME
+            ota_resume_start(s_ota_ctx.part_num);
+            response_resume(ret);
+            break;
+            #else
             hal_flash_erase_sector(OTAF_2nd_BOOTINFO_ADDR);
+            #endif
         }
 
         response(OTA_RSP_START_OTA, ret);
@@ -627,6 +800,20 @@ void process_ctrl_cmd(uint8_t* cmdbuf, uint8_t size)
         s_ota_ctx.block_offset = 0;
         s_ota_ctx.block_offset_retry = 0;
         s_ota_ctx.partition_buf = ota_patition_buffer;
+        #ifdef CFG_OTA_RESUME
+        s_ota_ctx.resume_ent[0] = ppart->flash_addr;
+        s_ota_ctx.resume_ent[1] = ppart->run_addr;
+        s_ota_ctx.resume_ent[2] = ppart->size;
+        s_ota_ctx.resume_ent[3] = (uint32_t)ppart->checksum;
+
+        //partition verified in last OTA, no data needed
+        if(ota_resume_check(idx, ppart))
+        {
+            partition_complete();
+            break;
+        }
+
+        #endif
         osal_memset(ota_patition_buffer, 0xff, OTA_PBUF_SIZE);
         response(OTA_RSP_PARTITION_INFO, PPlus_SUCCESS);
         break;
@@ -845,6 +1032,26 @@ static int write_app_boot_sector(void)
     return PPlus_SUCCESS;
 }
 
+static void partition_complete(void)
+{
+    int ret;
+
+    //case all partition data finished
+    if(s_ota_ctx.current_part+1 == s_ota_ctx.part_num)
+    {
+        if(!s_ota_ctx.ota_resource)
+            ret = write_app_boot_sector();
+
+        s_ota_ctx.ota_state = OTA_ST_COMPLETE;
+        response(OTA_RSP_OTA_COMPLETE,PPlus_SUCCESS);
+    }
+    else
+    {
+        s_ota_ctx.ota_state = OTA_ST_WAIT_PARTITION_INFO;
+        response(OTA_RSP_PARTITION_COMPLETE, PPlus_SUCCESS);
+    }
+}
+
 static void partition_program(void)
 {
     int ret;
@@ -884,6 +1091,15 @@ static void partition_program(void)
         else
         {
             er_addr = (flash_addr & 0xfffff000) +0x1000;//make address 4k align
+            #ifdef CFG_OTA_RESUME
+
+            if(!ota_resume_head_blank(flash_addr, (er_addr < flash_addr + ppart->size) ? er_addr : flash_addr + ppart->size))
+            {
+                handle_error(PPlus_ERR_OTA_BAD_DATA);
+                return;
+            }
+
+            #endif
         }
 
         er_size = flash_addr + ppart->size + 0xfff - er_addr ;
@@ -905,28 +1121,110 @@ static void partition_program(void)
         return;
     }
 
-    //case all partition data finished
-    if(s_ota_ctx.current_part+1 == s_ota_ctx.part_num)
-    {
-        if(!s_ota_ctx.ota_resource)
-            ret = write_app_boot_sector();
+    #ifdef CFG_OTA_RESUME
+    ota_resume_mark(s_ota_ctx.current_part, ppart);
+    #endif
+    partition_complete();
+}
+#endif
+#ifdef CFG_OTA_LZSS
+static int ota_zstream_begin(uint8_t* data, uint8_t size)
+{
+    s_ota_ctx.zstream = FALSE;
 
-        s_ota_ctx.ota_state = OTA_ST_COMPLETE;
-        response(OTA_RSP_OTA_COMPLETE,PPlus_SUCCESS);
-    }
-    else
-    {
-        s_ota_ctx.ota_state = OTA_ST_WAIT_PARTITION_INFO;
-        response(OTA_RSP_PARTITION_COMPLETE, PPlus_SUCCESS);
-    }
+    if(lzss_read_hdr(data, size, &s_ota_ctx.zhdr) != PPlus_SUCCESS)
+        return PPlus_SUCCESS;
+
+    //mic is over the plain image, compressed partition is not supported for crypto app
+    if(is_encrypt || s_ota_ctx.zhdr.raw_size > OTA_PBUF_SIZE)
+        return PPlus_ERR_NOT_SUPPORTED;
+
+    s_ota_ctx.zstream = TRUE;
+    s_ota_ctx.zcrc = 0;
+    lzss_dec_init(&s_ota_ctx.zdec, s_ota_ctx.partition_buf, OTA_PBUF_SIZE);
+    return PPlus_SUCCESS;
+}
+
+static int ota_zstream_data(uint8_t* data, uint8_t size)
+{
+    int ret;
+    uint32_t consumed;
+    uint32_t skip = 0;
+    s_ota_ctx.zcrc = crc16(s_ota_ctx.zcrc, data, size);
+
+    if(s_ota_ctx.block_offset == 0)
+        skip = sizeof(lzss_hdr_t);
+
+    //partition buffer holds the whole partition, so it is never used as ring
+    ret = lzss_decode(&s_ota_ctx.zdec, data + skip, size - skip, s_ota_ctx.zhdr.raw_size - s_ota_ctx.zdec.out, &consumed);
+
+    if(ret)
+        return ret;
+
+    if(consumed != size - skip)
+        return PPlus_ERR_OTA_DATA_SIZE;
+
+    return PPlus_SUCCESS;
+}
+
+//stream is completed, take decoded data as partition data
+static int ota_zstream_end(ota_part_t* ppart)
+{
+    if(s_ota_ctx.zcrc != ppart->checksum)
+        return PPlus_ERR_OTA_CRC;
+
+    if(s_ota_ctx.zdec.out != s_ota_ctx.zhdr.raw_size || s_ota_ctx.zdec.match_len)
+        return PPlus_ERR_OTA_DATA_SIZE;
+
+    ppart->size = s_ota_ctx.zhdr.raw_size;
+    ppart->checksum = (uint16_t)s_ota_ctx.zhdr.raw_crc;
+
+    if(!validate_partition_parameter(ppart))
+        return PPlus_ERR_INVALID_PARAM;
+
+    return PPlus_SUCCESS;
 }
 #endif
+
 static void process_ota_partition_data(uint8_t* data, uint8_t size)
 {
     uint32_t block_offset = s_ota_ctx.block_offset;
     ota_part_t* ppart = NULL;
     ppart = &s_ota_ctx.part[s_ota_ctx.current_part];
-    osal_memcpy(s_ota_ctx.partition_buf + block_offset, data, size);
+    #ifdef CFG_OTA_LZSS
+    int ret;
+
+    if(block_offset + size > ppart->size)
+    {
+        handle_error(PPlus_ERR_OTA_DATA_SIZE);
+        return;
+    }
+
+    if(block_offset == 0)
+    {
+        ret = ota_zstream_begin(data, size);
+
+        if(ret != PPlus_SUCCESS)
+        {
+            handle_error(ret);
+            return;
+        }
+    }
+
+    if(s_ota_ctx.zstream)
+    {
+        ret = ota_zstream_data(data, size);
+
+        if(ret != PPlus_SUCCESS)
+        {
+            handle_error(ret);
+            return;
+        }
+    }
+    else
+    #endif
+        osal_memcpy(s_ota_ctx.partition_buf + block_offset, data, size);
+
     block_offset += size;
     AT_LOG("boff[%d], rty[%d]\n", block_offset,s_ota_ctx.block_offset_retry);
 
@@ -942,6 +1240,10 @@ static void process_ota_partition_data(uint8_t* data, uint8_t size)
     {
         response(OTA_RSP_BLOCK_BURST, PPlus_SUCCESS);
         s_ota_ctx.block_offset_retry = s_ota_ctx.block_offset;
+        #ifdef CFG_OTA_LZSS
+        s_ota_ctx.zdec_retry = s_ota_ctx.zdec;
+        s_ota_ctx.zcrc_retry = s_ota_ctx.zcrc;
+        #endif
         start_timer(OTA_BLOCK_REQ_TIMEOUT);
     }
     else
@@ -952,6 +1254,20 @@ static void process_ota_partition_data(uint8_t* data, uint8_t size)
     if(block_offset == ppart->size)
     {
         stop_timer();
+        #ifdef CFG_OTA_LZSS
+
+        if(s_ota_ctx.zstream)
+        {
+            ret = ota_zstream_end(ppart);
+
+            if(ret != PPlus_SUCCESS)
+            {
+                handle_error(ret);
+                return;
+            }
+        }
+
+        #endif
 
         //cec check
         if(is_encrypt==0)
@@ -1109,6 +1425,11 @@ void otaProtocol_mtu(uint16_t mtu)
 void otaProtocol_TimerEvt(void)
 {
     s_ota_ctx.block_offset = s_ota_ctx.block_offset_retry;
+    #ifdef CFG_OTA_LZSS
+    //rewind decoder to the last acknowledged burst, block_offset 0 restarts the stream
+    s_ota_ctx.zdec = s_ota_ctx.zdec_retry;
+    s_ota_ctx.zcrc = s_ota_ctx.zcrc_retry;
+    #endif
     response(OTA_RSP_BLOCK_BURST, PPlus_ERR_OTA_BAD_DATA);
     LOG("ll_to_hci_pkt_cnt = %d\r\n", conn_param[0].pmCounter.ll_to_hci_pkt_cnt);
     LOG("ll_hci_to_ll_pkt_cnt = %d\r\n", conn_param[0].pmCounter.ll_hci_to_ll_pkt_cnt);
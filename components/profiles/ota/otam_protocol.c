@@ -88,9 +88,11 @@ enum
 
 typedef struct
 {
-    ota_fw_t         fw;
+    uint8_t           part_current;
+    uint32_t          offset;
+    uint32_t          total_offset;
 
-    //data cache for a block transmit
+    //data cache for a block transmit, points to the image in flash shared by all links
     uint32_t          cache_size;
     uint32_t          cache_offset;
     uint8_t           cache_retry;
@@ -107,11 +109,13 @@ typedef struct
     uint16_t            burst_size;
     uint8_t             opcode;
     otam_fw_t           fw;
-    otam_proto_meth_t   method;
+    otam_link_stat_t    stat;
 } otam_proto_ctx_t;
 
 
-static otam_proto_ctx_t s_otap_ctx_t;
+static ota_fw_t s_otam_img;     //firmware image, shared by all links
+static otam_proto_meth_t s_otam_method;
+static otam_proto_ctx_t s_otap_ctx_t[OTAM_LINK_NUM];
 
 static void print_hex (const uint8* data, uint16 len)
 {
@@ -134,26 +138,46 @@ static void print_hex (const uint8* data, uint16 len)
 }
 
 
+//image can be changed only when no link is transmitting it
+static bool otam_img_busy(void)
+{
+    for(uint8_t i = 0; i < OTAM_LINK_NUM; i++)
+    {
+        if(s_otap_ctx_t[i].state >= OTAM_ST_WAIT_STARTED && s_otap_ctx_t[i].state <= OTAM_ST_DATA)
+            return TRUE;
+    }
 
+    return FALSE;
+}
 
-static int otam_proto_ctx_reset(uint8_t st)
+static void otam_link_acked(otam_proto_ctx_t* pctx)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
-    otam_proto_meth_t* method = &(pctx->method);
+    otam_link_stat_t* pstat = &(pctx->stat);
+    uint32_t elapsed = osal_GetSystemClock() - pstat->start_tick;
+    pstat->bytes_acked += pctx->fw.cache_size;
+
+    if(elapsed)
+        pstat->throughput = pstat->bytes_acked * 1000 / elapsed;
+}
+
+static int otam_proto_ctx_reset(uint8_t link, uint8_t st)
+{
+    otam_proto_ctx_t* pctx = &s_otap_ctx_t[link];
+    otam_proto_meth_t* method = &s_otam_method;
     pctx->state = st;
     pctx->opcode = 0;
     memset(&(pctx->fw), 0, sizeof(otam_fw_t));
-    method->clear();
+    method->clear(link);
     return PPlus_SUCCESS;
 }
 
-static void otam_proto_disconnect(void* param)
+static void otam_proto_disconnect(uint8_t link, void* param)
 {
-    otam_proto_ctx_reset(OTAM_ST_DISCONNECT);
+    otam_proto_ctx_reset(link, OTAM_ST_DISCONNECT);
 }
-static void otam_proto_connect(void* param)
+static void otam_proto_connect(uint8_t link, void* param)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
+    otam_proto_ctx_t* pctx = &s_otap_ctx_t[link];
     otam_proto_conn_param_t* pconn =  (otam_proto_conn_param_t*)param;
     pctx->state = OTAM_ST_CONNECTED;
     pctx->mtu_a = pconn->mtu -3;
@@ -180,11 +204,11 @@ static void otam_proto_connect(void* param)
     }
 }
 
-static int send_patition_info(void)
+static int send_patition_info(uint8_t link)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
+    otam_proto_ctx_t* pctx = &s_otap_ctx_t[link];
     otam_fw_t* pfw = &(pctx->fw);
-    otam_proto_meth_t* method = &(pctx->method);
+    otam_proto_meth_t* method = &s_otam_method;
     uint8_t data[20];
 
     if(pctx->state != OTAM_ST_WAIT_STARTED && pctx->state != OTAM_ST_DATA)
@@ -201,7 +225,7 @@ static int send_patition_info(void)
     uint32_t val;
     uint16_t offset = 0;
     uint32_t flash_addr = 0;
-    uint32_t run_addr = pfw->fw.part[pfw->fw.part_current].run_addr;
+    uint32_t run_addr = s_otam_img.part[pfw->part_current].run_addr;
 
     if(run_addr > OTAF_BASE_ADDR && run_addr < OTAF_END_ADDR )
     {
@@ -210,19 +234,19 @@ static int send_patition_info(void)
     else
     {
         //calculate store address in flash
-        for(int i = 0; i<pfw->fw.part_current; i++ )
+        for(int i = 0; i<pfw->part_current; i++ )
         {
-            if(pfw->fw.part[i].run_addr > OTAF_BASE_ADDR && pfw->fw.part[i].run_addr < OTAF_END_ADDR)
+            if(s_otam_img.part[i].run_addr > OTAF_BASE_ADDR && s_otam_img.part[i].run_addr < OTAF_END_ADDR)
                 continue;
 
-            val = pfw->fw.part[i].size +3;
+            val = s_otam_img.part[i].size +3;
             val = val - (val%4);
             flash_addr += val;
         }
     }
 
     data[offset ++] = OTA_CMD_PARTITION_INFO;
-    data[offset ++] = pfw->fw.part_current;
+    data[offset ++] = pfw->part_current;
     val = flash_addr;
     data[offset ++] = (uint8_t)(val&0xff);
     data[offset ++] = (uint8_t)((val>>8)&0xff);
@@ -233,50 +257,50 @@ static int send_patition_info(void)
     data[offset ++] = (uint8_t)((val>>8)&0xff);
     data[offset ++] = (uint8_t)((val>>16)&0xff);
     data[offset ++] = (uint8_t)((val>>24)&0xff);
-    val = pfw->fw.part[pfw->fw.part_current].size;
+    val = s_otam_img.part[pfw->part_current].size;
     data[offset ++] = (uint8_t)(val&0xff);
     data[offset ++] = (uint8_t)((val>>8)&0xff);
     data[offset ++] = (uint8_t)((val>>16)&0xff);
     data[offset ++] = (uint8_t)((val>>24)&0xff);
-    val = (uint32_t)(pfw->fw.part[pfw->fw.part_current].checksum);
+    val = (uint32_t)(s_otam_img.part[pfw->part_current].checksum);
     data[offset ++] = (uint8_t)(val&0xff);
     data[offset ++] = (uint8_t)((val>>8)&0xff);
     pctx->state = OTAM_ST_WAIT_PARTITION_INFO;
     pfw->cache_offset = 0;
     pfw->cache_size = 0;
     pfw->cache_retry = 0;
-    pfw->fw.offset = 0;
-    return method->write_cmd(data, offset, 1000);
+    pfw->offset = 0;
+    return method->write_cmd(link, data, offset, 1000);
 }
 
 
-static int load_data_cache(void)
+static int load_data_cache(uint8_t link)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
+    otam_proto_ctx_t* pctx = &s_otap_ctx_t[link];
     otam_fw_t* pfw = &(pctx->fw);
-    ota_fw_part_t* ppart = &(pfw->fw.part[pfw->fw.part_current]);
+    ota_fw_part_t* ppart = &(s_otam_img.part[pfw->part_current]);
     uint16_t mtu_a = pctx->mtu_a;
     uint32_t size = mtu_a * pctx->burst_size;
 
-    if(pfw->fw.offset + size > ppart->size)
+    if(pfw->offset + size > ppart->size)
     {
-        size = ppart->size - pfw->fw.offset;
+        size = ppart->size - pfw->offset;
     }
 
     //memset(pfw->cache, 0, (ATT_MTU_SIZE-3));
-    pfw->cache = (uint8_t*)(ppart->flash_addr + pfw->fw.offset+OTAFM_FW_OTA_DATA_ADDR);
+    pfw->cache = (uint8_t*)(ppart->flash_addr + pfw->offset+OTAFM_FW_OTA_DATA_ADDR);
     pfw->cache_size = size;
     pfw->cache_offset = 0;
     pfw->cache_retry = 0;
-    pfw->fw.offset += size;
+    pfw->offset += size;
     return PPlus_SUCCESS;
 }
 
-static int send_data(void)
+static int send_data(uint8_t link)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
+    otam_proto_ctx_t* pctx = &s_otap_ctx_t[link];
     otam_fw_t* pfw = &(pctx->fw);
-    otam_proto_meth_t* method = &(pctx->method);
+    otam_proto_meth_t* method = &s_otam_method;
 
     if(!(method->write_data))
         return PPlus_ERR_NOT_REGISTED;
@@ -287,23 +311,33 @@ static int send_data(void)
     int ret = PPlus_SUCCESS;
     uint16_t size = 0;
     uint16_t mtu_a = pctx->mtu_a;
+    uint8_t quota = OTAM_LINK_TX_QUOTA;
 
     while(pfw->cache_size - pfw->cache_offset)
     {
+        //give up tx buffers to other links, continue by OTAP_EVT_DATA_WR_DELAY
+        if(quota == 0)
+        {
+            method->write_data_delay(link, 1);
+            return PPlus_SUCCESS;
+        }
+
         size = mtu_a;
 
         if((pfw->cache_size - pfw->cache_offset) < mtu_a)
             size = pfw->cache_size - pfw->cache_offset;
 
-        ret = method->write_data(pfw->cache + pfw->cache_offset, size);
+        ret = method->write_data(link, pfw->cache + pfw->cache_offset, size);
 
         if(ret != PPlus_SUCCESS)
         {
-            method->write_data_delay(2);
+            method->write_data_delay(link, 2);
             return PPlus_SUCCESS;
         }
 
         pfw->cache_offset += size;
+        pctx->stat.bytes_sent += size;
+        quota--;
     }
 
     return PPlus_SUCCESS;
@@ -313,9 +347,9 @@ void print_version(uint8_t* vinfo)
 {
 }
 
-static void handle_app_notify_event(void* param, uint8_t len)
+static void handle_app_notify_event(uint8_t link, void* param, uint8_t len)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
+    otam_proto_ctx_t* pctx = &s_otap_ctx_t[link];
 
     switch(pctx->opcode)
     {
@@ -331,21 +365,21 @@ static void handle_app_notify_event(void* param, uint8_t len)
     }
 }
 
-static void handle_ota_notify_event(void* param, uint8_t len)
+static void handle_ota_notify_event(uint8_t link, void* param, uint8_t len)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
+    otam_proto_ctx_t* pctx = &s_otap_ctx_t[link];
     otam_fw_t* pfw = &(pctx->fw);
     uint8_t* pnotify = (uint8_t*)param;
-    otam_proto_meth_t* method = &(pctx->method);
+    otam_proto_meth_t* method = &s_otam_method;
     int retval = pnotify[0];
 
     if(len == 1)  //fatal error
     {
-        otam_proto_ctx_reset(OTAM_ST_CONNECTED);
+        otam_proto_ctx_reset(link, OTAM_ST_CONNECTED);
         return;
     }
 
-    LOG("OTA Notif %x, %x\n",pnotify[0],pnotify[1]);
+    LOG("OTA Notif[%d] %x, %x\n",link,pnotify[0],pnotify[1]);
     print_hex(pnotify, len);
 
     switch(pnotify[1]) //response type
@@ -354,7 +388,7 @@ static void handle_ota_notify_event(void* param, uint8_t len)
     {
         if(retval == PPlus_SUCCESS && pctx->state == OTAM_ST_WAIT_STARTED)
         {
-            send_patition_info();
+            send_patition_info(link);
         }
         else
         {
@@ -375,14 +409,16 @@ static void handle_ota_notify_event(void* param, uint8_t len)
     case OTA_RSP_OTA_COMPLETE:
     {
         uint8_t data[20];
+        otam_link_acked(pctx);
+        pctx->stat.end_tick = osal_GetSystemClock();
 
         if(method->write_cmd)
         {
             data[0] = OTA_CMD_REBOOT;
             data[1] = 1;
             pctx->state = OTAM_ST_COMPLETE;
-            LOG("OTA completed!!\n");
-            method->write_cmd(data, 2, 1000);
+            LOG("OTA[%d] completed!! %d B/s\n", link, pctx->stat.throughput);
+            method->write_cmd(link, data, 2, 1000);
         }
 
         break;
@@ -392,21 +428,22 @@ static void handle_ota_notify_event(void* param, uint8_t len)
     {
         pctx->state = OTAM_ST_DATA;
 
-        if(pfw->fw.part_current)
+        if(pfw->part_current)
         {
             LOG(" ");
         }
 
-        load_data_cache();
-        send_data();
+        load_data_cache(link);
+        send_data(link);
         break;
     }
 
     case OTA_RSP_PARTITION_COMPLETE:
     {
-        pfw->fw.total_offset += pfw->cache_size;
-        pfw->fw.part_current ++;
-        send_patition_info();
+        otam_link_acked(pctx);
+        pfw->total_offset += pfw->cache_size;
+        pfw->part_current ++;
+        send_patition_info(link);
         break;
     }
 
@@ -420,22 +457,25 @@ static void handle_ota_notify_event(void* param, uint8_t len)
 
         if(retval == PPlus_SUCCESS)
         {
-            load_data_cache();
-            send_data();
+            otam_link_acked(pctx);
+            pctx->stat.bursts++;
+            load_data_cache(link);
+            send_data(link);
         }
         else if(retval == PPlus_ERR_OTA_BAD_DATA)
         {
-            //case block data is not completed, retry block data
+            //case block data is not completed, retry block data after a back off delay
             pfw->cache_retry++;
             pfw->cache_offset = 0;
+            pctx->stat.retries++;
 
-            if(pfw->cache_retry > 3)
+            if(pfw->cache_retry > OTAM_LINK_RETRY_MAX)
             {
                 pctx->state = OTAM_ST_ERROR;
                 break;
             }
 
-            send_data();
+            method->write_data_delay(link, OTAM_LINK_RETRY_DELAY << (pfw->cache_retry - 1));
         }
         else
         {
@@ -448,7 +488,7 @@ static void handle_ota_notify_event(void* param, uint8_t len)
     case OTA_RSP_REBOOT:
     {
         LOG("[OTA_RSP_REBOOT]GAPCentralRole_TerminateLink\n");
-        GAPCentralRole_TerminateLink(0);
+        GAPCentralRole_TerminateLink(link);
     }
 
     case OTA_RSP_ERASE:
@@ -464,31 +504,37 @@ static void handle_ota_notify_event(void* param, uint8_t len)
 
 void otamProtocol_event(otap_evt_t* pev)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
+    uint8_t link = pev->link;
+    otam_proto_ctx_t* pctx;
+
+    if(link >= OTAM_LINK_NUM)
+        return;
+
+    pctx = &s_otap_ctx_t[link];
 
     switch(pev->ev)
     {
     case OTAP_EVT_DISCONNECTED:
-        otam_proto_disconnect(pev->data);
+        otam_proto_disconnect(link, pev->data);
         break;
 
     case OTAP_EVT_CONNECTED:
-        otam_proto_connect(pev->data);
+        otam_proto_connect(link, pev->data);
         break;
 
     case OTAP_EVT_NOTIFY:
     {
         if(pctx->run_mode == OTAC_RUNMODE_APP)
-            handle_app_notify_event(pev->data, pev->len);
+            handle_app_notify_event(link, pev->data, pev->len);
         else
-            handle_ota_notify_event(pev->data, pev->len);
+            handle_ota_notify_event(link, pev->data, pev->len);
 
         break;
     }
 
     case OTAP_EVT_DATA_WR_DELAY:
     {
-        send_data();
+        send_data(link);
         break;
     }
 
@@ -515,35 +561,38 @@ void otamProtocol_event(otap_evt_t* pev)
 
 int load_fw(uint8_t fw_id)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
-    otam_fw_t* pfw = &(pctx->fw);
+    ota_fw_t* pimg = &s_otam_img;
     uint32_t faddr = fw_id == 0 ? OTAM_FW_DATA_ADDR : OTAM_FW_DATA_ADDR1;
     uint8_t* pdata = (uint8_t*) (faddr);
     uint32_t* pdata32 = (uint32_t*) pdata;
     uint32_t offset = 0;
     LOG("load fw %x\n", faddr);
-    memset((void*)pfw, 0,sizeof(otam_fw_t));
+
+    if(otam_img_busy())
+        return PPlus_ERR_BUSY;
+
+    memset((void*)pimg, 0,sizeof(ota_fw_t));
 
     if(!((char)(pdata[0]) == 'O' && (char)(pdata[1]) == 'T' &&(char)(pdata[2]) == 'A'&&(char)(pdata[3]) == 'F'))
     {
         return PPlus_ERR_INVALID_DATA;
     }
 
-    pfw->fw.part_num = (uint8_t)(pdata32[1]);
-    offset = 2 * 4 + 2 * 4 * pfw->fw.part_num;
-    pfw->fw.total_size = 0;
+    pimg->part_num = (uint8_t)(pdata32[1]);
+    offset = 2 * 4 + 2 * 4 * pimg->part_num;
+    pimg->total_size = 0;
 
-    for (uint8_t i = 0; i < pfw->fw.part_num; i++)
+    for (uint8_t i = 0; i < pimg->part_num; i++)
     {
-        pfw->fw.part[i].run_addr = pdata32[i*2+2];
-        pfw->fw.part[i].size = pdata32[i*2+3];
-        pfw->fw.part[i].flash_addr = faddr + offset;
-        pfw->fw.part[i].checksum = crc16(0, (const volatile void* )(pfw->fw.part[i].flash_addr), pfw->fw.part[i].size);
-        offset += pfw->fw.part[i].size;
-        pfw->fw.total_size += pfw->fw.part[i].size;
+        pimg->part[i].run_addr = pdata32[i*2+2];
+        pimg->part[i].size = pdata32[i*2+3];
+        pimg->part[i].flash_addr = faddr + offset;
+        pimg->part[i].checksum = crc16(0, (const volatile void* )(pimg->part[i].flash_addr), pimg->part[i].size);
+        offset += pimg->part[i].size;
+        pimg->total_size += pimg->part[i].size;
     }
 
-    pfw->fw.total_size += 0;
+    pimg->total_size += 0;
     return PPlus_SUCCESS;
 }
 
@@ -553,16 +602,32 @@ int load_res(void)
 }
 
 
-int otamProtocol_start_ota(ota_fw_t* pffw)
+/*
+    start OTA of one link, pffw is the image to send, NULL for the image loaded by load_fw().
+    all links running at the same time send the same image
+*/
+int otamProtocol_start_ota(uint8_t link, ota_fw_t* pffw)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
-    otam_fw_t* pfw = &(pctx->fw);
-    otam_proto_meth_t* method = &(pctx->method);
+    otam_proto_ctx_t* pctx;
+    otam_fw_t* pfw;
+    otam_proto_meth_t* method = &s_otam_method;
     uint8_t data[20];
-    memcpy(&(pfw->fw), pffw, sizeof(ota_fw_t));
-    pfw->fw.offset = 0;
-    pfw->fw.part_current = 0;
-    pfw->fw.total_offset = 0;
+
+    if(link >= OTAM_LINK_NUM)
+        return PPlus_ERR_INVALID_PARAM;
+
+    pctx = &s_otap_ctx_t[link];
+    pfw = &(pctx->fw);
+
+    if(pffw && pffw != &s_otam_img)
+    {
+        if(otam_img_busy() && memcmp(s_otam_img.part, pffw->part, sizeof(pffw->part)) != 0)
+            return PPlus_ERR_BUSY;
+
+        memcpy(&s_otam_img, pffw, sizeof(ota_fw_t));
+    }
+
+    memset(pfw, 0, sizeof(otam_fw_t));
 
     if(pctx->state < OTAM_ST_CONNECTED)
         return PPlus_ERR_BLE_NOT_READY;
@@ -575,54 +640,66 @@ int otamProtocol_start_ota(ota_fw_t* pffw)
     if(method->write_cmd)
     {
         pctx->state = OTAM_ST_WAIT_STARTED;
-        pfw->fw.part_current = 0;
+        memset(&(pctx->stat), 0, sizeof(otam_link_stat_t));
+        pctx->stat.total_size = s_otam_img.total_size;
+        pctx->stat.start_tick = osal_GetSystemClock();
 
         if(pctx->mtu_a == 20)
         {
             pctx->burst_size = OTA_BURST_SIZE_DEFAULT;
             data[0] = OTA_CMD_START_OTA;
-            data[1] = pfw->fw.part_num;
+            data[1] = s_otam_img.part_num;
             data[2] = 0;
         }
         else
         {
             pctx->burst_size = 0xffff;
             data[0] = OTA_CMD_START_OTA;
-            data[1] = pfw->fw.part_num;
+            data[1] = s_otam_img.part_num;
             data[2] = OTA_BURST_SIZE_HISPEED;
         }
 
-        return method->write_cmd(data, 3, 1000);
+        return method->write_cmd(link, data, 3, 1000);
     }
 
     return PPlus_ERR_NOT_REGISTED;
 }
 
 
-int otamProtocol_stop_ota(void)
+int otamProtocol_stop_ota(uint8_t link)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
-    otam_proto_meth_t* method = &(pctx->method);
+    otam_proto_ctx_t* pctx;
+    otam_proto_meth_t* method = &s_otam_method;
     uint8_t data[20];
 
+    if(link >= OTAM_LINK_NUM)
+        return PPlus_ERR_INVALID_PARAM;
+
+    pctx = &s_otap_ctx_t[link];
+
     if(method->write_cmd)
     {
         data[0] = OTA_CMD_START_OTA;
         data[1] = 0xff;
         data[2] = 0;
         pctx->state = OTAM_ST_CANCELING;
-        return method->write_cmd(data, 3, 1000);
+        return method->write_cmd(link, data, 3, 1000);
     }
 
     return PPlus_ERR_NOT_REGISTED;
 }
 
-int otamProtocol_app_start_ota(uint8_t mode)
+int otamProtocol_app_start_ota(uint8_t link, uint8_t mode)
 {
-    otam_proto_ctx_t* pctx = &s_otap_ctx_t;
-    otam_proto_meth_t* method = &(pctx->method);
+    otam_proto_ctx_t* pctx;
+    otam_proto_meth_t* method = &s_otam_method;
     uint8_t data[20];
 
+    if(link >= OTAM_LINK_NUM)
+        return PPlus_ERR_INVALID_PARAM;
+
+    pctx = &s_otap_ctx_t[link];
+
     if(pctx->run_mode != OTAC_RUNMODE_APP)
         return PPlus_ERR_INVALID_STATE;
 
@@ -634,16 +711,25 @@ int otamProtocol_app_start_ota(uint8_t mode)
         data[0] = OTAAPP_CMD_START_OTA;
         data[1] = mode;
         data[2] = 1;
-        return method->write_cmd(data, 3, 0);
+        return method->write_cmd(link, data, 3, 0);
     }
 
     return PPlus_ERR_NOT_REGISTED;
 }
 
-int otamProtocol_init(otam_proto_meth_t* method)
+int otamProtocol_link_stat(uint8_t link, otam_link_stat_t* pstat)
 {
-    memset(&s_otap_ctx_t, 0, sizeof(s_otap_ctx_t));
-    s_otap_ctx_t.method = *method;
+    if(link >= OTAM_LINK_NUM || pstat == NULL)
+        return PPlus_ERR_INVALID_PARAM;
+
+    *pstat = s_otap_ctx_t[link].stat;
     return PPlus_SUCCESS;
 }
 
+int otamProtocol_init(otam_proto_meth_t* method)
+{
+    memset(s_otap_ctx_t, 0, sizeof(s_otap_ctx_t));
+    memset(&s_otam_img, 0, sizeof(s_otam_img));
+    s_otam_method = *method;
+    return PPlus_SUCCESS;
+}
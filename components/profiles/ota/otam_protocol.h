@@ -40,6 +40,17 @@
 #define OTA_BURST_SIZE_DEFAULT    16
 #define OTA_BURST_SIZE_HISPEED    0xff
 
+//number of slaves upgraded at the same time, link index is the connection handle
+#ifndef OTAM_LINK_NUM
+    #define OTAM_LINK_NUM         4
+#endif
+
+//packets written to one link in a turn, then other links get the chance to write
+#define OTAM_LINK_TX_QUOTA        4
+//retry of a burst, the delay before retry is doubled each time
+#define OTAM_LINK_RETRY_MAX       3
+#define OTAM_LINK_RETRY_DELAY     8   //ms
+
 
 enum
 {
@@ -60,14 +71,27 @@ typedef struct
 typedef struct
 {
     uint8_t   ev;
+    uint8_t   link;
     uint16_t  len;
     void*     data;
 } otap_evt_t;
 
-typedef int (*otam_clear_t)(void);
-typedef int (*otam_wcmd_op_t)(uint8_t* data, uint16_t len, uint32_t timeout);
-typedef int (*otam_wdata_op_t)(uint8_t* data, uint16_t len);
-typedef int (*otam_wdata_delay_t)(uint32_t msec_delay);
+typedef struct
+{
+    uint32_t  bytes_sent;   //include retried data
+    uint32_t  bytes_acked;
+    uint32_t  total_size;
+    uint16_t  bursts;
+    uint16_t  retries;
+    uint32_t  start_tick;   //ms
+    uint32_t  end_tick;     //ms, 0 if not completed
+    uint32_t  throughput;   //bytes per second of acked data
+} otam_link_stat_t;
+
+typedef int (*otam_clear_t)(uint8_t link);
+typedef int (*otam_wcmd_op_t)(uint8_t link, uint8_t* data, uint16_t len, uint32_t timeout);
+typedef int (*otam_wdata_op_t)(uint8_t link, uint8_t* data, uint16_t len);
+typedef int (*otam_wdata_delay_t)(uint8_t link, uint32_t msec_delay);
 
 typedef struct
 {
@@ -80,9 +104,10 @@ typedef struct
 
 
 void otamProtocol_event(otap_evt_t* pev);
-int otamProtocol_start_ota(ota_fw_t* pffw);
-int otamProtocol_stop_ota(void);
-int otamProtocol_app_start_ota(uint8_t mode);
+int otamProtocol_start_ota(uint8_t link, ota_fw_t* pffw);
+int otamProtocol_stop_ota(uint8_t link);
+int otamProtocol_app_start_ota(uint8_t link, uint8_t mode);
+int otamProtocol_link_stat(uint8_t link, otam_link_stat_t* pstat);
 int otamProtocol_init(otam_proto_meth_t* method);
 
 #endif
@@ -39,6 +39,9 @@
 #include "flash.h"
 //#include "common.h"
 #include "crc16.h"
+#ifdef CFG_OTA_LZSS
+    #include "lzss.h"
+#endif
 #include "slb.h"
 #include "log.h"
 
@@ -86,6 +89,13 @@ typedef struct
     uint32_t        ooo_recv_numbers;
     uint32_t        ooo_piece_len;
     slb_chksum_cb_t ccb;
+    #ifdef CFG_OTA_LZSS
+    bool            zstream;    //partition data is lzss compressed
+    uint16_t        zcrc;       //crc of received stream
+    uint32_t        zflushed;   //decoded bytes written to flash
+    lzss_hdr_t      zhdr;
+    lzss_dec_t      zdec;
+    #endif
 } slb_ctx_t;
 
 slb_ctx_t    m_slb_ctx =
@@ -176,24 +186,248 @@ uint16_t slb_flash_calc_checksum(uint32_t addr, uint32_t size)
 //mark the exchange zone as garbage data
 #define SLB_DELETE_EXCHANGE_ZONE()    {uint32_t tmpdata = 0;slb_spif_write(SLB_FLASH_FW_BASE, (uint8_t*)(&tmpdata), 4);}
 
+static bool slb_delta_read_hdr(uint32_t faddr, uint32_t size, slb_delta_hdr_t* phdr)
+{
+    if(size < sizeof(slb_delta_hdr_t))
+        return FALSE;
+
+    slb_spif_read(faddr, (uint8_t*)phdr, sizeof(slb_delta_hdr_t));
+    return (phdr->magic == SLB_DELTA_MAGIC) ? TRUE : FALSE;
+}
+
+//find the partition of running firmware the patch is made against, and check it by crc
+static int slb_delta_find_base(slb_delta_hdr_t* phdr, uint32_t* src_addr)
+{
+    int i;
+    uint32_t part_num = 0;
+    uint32_t part_info[4];
+
+    if(phdr->version != SLB_DELTA_VERSION)
+        return PPlus_ERR_VERSION;
+
+    if((phdr->run_addr & 0xff000000) == OTAF_BASE_ADDR)
+    {
+        //XIP partition is not recorded in boot sector, it is in place
+        *src_addr = phdr->run_addr;
+    }
+    else
+    {
+        *src_addr = 0;
+        slb_spif_read(OTAF_2nd_BOOTINFO_ADDR, (uint8_t*)(&part_num), 4);
+
+        if(part_num == 0 || part_num > OTAF_PARTITION_NUM_MAX)
+            return PPlus_ERR_OTA_NO_APP;
+
+        for(i = 1; i <= part_num; i++)
+        {
+            slb_spif_read(OTAF_2nd_BOOTINFO_ADDR + 0x10*i, (uint8_t*) part_info, 0x10);
+
+            if(part_info[1] == phdr->run_addr && part_info[2] == phdr->src_size)
+            {
+                *src_addr = OTAF_APP_BANK_0_ADDR + part_info[0];
+                break;
+            }
+        }
+
+        if(*src_addr == 0)
+            return PPlus_ERR_NOT_FOUND;
+    }
+
+    if(slb_flash_calc_checksum(*src_addr, phdr->src_size) != (uint16_t)phdr->src_crc)
+        return PPlus_ERR_OTA_CRC;
+
+    return PPlus_SUCCESS;
+}
+
 #ifdef ON_SLB_BOOTLOADER
 
 static int slb_erase_fw(void)
 {
     return ota_flash_erase(OTAF_APP_BANK_0_ADDR);
 }
+//expand delta partition into s_partition_buf, the base partition is read from flash directly
+static int slb_delta_expand(uint32_t* part_info, uint32_t* dst_size, uint32_t* dst_crc)
+{
+    int ret;
+    slb_delta_hdr_t hdr;
+    uint32_t op[2];
+    uint32_t src_addr;
+    uint32_t len;
+    uint32_t out = 0;
+    uint32_t pdata = SLB_FLASH_PART_DATA_BASE + part_info[0];
+    uint32_t offset = sizeof(slb_delta_hdr_t);
+
+    if(slb_flash_calc_checksum(pdata, part_info[2]) != (uint16_t)part_info[3])
+        return PPlus_ERR_OTA_CRC;
+
+    slb_delta_read_hdr(pdata, part_info[2], &hdr);
+
+    if(hdr.run_addr != part_info[1] || hdr.dst_size > sizeof(s_partition_buf) - 16)
+        return PPlus_ERR_INVALID_DATA;
+
+    ret = slb_delta_find_base(&hdr, &src_addr);
+
+    if(ret)
+        return ret;
+
+    while(offset + 8 <= part_info[2])
+    {
+        slb_spif_read(pdata + offset, (uint8_t*) op, 8);
+        offset += 8;
+        len = op[0] & SLB_DELTA_OP_LEN_MASK;
+
+        if(out + len > hdr.dst_size)
+            return PPlus_ERR_INVALID_DATA;
+
+        switch(op[0] >> 24)
+        {
+        case SLB_DELTA_OP_COPY:
+            if(op[1] + len > hdr.src_size)
+                return PPlus_ERR_INVALID_DATA;
+
+            slb_spif_read(src_addr + op[1], s_partition_buf + out, len);
+            break;
+
+        case SLB_DELTA_OP_INSERT:
+            if(offset + len > part_info[2])
+                return PPlus_ERR_INVALID_DATA;
+
+            slb_spif_read(pdata + offset, s_partition_buf + out, len);
+            offset += (len + 3) & 0xfffffffc;
+            break;
+
+        default:
+            return PPlus_ERR_INVALID_DATA;
+        }
+
+        out += len;
+    }
+
+    if(out != hdr.dst_size)
+        return PPlus_ERR_INVALID_DATA;
+
+    if(crc16(0, (const volatile void*)s_partition_buf, out) != (uint16_t)hdr.dst_crc)
+        return PPlus_ERR_OTA_CRC;
+
+    *dst_size = out;
+    *dst_crc = hdr.dst_crc;
+    return PPlus_SUCCESS;
+}
+
+/*
+    expand all delta partitions to staging area, must be done before the old firmware is erased.
+    the staging area is right after the partition data, so it can be found again after power lost.
+    stage_base is 0 if there is no delta partition
+*/
+static int slb_delta_stage(uint32_t part_num, uint32_t* stage_base)
+{
+    int i, ret;
+    uint32_t part_info[4];
+    uint32_t entry[4];
+    uint32_t value = 0;
+    uint32_t stage_offset = 0;
+    slb_delta_hdr_t hdr;
+    bool has_delta = FALSE;
+    *stage_base = 0;
+
+    for(i = 1; i< part_num; i++)
+    {
+        slb_spif_read(SLB_FLASH_FW_PART_FADDR(i), (uint8_t*) part_info, 0x10);
+
+        if(slb_delta_read_hdr(SLB_FLASH_PART_DATA_BASE + part_info[0], part_info[2], &hdr))
+            has_delta = TRUE;
+
+        if(part_info[0] + part_info[2] > stage_offset)
+            stage_offset = part_info[0] + part_info[2];
+    }
+
+    if(!has_delta)
+        return PPlus_SUCCESS;
+
+    *stage_base = (SLB_FLASH_PART_DATA_BASE + stage_offset + 0xfff) & 0xfffff000;
+    slb_spif_read(SLB_FLASH_FW_DELTA_ST, (uint8_t*)(&value), 4);
+
+    if(value == SLB_DELTA_STAGED_MAGIC)
+        return PPlus_SUCCESS;
+
+    //staging was not completed, restart it, the old firmware is still there
+    slb_spif_erase(*stage_base, SLB_FLASH_STAGE_DATA_OFFSET);
+    stage_offset = *stage_base + SLB_FLASH_STAGE_DATA_OFFSET - SLB_FLASH_PART_DATA_BASE;
+
+    for(i = 1; i< part_num; i++)
+    {
+        slb_spif_read(SLB_FLASH_FW_PART_FADDR(i), (uint8_t*) part_info, 0x10);
+
+        if(!slb_delta_read_hdr(SLB_FLASH_PART_DATA_BASE + part_info[0], part_info[2], &hdr))
+            continue;
+
+        ret = slb_delta_expand(part_info, &entry[2], &entry[3]);
+
+        if(ret)
+            return ret;
+
+        if(SLB_FLASH_PART_DATA_BASE + stage_offset + entry[2] > SLB_EXCH_AREA_BASE + SLB_EXCH_AREA_SIZE)
+            return PPlus_ERR_DATA_SIZE;
+
+        entry[0] = stage_offset;
+        entry[1] = part_info[1];
+        slb_spif_erase(SLB_FLASH_PART_DATA_BASE + stage_offset, entry[2]);
+        ret = slb_spif_write(SLB_FLASH_PART_DATA_BASE + stage_offset, (uint8_t*)s_partition_buf, entry[2]);
+
+        if(ret)
+            return ret;
+
+        ret = slb_spif_write(SLB_FLASH_STAGE_FADDR(*stage_base, i), (uint8_t*) entry, 0x10);
+
+        if(ret)
+            return ret;
+
+        stage_offset += (entry[2] + 0xfff) & 0xfffff000;
+    }
+
+    value = SLB_DELTA_STAGED_MAGIC;
+    return slb_spif_write(SLB_FLASH_FW_DELTA_ST, (uint8_t*)(&value), 4);
+}
+
+//read partition information, delta partition is replaced by its expanded data in staging area
+static void slb_read_part_info(uint32_t stage_base, int idx, uint32_t* part_info)
+{
+    uint32_t entry[4];
+    slb_spif_read(SLB_FLASH_FW_PART_FADDR(idx), (uint8_t*) part_info, 0x10);
+
+    if(stage_base == 0 || idx == 0)
+        return;
+
+    slb_spif_read(SLB_FLASH_STAGE_FADDR(stage_base, idx), (uint8_t*) entry, 0x10);
+
+    if(entry[0] != 0xffffffff)
+    {
+        part_info[0] = entry[0];
+        part_info[2] = entry[2];
+        part_info[3] = entry[3];
+    }
+}
+
 static int slb_apply_exch_zone_to_fw(uint32_t part_num)
 {
-    int i;
+    int i, ret;
     uint32_t part_info[4];
     uint32_t flash_offset = 0;
     uint32_t ram_part_idx = 0;
+    uint32_t stage_base = 0;
+    ret = slb_delta_stage(part_num, &stage_base);
+
+    if(ret != PPlus_SUCCESS)
+    {
+        SLB_DELETE_EXCHANGE_ZONE();
+        return ret;
+    }
 
     //validate partition
     for(i = 1; i< part_num; i++)
     {
         uint32_t crc = 0;
-        slb_spif_read(SLB_FLASH_FW_PART_FADDR(i), (uint8_t*) part_info, 0x10);
+        slb_read_part_info(stage_base, i, part_info);
         slb_spif_read(SLB_FLASH_PART_DATA_BASE + part_info[0], (uint8_t*)s_partition_buf, part_info[2]);
         crc = (uint32_t)crc16(0, (const volatile void*)s_partition_buf, part_info[2]);
 
@@ -209,7 +443,7 @@ static int slb_apply_exch_zone_to_fw(uint32_t part_num)
 
     for(i = 0; i< part_num; i++)
     {
-        slb_spif_read(SLB_FLASH_FW_PART_FADDR(i), (uint8_t*) part_info, 0x10);
+        slb_read_part_info(stage_base, i, part_info);
         slb_spif_read(SLB_FLASH_PART_DATA_BASE + part_info[0], (uint8_t*)s_partition_buf, part_info[2]);
         //LOG("part_num:%d,fladdr:%x,size:%x,crc:%x \n",i,part_info[1],part_info[2],part_info[3]);
 
@@ -452,20 +686,123 @@ int slb_upgrade_partition_info(uint32_t runaddr, uint32_t len, uint16_t crc, boo
     value = ppart->run_addr;
     ret = slb_spif_write(SLB_FLASH_FW_PART_RADDR(m_slb_ctx.part_num-1), (uint8_t*) (&value), 4);
     SLB_ASSERT(ret);
-    value = ppart->size;
-    ret = slb_spif_write(SLB_FLASH_FW_PART_SIZE(m_slb_ctx.part_num-1), (uint8_t*) (&value), 4);
-    SLB_ASSERT(ret);
-    value = (uint32_t)ppart->checksum;
-    ret = slb_spif_write(SLB_FLASH_FW_PART_CHKSUM(m_slb_ctx.part_num-1), (uint8_t*) (&value), 4);
-    SLB_ASSERT(ret);
+    //size and checksum are written when partition data is completed, the stored data may be decoded
     m_slb_ctx.state = SLB_PROG_ST_PART_DATA;
     return PPlus_SUCCESS;
 }
 
+#ifdef CFG_OTA_LZSS
+//decode ring: window of history plus the bytes not yet written to flash
+#define SLB_LZSS_RING_SIZE  (LZSS_WINDOW_SIZE*2)
+#define SLB_LZSS_FLUSH_SIZE 256
+static uint8_t slb_lzss_ring[SLB_LZSS_RING_SIZE];
+
+static int slb_zstream_begin(uint8_t* data, uint32_t len)
+{
+    m_slb_ctx.zstream = FALSE;
+
+    if(lzss_read_hdr(data, len, &m_slb_ctx.zhdr) != PPlus_SUCCESS)
+        return PPlus_SUCCESS;
+
+    if(SLB_FLASH_PART_DATA_BASE + m_slb_ctx.flash_offset + m_slb_ctx.zhdr.raw_size > SLB_EXCH_AREA_BASE + SLB_EXCH_AREA_SIZE)
+        return PPlus_ERR_DATA_SIZE;
+
+    m_slb_ctx.zstream = TRUE;
+    m_slb_ctx.zcrc = 0;
+    m_slb_ctx.zflushed = 0;
+    lzss_dec_init(&m_slb_ctx.zdec, slb_lzss_ring, SLB_LZSS_RING_SIZE);
+    return PPlus_SUCCESS;
+}
+
+static int slb_zstream_flush(bool final)
+{
+    int ret;
+    uint32_t size;
+
+    while(m_slb_ctx.zdec.out - m_slb_ctx.zflushed >= SLB_LZSS_FLUSH_SIZE || (final && m_slb_ctx.zdec.out > m_slb_ctx.zflushed))
+    {
+        size = m_slb_ctx.zdec.out - m_slb_ctx.zflushed;
+
+        if(size > SLB_LZSS_FLUSH_SIZE)
+            size = SLB_LZSS_FLUSH_SIZE;
+
+        if(m_slb_ctx.zflushed + size > m_slb_ctx.zhdr.raw_size)
+            return PPlus_ERR_DATA_SIZE;
+
+        ret = slb_spif_write(SLB_FLASH_PART_DATA_BASE + m_slb_ctx.flash_offset + m_slb_ctx.zflushed,
+                             slb_lzss_ring + (m_slb_ctx.zflushed % SLB_LZSS_RING_SIZE), size);
+
+        if(ret)
+            return ret;
+
+        m_slb_ctx.zflushed += size;
+    }
+
+    return PPlus_SUCCESS;
+}
+
+static int slb_zstream_data(uint8_t* data, uint32_t len)
+{
+    int ret;
+    uint32_t consumed;
+    uint32_t out_max;
+    m_slb_ctx.zcrc = crc16(m_slb_ctx.zcrc, data, len);
+
+    //header is always in the first piece of data
+    if(m_slb_ctx.offset == 0)
+    {
+        data += sizeof(lzss_hdr_t);
+        len -= sizeof(lzss_hdr_t);
+    }
+
+    //a match may still have bytes to output when input is used up
+    while(len || m_slb_ctx.zdec.match_len)
+    {
+        out_max = SLB_LZSS_RING_SIZE - LZSS_WINDOW_SIZE - (m_slb_ctx.zdec.out - m_slb_ctx.zflushed);
+        ret = lzss_decode(&m_slb_ctx.zdec, data, len, out_max, &consumed);
+
+        if(ret)
+            return ret;
+
+        data += consumed;
+        len -= consumed;
+        ret = slb_zstream_flush(FALSE);
+
+        if(ret)
+            return ret;
+    }
+
+    return PPlus_SUCCESS;
+}
+
+//all stream is received, check it and take decoded data as partition data
+static int slb_zstream_end(ota_fw_part_t* ppart)
+{
+    int ret;
+
+    if(m_slb_ctx.zcrc != ppart->checksum)
+        return PPlus_ERR_OTA_CRC;
+
+    ret = slb_zstream_flush(TRUE);
+
+    if(ret)
+        return ret;
+
+    if(m_slb_ctx.zflushed != m_slb_ctx.zhdr.raw_size)
+        return PPlus_ERR_OTA_DATA_SIZE;
+
+    ppart->size = m_slb_ctx.zhdr.raw_size;
+    ppart->checksum = (uint16_t)m_slb_ctx.zhdr.raw_crc;
+    return PPlus_SUCCESS;
+}
+#endif
+
 // partition data storing should be as stream, auto seek
 stream_st_t slb_upgrade_partition_data(uint8_t* data, uint32_t len)
 {
     int ret;
+    uint32_t value;
+    slb_delta_hdr_t hdr;
     ota_fw_part_t* ppart = &(m_slb_ctx.part);
 
     if( m_slb_ctx.state != SLB_PROG_ST_PART_DATA)
@@ -474,7 +811,21 @@ stream_st_t slb_upgrade_partition_data(uint8_t* data, uint32_t len)
     if(m_slb_ctx.offset + len > ppart->size)
         SLB_ASSERT(SLB_SST_ERROR);
 
-    ret = slb_spif_write(SLB_FLASH_PART_DATA_BASE + m_slb_ctx.flash_offset + m_slb_ctx.offset, data, len);
+    #ifdef CFG_OTA_LZSS
+
+    if(m_slb_ctx.offset == 0)
+    {
+        ret = slb_zstream_begin(data, len);
+
+        if(ret)
+            SLB_ASSERT(SLB_SST_ERROR);
+    }
+
+    if(m_slb_ctx.zstream)
+        ret = slb_zstream_data(data, len);
+    else
+    #endif
+        ret = slb_spif_write(SLB_FLASH_PART_DATA_BASE + m_slb_ctx.flash_offset + m_slb_ctx.offset, data, len);
 
     if(ret)
         SLB_ASSERT(SLB_SST_ERROR);
@@ -483,6 +834,12 @@ stream_st_t slb_upgrade_partition_data(uint8_t* data, uint32_t len)
 
     if(m_slb_ctx.offset == ppart->size)
     {
+        #ifdef CFG_OTA_LZSS
+
+        if(m_slb_ctx.zstream && slb_zstream_end(ppart) != PPlus_SUCCESS)
+            SLB_ASSERT(SLB_SST_ERROR);
+
+        #endif
         uint16_t crc = slb_flash_calc_checksum(SLB_FLASH_PART_DATA_BASE + m_slb_ctx.flash_offset, ppart->size);
 
         if(crc != ppart->checksum)
@@ -490,6 +847,27 @@ stream_st_t slb_upgrade_partition_data(uint8_t* data, uint32_t len)
             SLB_ASSERT(SLB_SST_ERROR);
         }
 
+        //reject a patch that is not made against the running firmware before reboot
+        if(slb_delta_read_hdr(SLB_FLASH_PART_DATA_BASE + m_slb_ctx.flash_offset, ppart->size, &hdr))
+        {
+            uint32_t src_addr;
+
+            if(hdr.run_addr != ppart->run_addr || slb_delta_find_base(&hdr, &src_addr) != PPlus_SUCCESS)
+                SLB_ASSERT(SLB_SST_ERROR);
+        }
+
+        value = ppart->size;
+        ret = slb_spif_write(SLB_FLASH_FW_PART_SIZE(m_slb_ctx.part_num-1), (uint8_t*) (&value), 4);
+
+        if(ret)
+            SLB_ASSERT(SLB_SST_ERROR);
+
+        value = (uint32_t)ppart->checksum;
+        ret = slb_spif_write(SLB_FLASH_FW_PART_CHKSUM(m_slb_ctx.part_num-1), (uint8_t*) (&value), 4);
+
+        if(ret)
+            SLB_ASSERT(SLB_SST_ERROR);
+
         m_slb_ctx.flash_offset += (ppart->size + 4) & 0xfffffffc;
         m_slb_ctx.part_num --;
         m_slb_ctx.state = SLB_PROG_ST_PART_INFO;
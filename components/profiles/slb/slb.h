@@ -40,6 +40,34 @@ enum
 
 #define SLB_FLASH_PART_DATA_BASE    (SLB_EXCH_AREA_BASE + 0x1000)
 
+/*
+    delta partition:
+    a partition whose data starts with SLB_DELTA_MAGIC is a patch against the partition
+    of the running firmware that has the same run address. The patch is transferred and
+    checked (crc of the patch itself) like a normal partition, the bootloader expands it
+    into the staging area of exchange zone before the old firmware is erased.
+
+    patch layout (little endian, word aligned):
+    slb_delta_hdr_t
+    op word0: [31:24] op code, [23:0] length
+    op word1: source offset(SLB_DELTA_OP_COPY), unused(SLB_DELTA_OP_INSERT)
+    SLB_DELTA_OP_INSERT is followed by length bytes of data, padded to word
+*/
+#define SLB_DELTA_MAGIC             0x44424c53  //"SLBD"
+#define SLB_DELTA_VERSION           1
+#define SLB_DELTA_STAGED_MAGIC      0x53544744  //"DGTS", delta partitions are expanded
+
+#define SLB_DELTA_OP_COPY           1
+#define SLB_DELTA_OP_INSERT         2
+#define SLB_DELTA_OP_LEN_MASK       0x00ffffff
+
+//staged state of delta partitions, word 2 of exchange zone head is not used by full image
+#define SLB_FLASH_FW_DELTA_ST       (SLB_EXCH_AREA_BASE+8)
+
+//staging area: first sector is the table of expanded partitions, data follows sector by sector
+#define SLB_FLASH_STAGE_FADDR(base, n)  ((base) + 0x10*(n))
+#define SLB_FLASH_STAGE_DATA_OFFSET     0x1000
+
 #define SLB_FLASH_CACHE_ENTER_BYPASS_SECTION()  do{ \
         AP_CACHE->CTRL0 = 0x02; \
         AP_PCR->CACHE_RST = 0x02;\
@@ -73,6 +101,18 @@ typedef struct
     uint32_t  hwver;
 } slb_fwinfo_t;
 
+typedef struct
+{
+    uint32_t  magic;
+    uint32_t  version;
+    uint32_t  run_addr;     //run address of partition, used to find the base partition
+    uint32_t  src_size;     //size of the base partition
+    uint32_t  src_crc;      //crc16 of the base partition
+    uint32_t  dst_size;     //size of the partition after patching
+    uint32_t  dst_crc;      //crc16 of the partition after patching
+    uint32_t  reserved;
+} slb_delta_hdr_t;
+
 typedef int (*slb_chksum_cb_t)(uint8_t* data, uint32_t len);
 
 
@@ -0,0 +1,130 @@
+#! /usr/bin/env python3
+'''
+slb delta partition generator
+
+make a patch of one partition against the same partition of the firmware running on
+device. The patch replaces the partition binary in OTA package, it is transferred by
+slb_upgrade_partition_info/slb_upgrade_partition_data as a normal partition and expanded
+by slboot before the old firmware is erased. See slb.h for the layout.
+
+usage:
+    slb_delta.py old.bin new.bin run_addr out.bin
+'''
+import struct
+import sys
+
+SLB_DELTA_MAGIC = 0x44424c53
+SLB_DELTA_VERSION = 1
+SLB_DELTA_OP_COPY = 1
+SLB_DELTA_OP_INSERT = 2
+SLB_DELTA_OP_LEN_MASK = 0x00ffffff
+
+HASH_LEN = 8            # length of the index key
+MIN_COPY = 16           # a copy op costs 8 bytes, shorter matches are inserted
+MAX_CANDIDATES = 32
+
+
+def crc16(data, seed=0):
+    # same as crc16() of components/libraries/crc16, reflected poly 0xA001
+    crc = seed
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def build_index(old):
+    index = {}
+    for i in range(len(old) - HASH_LEN + 1):
+        lst = index.setdefault(old[i:i + HASH_LEN], [])
+        if len(lst) < MAX_CANDIDATES:
+            lst.append(i)
+    return index
+
+
+def diff(old, new):
+    index = build_index(old)
+    ops = []
+    pending = bytearray()
+    i = 0
+
+    def flush():
+        if pending:
+            ops.append((SLB_DELTA_OP_INSERT, 0, bytes(pending)))
+            pending.clear()
+
+    while i < len(new):
+        best_len, best_pos = 0, 0
+        for pos in index.get(new[i:i + HASH_LEN], ()):
+            n = 0
+            limit = min(len(old) - pos, len(new) - i, SLB_DELTA_OP_LEN_MASK)
+            while n < limit and old[pos + n] == new[i + n]:
+                n += 1
+            if n > best_len:
+                best_len, best_pos = n, pos
+        if best_len >= MIN_COPY:
+            flush()
+            ops.append((SLB_DELTA_OP_COPY, best_pos, best_len))
+            i += best_len
+        else:
+            pending.append(new[i])
+            i += 1
+    flush()
+    return ops
+
+
+def encode(old, new, run_addr, ops):
+    out = bytearray(struct.pack('<8I', SLB_DELTA_MAGIC, SLB_DELTA_VERSION, run_addr,
+                                len(old), crc16(old), len(new), crc16(new), 0xffffffff))
+    for op, arg, data in ops:
+        if op == SLB_DELTA_OP_COPY:
+            out += struct.pack('<2I', (op << 24) | data, arg)
+        else:
+            out += struct.pack('<2I', (op << 24) | len(data), 0)
+            out += data + b'\xff' * (-len(data) & 3)
+    return bytes(out)
+
+
+def apply(old, patch):
+    # same as slb_delta_expand() of slb.c, used to verify the output
+    magic, ver, run_addr, src_size, src_crc, dst_size, dst_crc, _ = struct.unpack_from('<8I', patch)
+    assert magic == SLB_DELTA_MAGIC and src_size == len(old) and src_crc == crc16(old)
+    out = bytearray()
+    off = 32
+    while off + 8 <= len(patch):
+        w0, w1 = struct.unpack_from('<2I', patch, off)
+        off += 8
+        n = w0 & SLB_DELTA_OP_LEN_MASK
+        if w0 >> 24 == SLB_DELTA_OP_COPY:
+            out += old[w1:w1 + n]
+        else:
+            out += patch[off:off + n]
+            off += (n + 3) & ~3
+    assert len(out) == dst_size and crc16(out) == dst_crc
+    return bytes(out)
+
+
+def main(argv):
+    if len(argv) != 5:
+        print(__doc__)
+        return 1
+    old = open(argv[1], 'rb').read()
+    new = open(argv[2], 'rb').read()
+    run_addr = int(argv[3], 0)
+    patch = encode(old, new, run_addr, diff(old, new))
+    if apply(old, patch) != new:
+        print('patch verify failed')
+        return 1
+    print('old %d bytes, new %d bytes, patch %d bytes (%.1f%%)'
+          % (len(old), len(new), len(patch), 100.0 * len(patch) / max(len(new), 1)))
+    if len(patch) >= len(new):
+        # slboot expands the patch in the partition buffer, never send a patch bigger than the image
+        print('patch is not smaller than the new partition, send the full partition instead')
+        return 1
+    open(argv[4], 'wb').write(patch)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,141 @@
+#! /usr/bin/env python3
+'''
+lzss packer for OTA partition
+
+compress one partition binary to the stream of components/libraries/lzss (see lzss.h).
+The output replaces the partition binary in OTA package: partition size and checksum
+sent to device are the size and crc16 of the packed file, the header carries the size
+and crc16 of the plain partition. Firmware must be built with CFG_OTA_LZSS.
+
+usage:
+    slb_pack.py in.bin out.bin
+    slb_pack.py --bench in.bin [in.bin ...]
+'''
+import struct
+import sys
+import time
+
+LZSS_MAGIC = 0x5a424c53
+LZSS_WINDOW_SIZE = 1024
+LZSS_MATCH_MIN = 3
+LZSS_MATCH_MAX = LZSS_MATCH_MIN + 0x3f
+MAX_CHAIN = 256
+
+
+def crc16(data, seed=0):
+    # same as crc16() of components/libraries/crc16, reflected poly 0xA001
+    crc = seed
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def longest_match(data, i, chains):
+    best_len, best_off = 0, 0
+    limit = min(LZSS_MATCH_MAX, len(data) - i)
+    for pos in reversed(chains.get(data[i:i + LZSS_MATCH_MIN], ())[-MAX_CHAIN:]):
+        if i - pos > LZSS_WINDOW_SIZE:
+            break
+        n = 0
+        while n < limit and data[pos + n] == data[i + n]:
+            n += 1
+        if n > best_len:
+            best_len, best_off = n, i - pos
+            if n == limit:
+                break
+    return best_len, best_off
+
+
+def compress(data):
+    out = bytearray()
+    chains = {}
+    items = []
+    i = 0
+
+    def index(pos):
+        if pos + LZSS_MATCH_MIN <= len(data):
+            chains.setdefault(data[pos:pos + LZSS_MATCH_MIN], []).append(pos)
+
+    while i < len(data):
+        n, off = longest_match(data, i, chains)
+        if n >= LZSS_MATCH_MIN:
+            o = off - 1
+            items.append(bytes(((o & 0xff), ((o >> 8) << 6) | (n - LZSS_MATCH_MIN))))
+            for k in range(n):
+                index(i + k)
+            i += n
+        else:
+            items.append(data[i:i + 1])
+            index(i)
+            i += 1
+    for k in range(0, len(items), 8):
+        group = items[k:k + 8]
+        flags = 0
+        for bit, item in enumerate(group):
+            if len(item) == 1:
+                flags |= 1 << bit
+        out.append(flags)
+        for item in group:
+            out += item
+    return struct.pack('<4I', LZSS_MAGIC, len(data), crc16(data), 0xffffffff) + bytes(out)
+
+
+def decompress(stream):
+    # same as lzss_decode() of lzss.c
+    magic, raw_size, raw_crc, _ = struct.unpack_from('<4I', stream)
+    assert magic == LZSS_MAGIC
+    out = bytearray()
+    i = 16
+    while i < len(stream):
+        flags = stream[i]
+        i += 1
+        for bit in range(8):
+            if i >= len(stream):
+                break
+            if flags & (1 << bit):
+                out.append(stream[i])
+                i += 1
+            else:
+                off = (stream[i] | ((stream[i + 1] >> 6) << 8)) + 1
+                n = (stream[i + 1] & 0x3f) + LZSS_MATCH_MIN
+                i += 2
+                for _ in range(n):
+                    out.append(out[-off])
+    assert len(out) == raw_size and crc16(out) == raw_crc
+    return bytes(out)
+
+
+def bench(files):
+    print('%-32s %8s %8s %7s %8s' % ('file', 'raw', 'packed', 'ratio', 'pack(s)'))
+    for name in files:
+        data = open(name, 'rb').read()
+        t = time.perf_counter()
+        packed = compress(data)
+        t = time.perf_counter() - t
+        assert decompress(packed) == data
+        print('%-32s %8d %8d %6.1f%% %8.2f' % (name[-32:], len(data), len(packed),
+                                             100.0 * len(packed) / max(len(data), 1), t))
+
+
+def main(argv):
+    if len(argv) >= 3 and argv[1] == '--bench':
+        bench(argv[2:])
+        return 0
+    if len(argv) != 3:
+        print(__doc__)
+        return 1
+    data = open(argv[1], 'rb').read()
+    packed = compress(data)
+    if decompress(packed) != data:
+        print('pack verify failed')
+        return 1
+    print('raw %d bytes, packed %d bytes (%.1f%%), packed crc16 0x%04x'
+          % (len(data), len(packed), 100.0 * len(packed) / max(len(data), 1), crc16(packed)))
+    open(argv[2], 'wb').write(packed)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
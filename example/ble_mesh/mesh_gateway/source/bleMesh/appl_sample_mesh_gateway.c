@@ -11,11 +11,13 @@
 #include "ltrn_extern.h"
 #include "net_extern.h"
 #include "vendormodel_client.h"
+#include "vendormodel_bulk.h"
 
 #include "flash.h"
 #include "ll_def.h"
 #include "ll_enc.h"
 #include "EXT_cbtimer.h"
+#include "clock.h"
 
 
 #undef USE_HSL                 // enable Light HSL server model
@@ -49,7 +51,22 @@ MS_NET_ADDR     ui_raw_data_destnation_address;
 
 
 #define VENDOR_PRODUCT_MAC_ADDR         0x4000
-#define PROCFG_COMPLETE_TIMEOUT         10
+
+/* Commissioning pipeline */
+#define UI_CFG_PIPELINE_DEPTH           4
+#define UI_CFG_TICK_MS                  100
+#define UI_CFG_RSP_TIMEOUT_MS           2000
+#define UI_CFG_RSP_GUARD_MS             1000
+#define UI_CFG_BACKOFF_BASE_MS          500
+#define UI_CFG_MAX_RETRY                3
+#define UI_CFG_NONE                     0xFF
+
+/* Commissioning pipeline node states */
+#define UI_CFG_STATE_FREE               0x00
+#define UI_CFG_STATE_COMPDATA           0x01
+#define UI_CFG_STATE_APPKEY             0x02
+#define UI_CFG_STATE_BIND               0x03
+#define UI_CFG_STATE_RESET              0x04
 
 
 #define UI_PROV_START_ADDRESS           0x0002
@@ -177,8 +194,68 @@ DECL_STATIC UCHAR UI_device_uuid[MS_DEVICE_UUID_SIZE] = UI_DEVICE_UUID;
 /* Configuration Client Model Handle */
 MS_ACCESS_MODEL_HANDLE   UI_config_client_model_handle;
 
-/* Provsion timeout handle */
-DECL_STATIC EM_timer_handle procfg_timer_handle;
+/** Per node commissioning state */
+typedef struct _UI_CFG_NODE
+{
+    /** Primary element address of the node */
+    MS_NET_ADDR uaddr;
+
+    /** Configuration stage to run next, UI_CFG_STATE_FREE if unused */
+    UCHAR state;
+
+    /** Failed attempts at the current stage */
+    UCHAR retry;
+
+    /** Backoff left before the stage is sent again */
+    UINT16 backoff_ms;
+
+    /** System tick when provisioning of the node completed */
+    UINT32 start_tick;
+
+} UI_CFG_NODE;
+
+/** Commissioning throughput counters */
+typedef struct _UI_CFG_STAT
+{
+    /** Nodes handed over by the provisioning layer */
+    UINT16 provisioned;
+
+    /** Nodes that completed configuration */
+    UINT16 configured;
+
+    /** Nodes dropped after running out of retries */
+    UINT16 failed;
+
+    /** Configuration messages sent again */
+    UINT16 retries;
+
+    /** Sum of provisioning complete to configured time */
+    UINT32 busy_ms;
+
+    /** System tick of the first provisioned node */
+    UINT32 first_tick;
+
+} UI_CFG_STAT;
+
+/** Nodes being configured */
+DECL_STATIC UI_CFG_NODE UI_cfg_node[UI_CFG_PIPELINE_DEPTH];
+
+/** Node owning the Configuration Client transaction */
+DECL_STATIC UCHAR UI_cfg_active = UI_CFG_NONE;
+
+/** Round robin start for the next transaction */
+DECL_STATIC UCHAR UI_cfg_next;
+
+/** Time left for the status of the active transaction */
+DECL_STATIC UINT16 UI_cfg_rsp_ms;
+
+/** Time left after a timeout during which late statuses are dropped */
+DECL_STATIC UINT16 UI_cfg_guard_ms;
+
+/* Commissioning pipeline tick timer handle */
+DECL_STATIC EM_timer_handle UI_cfg_timer_handle = EM_TIMER_HANDLE_INIT_VAL;
+
+DECL_STATIC UI_CFG_STAT UI_cfg_stat;
 
 
 /** Appkey to be used for model binding */
@@ -323,7 +400,7 @@ API_RESULT UI_set_provision_data(MS_NET_ADDR provision_addr)
 /* ----------------------------------------- Functions */
 /* Model Client - Configuration Models */
 /* Send Config Composition Data Get */
-void UI_config_client_get_composition_data(UCHAR page)
+API_RESULT UI_config_client_get_composition_data(UCHAR page)
 {
     API_RESULT retval;
     ACCESS_CONFIG_COMPDATA_GET_PARAM  param;
@@ -333,6 +410,7 @@ void UI_config_client_get_composition_data(UCHAR page)
     retval = MS_config_client_composition_data_get(&param);
     CONSOLE_OUT
     ("Retval - 0x%04X\n", retval);
+    return retval;
 }
 
 API_RESULT UI_sample_binding_app_key(void)
@@ -399,7 +477,7 @@ void UI_config_client_appkey_binding(UINT16 netkey_index, UINT16 appkey_index, U
 
 
 /* Send Config Appkey Add */
-void UI_config_client_appkey_add(UINT16 netkey_index, UINT16 appkey_index, UCHAR* appkey)
+API_RESULT UI_config_client_appkey_add(UINT16 netkey_index, UINT16 appkey_index, UCHAR* appkey)
 {
     API_RESULT retval;
     ACCESS_CONFIG_APPKEY_ADD_PARAM  param;
@@ -418,6 +496,7 @@ void UI_config_client_appkey_add(UINT16 netkey_index, UINT16 appkey_index, UCHAR
     retval = MS_config_client_appkey_add(&param);
     CONSOLE_OUT
     ("Retval - 0x%04X\n", retval);
+    return retval;
 }
 
 /* Send Config Relay Set */
@@ -431,7 +510,7 @@ void UI_config_proxy_set(UINT8 en)
 }
 
 
-void UI_config_client_model_app_bind(UINT16 addr, UINT16 appkey_index, UCHAR model_type, UINT32 model_id)
+API_RESULT UI_config_client_model_app_bind(UINT16 addr, UINT16 appkey_index, UCHAR model_type, UINT32 model_id)
 {
     API_RESULT retval;
     ACCESS_CONFIG_MODEL_APP_BIND_PARAM  param;
@@ -444,6 +523,7 @@ void UI_config_client_model_app_bind(UINT16 addr, UINT16 appkey_index, UCHAR mod
     retval = MS_config_client_model_app_bind(&param);
     CONSOLE_OUT
     ("Retval - 0x%04X\n", retval);
+    return retval;
 }
 
 /* Set Publish Address */
@@ -745,6 +825,64 @@ void UI_vendor_model_reset(MS_NET_ADDR src_addr)
     }
 }
 
+/* Bulk transfer test blob */
+DECL_STATIC UCHAR UI_vendor_bulk_blob[1024];
+
+API_RESULT UI_vendor_model_bulk_cb(UCHAR event, MS_VENDORMODEL_BULK_EVT* param)
+{
+    switch (event)
+    {
+    case MS_VENDORMODEL_BULK_EVT_RX_START:
+        CONSOLE_OUT("[BULK_Rx] SRC:0x%04X,LEN:%d\r\n", param->peer, param->offset);
+        break;
+
+    case MS_VENDORMODEL_BULK_EVT_RX_DONE:
+        CONSOLE_OUT("[BULK_Rx] SRC:0x%04X,LEN:%d,TIME:%dms,GOODPUT:%dB/s\r\n",
+                    param->peer, param->report->length, param->report->elapsed_ms, param->report->goodput);
+        break;
+
+    case MS_VENDORMODEL_BULK_EVT_RX_FAIL:
+        CONSOLE_OUT("[BULK_Rx] FAIL SRC:0x%04X,LEN:%d,RCVD:%d,TIME:%dms\r\n",
+                    param->peer, param->report->length, param->offset, param->report->elapsed_ms);
+        break;
+
+    case MS_VENDORMODEL_BULK_EVT_TX_DONE:
+    case MS_VENDORMODEL_BULK_EVT_TX_FAIL:
+        CONSOLE_OUT("[BULK_Tx] %s DST:0x%04X,LEN:%d,TIME:%dms,GOODPUT:%dB/s,SENT:%d,RETX:%d,PACE:%dms\r\n",
+                    (MS_VENDORMODEL_BULK_EVT_TX_DONE == event) ? "DONE" : "FAIL",
+                    param->peer, param->report->length, param->report->elapsed_ms, param->report->goodput,
+                    param->report->chunks_sent, param->report->chunks_retx, param->report->pace_ms);
+        break;
+
+    default:
+        break;
+    }
+
+    return API_SUCCESS;
+}
+
+/* Stream a test blob to the raw data destination and report the goodput */
+void UI_vendor_model_bulk_send(UINT16 length)
+{
+    API_RESULT retval;
+    MS_NET_ADDR dst_addr;
+    UINT16 i;
+
+    if (length > sizeof(UI_vendor_bulk_blob))
+    {
+        length = sizeof(UI_vendor_bulk_blob);
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        UI_vendor_bulk_blob[i] = (UCHAR)i;
+    }
+
+    UI_GET_RAW_DATA_DST_ADDR(dst_addr);
+    retval = MS_vendormodel_bulk_send(&UI_vendor_defined_client_model_handle, dst_addr, UI_vendor_bulk_blob, length);
+    CONSOLE_OUT("[BULK_Tx] DST:0x%04X,LEN:%d,Retval - 0x%04X\r\n", dst_addr, length, retval);
+}
+
 #if (CFG_HEARTBEAT_MODE)
 void UI_update_heartbeat_flag_with_uaddr(MS_NET_ADDR saddr)
 {
@@ -919,6 +1057,402 @@ API_RESULT UI_register_vendor_defined_model_client
 }
 
 
+/* ---- Commissioning Pipeline */
+
+/**
+    Provisioned nodes are handed to a table of per node state machines, so
+    provisioning of the next device over PB-ADV overlaps configuration of the
+    nodes provisioned before it.
+
+    The Configuration Client holds a single reliable transaction and reports
+    status messages without the source address. The pipeline therefore keeps
+    one configuration message on air and attributes its status to the node
+    the request was sent to. This also limits the lower transport to one
+    segmented message at a time (Appkey Add out, Composition Data Status in).
+    A node waiting in backoff does not hold the transaction, so one slow node
+    does not stall the others.
+
+    A status arriving after its request timed out would be taken for the
+    next node's. So no request is sent for UI_CFG_RSP_GUARD_MS after a
+    timeout, and Model App Status must carry the element address bound.
+
+    A node that runs out of retries is reset. The Node Reset is a
+    transaction like the others, and the device key is deleted once it is
+    acknowledged or its retries run out.
+*/
+DECL_STATIC void UI_cfg_timeout_handler(void* args, UINT16 size);
+DECL_STATIC void UI_cfg_node_retry(UCHAR index);
+DECL_STATIC void UI_cfg_node_remove(UCHAR index);
+
+DECL_STATIC UCHAR UI_cfg_node_count(void)
+{
+    UCHAR i, count;
+    count = 0;
+
+    for (i = 0; i < UI_CFG_PIPELINE_DEPTH; i++)
+    {
+        if (UI_CFG_STATE_FREE != UI_cfg_node[i].state)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/* Provisioning or configuration of some node is in progress */
+UCHAR UI_commissioning_busy(void)
+{
+    return ((MS_TRUE == blebrr_prov_started) || (0 != UI_cfg_node_count())) ?
+           MS_TRUE : MS_FALSE;
+}
+
+DECL_STATIC void UI_cfg_report(void)
+{
+    UINT32 elapsed_ms;
+    UINT32 rate;
+    elapsed_ms = hal_ms_intv(UI_cfg_stat.first_tick);
+    CONSOLE_OUT("[CFG] Provisioned %d, Configured %d, Failed %d, Retries %d, In Flight %d\n",
+                UI_cfg_stat.provisioned, UI_cfg_stat.configured, UI_cfg_stat.failed,
+                UI_cfg_stat.retries, UI_cfg_node_count());
+
+    if ((0 != elapsed_ms) && (0 != UI_cfg_stat.configured))
+    {
+        /* Nodes per minute in hundredths */
+        rate = (UINT32)(((UINT64)UI_cfg_stat.configured * 6000000) / elapsed_ms);
+        CONSOLE_OUT("[CFG] %d.%02d nodes/min over %d s, %d ms per node\n",
+                    rate / 100, rate % 100, elapsed_ms / 1000,
+                    UI_cfg_stat.busy_ms / UI_cfg_stat.configured);
+    }
+}
+
+DECL_STATIC void UI_cfg_timer_start(void)
+{
+    if (EM_TIMER_HANDLE_INIT_VAL == UI_cfg_timer_handle)
+    {
+        EM_start_timer
+        (
+            &UI_cfg_timer_handle,
+            (UI_CFG_TICK_MS | EM_TIMEOUT_MILLISEC),
+            UI_cfg_timeout_handler,
+            NULL,
+            0
+        );
+    }
+}
+
+DECL_STATIC void UI_cfg_send(UCHAR index)
+{
+    UI_CFG_NODE* node;
+    API_RESULT retval;
+    node = &UI_cfg_node[index];
+    UI_cfg_active = index;
+    UI_cfg_rsp_ms = UI_CFG_RSP_TIMEOUT_MS;
+    /* Point the Config Client at this node's device key */
+    UI_set_publish_address(node->uaddr, UI_config_client_model_handle, MS_TRUE);
+
+    switch (node->state)
+    {
+    case UI_CFG_STATE_COMPDATA:
+        retval = UI_config_client_get_composition_data(0x00);
+        break;
+
+    case UI_CFG_STATE_APPKEY:
+        retval = UI_config_client_appkey_add(0, 0, UI_appkey);
+        break;
+
+    case UI_CFG_STATE_BIND:
+        retval = UI_config_client_model_app_bind(node->uaddr, 0, MS_ACCESS_MODEL_TYPE_SIG, MS_MODEL_ID_GENERIC_ONOFF_SERVER);
+        break;
+
+    default:
+        retval = MS_config_client_node_reset();
+        break;
+    }
+
+    /* Not sent, nothing to wait for */
+    if (API_SUCCESS != retval)
+    {
+        UI_cfg_active = UI_CFG_NONE;
+        UI_cfg_node_retry(index);
+    }
+}
+
+DECL_STATIC void UI_cfg_schedule(void)
+{
+    UCHAR i, index;
+
+    if ((UI_CFG_NONE != UI_cfg_active) || (0 != UI_cfg_guard_ms))
+    {
+        return;
+    }
+
+    /* Leave room in the bearer queue for provisioning and relayed traffic */
+    if (blebrr_get_queue_depth() > (BLEBRR_QUEUE_SIZE >> 1))
+    {
+        return;
+    }
+
+    for (i = 0; i < UI_CFG_PIPELINE_DEPTH; i++)
+    {
+        index = (UI_cfg_next + i) % UI_CFG_PIPELINE_DEPTH;
+
+        if ((UI_CFG_STATE_FREE != UI_cfg_node[index].state) &&
+                (0 == UI_cfg_node[index].backoff_ms))
+        {
+            UI_cfg_next = (index + 1) % UI_CFG_PIPELINE_DEPTH;
+            UI_cfg_send(index);
+            break;
+        }
+    }
+}
+
+DECL_STATIC void UI_cfg_node_done(UCHAR index)
+{
+    UI_CFG_NODE* node;
+    node = &UI_cfg_node[index];
+    UI_SET_RAW_DATA_DST_ADDR(node->uaddr);
+    MS_access_cm_set_transmit_state(MS_NETWORK_TX_STATE, (0<<3)|0);
+    UI_cfg_stat.configured++;
+    UI_cfg_stat.busy_ms += hal_ms_intv(node->start_tick);
+    node->state = UI_CFG_STATE_FREE;
+    CONSOLE_OUT(
+        "PROVISION AND CONFIG DONE!!! Uaddr:0x%04X\n", node->uaddr);
+    UI_cfg_report();
+}
+
+/* Forget the node, after its Node Reset is acknowledged or given up */
+DECL_STATIC void UI_cfg_node_remove(UCHAR index)
+{
+    UI_CFG_NODE* node;
+    MS_ACCESS_DEV_KEY_HANDLE dev_key_handle;
+    node = &UI_cfg_node[index];
+
+    if (API_SUCCESS == MS_access_cm_get_device_key_handle(node->uaddr, &dev_key_handle))
+    {
+        MS_access_cm_delete_device_key(dev_key_handle);
+    }
+
+    net_delete_from_cache(node->uaddr);
+    ltrn_delete_from_reassembled_cache(node->uaddr);
+    ltrn_delete_from_replay_cache(node->uaddr);
+    printf("Delete Uaddr:0x%04X\n", node->uaddr);
+    node->state = UI_CFG_STATE_FREE;
+    UI_cfg_report();
+}
+
+DECL_STATIC void UI_cfg_node_fail(UCHAR index)
+{
+    UI_CFG_NODE* node;
+    node = &UI_cfg_node[index];
+    UI_cfg_stat.failed++;
+    printf("Provisining and config Complete Timeout\n");
+    /* Reset the node while its device key is still known */
+    node->state = UI_CFG_STATE_RESET;
+    node->retry = 0;
+    node->backoff_ms = 0;
+}
+
+DECL_STATIC void UI_cfg_node_retry(UCHAR index)
+{
+    UI_CFG_NODE* node;
+    node = &UI_cfg_node[index];
+    node->retry++;
+
+    if (UI_CFG_MAX_RETRY < node->retry)
+    {
+        if (UI_CFG_STATE_RESET == node->state)
+        {
+            UI_cfg_node_remove(index);
+        }
+        else
+        {
+            UI_cfg_node_fail(index);
+        }
+
+        return;
+    }
+
+    UI_cfg_stat.retries++;
+    /* Exponential backoff, other nodes use the transaction meanwhile */
+    node->backoff_ms = UI_CFG_BACKOFF_BASE_MS << (node->retry - 1);
+    CONSOLE_OUT("[CFG] Uaddr:0x%04X Stage %d Retry %d in %d ms\n",
+                node->uaddr, node->state, node->retry, node->backoff_ms);
+}
+
+DECL_STATIC void UI_cfg_rsp(UINT32 opcode, UCHAR* data_param, UINT16 data_len)
+{
+    UI_CFG_NODE* node;
+    UINT32 rsp_opcode;
+    UCHAR index;
+    index = UI_cfg_active;
+
+    if (UI_CFG_NONE == index)
+    {
+        return;
+    }
+
+    node = &UI_cfg_node[index];
+
+    switch (node->state)
+    {
+    case UI_CFG_STATE_COMPDATA:
+        rsp_opcode = MS_ACCESS_CONFIG_COMPOSITION_DATA_STATUS_OPCODE;
+        break;
+
+    case UI_CFG_STATE_APPKEY:
+        rsp_opcode = MS_ACCESS_CONFIG_APPKEY_STATUS_OPCODE;
+        break;
+
+    case UI_CFG_STATE_BIND:
+        rsp_opcode = MS_ACCESS_CONFIG_MODEL_APP_STATUS_OPCODE;
+        break;
+
+    default:
+        rsp_opcode = MS_ACCESS_CONFIG_NODE_RESET_STATUS_OPCODE;
+        break;
+    }
+
+    /* Late status of a request that already timed out */
+    if (rsp_opcode != opcode)
+    {
+        return;
+    }
+
+    /* Model App Status: status, element address, AppKey index, model */
+    if ((MS_ACCESS_CONFIG_MODEL_APP_STATUS_OPCODE == opcode) &&
+            ((3 > data_len) || (node->uaddr != (data_param[1] | ((UINT16)data_param[2] << 8)))))
+    {
+        return;
+    }
+
+    UI_cfg_active = UI_CFG_NONE;
+
+    if (UI_CFG_STATE_RESET == node->state)
+    {
+        UI_cfg_node_remove(index);
+        UI_cfg_schedule();
+        return;
+    }
+
+    /* Composition Data Status starts with the page, the others with a status code */
+    if ((MS_ACCESS_CONFIG_COMPOSITION_DATA_STATUS_OPCODE != opcode) &&
+            ((0 == data_len) || (0x00 != data_param[0])))
+    {
+        UI_cfg_node_retry(index);
+    }
+    else
+    {
+        node->retry = 0;
+
+        if (UI_CFG_STATE_COMPDATA == node->state)
+        {
+            node->state = UI_CFG_STATE_APPKEY;
+        }
+        #ifndef EASY_BOUNDING
+        else if (UI_CFG_STATE_APPKEY == node->state)
+        {
+            node->state = UI_CFG_STATE_BIND;
+        }
+        #endif
+        else
+        {
+            UI_cfg_node_done(index);
+        }
+    }
+
+    UI_cfg_schedule();
+}
+
+DECL_STATIC void UI_cfg_timeout_handler(void* args, UINT16 size)
+{
+    UCHAR i;
+    MS_IGNORE_UNUSED_PARAM(args);
+    MS_IGNORE_UNUSED_PARAM(size);
+    UI_cfg_timer_handle = EM_TIMER_HANDLE_INIT_VAL;
+
+    if (UI_CFG_NONE != UI_cfg_active)
+    {
+        if (UI_cfg_rsp_ms > UI_CFG_TICK_MS)
+        {
+            UI_cfg_rsp_ms -= UI_CFG_TICK_MS;
+        }
+        else
+        {
+            i = UI_cfg_active;
+            UI_cfg_active = UI_CFG_NONE;
+            UI_cfg_guard_ms = UI_CFG_RSP_GUARD_MS;
+            UI_cfg_node_retry(i);
+        }
+    }
+    else if (UI_cfg_guard_ms > UI_CFG_TICK_MS)
+    {
+        UI_cfg_guard_ms -= UI_CFG_TICK_MS;
+    }
+    else
+    {
+        UI_cfg_guard_ms = 0;
+    }
+
+    for (i = 0; i < UI_CFG_PIPELINE_DEPTH; i++)
+    {
+        if (UI_cfg_node[i].backoff_ms > UI_CFG_TICK_MS)
+        {
+            UI_cfg_node[i].backoff_ms -= UI_CFG_TICK_MS;
+        }
+        else
+        {
+            UI_cfg_node[i].backoff_ms = 0;
+        }
+    }
+
+    UI_cfg_schedule();
+
+    if (0 != UI_cfg_node_count())
+    {
+        UI_cfg_timer_start();
+    }
+}
+
+DECL_STATIC API_RESULT UI_cfg_node_add(MS_NET_ADDR uaddr)
+{
+    UCHAR i;
+
+    for (i = 0; i < UI_CFG_PIPELINE_DEPTH; i++)
+    {
+        if (UI_CFG_STATE_FREE == UI_cfg_node[i].state)
+        {
+            break;
+        }
+    }
+
+    if (UI_CFG_PIPELINE_DEPTH == i)
+    {
+        return API_FAILURE;
+    }
+
+    UI_cfg_node[i].uaddr = uaddr;
+    #ifndef EASY_BOUNDING
+    UI_cfg_node[i].state = UI_CFG_STATE_COMPDATA;
+    #else
+    UI_cfg_node[i].state = UI_CFG_STATE_APPKEY;
+    #endif
+    UI_cfg_node[i].retry = 0;
+    UI_cfg_node[i].backoff_ms = 0;
+    UI_cfg_node[i].start_tick = hal_systick();
+
+    if (0 == UI_cfg_stat.provisioned)
+    {
+        UI_cfg_stat.first_tick = UI_cfg_node[i].start_tick;
+    }
+
+    UI_cfg_stat.provisioned++;
+    UI_cfg_schedule();
+    UI_cfg_timer_start();
+    return API_SUCCESS;
+}
+
+
 /**
     \brief Client Application Asynchronous Notification Callback.
 
@@ -971,8 +1505,8 @@ API_RESULT UI_config_client_cb
     {
         CONSOLE_OUT(
             "MS_ACCESS_CONFIG_COMPOSITION_DATA_STATUS_OPCODE\n");
-        /* Add Appkey */
-        UI_config_client_appkey_add(0, 0, UI_appkey);
+        /* Next stage is Appkey Add */
+        UI_cfg_rsp(opcode, data_param, data_len);
     }
     break;
 
@@ -1022,20 +1556,8 @@ API_RESULT UI_config_client_cb
     {
         CONSOLE_OUT(
             "MS_ACCESS_CONFIG_APPKEY_STATUS_OPCODE\n");
-        #ifdef EASY_BOUNDING
-        UI_SET_RAW_DATA_DST_ADDR(UI_prov_data.uaddr);
-        MS_access_cm_set_transmit_state(MS_NETWORK_TX_STATE, (0<<3)|0);
-        /* Set provision started */
-        blebrr_prov_started = MS_FALSE;
-        EM_stop_timer(&procfg_timer_handle);
-        CONSOLE_OUT(
-            "PROVISION AND CONFIG DONE!!!\n");
-//        UI_config_proxy_set(0);
-        /* Send a Generic ON */
-        #else
-        /* Bind the model to Appkey */
-        UI_config_client_model_app_bind(UI_prov_data.uaddr, 0, MS_ACCESS_MODEL_TYPE_SIG, MS_MODEL_ID_GENERIC_ONOFF_SERVER);
-        #endif
+        /* Next stage is Model App Bind, or done with EASY_BOUNDING */
+        UI_cfg_rsp(opcode, data_param, data_len);
     }
     break;
 
@@ -1057,20 +1579,7 @@ API_RESULT UI_config_client_cb
     {
         CONSOLE_OUT(
             "MS_ACCESS_CONFIG_MODEL_APP_STATUS_OPCODE\n");
-        #ifndef EASY_BOUNDING
-//            /* Set the Publish address for Config Client */
-//            UI_set_publish_address(UI_prov_data.uaddr, UI_generic_onoff_client_model_handle,MS_FALSE);
-//            UI_set_publish_address(UI_prov_data.uaddr, UI_vendor_defined_client_model_handle,MS_FALSE);
-        UI_SET_RAW_DATA_DST_ADDR(UI_prov_data.uaddr);
-        MS_access_cm_set_transmit_state(MS_NETWORK_TX_STATE, (0<<3)|0);
-        /* Set provision started */
-        blebrr_prov_started = MS_FALSE;
-        EM_stop_timer(procfg_timer_handle);
-        procfg_timer_handle = EM_TIMER_HANDLE_INIT_VAL;
-        CONSOLE_OUT(
-            "PROVISION AND CONFIG DONE!!!\n");
-        /* Send a Generic ON */
-        #endif
+        UI_cfg_rsp(opcode, data_param, data_len);
     }
     break;
 
@@ -1078,6 +1587,7 @@ API_RESULT UI_config_client_cb
     {
         CONSOLE_OUT(
             "MS_ACCESS_CONFIG_NODE_RESET_STATUS_OPCODE\n");
+        UI_cfg_rsp(opcode, data_param, data_len);
     }
     break;
 
@@ -1240,25 +1750,6 @@ API_RESULT UI_register_generic_onoff_model_client
     return retval;
 }
 
-void UI_provcfg_complete_timeout_handler(void* args, UINT16 size)
-{
-    MS_ACCESS_DEV_KEY_HANDLE dev_key_handle;
-    MS_access_cm_get_device_key_handle
-    (
-        UI_prov_data.uaddr,
-        &dev_key_handle
-    );
-    MS_access_cm_delete_device_key(dev_key_handle);
-    net_delete_from_cache(UI_prov_data.uaddr);
-    ltrn_delete_from_reassembled_cache(UI_prov_data.uaddr);
-    ltrn_delete_from_replay_cache(UI_prov_data.uaddr);
-    MS_config_client_node_reset();
-    printf("Delete Uaddr:0x%04X\n",UI_prov_data.uaddr);
-    /* Set provision started */
-    blebrr_prov_started = MS_FALSE;
-    printf("Provisining and config Complete Timeout\n");
-}
-
 #if (CFG_HEARTBEAT_MODE)
 API_RESULT UI_trn_stop_heartbeat_publication(void)
 {
@@ -1318,6 +1809,7 @@ API_RESULT UI_prov_callback
         retval = API_SUCCESS;
 
         if((blebrr_prov_started == MS_TRUE) ||
+                (UI_cfg_node_count() == UI_CFG_PIPELINE_DEPTH) ||
                 (blebrr_get_queue_depth()>(BLEBRR_QUEUE_SIZE>>1))
                 || (MS_key_refresh_active == MS_TRUE))
         {
@@ -1498,14 +1990,6 @@ API_RESULT UI_prov_callback
         {
             if (PROV_ROLE_PROVISIONER == UI_prov_role)
             {
-                retval = EM_start_timer
-                         (
-                             &procfg_timer_handle,
-                             PROCFG_COMPLETE_TIMEOUT,
-                             UI_provcfg_complete_timeout_handler,
-                             NULL,
-                             0
-                         );
 //                    if (0x0001 != UI_prov_data.uaddr)
 //                    {
 //                        /* Holding a temporary structure for local prov data */
@@ -1537,8 +2021,6 @@ API_RESULT UI_prov_callback
 //                         *  provisioned device.
 //                         */
 //                    }
-                /* Set the Publish address for Config Client */
-                UI_set_publish_address(UI_prov_data.uaddr, UI_config_client_model_handle,MS_TRUE);
                 net_delete_from_cache(UI_prov_data.uaddr);
                 ltrn_delete_from_reassembled_cache(UI_prov_data.uaddr);
                 ltrn_delete_from_replay_cache(UI_prov_data.uaddr);
@@ -1552,19 +2034,12 @@ API_RESULT UI_prov_callback
                     MS_net_start_snb_timer(0);
                 }
 
-                #ifndef EASY_BOUNDING
-                /* Get the Composition data */
-                UI_config_client_get_composition_data(0x00);
-                #else
-                UI_config_client_appkey_add(0, 0, UI_appkey);
-                #endif
+                /* Configure in the pipeline, the link is free for the next device */
+                UI_cfg_node_add(UI_prov_data.uaddr);
             }
         }
-        else
-        {
-            blebrr_prov_started = MS_FALSE;
-        }
 
+        blebrr_prov_started = MS_FALSE;
         break;
 
     default:
@@ -1677,6 +2152,7 @@ void appl_mesh_sample (void)
     {
         /* Register Vendor Defined model server */
         retval = UI_register_vendor_defined_model_client(element_handle);
+        MS_vendormodel_bulk_register(UI_vendor_model_bulk_cb);
     }
 
     #endif
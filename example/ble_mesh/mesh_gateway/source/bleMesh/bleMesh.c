@@ -157,6 +157,8 @@ void UI_lpn_seek_friend(void);
 
 void UI_generic_onoff_set(UCHAR state);
 
+UCHAR UI_commissioning_busy(void);
+
 UINT8 bleMesh_check_node_inline(void);
 
 
@@ -412,7 +414,7 @@ uint16 bleMesh_ProcessEvent( uint8 task_id, uint16 events )
 //        g_count_timer%=3000;
 
 //        g_count_timer+=631;
-        if(blebrr_prov_started == MS_FALSE)
+        if(UI_commissioning_busy() == MS_FALSE)
         {
             UI_vendor_model_set_raw_addr();
             UI_vendor_model_set(1,248,bleMesh_pdu_time++);
@@ -480,7 +482,7 @@ uint16 bleMesh_ProcessEvent( uint8 task_id, uint16 events )
         #endif
         #if (CFG_HEARTBEAT_MODE)
 
-        if((blebrr_prov_started == MS_FALSE)&&(MS_key_refresh_active == MS_FALSE))
+        if((UI_commissioning_busy() == MS_FALSE)&&(MS_key_refresh_active == MS_FALSE))
         {
             remove_node_flag = bleMesh_check_node_inline();
         }
@@ -739,9 +739,7 @@ API_RESULT UI_light_ctl_model_state_get(UINT16 state_t, UINT16 state_inst, void*
 
 void UI_light_ctl_set_actual(UINT16 state_inst, UINT16 lightness, UINT16 temperature, UINT16 deltaUv)
 {
-    // TODO: convert CTL to RGB and set light
-    light_lightness_set_pl (lightness);
-    light_ctl_set_pl (temperature,deltaUv);
+    light_ctl_lightness_set_pl (lightness, temperature);
 }
 
 API_RESULT UI_light_ctl_model_state_set(UINT16 state_t, UINT16 state_inst, void* param, UINT8 direction)
@@ -87,7 +87,11 @@ uint8 LastCombine_key=0XFF;
 uint8 reCheck_key_number=0;
 
 
-kscan_Evt_t hal_keyScanEvt;
+//key batches waiting for the task; one entry less than the driver keeps, so the
+//keys of every waiting batch are still valid
+kscan_Evt_t hal_keyScanEvt[KSCAN_EVT_FIFO_SIZE];
+uint8 hal_keyScanEvt_rd=0;
+uint8 hal_keyScanEvt_wr=0;
 
 
 
@@ -319,7 +323,17 @@ static void kscan_evt_handler(kscan_Evt_t* evt)
 {
     //LOG("kscan_evt_handler\n");
 //  hal_keyScanEvt=evt;
-    osal_memcpy(&hal_keyScanEvt, evt, sizeof(kscan_Evt_t));
+    uint8 wr = (hal_keyScanEvt_wr + 1) % KSCAN_EVT_FIFO_SIZE;
+
+    //queue full: leave the batch to the driver, it reports it again with a later scan
+    if(wr == hal_keyScanEvt_rd)
+    {
+        hal_kscan_evt_defer();
+        return;
+    }
+
+    osal_memcpy(&hal_keyScanEvt[hal_keyScanEvt_wr], evt, sizeof(kscan_Evt_t));
+    hal_keyScanEvt_wr = wr;
     osal_set_event(halKeyboardMatrix_TaskID, HAL_INTERUPT_HANDLER_EVT);
     LOG("key change num=%d\n\r",evt->num);
     //LOG("key_hold_num:%d\n\r",key_hold_num);
@@ -404,7 +418,12 @@ uint16 hal_keyboard_matrix_task_ProcessEvent( uint8 task_id, uint16 events )
 
     if(events & HAL_INTERUPT_HANDLER_EVT)
     {
-        kscan_evt_hand_hook(&hal_keyScanEvt);
+        while(hal_keyScanEvt_rd != hal_keyScanEvt_wr)
+        {
+            kscan_evt_hand_hook(&hal_keyScanEvt[hal_keyScanEvt_rd]);
+            hal_keyScanEvt_rd = (hal_keyScanEvt_rd + 1) % KSCAN_EVT_FIFO_SIZE;
+        }
+
         return (events ^ HAL_INTERUPT_HANDLER_EVT);
     }
 
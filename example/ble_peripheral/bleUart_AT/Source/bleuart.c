@@ -124,6 +124,8 @@ uint16 gapConnHandle;
 
 static bool g_uart_at_mod = true;
 
+static bool g_conn_evt_notice = false;
+
 static gaprole_States_t gapProfileState = GAPROLE_INIT;
 
 // GAP - SCAN RSP data (max size = 31 bytes)
@@ -167,7 +169,7 @@ void set_uart_at_mod(bool at_mod)
     g_uart_at_mod = at_mod;
 }
 
-void on_bleuartServiceEvt(bleuart_Evt_t* pev)
+bStatus_t on_bleuartServiceEvt(bleuart_Evt_t* pev)
 {
     switch(pev->ev)
     {
@@ -182,12 +184,17 @@ void on_bleuartServiceEvt(bleuart_Evt_t* pev)
         break;
 
     case bleuart_EVT_BLE_DATA_RECIEVED:
-        BUP_data_BLE_to_uart( (uint8_t*)pev->data, (uint8_t)pev->param);
+        // refused data goes back to the peer as an ATT error on write request
+        if(BUP_data_BLE_to_uart( (uint8_t*)pev->data, (uint8_t)pev->param) != PPlus_SUCCESS)
+            return ATT_ERR_INSUFFICIENT_RESOURCES;
+
         break;
 
     default:
         break;
     }
+
+    return SUCCESS;
 }
 
 void on_BUP_Evt(BUP_Evt_t* pev)
@@ -537,21 +544,7 @@ uint16 bleuart_ProcessEvent( uint8 task_id, uint16 events )
     if ( events & BUP_OSAL_EVT_AT_UART_RX_CMD )
     {
         LOG("BUP_OSAL_EVT_AT_UART_RX_EVT\n");
-
-        if (('\r' == cmdstr[cmdlen - 1]) || ('\n' == cmdstr[cmdlen - 1]) || (' ' == cmdstr[cmdlen - 1]))
-        {
-            //cmdstr[cmdlen - 1] = '\0';
-            CLI_process_line
-            (
-                cmdstr,
-                cmdlen,
-                (CLI_COMMAND*) cli_cmd_list,
-                (sizeof (cli_cmd_list)/sizeof(CLI_COMMAND))
-            );
-            cmdlen = 0;
-            memset(cmdstr, 0, 64); // clean the cdmstr with fixed len = 64.
-        }
-
+        at_cmd_process();
         return ( events ^ BUP_OSAL_EVT_AT_UART_RX_CMD);
     }
 
@@ -625,6 +618,7 @@ uint16 bleuart_ProcessEvent( uint8 task_id, uint16 events )
     {
         uint32_t m_auto_slp_time = at_get_auto_slp_time();
         BUP_disconnect_handler(); // set mBUP_Ctx.conn_state to false
+        bleuart_conn_evt_notice(false);
 
         if(at_get_dma_flag())  // for DMA PT
         {
@@ -690,26 +684,27 @@ uint16 bleuart_ProcessEvent( uint8 task_id, uint16 events )
 
         if(at_get_rxpath_flag())   // For Rx path, triggered by ch0 p2m DMA callback -- dma_rx_cb0()
         {
-            at_dma_uart_to_BLE_DMA_rx();
-
-            if(!at_dma_get_notify_flag())
-            {
-                at_dma_set_notify_flag(true);
-                at_dma_uart_to_BLE_notify_data();
-            }
+            at_dma_uart_to_BLE_notify_data();
         }
         else   // // For Tx path, triggered by BLE APP data -- BUP_data_BLE_to_uart()
         {
-            if(!at_dma_get_send_flag())
-            {
-                at_dma_set_send_flag(true);
-                at_dma_BLE_to_uart_DMA_tx();
-            }
+            at_dma_BLE_to_uart_DMA_tx();
         }
 
         return ( events ^ BUP_OSAL_EVT_UART_DATA_RX );
     }
 
+//    case BUP_OSAL_EVT_CONN_EVT_DONE:  // link layer buffers freed, retry pending notify.
+    if ( events & BUP_OSAL_EVT_CONN_EVT_DONE )
+    {
+        if(at_get_dma_flag() && at_get_rxpath_flag())
+            at_dma_uart_to_BLE_notify_data();
+        else if(BUP_data_uart_to_BLE_send() != PPlus_SUCCESS)
+            bleuart_conn_evt_notice(false);
+
+        return ( events ^ BUP_OSAL_EVT_CONN_EVT_DONE );
+    }
+
     /*  Skip these events as they are not used at the moment.
             case BUP_OSAL_EVT_CCCD_UPDATE:{ //
                 LOG("BUP_OSAL_EVT_CCCD_UPDATE\n");
@@ -798,6 +793,25 @@ uint16_t bleuart_conn_interval(void)
     return ((1+latency)*interval*5/4);
 }
 
+/*********************************************************************
+    @fn      bleuart_conn_evt_notice
+
+    @brief   Post BUP_OSAL_EVT_CONN_EVT_DONE at every connection event end, while
+            notifications wait for link layer buffers to be freed.
+
+    @param   enable - TRUE to start the notice, FALSE to stop it.
+
+    @return  none
+*/
+void bleuart_conn_evt_notice(bool enable)
+{
+    if(enable == g_conn_evt_notice)
+        return;
+
+    g_conn_evt_notice = enable;
+    HCI_PPLUS_ConnEventDoneNoticeCmd(bleuart_TaskID, enable ? BUP_OSAL_EVT_CONN_EVT_DONE : 0);
+}
+
 
 /*********************************************************************
 *********************************************************************/
@@ -78,6 +78,8 @@
 #define BUP_OSAL_EVT_LED_BLK_TIMER                        0x1000
 #define BUP_OSAL_EVT_UART_DATA_RX                         0x2000  // not used
 //#define BUP_OSAL_EVT_ENTER_NOCONN                         0x4000  // not used
+// connection event ended while notify waits for link layer buffers.
+#define BUP_OSAL_EVT_CONN_EVT_DONE                        0x4000
 
 //#define FLOW_CTRL_IO_HOST_WAKEUP      P10 //host mcu wakeup befor host-->uart-->620x
 #define FLOW_CTRL_IO_HOST_WAKEUP      P10 //host mcu wakeup befor host-->uart-->620x
@@ -87,6 +89,9 @@
 #define FLOW_CTRL_IO_BLE_TX           P23 //host-->uart-->ble-->mobile
 #define FLOW_CTRL_IO_BLE_CONNECTION   P20 //indicate host 620x BLE connection status: 1: connected; 0: advertising
 #define FLOW_CTRL_IO_USR1           P24 //host-->uart-->ble-->mobile
+// DMA pass-through flow control, no uart rts/cts in pin mux so both are GPIOs.
+#define FLOW_CTRL_IO_UART_RTS       FLOW_CTRL_IO_BLE_TX //out, high: 620x buffer full, host holds uart tx
+#define FLOW_CTRL_IO_UART_CTS       P14 //in, high: host busy, 620x holds uart tx
 
 
 //#define io_lock(io) {hal_gpio_write(io, 1);hal_gpio_pull_set(io, STRONG_PULL_UP);}
@@ -106,13 +111,17 @@
 #define FLOW_CTRL_BLE_USR1_LOCK()     io_lock(FLOW_CTRL_IO_USR1)
 #define FLOW_CTRL_BLE_USR1_UNLOCK()   io_unlock(FLOW_CTRL_IO_USR1)
 
+#define FLOW_CTRL_UART_RTS_LOCK()     io_lock(FLOW_CTRL_IO_UART_RTS)
+#define FLOW_CTRL_UART_RTS_UNLOCK()   io_unlock(FLOW_CTRL_IO_UART_RTS)
+
 extern uint8 bleuart_TaskID;   // Task ID for internal task/event processing
 extern uint16 gapConnHandle;
 
 void bleuart_Init( uint8 task_id );
 uint16_t bleuart_conn_interval(void);
+void bleuart_conn_evt_notice(bool enable);
 uint16 bleuart_ProcessEvent( uint8 task_id, uint16 events );
-void on_bleuartServiceEvt(bleuart_Evt_t* pev);
+bStatus_t on_bleuartServiceEvt(bleuart_Evt_t* pev);
 
 // These functions would be called by AT cmds.
 // true: update scan rsp data parameters.
@@ -114,6 +114,10 @@ bool g_rxpath_flag = true;
 // for at_cli_cmd.
 uint8_t cmdstr[AT_CMD_LENGTH_MAX];
 uint8_t cmdlen = 0;
+// hashed index over cli_cmd_list, set up by at_Init. Kept at least twice the
+// number of commands so that probe runs stay short.
+static uint8_t   at_cmd_slot[128];
+static CLI_TABLE at_cmd_table;
 
 AT_ctx_t mAT_Ctx;
 AT_ctx_t mAT_Ctx_def =
@@ -167,6 +171,7 @@ uint16_t at_div(uint32_t argc, uint8_t* argv[]);
 uint16_t at_pcnt(uint32_t argc, uint8_t* argv[]);
 uint16_t at_dma(uint32_t argc, uint8_t* argv[]);
 uint16_t at_rxpath(uint32_t argc, uint8_t* argv[]);
+uint16_t at_stat(uint32_t argc, uint8_t* argv[]);
 
 /**
     Use FS API to fetch data from/to flash.
@@ -336,6 +341,9 @@ const CLI_COMMAND cli_cmd_list[] =
 
     /* at+rxpath cmd. */
     { "at+rxpath", "Set rx/tx DMA path", at_rxpath },
+
+    /* at+stat cmd. On benchmark purpose*/
+    { "at+stat", "Get/clear DMA pass-through statistics", at_stat },
     #endif
 };
 
@@ -811,6 +819,7 @@ uint16_t at_baud(uint32_t argc, uint8_t* argv[])
 {
     uint8_t ret = 0;
     uint32_t orig_baudrate;
+    uint32_t baud;
     osal_stop_timerEx( bleuart_TaskID, BUP_OSAL_EVT_AT_AUTO_SLEEP);
     #ifdef BLEUART_DEDICATE
     uint32_t orig_parity = 0;
@@ -851,22 +860,24 @@ uint16_t at_baud(uint32_t argc, uint8_t* argv[])
         orig_baudrate = mAT_Ctx.baudrate[0];
 
         //check whether the data string is valid or not.
-        if(strcmp((char*)(argv[0]), "4800") == 0)
-            mAT_Ctx.baudrate[0] = 4800;
-        else if(strcmp((char*)(argv[0]), "9600") == 0)
-            mAT_Ctx.baudrate[0] = 9600;
-        else if(strcmp((char*)(argv[0]), "14400") == 0)
-            mAT_Ctx.baudrate[0] = 14400;
-        else if(strcmp((char*)(argv[0]), "19200") == 0)
-            mAT_Ctx.baudrate[0] = 19200;
-        else if(strcmp((char*)(argv[0]), "38400") == 0)
-            mAT_Ctx.baudrate[0] = 38400;
-        else if(strcmp((char*)(argv[0]), "57600") == 0)
-            mAT_Ctx.baudrate[0] = 57600;
-        else if(strcmp((char*)(argv[0]), "115200") == 0)
-            mAT_Ctx.baudrate[0] = 115200;
-        else
+        if(CLI_strtoui(argv[0], 10, &baud) != 0)
+            goto ERR_exit;
+
+        switch(baud)
+        {
+        case 4800:
+        case 9600:
+        case 14400:
+        case 19200:
+        case 38400:
+        case 57600:
+        case 115200:
+            mAT_Ctx.baudrate[0] = baud;
+            break;
+
+        default:
             goto ERR_exit;
+        }
 
         // handle parity.
         orig_parity = mAT_Ctx.baudrate[1];
@@ -921,27 +932,27 @@ uint16_t at_baud(uint32_t argc, uint8_t* argv[])
             orig_baudrate = mAT_Ctx.baudrate;
 
             //check whether the data string is valid or not.
-            if(strcmp((char*)(argv[0]), "4800") == 0)
-                mAT_Ctx.baudrate = 4800;
-            else if(strcmp((char*)(argv[0]), "9600") == 0)
-                mAT_Ctx.baudrate = 9600;
-            else if(strcmp((char*)(argv[0]), "14400") == 0)
-                mAT_Ctx.baudrate = 14400;
-            else if(strcmp((char*)(argv[0]), "19200") == 0)
-                mAT_Ctx.baudrate = 19200;
-            else if(strcmp((char*)(argv[0]), "38400") == 0)
-                mAT_Ctx.baudrate = 38400;
-            else if(strcmp((char*)(argv[0]), "57600") == 0)
-                mAT_Ctx.baudrate = 57600;
-            else if(strcmp((char*)(argv[0]), "115200") == 0)
-                mAT_Ctx.baudrate = 115200;
-            else if(strcmp((char*)(argv[0]), "500000") == 0)
-                mAT_Ctx.baudrate = 500000;
-            else if(strcmp((char*)(argv[0]), "1000000") == 0)
-                mAT_Ctx.baudrate = 1000000;
-            else
+            if(CLI_strtoui(argv[0], 10, &baud) != 0)
                 goto ERR_exit;
 
+            switch(baud)
+            {
+            case 4800:
+            case 9600:
+            case 14400:
+            case 19200:
+            case 38400:
+            case 57600:
+            case 115200:
+            case 500000:
+            case 1000000:
+                mAT_Ctx.baudrate = baud;
+                break;
+
+            default:
+                goto ERR_exit;
+            }
+
             if(orig_baudrate != mAT_Ctx.baudrate)  // baudrate is changed.
             {
                 ret = at_snv_write_flash(AT_SNV_ID_BAUDRATE_OFFSET); // write data into flash.
@@ -1669,6 +1680,7 @@ ERR_exit:
 uint16_t at_div(uint32_t argc, uint8_t* argv[])
 {
     //uint8_t ret = 0;
+    uint32_t div;
     osal_stop_timerEx( bleuart_TaskID, BUP_OSAL_EVT_AT_AUTO_SLEEP);
 
     if(argc == 1)
@@ -1703,18 +1715,34 @@ uint16_t at_div(uint32_t argc, uint8_t* argv[])
         }
         else
         {
-            if(strcmp((char*)(argv[0]), "256") == 0)
+            if(CLI_strtoui(argv[0], 10, &div) != 0)
+                goto ERR_exit;
+
+            switch(div)
+            {
+            case 256:
                 at_dma_set_div(AT_BUF_DIV_256);
-            else if(strcmp((char*)(argv[0]), "128") == 0)
+                break;
+
+            case 128:
                 at_dma_set_div(AT_BUF_DIV_128);
-            else if(strcmp((char*)(argv[0]), "64") == 0)
+                break;
+
+            case 64:
                 at_dma_set_div(AT_BUF_DIV_64);
-            else if(strcmp((char*)(argv[0]), "32") == 0)
+                break;
+
+            case 32:
                 at_dma_set_div(AT_BUF_DIV_32);
-            else if(strcmp((char*)(argv[0]), "16") == 0)
+                break;
+
+            case 16:
                 at_dma_set_div(AT_BUF_DIV_16);
-            else
+                break;
+
+            default:
                 goto ERR_exit;
+            }
         }
 
         AT_LOG("\nOK\n");
@@ -1731,6 +1759,7 @@ ERR_exit:
 uint16_t at_pcnt(uint32_t argc, uint8_t* argv[])
 {
     //uint8_t ret = 0;
+    uint32_t len;
     osal_stop_timerEx( bleuart_TaskID, BUP_OSAL_EVT_AT_AUTO_SLEEP);
 
     if(argc == 1)
@@ -1741,10 +1770,11 @@ uint16_t at_pcnt(uint32_t argc, uint8_t* argv[])
         }
         else
         {
-            if(strcmp((char*)(argv[0]), "160") == 0)
-                at_dma_set_buf_len(160);
-            else if(strcmp((char*)(argv[0]), "128") == 0)
-                at_dma_set_buf_len(128);
+            if(CLI_strtoui(argv[0], 10, &len) != 0)
+                len = 0;
+
+            if((len == 160) || (len == 128))
+                at_dma_set_buf_len((uint8_t)len);
             else
                 at_dma_set_buf_len(240);
         }
@@ -1868,6 +1898,46 @@ uint16_t at_rxpath(uint32_t argc, uint8_t* argv[])
     return 0;
 }
 
+/*  at+stat=? prints one benchmark record of the DMA pass-through since the last clear:
+    mtu,conn interval(ms),baudrate,elapsed(ms),rx bytes,tx bytes,bytes/s,notify,notify busy,
+    write busy,rts,cts,latency avg(ms),latency max(ms),buffer peak
+    at+stat=0 clears it. Sweep by changing mtu on the peer, at+cint and at+baud between runs.
+*/
+uint16_t at_stat(uint32_t argc, uint8_t* argv[])
+{
+    AT_stat_t stat;
+    uint32_t bytes;
+    osal_stop_timerEx( bleuart_TaskID, BUP_OSAL_EVT_AT_AUTO_SLEEP);
+
+    if(argc == 1)
+    {
+        if('?' == argv[0][0])
+        {
+            at_dma_get_stat(&stat, false);
+            bytes = stat.rx_bytes + stat.tx_bytes;
+            AT_LOG("\n%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d",
+                   bleuart_notify_max_len() + 3, bleuart_conn_interval(), at_get_baudrate(),
+                   stat.elapsed_ms, stat.rx_bytes, stat.tx_bytes,
+                   (stat.elapsed_ms == 0) ? 0 : (uint32_t)((uint64_t)bytes * 1000 / stat.elapsed_ms),
+                   stat.notify_cnt, stat.notify_busy, stat.write_busy, stat.rts_cnt, stat.cts_cnt,
+                   (stat.lat_cnt == 0) ? 0 : stat.lat_sum_ms / stat.lat_cnt, stat.lat_max_ms,
+                   stat.ring_max);
+        }
+        else
+        {
+            at_dma_get_stat(NULL, true);
+        }
+
+        AT_LOG("\nOK\n");
+        osal_start_timerEx( bleuart_TaskID, BUP_OSAL_EVT_AT_AUTO_SLEEP, mAT_Ctx.auto_slp_time * 1000 );
+        return 0;
+    }
+
+    AT_LOG("\nERR\n");
+    osal_start_timerEx( bleuart_TaskID, BUP_OSAL_EVT_AT_AUTO_SLEEP, mAT_Ctx.auto_slp_time * 1000 );
+    return 0;
+}
+
 // following functions are not partial of AT cmd set.
 void    at_update_bd_addr(void)
 {
@@ -2548,8 +2618,54 @@ void at_uart_init(void)
 }
 
 
+/*  Runs the command collected in cmdstr. A text command ends with CR, LF or space.
+    A host MCU may send CLI_FRAME_SYNC, a length octet and the command without the
+    terminator instead, it runs as soon as that many octets are in.
+*/
+void at_cmd_process(void)
+{
+    uint8_t len;
+
+    if(cmdlen == 0)
+        return;
+
+    if(CLI_FRAME_SYNC == cmdstr[0])
+    {
+        if(cmdlen < CLI_FRAME_HDR_LEN)
+            return;
+
+        len = cmdstr[1];
+
+        if((len != 0) && (len < (AT_CMD_LENGTH_MAX - CLI_FRAME_HDR_LEN)))
+        {
+            if(cmdlen < (CLI_FRAME_HDR_LEN + len))
+                return;
+
+            cmdstr[CLI_FRAME_HDR_LEN + len] = '\0';  // drop octets past the frame
+            CLI_process_line_table(cmdstr + CLI_FRAME_HDR_LEN, len, &at_cmd_table);
+        }
+    }
+    else if (('\r' == cmdstr[cmdlen - 1]) || ('\n' == cmdstr[cmdlen - 1]) || (' ' == cmdstr[cmdlen - 1]))
+    {
+        CLI_process_line_table(cmdstr, cmdlen, &at_cmd_table);
+    }
+    else
+    {
+        return;
+    }
+
+    cmdlen = 0;
+    memset(cmdstr, 0, AT_CMD_LENGTH_MAX);
+}
+
 void at_Init()
 {
+    if (0 != CLI_table_init(&at_cmd_table, cli_cmd_list, sizeof(cli_cmd_list)/sizeof(CLI_COMMAND),
+                            at_cmd_slot, sizeof(at_cmd_slot)))
+    {
+        AT_LOG("AT cmd table init failed\n");
+    }
+
     hal_uart_deinit((UART_INDEX_e)get_uart_idx());
     at_uart_init();
     set_uart_at_mod(true);
@@ -99,7 +99,7 @@ typedef struct
 
 extern uint8_t cmdstr[64];
 extern uint8_t cmdlen;
-extern const CLI_COMMAND cli_cmd_list[26];
+extern const CLI_COMMAND cli_cmd_list[27];
 /*********************************************************************
     FUNCTIONS
 */
@@ -123,6 +123,7 @@ uint8_t  at_get_pw_mode(void);
 bool     at_get_led_mode(void);
 uint32_t at_get_auto_slp_time(void);
 void     at_Init(void);
+void     at_cmd_process(void);
 uint16_t at_default(uint32_t argc, uint8_t* argv[]);
 uint16_t at_at(uint32_t argc, uint8_t* argv[]);
 uint16_t at_reset(uint32_t argc, uint8_t* argv[]);
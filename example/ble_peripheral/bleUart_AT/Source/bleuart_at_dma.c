@@ -53,65 +53,102 @@
 #include "error.h"
 #include "dma.h"
 #include "flash.h"
+#include "att.h"
 #include "bleuart_protocol.h"
 #include "bleuart_at_cmd.h"
 
-#define AT_UART_RX_BUF_SIZE  1024
+#define AT_UART_RX_BUF_SIZE  1024  // power of 2, ring indexes run free over uint16_t
 //#define AT_UART_RX_BUF_SIZE  512
+#define AT_RING_MASK         (AT_UART_RX_BUF_SIZE - 1)
+#define AT_RING_CONTIG(idx)  (AT_UART_RX_BUF_SIZE - ((idx) & AT_RING_MASK))  // bytes from idx to buf end
+#define AT_TX_DMA_MAX        64  // bytes the host may still get after raising CTS, plus uart fifo
+#define AT_RX_DMA_AHEAD      (AT_UART_RX_BUF_SIZE / 2 + 64)  // rx DMA may write this much between two ring events
 
 uint8_t g_data_buf[AT_UART_RX_BUF_SIZE] = {0};
 AT_BUF_DIV_e g_buf_div_e = AT_BUF_DIV_256;
-uint16_t g_buf_div = 256;
 uint8_t g_buf_len = 244;  // MTU(247) - 3
-uint8_t g_buf_num = AT_UART_RX_BUF_SIZE/256;
-uint8_t g_buf_rx_idx = 0;
-uint8_t g_buf_tx_idx = 0;
-volatile uint32_t g_buf_status = 0;
+// Single producer, single consumer ring over g_data_buf. Only the producer moves
+// g_ring_head and only the consumer moves g_ring_tail, so neither side locks.
+// Rx path: uart rx DMA events produce, notify consumes. Tx path: BLE write produces, DMA irq consumes.
+volatile uint16_t g_ring_head = 0;
+volatile uint16_t g_ring_tail = 0;
+volatile uint16_t g_dma_len = 0;  // tx path: bytes of the DMA transfer in flight, 0 if DMA is idle
+// used by uart to ble path only. line went idle, send what is left below a full block
+volatile bool g_rx_idle = false;
+bool g_rx_dma_on = false;
 DMA_CH_CFG_t g_dma_cfg_ch0 = {0};
 AP_UART_TypeDef* cur_uart = (AP_UART_TypeDef*)AP_UART0_BASE;
 uint32_t g_pkt_cnt = 0;
 uint32_t g_error   = 0;
-// used by uart to ble path only. indicate whether there is data sending to APP via BLE
-bool g_notify_flag = false;
-// used by ble to uart path only. indicate whether there is data sending to UART via DMA
-bool g_send_flag = false;
-
-/*
-    Public APIs.
-*/
-AT_BUF_DIV_e at_dma_get_div()
+// used by uart to ble path only. host is held off by RTS
+bool g_rts_flag = false;
+// used by uart to ble path only. notify ran out of buffers, retry at connection event end
+bool g_notify_wait = false;
+// latency sample: time the ring reached g_lat_end, taken by producer, closed by consumer
+volatile bool g_lat_pending = false;
+uint16_t g_lat_end = 0;
+uint32_t g_lat_stamp = 0;
+uint32_t g_stat_tick = 0;
+AT_stat_t g_at_stat = {0};
+
+static uint16_t at_ring_count(void)
 {
-    return g_buf_div_e;
+    return (uint16_t)(g_ring_head - g_ring_tail);
 }
 
-uint8_t at_dma_get_buf_len()
+static void at_ring_update_max(void)
 {
-    return g_buf_len;
+    uint16_t cnt = at_ring_count();
+
+    if(cnt > g_at_stat.ring_max)
+        g_at_stat.ring_max = cnt;
 }
 
-void at_dma_set_buf_len(uint8_t b_len)
+// producer side, after g_ring_head moved
+static void at_lat_start(void)
 {
-    g_buf_len = b_len;
+    if(!g_lat_pending)
+    {
+        g_lat_end = g_ring_head;
+        g_lat_stamp = hal_systick();
+        g_lat_pending = true;
+    }
 }
 
-bool at_dma_get_notify_flag()
+// consumer side, after g_ring_tail moved
+static void at_lat_stop(void)
 {
-    return g_notify_flag;
+    uint32_t lat;
+
+    if(g_lat_pending && ((int16_t)(g_ring_tail - g_lat_end) >= 0))
+    {
+        lat = hal_ms_intv(g_lat_stamp);
+        g_at_stat.lat_sum_ms += lat;
+        g_at_stat.lat_cnt++;
+
+        if(lat > g_at_stat.lat_max_ms)
+            g_at_stat.lat_max_ms = lat;
+
+        g_lat_pending = false;
+    }
 }
 
-void at_dma_set_notify_flag(bool n_flag)
+/*
+    Public APIs.
+*/
+AT_BUF_DIV_e at_dma_get_div()
 {
-    g_notify_flag = n_flag;
+    return g_buf_div_e;
 }
 
-bool at_dma_get_send_flag()
+uint8_t at_dma_get_buf_len()
 {
-    return g_send_flag;
+    return g_buf_len;
 }
 
-void at_dma_set_send_flag(bool n_flag)
+void at_dma_set_buf_len(uint8_t b_len)
 {
-    g_send_flag = n_flag;
+    g_buf_len = b_len;
 }
 
 uint32_t at_get_count()
@@ -128,6 +165,25 @@ uint32_t at_get_count()
     return g_pkt_cnt;
 }
 
+void at_dma_get_stat(AT_stat_t* stat, bool reset)
+{
+    HAL_ENTER_CRITICAL_SECTION();
+
+    if(stat)
+    {
+        *stat = g_at_stat;
+        stat->elapsed_ms = hal_ms_intv(g_stat_tick);
+    }
+
+    if(reset)
+    {
+        memset(&g_at_stat, 0, sizeof(AT_stat_t));
+        g_stat_tick = hal_systick();
+    }
+
+    HAL_EXIT_CRITICAL_SECTION();
+}
+
 
 void at_dma_set_div(AT_BUF_DIV_e div)
 {
@@ -135,106 +191,145 @@ void at_dma_set_div(AT_BUF_DIV_e div)
     {
     case AT_BUF_DIV_256:
         g_buf_div_e = AT_BUF_DIV_256;
-        g_buf_div = 256;
         g_buf_len = 244;  // MTU(247) - 3
-        g_buf_num = AT_UART_RX_BUF_SIZE/256;
         break;
 
     case AT_BUF_DIV_128:
         g_buf_div_e = AT_BUF_DIV_128;
-        g_buf_div = 128;
         g_buf_len = 128;
-        g_buf_num = AT_UART_RX_BUF_SIZE/128;
         break;
 
     case AT_BUF_DIV_64:
         g_buf_div_e = AT_BUF_DIV_64;
-        g_buf_div = 64;
         g_buf_len = 64;
-        g_buf_num = AT_UART_RX_BUF_SIZE/64;
         break;
 
     case AT_BUF_DIV_32:
         g_buf_div_e = AT_BUF_DIV_32;
-        g_buf_div = 32;
         g_buf_len = 32;
-        g_buf_num = AT_UART_RX_BUF_SIZE/32;
+        break;
 
     case AT_BUF_DIV_16:
         g_buf_div_e = AT_BUF_DIV_16;
-        g_buf_div = 16;
         g_buf_len = 16;
-        g_buf_num = (AT_UART_RX_BUF_SIZE/16 > 32)? 32: AT_UART_RX_BUF_SIZE/16;
         break;
 
     default:
         g_buf_div_e = AT_BUF_DIV_256;
-        g_buf_div = 256;
         g_buf_len = 244;  // MTU(247) - 3
-        g_buf_num = AT_UART_RX_BUF_SIZE/256;
         break;
     }
 }
 
+// use in UART --> MODULE --> BLE path. The DMA runs on between two ring events, hold the
+// host off while it could reach unsent data, let it go once another block is free.
+static void at_flow_rts_update(void)
+{
+    uint16_t cnt = at_ring_count();
+    uint16_t room = (cnt < AT_UART_RX_BUF_SIZE) ? (AT_UART_RX_BUF_SIZE - cnt) : 0;
+
+    if(!g_rts_flag && room < AT_RX_DMA_AHEAD)
+    {
+        g_rts_flag = true;
+        FLOW_CTRL_UART_RTS_LOCK();
+        g_at_stat.rts_cnt++;
+    }
+    else if(g_rts_flag && room >= AT_RX_DMA_AHEAD + g_buf_len)
+    {
+        g_rts_flag = false;
+        FLOW_CTRL_UART_RTS_UNLOCK();
+    }
+}
+
+// use in BLE --> MODULE --> UART path. Called with interrupts off.
+static void at_dma_tx_arm(void)
+{
+    uint16_t len = at_ring_count();
+
+    if(g_dma_len != 0 || len == 0)
+        return;
+
+    if(hal_gpio_read(FLOW_CTRL_IO_UART_CTS))  // host not ready, CTS falling edge re-arms
+    {
+        g_at_stat.cts_cnt++;
+        return;
+    }
+
+    if(len > AT_RING_CONTIG(g_ring_tail))
+        len = AT_RING_CONTIG(g_ring_tail);
+
+    if(len > AT_TX_DMA_MAX)
+        len = AT_TX_DMA_MAX;
+
+    g_dma_len = len;
+    at_dma_start((uint32_t)(g_data_buf + (g_ring_tail & AT_RING_MASK)), len);
+}
+
 // Local callback. use in UART --> MODULE --> BLE path
-void dma_rx_cb0(DMA_CH_t ch)
+// The uart rx DMA fills g_data_buf in a loop, pos is where its next byte goes.
+static void dma_rx_evt(UART_INDEX_e uart_index, uint8_t evt, uint16_t pos)
 {
     //gpio_write(P23, 1);
     //gpio_write(P23, 0);
-    g_buf_status |= BIT(g_buf_rx_idx); // set g_buf_rx_idx bit
-    g_buf_rx_idx++;
+    g_ring_head += (uint16_t)((pos - g_ring_head) & AT_RING_MASK);
+
+    if(evt == UART_RX_DMA_EVT_IDLE)
+        g_rx_idle = true;
+
+    at_lat_start();
+    at_ring_update_max();
+    at_flow_rts_update();
     osal_set_event(bleuart_TaskID, BUP_OSAL_EVT_UART_DATA_RX);
 }
 
 // Local callback. use in BLE --> MODULE --> UART path
-void dma_tx_cb0(DMA_CH_t ch)  // tbd
+void dma_tx_cb0(DMA_CH_t ch)
 {
 //  gpio_write(P23, 1);
 //  gpio_write(P23, 0);
-    g_buf_status &= ~BIT(g_buf_tx_idx); // clear g_buf_tx_idx bit
-    g_send_flag = false; // clear flag once sending data done
-    g_buf_tx_idx++;
+    g_ring_tail += g_dma_len;
+    g_at_stat.tx_bytes += g_dma_len;
+    g_dma_len = 0;
     g_pkt_cnt++;  // count total pkt number on debug purpose
-    osal_set_event(bleuart_TaskID, BUP_OSAL_EVT_UART_DATA_RX);
+    at_lat_stop();
+    at_dma_tx_arm();
 }
 
-// use in BLE --> MODULE --> UART path
+// use in BLE --> MODULE --> UART path. Host lowered CTS.
+static void at_dma_cts_clear_cb(gpio_pin_e pin, gpio_polarity_e type)
+{
+    at_dma_tx_arm();
+}
+
+static void at_dma_ring_reset(void)
+{
+    g_ring_head   = 0;
+    g_ring_tail   = 0;
+    g_dma_len     = 0;
+    g_rx_idle     = false;
+    g_rts_flag    = false;
+    g_notify_wait = false;
+    g_lat_pending = false;
+    g_pkt_cnt     = 0; //debug
+    g_error       = 0; //debug
+    at_dma_get_stat(NULL, true);
+}
+
+// use in UART --> MODULE --> BLE path
 void at_dma_rx_init()
 {
     HAL_DMA_t ch_cfg;
     hal_dma_init();
     ch_cfg.dma_channel = DMA_CH_0;
-    ch_cfg.evt_handler = dma_rx_cb0;
+    ch_cfg.evt_handler = NULL;  // ring transfer never completes, progress comes from dma_rx_evt
     hal_dma_init_channel(ch_cfg);
-    g_buf_rx_idx  = 0;
-    g_buf_tx_idx  = 0;
-    g_buf_status  = 0;
-    g_notify_flag = false;
-    g_pkt_cnt     = 0; //debug
-    g_error       = 0; //debug
-    memset(g_data_buf, 0, AT_UART_RX_BUF_SIZE);
-
-    // get uart idx
-    if(UART0 == get_uart_idx())
-        cur_uart = (AP_UART_TypeDef*)AP_UART0_BASE;
-    else
-        cur_uart = (AP_UART_TypeDef*)AP_UART1_BASE;
-
-    // Initialize the channel configuration array
-    g_dma_cfg_ch0.transf_size = 0x0; // Update by start later
-    g_dma_cfg_ch0.sinc = DMA_INC_NCHG;
-    g_dma_cfg_ch0.src_tr_width = DMA_WIDTH_BYTE;
-    g_dma_cfg_ch0.src_msize = DMA_BSIZE_1; // DMA_BSIZE_32
-    //g_dma_cfg_ch0.src_addr = cur_uart->RBR;
-    g_dma_cfg_ch0.src_addr = (uint32_t)0x40004000;
-    g_dma_cfg_ch0.dinc = DMA_INC_INC;
-    g_dma_cfg_ch0.dst_tr_width = DMA_WIDTH_BYTE;
-    g_dma_cfg_ch0.dst_msize = DMA_BSIZE_1; // DMA_BSIZE_32
-    g_dma_cfg_ch0.dst_addr = NULL; // Update by APP later
-    g_dma_cfg_ch0.enable_int = true;
+    at_dma_ring_reset();
+    g_rx_dma_on = false;
+    hal_gpio_pin_init(FLOW_CTRL_IO_UART_RTS, GPIO_OUTPUT);
+    FLOW_CTRL_UART_RTS_UNLOCK();
 }
 
-// use in UART --> MODULE --> BLE path
+// use in BLE --> MODULE --> UART path
 void at_dma_tx_init()
 {
     HAL_DMA_t ch_cfg;
@@ -242,13 +337,11 @@ void at_dma_tx_init()
     ch_cfg.dma_channel = DMA_CH_0;
     ch_cfg.evt_handler = dma_tx_cb0;
     hal_dma_init_channel(ch_cfg);
-    g_buf_rx_idx = 0;
-    g_buf_tx_idx = 0;
-    g_buf_status = 0;
-    g_send_flag  = false;
-    g_pkt_cnt    = 0; //debug
-    g_error      = 0; //debug
-    memset(g_data_buf, 0, AT_UART_RX_BUF_SIZE);
+    at_dma_ring_reset();
+    // CTS left unconnected reads low, clear to send
+    hal_gpio_pin_init(FLOW_CTRL_IO_UART_CTS, GPIO_INPUT);
+    hal_gpio_pull_set(FLOW_CTRL_IO_UART_CTS, PULL_DOWN);
+    hal_gpioin_register(FLOW_CTRL_IO_UART_CTS, NULL, at_dma_cts_clear_cb);
 
     // get uart idx
     if(UART0 == get_uart_idx())
@@ -273,24 +366,33 @@ void at_dma_tx_init()
 
 void at_dma_deinit()
 {
+    if(g_rx_dma_on)
+    {
+        hal_uart_rx_dma_stop((UART_INDEX_e)get_uart_idx());
+        g_rx_dma_on = false;
+    }
+
     hal_dma_stop_channel(DMA_CH_0);
     hal_dma_deinit();
-}
-
-uint8_t at_dma_start(uint32_t tgt_addr)
-{
-    uint8_t ret;
-    g_dma_cfg_ch0.transf_size = g_buf_len;
 
     if(at_get_rxpath_flag())
     {
-        g_dma_cfg_ch0.dst_addr = tgt_addr;
+        FLOW_CTRL_UART_RTS_UNLOCK();
     }
     else
     {
-        g_dma_cfg_ch0.src_addr = tgt_addr;
+        hal_gpioin_unregister(FLOW_CTRL_IO_UART_CTS);
     }
 
+    g_notify_wait = false;
+}
+
+// use in BLE --> MODULE --> UART path, the rx path runs the uart rx DMA ring instead
+uint8_t at_dma_start(uint32_t tgt_addr, uint16_t len)
+{
+    uint8_t ret;
+    g_dma_cfg_ch0.transf_size = len;
+    g_dma_cfg_ch0.src_addr = tgt_addr;
     ret = hal_dma_config_channel(DMA_CH_0,&g_dma_cfg_ch0);
 
     if(ret == PPlus_SUCCESS)
@@ -303,6 +405,7 @@ uint8_t at_dma_start(uint32_t tgt_addr)
     else
     {
         hal_dma_stop_channel(DMA_CH_0);
+        g_dma_len = 0;
         AT_LOG("[err]ret:%d\n",ret);
         return PPlus_ERR_INTERNAL;
     }
@@ -310,109 +413,121 @@ uint8_t at_dma_start(uint32_t tgt_addr)
 
 void at_dma_uart_to_BLE_DMA_rx()
 {
-    if(g_buf_rx_idx == g_buf_num)  // round robin.
-        g_buf_rx_idx = 0;
+    int ret;
 
-    if(g_buf_status & BIT(g_buf_rx_idx))  // The data in this buf idx is still not sent to BLE.
+    if(!g_rx_dma_on)
     {
-        //g_buf_status &= ~BIT(g_buf_rx_idx); // **Note**: overwrite the forma data?? TBD.
-        g_error++; // set error number
-        AT_LOG("Rx Data overflow!");
-    }
+        ret = hal_uart_rx_dma_start((UART_INDEX_e)get_uart_idx(), g_data_buf, AT_UART_RX_BUF_SIZE, dma_rx_evt);
 
-    at_dma_start((uint32_t)(g_data_buf + g_buf_rx_idx * g_buf_div));
+        if(ret != PPlus_SUCCESS)
+        {
+            AT_LOG("[err]ret:%d\n",ret);
+            return;
+        }
 
-    if(!g_notify_flag && g_buf_status)  // Notify is not ongoing and buf is not empty, try to notify data
-    {
-        g_notify_flag = true;
-        at_dma_uart_to_BLE_notify_data();
+        g_rx_dma_on = true;
     }
+
+    HAL_ENTER_CRITICAL_SECTION();
+    at_flow_rts_update();
+    HAL_EXIT_CRITICAL_SECTION();
 }
 
-/*  The caller should set g_notify_flag = true
-    to indicate the notify is ongoing
-    before calling it
+/*  Sends every full block waiting in the ring, and the rest as well once the line went
+    idle. The notification is built straight from the ring slice; when the link layer is
+    out of buffers the data stays in the ring and is sent again at the end of the next
+    connection event.
 */
 void at_dma_uart_to_BLE_notify_data(void)
 {
     bStatus_t ret;
+    bool flush;
+    uint16_t cnt;
+    uint16_t len = bleuart_notify_max_len();
+
+    if(len > g_buf_len)
+        len = g_buf_len;
 
-    if(g_buf_tx_idx == g_buf_num)  // round robin.
-        g_buf_tx_idx = 0;
+    HAL_ENTER_CRITICAL_SECTION();
+    flush = g_rx_idle;
+    g_rx_idle = false;
+    HAL_EXIT_CRITICAL_SECTION();
 
-    //HAL_ENTER_CRITICAL_SECTION();
+    if(at_ring_count() > AT_UART_RX_BUF_SIZE)  // host ignored RTS, DMA ran over unsent data
+    {
+        g_error++;
+        g_ring_tail = g_ring_head - AT_UART_RX_BUF_SIZE;
+    }
 
-    if(g_buf_status & BIT(g_buf_tx_idx))  // handle buf data if not NULL; else do nothing
+    while(((cnt = at_ring_count()) >= len) || (flush && cnt))
     {
-        // Notes: it would be interruptted by DMA IRQ;
-        //        Remember to set g_notify_flag = false(inform APP can do notify data again) in case it would return here.
-        ret = bleuart_notify_data(g_buf_len,(uint8_t*)(g_data_buf + g_buf_tx_idx * g_buf_div));
+        if(cnt > len)
+            cnt = len;
 
-        if(SUCCESS != ret)   // re-send data in case Notify data error! Send data to APP via BLE
+        ret = bleuart_notify_ring(g_data_buf, AT_UART_RX_BUF_SIZE, g_ring_tail & AT_RING_MASK, cnt);
+
+        if(SUCCESS != ret)
         {
-            ret = bleuart_notify_data(g_buf_len,(uint8_t*)(g_data_buf + g_buf_tx_idx * g_buf_div));
+            g_at_stat.notify_busy++;
+
+            if(flush)
+                g_rx_idle = true;
 
-            if(SUCCESS != ret)
+            if(!g_notify_wait)
             {
-                //gpio_write(P18, 1);  // LED pin
-                //gpio_write(P18, 0);
-                g_error |= BIT(31); // set error number
-                g_notify_flag = false;
-                //HAL_EXIT_CRITICAL_SECTION();
-                return;
+                g_notify_wait = true;
+                bleuart_conn_evt_notice(true);
             }
+
+            return;
         }
 
         //gpio_write(P20, 1);  // Notify_L1_S, Notify_L2_S
         //gpio_write(P20, 0);
-        HAL_ENTER_CRITICAL_SECTION();
-        g_buf_status &= ~BIT(g_buf_tx_idx);
-        g_buf_tx_idx++;
+        g_ring_tail += cnt;
         g_pkt_cnt++;  // count total pkt number on debug purpose
-        HAL_EXIT_CRITICAL_SECTION();
+        g_at_stat.notify_cnt++;
+        g_at_stat.rx_bytes += cnt;
+        at_lat_stop();
+        // host held off by RTS goes on now that room is freed
+        at_dma_uart_to_BLE_DMA_rx();
     }
 
-    //gpio_write(P24, 1);  // Notify_L1_S, Notify_L2_S
-    //gpio_write(P24, 0);
-    g_notify_flag = false;  // clear flag, so it's ready to notify next pkt
-    //HAL_EXIT_CRITICAL_SECTION();
+    if(g_notify_wait)
+    {
+        g_notify_wait = false;
+        bleuart_conn_evt_notice(false);
+    }
 }
 
 
 // use in BLE --> MODULE --> UART path
-void at_dma_move_ble_data(uint8_t* pdata)
+bStatus_t at_dma_move_ble_data(uint8_t* pdata, uint16_t len)
 {
-    if(g_buf_rx_idx == g_buf_num)  // round robin.
-        g_buf_rx_idx = 0;
+    uint16_t head = g_ring_head & AT_RING_MASK;
+    uint16_t first = AT_RING_CONTIG(head);
 
-    if(g_buf_status & BIT(g_buf_rx_idx))   // The data in this buf idx is still not sent to UART.
+    if(len > AT_UART_RX_BUF_SIZE - at_ring_count())  // no room, refuse instead of overwriting
     {
-        AT_LOG("Tx data overflow!");         // **Note**: overwrite the forma data?? TBD. No flow control for now.
+        g_at_stat.write_busy++;
+        return ATT_ERR_INSUFFICIENT_RESOURCES;
     }
 
-    memcpy((uint8_t*)(g_data_buf + g_buf_rx_idx * g_buf_div), pdata, g_buf_len);
-    g_buf_status |= BIT(g_buf_rx_idx);
-    g_buf_rx_idx++;
+    if(first > len)
+        first = len;
+
+    memcpy(g_data_buf + head, pdata, first);
+    memcpy(g_data_buf, pdata + first, len - first);
+    g_ring_head += len;
+    at_lat_start();
+    at_ring_update_max();
+    return SUCCESS;
 }
 
 // use in BLE --> MODULE --> UART path
-/*  The caller should set g_send_flag = true
-    to indicate the notify is ongoing
-    before calling it
-*/
 void at_dma_BLE_to_uart_DMA_tx()
 {
-    if(g_buf_tx_idx == g_buf_num)  // round robin.
-        g_buf_tx_idx = 0;
-
-    if(g_buf_status & BIT(g_buf_tx_idx))  // If there is data in buf, send it to UART.
-    {
-//      gpio_write(P24, 1);  // Notify_L1_S, Notify_L2_S
-//      gpio_write(P24, 0);
-        at_dma_start((uint32_t)(g_data_buf + g_buf_tx_idx * g_buf_div));
-    }
-    else
-    {
-        g_send_flag = false; // clear flag if no data done
-    }
+    HAL_ENTER_CRITICAL_SECTION();
+    at_dma_tx_arm();
+    HAL_EXIT_CRITICAL_SECTION();
 }
@@ -42,6 +42,7 @@
 #define __BLEUART_AT_DMA_H__
 
 #include "types.h"
+#include "bcomdef.h"
 #include "dma.h"
 
 #ifdef __cplusplus
@@ -62,26 +63,42 @@ typedef enum
     AT_BUF_DIV_MAX,
 } AT_BUF_DIV_e;
 
+/**
+    @brief Pass-through statistics, read and cleared by at+stat
+*/
+typedef struct
+{
+    uint32_t elapsed_ms;   // since last clear
+    uint32_t rx_bytes;     // UART --> BLE bytes notified
+    uint32_t tx_bytes;     // BLE --> UART bytes sent by DMA
+    uint32_t notify_cnt;   // notifications sent
+    uint32_t notify_busy;  // notifications put off to the connection event end
+    uint32_t write_busy;   // BLE writes refused on a full buffer
+    uint32_t rts_cnt;      // host held off by RTS
+    uint32_t cts_cnt;      // UART tx held off by CTS
+    uint32_t lat_sum_ms;   // sampled buffer-in to buffer-out latency
+    uint32_t lat_cnt;
+    uint32_t lat_max_ms;
+    uint16_t ring_max;     // peak bytes buffered
+} AT_stat_t;
+
 /*********************************************************************
     FUNCTIONS
 */
 void at_dma_rx_init(void);
 void at_dma_tx_init(void);
 void at_dma_deinit(void);
-uint8_t at_dma_start(uint32_t dst_addr);
+uint8_t at_dma_start(uint32_t dst_addr, uint16_t len);
 void at_dma_uart_to_BLE_DMA_rx(void);
 void at_dma_uart_to_BLE_notify_data(void);
-bool at_dma_get_notify_flag(void);
-void at_dma_set_notify_flag(bool n_flag);
 AT_BUF_DIV_e at_dma_get_div(void);
 void at_dma_set_div(AT_BUF_DIV_e div);
 uint32_t at_get_count(void);
 uint8_t at_dma_get_buf_len(void);
 void at_dma_set_buf_len(uint8_t b_len);
-void at_dma_move_ble_data(uint8_t* pdata);
+bStatus_t at_dma_move_ble_data(uint8_t* pdata, uint16_t len);
 void at_dma_BLE_to_uart_DMA_tx(void);
-bool at_dma_get_send_flag(void);
-void at_dma_set_send_flag(bool n_flag);
+void at_dma_get_stat(AT_stat_t* stat, bool reset);
 /*********************************************************************
 *********************************************************************/
 
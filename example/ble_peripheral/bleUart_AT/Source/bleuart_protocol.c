@@ -95,6 +95,9 @@ typedef struct
 BUP_ctx_t mBUP_Ctx = {0};
 
 uint8_t ptcmd[] = "at+reset";
+#define BUP_PT_CMD_NONE     0
+#define BUP_PT_CMD_AT       1
+#define BUP_PT_CMD_RESET    2
 //uint8_t at_flag  = 0;
 uint8_t g_uart_idx = UART0;
 attHandleValueNoti_t notify_data= {0};
@@ -443,40 +446,39 @@ int BUP_data_BLE_to_uart_completed(void)
     return PPlus_SUCCESS;
 }
 
+// AT cmds taken out of the pass-through stream. Only a chunk that is exactly "at" or
+// "at+reset" qualifies, so streamed data costs a length compare and no byte compare.
+static uint8_t BUP_pt_cmd(uint8_t* buf, uint16_t len)
+{
+    if((len == 2) && (buf[0] == 'a') && (buf[1] == 't'))
+        return BUP_PT_CMD_AT;
+
+    if((len == sizeof(ptcmd) - 1) && (memcmp(buf, ptcmd, len) == 0))
+        return BUP_PT_CMD_RESET;
+
+    return BUP_PT_CMD_NONE;
+}
+
 int BUP_data_BLE_to_uart_send(void)
 {
     BUP_ctx_t* pctx = &mBUP_Ctx;
 
     if(pctx->tx_state != BUP_TX_ST_IDLE && pctx->tx_size)
     {
-        // run at cmd.
-        if((pctx->tx_size) == 2 && \
-                (pctx->tx_buf[0] == 'a') && \
-                (pctx->tx_buf[1] == 't'))
+        switch(BUP_pt_cmd(pctx->tx_buf, pctx->tx_size))
         {
+        case BUP_PT_CMD_AT:  // run at cmd.
             at_at(0,NULL);
             pctx->tx_state = BUP_TX_ST_IDLE;
             pctx->tx_size = 0;
             return PPlus_SUCCESS;
-        }
-        // run at+reset cmd.
-        else if(pctx->tx_size == 8)
-        {
-            bool flag = true;
 
-            for(int i=0; i<8; i++)
-            {
-                if(pctx->tx_buf[i] != ptcmd[i])
-                {
-                    flag = false;
-                    break;
-                }
-                else
-                    continue;
-            }
+        case BUP_PT_CMD_RESET:  // run at+reset cmd.
+            at_reset(0,NULL);
+            break;
 
-            if(flag)
-                at_reset(0,NULL);
+        default:
+            break;
         }
 
         hal_uart_send_buff((UART_INDEX_e)g_uart_idx, pctx->tx_buf, pctx->tx_size);
@@ -494,19 +496,11 @@ int BUP_data_BLE_to_uart(uint8_t* pdata, uint8_t size)
     //DMA_CH_t ch;
     if(at_get_dma_flag())  // use M2P DMA copy for block data. 'at+dma' cmd
     {
-        if(size != at_dma_get_buf_len())  // skip the pkt with wrong size? TBD may be <end of file>
-        {
-//          gpio_write(P20, 1);  // Notify_L1_S, Notify_L2_S
-//          gpio_write(P20, 0);
-            AT_LOG("Err blk size");
-            return PPlus_ERR_NOT_SUPPORTED;
-        }
-        else
-        {
-            at_dma_move_ble_data(pdata);
-            osal_set_event(bleuart_TaskID, BUP_OSAL_EVT_UART_DATA_RX);
-            return PPlus_SUCCESS;
-        }
+        if(at_dma_move_ble_data(pdata, size) != SUCCESS)
+            return PPlus_ERR_NO_MEM;
+
+        osal_set_event(bleuart_TaskID, BUP_OSAL_EVT_UART_DATA_RX);
+        return PPlus_SUCCESS;
     }
 
     BUP_ctx_t* pctx = &mBUP_Ctx;
@@ -518,7 +512,7 @@ int BUP_data_BLE_to_uart(uint8_t* pdata, uint8_t size)
     {
         if((pctx->tx_size + size)>=UART_TX_BUF_SIZE) // data overflow. 0304
         {
-            break;
+            return PPlus_ERR_NO_MEM;
         }
 
         HAL_ENTER_CRITICAL_SECTION();
@@ -538,7 +532,7 @@ int BUP_data_BLE_to_uart(uint8_t* pdata, uint8_t size)
         {
 //                  hal_gpio_write(P18,1);
 //                  hal_gpio_write(P18,0);
-            break;
+            return PPlus_ERR_NO_MEM;
         }
 
         HAL_ENTER_CRITICAL_SECTION();
@@ -557,10 +551,21 @@ int BUP_data_BLE_to_uart(uint8_t* pdata, uint8_t size)
     return PPlus_SUCCESS;
 }
 
+// largest notification payload on the current link
+uint16_t bleuart_notify_max_len(void)
+{
+    uint16_t mtu = ATT_GetCurrentMTUSize(gapConnHandle);
+
+    if(mtu > ATT_MTU_SIZE)
+        mtu = ATT_MTU_SIZE;
+
+    return mtu - 3;
+}
+
 bStatus_t bleuart_notify_data(uint8_t n_size, uint8_t* n_data)
 {
-    if(n_size > ATT_MTU_SIZE-3)
-        notify_data.len = ATT_MTU_SIZE-3;
+    if(n_size > bleuart_notify_max_len())
+        notify_data.len = bleuart_notify_max_len();
     else
         notify_data.len = n_size;
 
@@ -568,6 +573,20 @@ bStatus_t bleuart_notify_data(uint8_t n_size, uint8_t* n_data)
     return bleuart_Notify( gapConnHandle, &notify_data, bleuart_TaskID );
 }
 
+// notify n_size bytes from offset of a ring, wrapping to the ring start
+bStatus_t bleuart_notify_ring(uint8_t* ring, uint16_t ring_size, uint16_t offset, uint16_t n_size)
+{
+    uint16_t first = ring_size - offset;
+
+    if(first > n_size)
+        first = n_size;
+
+    notify_data.len = n_size;
+    memcpy(notify_data.value, ring + offset, first);
+    memcpy(notify_data.value + first, ring, n_size - first);
+    return bleuart_Notify( gapConnHandle, &notify_data, bleuart_TaskID );
+}
+
 int BUP_data_uart_to_BLE_send(void)
 {
     BUP_ctx_t* pctx = &mBUP_Ctx;
@@ -576,11 +595,9 @@ int BUP_data_uart_to_BLE_send(void)
     //AT_LOG("r_1\n");
     if(pctx->rx_state != BUP_RX_ST_IDLE && pctx->rx_size)
     {
-        // run at cmd.
-        if((pctx->rx_size) == 2 && \
-                (pctx->rx_buf[0] == 'a') && \
-                (pctx->rx_buf[1] == 't'))
+        switch(BUP_pt_cmd(pctx->rx_buf, pctx->rx_size))
         {
+        case BUP_PT_CMD_AT:  // run at cmd.
             at_at(0,NULL);
             pctx->rx_state = BUP_RX_ST_IDLE;
             pctx->rx_offset = 0;
@@ -593,25 +610,13 @@ int BUP_data_uart_to_BLE_send(void)
             }
 
             return PPlus_SUCCESS;
-        }
-        // run at+reset cmd.
-        else if(pctx->rx_size == 8)
-        {
-            bool flag = true;
 
-            for(int i=0; i<8; i++)
-            {
-                if(pctx->rx_buf[i] != ptcmd[i])
-                {
-                    flag = false;
-                    break;
-                }
-                else
-                    continue;
-            }
+        case BUP_PT_CMD_RESET:  // run at+reset cmd.
+            at_reset(0,NULL);
+            break;
 
-            if(flag)
-                at_reset(0,NULL);
+        default:
+            break;
         }
 
         if(bleuart_NotifyIsReady() == FALSE)
@@ -630,13 +635,12 @@ int BUP_data_uart_to_BLE_send(void)
         {
             uint8_t size =0;
             bStatus_t ret = 0;
-            attHandleValueNoti_t notify_data= {0};
-            HAL_ENTER_CRITICAL_SECTION();
-            size = ((pctx->rx_size - pctx->rx_offset) > 244) ? 244 : pctx->rx_size - pctx->rx_offset; //ATT_MTU_SIZE  20  192
-            memcpy(notify_data.value,pctx->rx_buf + pctx->rx_offset, size);
-            notify_data.len = size;
-            HAL_EXIT_CRITICAL_SECTION();
-            ret = bleuart_Notify(gapConnHandle, &notify_data, bleuart_TaskID);
+            // rx_buf is only filled from task context, no need to lock it
+            size = pctx->rx_size - pctx->rx_offset;
+            ret = bleuart_notify_data(size, pctx->rx_buf + pctx->rx_offset);
+
+            if(size > bleuart_notify_max_len())
+                size = bleuart_notify_max_len();
 
             //AT_LOG("bleuart_Notify: %d, %d, %d\n", ret,pctx->rx_offset, pctx->rx_size);
             //printf("ret:%d\n",ret);
@@ -648,6 +652,8 @@ int BUP_data_uart_to_BLE_send(void)
             {
                 if(ret == MSG_BUFFER_NOT_AVAIL)
                 {
+                    // sent again when the connection event frees buffers
+                    bleuart_conn_evt_notice(true);
 //          if(start_flg){
 //                      //AT_LOG("=NY1:");
 //            rx_start_timer(1);
@@ -668,6 +674,7 @@ int BUP_data_uart_to_BLE_send(void)
             if(pctx->rx_offset == pctx->rx_size)
             {
                 LOG("Success\n");
+                bleuart_conn_evt_notice(false);
                 pctx->rx_state = BUP_RX_ST_IDLE;
                 pctx->rx_offset = 0;
                 pctx->rx_size = 0;
@@ -59,6 +59,8 @@ void gpio_wakeup_handle(void);
 void gpio_sleep_handle(void);
 uint8_t get_uart_idx(void);
 void set_uart_idx(uint8_t idx);
+uint16_t bleuart_notify_max_len(void);
 bStatus_t bleuart_notify_data(uint8_t n_size, uint8_t* n_data);
+bStatus_t bleuart_notify_ring(uint8_t* ring, uint16_t ring_size, uint16_t offset, uint16_t n_size);
 #endif /*_BLE_UART_PROTOCOL_H*/
 
@@ -117,7 +117,8 @@ static bleuart_ProfileChangeCB_t bleuart_AppCBs = NULL;
 static gattAttrType_t bleuart_Service = { ATT_BT_UUID_SIZE, bleuart_ServiceUUID };
 
 // Profile Characteristic 1 Properties
-static uint8 bleuart_PTCharProps = GATT_PROP_NOTIFY| GATT_PROP_READ| GATT_PROP_WRITE_NO_RSP;
+// Write request lets the peer see a busy module and retry, write command data is lost then
+static uint8 bleuart_PTCharProps = GATT_PROP_NOTIFY| GATT_PROP_READ| GATT_PROP_WRITE_NO_RSP| GATT_PROP_WRITE;
 
 // Characteristic 1 Value
 static uint8 bleuart_PTCharValue[RAWPASS_RX_BUFF_SIZE];// = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0,};
@@ -326,7 +327,7 @@ static bStatus_t bleuart_WriteAttrCB( uint16 connHandle, gattAttribute_t* pAttr,
             evt.ev = bleuart_EVT_BLE_DATA_RECIEVED;
             evt.param = (uint16_t)len;
             evt.data = pValue;
-            bleuart_AppCBs(&evt);
+            status = bleuart_AppCBs(&evt);
         }
     }
     else
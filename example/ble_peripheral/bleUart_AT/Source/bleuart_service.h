@@ -80,7 +80,7 @@ typedef struct
     void*     data;
 } bleuart_Evt_t;
 
-typedef void (*bleuart_ProfileChangeCB_t)(bleuart_Evt_t* pev);
+typedef bStatus_t (*bleuart_ProfileChangeCB_t)(bleuart_Evt_t* pev);
 
 
 
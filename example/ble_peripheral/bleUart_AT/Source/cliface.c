@@ -36,33 +36,16 @@ uint16_t CLI_init
     return 0;
 }
 
-/**
-    \brief Process a command line instruction
-
-    \Description
-    This routine processes a command line instruction.
-
-    \param [in] buffer        Buffer containing a command
-    \param [in] buffer_len    Length of command in buffer
-    \param [in] cmd_list      Command List
-    \param [in] cmd_count     Number of command in the list
-
-    \return EM_SUCCESS or an error code indicating reason for failure
-*/
-uint16_t CLI_process_line
+/* Split a command line in place, returns the command name or NULL if empty */
+static uint8_t* cli_split_line
 (
-    /* IN */ uint8_t*        buffer,
-    /* IN */ uint32_t        buffer_len,
-    /* IN */ CLI_COMMAND* cmd_list,
-    /* IN */ uint32_t        cmd_count
+    /* IN */  uint8_t*   buffer,
+    /* IN */  uint32_t   buffer_len,
+    /* OUT */ uint32_t*  argc,
+    /* OUT */ uint8_t*   argv[]
 )
 {
-    uint32_t  argc;
-    uint8_t*   argv[CLI_MAX_ARGS];
     uint8_t*   cmd;
-    uint32_t   index;
-    /* TBD: Parameter Validation */
-    CLI_NULL_CHECK(buffer);
 
     /* Skip initial white spaces */
     for (; CLI_IS_WHITE_SPACE(*buffer) && (0 != buffer_len); buffer++, buffer_len--);
@@ -72,14 +55,14 @@ uint16_t CLI_process_line
     {
         CLI_ERR(
             "[CLI] Empty command line\n");
-        return 0xffff;
+        return NULL;
     }
 
     /**
         Got the initial command.
         Parse the remaining command line to get the arguments.
     */
-    argc = 0;
+    *argc = 0;
 
     for (cmd = buffer + 1; cmd < (buffer + buffer_len); cmd++)
     {
@@ -108,9 +91,9 @@ uint16_t CLI_process_line
             *cmd = '\0';
         }
         /* Check if this is start of a new argument */
-        else if ('\0' == (*(cmd - 1)))
+        else if (('\0' == (*(cmd - 1))) && (*argc < CLI_MAX_ARGS))
         {
-            argv[argc++] = cmd;
+            argv[(*argc)++] = cmd;
         }
         else
         {
@@ -119,23 +102,78 @@ uint16_t CLI_process_line
     }
 
     CLI_TRC(
-        "[CLI] Command %s, Number of arguments %d\n", buffer, argc);
+        "[CLI] Command %s, Number of arguments %d\n", buffer, *argc);
     {
         uint8_t ai;
 
-        for (ai = 0; ai < argc; ai++)
+        for (ai = 0; ai < *argc; ai++)
         {
             CLI_TRC(
                 "Arg [%02X] %s\n", ai, argv[ai]);
         }
     }
+    return buffer;
+}
+
+/* FNV-1a hash of a command name */
+static uint32_t cli_hash
+(
+    /* IN */ const uint8_t*  cmd,
+    /* IN */ uint32_t        cmd_len
+)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+
+    while (0 != cmd_len--)
+    {
+        hash ^= *cmd++;
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+/**
+    \brief Process a command line instruction
+
+    \Description
+    This routine processes a command line instruction.
+
+    \param [in] buffer        Buffer containing a command
+    \param [in] buffer_len    Length of command in buffer
+    \param [in] cmd_list      Command List
+    \param [in] cmd_count     Number of command in the list
+
+    \return EM_SUCCESS or an error code indicating reason for failure
+*/
+uint16_t CLI_process_line
+(
+    /* IN */ uint8_t*        buffer,
+    /* IN */ uint32_t        buffer_len,
+    /* IN */ CLI_COMMAND* cmd_list,
+    /* IN */ uint32_t        cmd_count
+)
+{
+    uint32_t  argc;
+    uint8_t*   argv[CLI_MAX_ARGS];
+    uint8_t*   cmd;
+    uint32_t   index;
+    /* TBD: Parameter Validation */
+    CLI_NULL_CHECK(buffer);
     /* Identified command name */
-    cmd = buffer;
+    cmd = cli_split_line(buffer, buffer_len, &argc, argv);
+
+    if (NULL == cmd)
+    {
+        return 0xffff;
+    }
 
     /* Search command and call associated callback */
     for (index = 0; index < cmd_count; index++)
     {
-        if (0 == CLI_STR_COMPARE(buffer, cmd_list[index].cmd))
+        if (0 == CLI_STR_COMPARE(cmd, cmd_list[index].cmd))
         {
             cmd_list[index].cmd_hdlr(argc, argv);
             break;
@@ -145,6 +183,155 @@ uint16_t CLI_process_line
     return 0;
 }
 
+/**
+    \brief Index a command list for hashed lookup
+
+    \Description
+    This routine places every command of the list in an open addressed slot
+    array, so that a command is found with one hash and a short probe run
+    whatever the size of the list. Probe runs grow quickly once the slots
+    are more than half full, so size the slot array at least twice the
+    number of commands.
+
+    \param [out] table        Table to be initialized
+    \param [in] cmd_list      Command List, kept by reference
+    \param [in] cmd_count     Number of command in the list
+    \param [in] slot          Slot array, kept by reference
+    \param [in] slot_count    Number of slots, a power of 2 above cmd_count and at most 256
+
+    \return EM_SUCCESS or an error code indicating reason for failure
+*/
+uint16_t CLI_table_init
+(
+    /* OUT */ CLI_TABLE*         table,
+    /* IN */  const CLI_COMMAND* cmd_list,
+    /* IN */  uint32_t           cmd_count,
+    /* IN */  uint8_t*           slot,
+    /* IN */  uint32_t           slot_count
+)
+{
+    uint32_t  index;
+    uint32_t  hash;
+    CLI_NULL_CHECK(table);
+    CLI_NULL_CHECK(cmd_list);
+    CLI_NULL_CHECK(slot);
+
+    /* Keep an empty slot so that a lookup miss terminates */
+    if ((slot_count > 256) || (0 != (slot_count & (slot_count - 1))) ||
+            (cmd_count >= slot_count))
+    {
+        CLI_ERR(
+            "[CLI] Invalid slot count %d\n", slot_count);
+        return 0xffff;
+    }
+
+    memset(slot, 0, slot_count);
+    table->cmd_list = cmd_list;
+    table->cmd_count = (uint8_t)cmd_count;
+    table->slot_mask = (uint8_t)(slot_count - 1);
+    table->slot = slot;
+
+    for (index = 0; index < cmd_count; index++)
+    {
+        hash = cli_hash(cmd_list[index].cmd, CLI_strlen(cmd_list[index].cmd));
+
+        while (0 != slot[hash & table->slot_mask])
+        {
+            hash++;
+        }
+
+        slot[hash & table->slot_mask] = (uint8_t)(index + 1);
+    }
+
+    return 0;
+}
+
+/**
+    \brief Find a command by name
+
+    \param [in] table      Command table
+    \param [in] cmd        Command name, need not be NULL terminated
+    \param [in] cmd_len    Length of the command name
+
+    \return The command or NULL if there is no such command
+*/
+const CLI_COMMAND* CLI_lookup
+(
+    /* IN */ CLI_TABLE*      table,
+    /* IN */ const uint8_t*  cmd,
+    /* IN */ uint32_t        cmd_len
+)
+{
+    const CLI_COMMAND* entry;
+    uint32_t  hash;
+    uint8_t   index;
+
+    /* Table not set up */
+    if ((NULL == table) || (NULL == table->slot))
+    {
+        return NULL;
+    }
+
+    hash = cli_hash(cmd, cmd_len);
+
+    while (0 != (index = table->slot[hash & table->slot_mask]))
+    {
+        entry = &table->cmd_list[index - 1];
+
+        if ((0 == strncmp((const char*)cmd, (const char*)entry->cmd, cmd_len)) &&
+                ('\0' == entry->cmd[cmd_len]))
+        {
+            return entry;
+        }
+
+        hash++;
+    }
+
+    return NULL;
+}
+
+/**
+    \brief Process a command line instruction through a hashed table
+
+    \Description
+    Same as CLI_process_line, with the command found by CLI_lookup.
+
+    \param [in] buffer        Buffer containing a command
+    \param [in] buffer_len    Length of command in buffer
+    \param [in] table         Command table set up by CLI_table_init
+
+    \return EM_SUCCESS or an error code indicating reason for failure
+*/
+uint16_t CLI_process_line_table
+(
+    /* IN */ uint8_t*        buffer,
+    /* IN */ uint32_t        buffer_len,
+    /* IN */ CLI_TABLE*      table
+)
+{
+    uint32_t  argc;
+    uint8_t*   argv[CLI_MAX_ARGS];
+    uint8_t*   cmd;
+    const CLI_COMMAND* entry;
+    CLI_NULL_CHECK(buffer);
+    CLI_NULL_CHECK(table);
+    cmd = cli_split_line(buffer, buffer_len, &argc, argv);
+
+    if (NULL == cmd)
+    {
+        return 0xffff;
+    }
+
+    entry = CLI_lookup(table, cmd, CLI_strlen(cmd));
+
+    if (NULL != entry)
+    {
+        entry->cmd_hdlr(argc, argv);
+    }
+
+    return 0;
+}
+
 /* TODO: Create a separe utility module or move to a common utility module */
 /* Supporting Macros */
 #define IS_SPACE(c) ((' ' == (c)) || ('\t' == (c)))
@@ -222,6 +409,57 @@ int32_t CLI_strtoi
     return (sign_adj * value);
 }
 
+/* Convert a whole NULL terminated string to an unsigned Integer, fails on any non digit or on overflow */
+uint16_t CLI_strtoui
+(
+    /* IN */  uint8_t*   data,
+    /* IN */  uint8_t    base,
+    /* OUT */ uint32_t*  value
+)
+{
+    uint32_t result;
+    uint8_t  c;
+    uint8_t  digit;
+    CLI_NULL_CHECK(data);
+
+    if ('\0' == *data)
+    {
+        return 0xFFFF;
+    }
+
+    result = 0;
+
+    for (; '\0' != (c = *data); data++)
+    {
+        if (IS_DIGIT(c))
+        {
+            digit = c - '0';
+        }
+        else if (IS_LOWER(c))
+        {
+            digit = c - 'a' + 10;
+        }
+        else if (IS_UPPER(c))
+        {
+            digit = c - 'A' + 10;
+        }
+        else
+        {
+            return 0xFFFF;
+        }
+
+        if ((digit >= base) || (result > ((0xFFFFFFFFUL - digit) / base)))
+        {
+            return 0xFFFF;
+        }
+
+        result = (result * base) + digit;
+    }
+
+    *value = result;
+    return 0;
+}
+
 /* Convert string to Integer Array */
 uint16_t CLI_strtoarray
 (
@@ -50,6 +50,13 @@
 
 #define CLI_strlen(s)   strlen((const char*)s)
 
+/**
+    Binary command framing for host MCUs: sync octet, length octet, then the
+    command line of that length without terminator.
+*/
+#define CLI_FRAME_SYNC      0xA5
+#define CLI_FRAME_HDR_LEN   2
+
 /* --------------------------------------------- Data Types/ Structures */
 /**
     CLI command handler.
@@ -79,6 +86,23 @@ typedef struct _cli_command
 
 } CLI_COMMAND;
 
+/** Command list indexed by a hash of the command name */
+typedef struct _cli_table
+{
+    /** Command List */
+    const CLI_COMMAND*      cmd_list;
+
+    /** Number of command in the list */
+    uint8_t                 cmd_count;
+
+    /** Number of slots - 1, the number of slots is a power of 2 */
+    uint8_t                 slot_mask;
+
+    /** Command index + 1 per slot, 0 for an empty slot */
+    uint8_t*                slot;
+
+} CLI_TABLE;
+
 
 /* --------------------------------------------- Functions */
 uint16_t CLI_init
@@ -94,6 +118,29 @@ uint16_t CLI_process_line
     /* IN */ uint32_t        cmd_count
 );
 
+uint16_t CLI_table_init
+(
+    /* OUT */ CLI_TABLE*         table,
+    /* IN */  const CLI_COMMAND* cmd_list,
+    /* IN */  uint32_t           cmd_count,
+    /* IN */  uint8_t*           slot,
+    /* IN */  uint32_t           slot_count
+);
+
+const CLI_COMMAND* CLI_lookup
+(
+    /* IN */ CLI_TABLE*      table,
+    /* IN */ const uint8_t*  cmd,
+    /* IN */ uint32_t        cmd_len
+);
+
+uint16_t CLI_process_line_table
+(
+    /* IN */ uint8_t*        buffer,
+    /* IN */ uint32_t        buffer_len,
+    /* IN */ CLI_TABLE*      table
+);
+
 int32_t CLI_strtoi
 (
     /* IN */ uint8_t* data,
@@ -101,6 +148,13 @@ int32_t CLI_strtoi
     /* IN */ uint8_t base
 );
 
+uint16_t CLI_strtoui
+(
+    /* IN */  uint8_t*   data,
+    /* IN */  uint8_t    base,
+    /* OUT */ uint32_t*  value
+);
+
 uint16_t CLI_strtoarray
 (
     /* IN */  uint8_t*   data,
@@ -24,6 +24,9 @@ extern "C" {
 ***********************************************************/
 #define INV_MOTION_DRIVER           0
 
+/* 1 - hardware I2C with interrupt driven transfers, 0 - GPIO simulated I2C */
+#define MPU_HW_I2C_EN               1
+
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -44,6 +47,8 @@ typedef BYTE_T MPU_RET;
 #define MPU_ERR_SELF_TEST_FAILED    0x0C
 #define MPU_ERR_EN_DMP_FAILED       0x0D
 #define MPU_ERR_IRQ_INIT_FAILED     0x0E
+#define MPU_ERR_BUSY                0x0F
+#define MPU_ERR_XFER_FAILED         0x10
 
 /* MPU6050 Gyro data type */
 typedef BYTE_T MPU_GYRO_DT_E;
@@ -85,6 +90,24 @@ typedef BYTE_T MPU_CLK_E;
 #define MPU_CLK_PLL_EXT19M          0x05
 #define MPU_CLK_KEEP_RESET          0x07
 
+/* MPU6050 raw sample */
+typedef struct {
+    SHORT_T accel[3];
+    SHORT_T temp;
+    SHORT_T gyro[3];
+} MPU_RAW_SAMPLE_T;
+
+/* sample ready callback */
+typedef VOID_T (*MPU_SAMPLE_CB)(MPU_RET ret);
+
+/* CPU time spent on sample reads */
+typedef struct {
+    UINT_T samples;
+    UINT_T errors;
+    UINT_T cpu_us;              /* total of all samples */
+    UINT_T cpu_us_max;          /* longest sample */
+} MPU_CPU_STAT_T;
+
 /***********************************************************
 ***********************variable define**********************
 ***********************************************************/
@@ -175,6 +198,39 @@ VOID_T tuya_mpu6050_read_gyro_spec_unit(_OUT FLOAT_T *g_x, _OUT FLOAT_T *g_y, _O
  */
 FLOAT_T tuya_mpu6050_read_temp(VOID_T);
 
+/**
+ * @brief start reading accel, temperature and gyro data in one burst
+ * @param[in] cb: called when the sample is ready, in interrupt context with hardware I2C
+ * @return MPU_OK, MPU_ERR_BUSY if the previous read is not over
+ */
+MPU_RET tuya_mpu6050_read_sample_async(_IN MPU_SAMPLE_CB cb);
+
+/**
+ * @brief get the last sample read (raw data)
+ * @param[out] sample: raw sample
+ * @return none
+ */
+VOID_T tuya_mpu6050_get_sample_raw(_OUT MPU_RAW_SAMPLE_T *sample);
+
+/**
+ * @brief get the last sample read (specified unit)
+ * @param[out] gyro: gyroscope data of 3-axis
+ * @param[in] g_unit: gyroscope unit
+ * @param[out] accel: accelerometer data of 3-axis
+ * @param[in] a_unit: accelerometer unit
+ * @return none
+ */
+VOID_T tuya_mpu6050_get_sample_spec_unit(_OUT FLOAT_T *gyro, _IN CONST MPU_GYRO_DT_E g_unit,
+                                         _OUT FLOAT_T *accel, _IN CONST MPU_ACCEL_DT_E a_unit);
+
+/**
+ * @brief get CPU time statistics of sample reads
+ * @param[out] stat: statistics
+ * @param[in] reset: TRUE - clear statistics after reading
+ * @return none
+ */
+VOID_T tuya_mpu6050_get_cpu_stat(_OUT MPU_CPU_STAT_T *stat, _IN CONST BOOL_T reset);
+
 #if INV_MOTION_DRIVER
 /**
  * @brief MPU6050 built-in DMP init
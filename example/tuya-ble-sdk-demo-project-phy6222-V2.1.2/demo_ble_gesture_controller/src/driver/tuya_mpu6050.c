@@ -13,6 +13,13 @@
 #include "ty_i2c.h"
 #include "tuya_ble_log.h"
 #include "tuya_ble_port.h"
+#include "timer.h"
+#include <string.h>
+
+#if MPU_HW_I2C_EN
+#include "i2c.h"
+#include "error.h"
+#endif
 
 #if INV_MOTION_DRIVER
 #include "inv_mpu.h"
@@ -35,6 +42,16 @@
 #define MPU6050_ADDR_CMD_WRITE          ((MPU6050_DEV_ADDR << 1) | I2C_CMD_WRITE)
 #define MPU6050_ADDR_CMD_READ           ((MPU6050_DEV_ADDR << 1) | I2C_CMD_READ)
 
+/* hardware I2C */
+#define MPU6050_I2C_DEV                 I2C_1
+#define MPU6050_I2C_PIN_SDA             GPIO_P26
+#define MPU6050_I2C_PIN_SCL             GPIO_P31
+
+/* accel, temperature and gyro registers in one burst */
+#define MPU6050_SAMPLE_LEN              14
+
+#define MPU_TIME_DELTA(t0, t1)          (((t1) >= (t0)) ? ((t1) - (t0)) : (BASE_TIME_UNITS - (t0) + (t1)))
+
 /* register map */
 #define MPU6050_RA_XG_OFFS_TC           0x00
 #define MPU6050_RA_YG_OFFS_TC           0x01
@@ -192,6 +209,15 @@ STATIC BOOL_T sg_pwr_pin_used = FALSE;
 STATIC FLOAT_T sg_gyro_sens = 0.0f;
 STATIC USHORT_T sg_accel_sens = 0;
 
+#if MPU_HW_I2C_EN
+STATIC VOID_T *sg_i2c = NULL;
+STATIC i2c_xfer_t sg_sample_xfer;
+#endif
+STATIC UCHAR_T sg_sample_buf[MPU6050_SAMPLE_LEN];
+STATIC MPU_RAW_SAMPLE_T sg_sample;
+STATIC MPU_SAMPLE_CB sg_sample_cb = NULL;
+STATIC MPU_CPU_STAT_T sg_cpu_stat;
+
 #if INV_MOTION_DRIVER
 STATIC CHAR_T gyro_orientation[9] = { 0,-1, 0,
                                       1, 0, 0,
@@ -201,6 +227,47 @@ STATIC CHAR_T gyro_orientation[9] = { 0,-1, 0,
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
+/**
+ * @brief I2C init, hardware I2C at 400kHz or GPIO simulated I2C
+ * @param[in] none
+ * @return none
+ */
+STATIC VOID_T __mpu6050_i2c_init(VOID_T)
+{
+#if MPU_HW_I2C_EN
+    hal_i2c_pin_init(MPU6050_I2C_DEV, MPU6050_I2C_PIN_SDA, MPU6050_I2C_PIN_SCL);
+    sg_i2c = hal_i2c_init(MPU6050_I2C_DEV, I2C_CLOCK_400K);
+#else
+    i2c_soft_gpio_init();
+#endif
+}
+
+#if MPU_HW_I2C_EN
+/**
+ * @brief transfer with MPU6050 registers over hardware I2C, waits for the end
+ * @param[in] dir: I2C_XFER_READ or I2C_XFER_WRITE
+ * @param[in] reg_addr: first register address
+ * @param[in] len: data length
+ * @param[inout] data: data buffer
+ * @return 0 means success
+ */
+STATIC INT_T __mpu6050_i2c_xfer(_IN CONST UCHAR_T dir, _IN CONST UCHAR_T reg_addr, _IN CONST USHORT_T len, _INOUT UCHAR_T *data)
+{
+    i2c_xfer_t xfer;
+
+    xfer.slave_addr = MPU6050_DEV_ADDR;
+    xfer.reg = reg_addr;
+    xfer.dir = dir;
+    /* FIFO and DMP memory ports do not auto increment */
+    xfer.flags = (reg_addr == MPU6050_RA_FIFO_R_W || reg_addr == MPU6050_RA_MEM_R_W) ? I2C_XFER_FIXED_REG : 0;
+    xfer.data = data;
+    xfer.size = len;
+    xfer.cb = NULL;
+    xfer.arg = NULL;
+    return hal_i2c_xfer(sg_i2c, &xfer);
+}
+#endif
+
 /**
  * @brief read data of MPU6050
  * @param[in] reg_addr: register address
@@ -210,11 +277,15 @@ STATIC CHAR_T gyro_orientation[9] = { 0,-1, 0,
  */
 STATIC VOID_T __mpu6050_read_data(_IN UCHAR_T reg_addr, _IN CONST UCHAR_T len, _OUT UCHAR_T *data)
 {
+#if MPU_HW_I2C_EN
+    __mpu6050_i2c_xfer(I2C_XFER_READ, reg_addr, len, data);
+#else
     i2c_start();
     i2c_send_bytes(MPU6050_ADDR_CMD_WRITE, &reg_addr, 1);
     i2c_start();
     i2c_rcv_bytes(MPU6050_ADDR_CMD_READ, data, len);
     i2c_stop();
+#endif
 }
 
 /**
@@ -224,12 +295,8 @@ STATIC VOID_T __mpu6050_read_data(_IN UCHAR_T reg_addr, _IN CONST UCHAR_T len, _
  */
 STATIC UCHAR_T __mpu6050_read_register(_IN UCHAR_T reg_addr)
 {
-    UCHAR_T reg_val;
-    i2c_start();
-    i2c_send_bytes(MPU6050_ADDR_CMD_WRITE, &reg_addr, 1);
-    i2c_start();
-    i2c_rcv_bytes(MPU6050_ADDR_CMD_READ, &reg_val, 1);
-    i2c_stop();
+    UCHAR_T reg_val = 0;
+    __mpu6050_read_data(reg_addr, 1, &reg_val);
     return reg_val;
 }
 
@@ -241,7 +308,11 @@ STATIC UCHAR_T __mpu6050_read_register(_IN UCHAR_T reg_addr)
  */
 STATIC VOID_T __mpu6050_write_register(_IN CONST UCHAR_T reg_addr, _IN UCHAR_T reg_val)
 {
+#if MPU_HW_I2C_EN
+    __mpu6050_i2c_xfer(I2C_XFER_WRITE, reg_addr, 1, &reg_val);
+#else
     i2c_soft_cfg(MPU6050_ADDR_CMD_WRITE, reg_addr, reg_val);
+#endif
 }
 
 /**
@@ -260,7 +331,7 @@ STATIC VOID_T __mpu6050_write_register_bit(_IN CONST UCHAR_T reg_addr, _IN CONST
         reg_val = __mpu6050_read_register(reg_addr);
         reg_val = (reg_val & (~valid_bit)) | (data & valid_bit);
     }
-    i2c_soft_cfg(MPU6050_ADDR_CMD_WRITE, reg_addr, reg_val);
+    __mpu6050_write_register(reg_addr, reg_val);
 }
 
 #if 0
@@ -525,8 +596,7 @@ MPU_RET tuya_mpu6050_init(_IN CONST MPU_CLK_E clk, _IN CONST MPU_GYRO_FSR_E g_fs
                           _IN TY_GPIO_IRQ_CB int_cb)
 {
     /* I2C init */
-    i2c_soft_gpio_init();
-	  //ty_i2c_init();
+    __mpu6050_i2c_init();
     /* reset MPU6050 */
     __mpu6050_reset();
     /* check communication */
@@ -752,6 +822,144 @@ VOID_T tuya_mpu6050_read_gyro_spec_unit(_OUT FLOAT_T *g_x, _OUT FLOAT_T *g_y, _O
     __cnv_gyro_unit(gx, gy, gz, g_x, g_y, g_z, unit);
 }
 
+/**
+ * @brief update CPU time statistics of sample reads
+ * @param[in] cpu_us: CPU time of this sample read
+ * @param[in] ret: result of this sample read
+ * @return none
+ */
+STATIC VOID_T __mpu6050_cpu_stat_update(_IN CONST UINT_T cpu_us, _IN CONST MPU_RET ret)
+{
+    sg_cpu_stat.samples++;
+    if (ret != MPU_OK) {
+        sg_cpu_stat.errors++;
+    }
+    sg_cpu_stat.cpu_us += cpu_us;
+    if (cpu_us > sg_cpu_stat.cpu_us_max) {
+        sg_cpu_stat.cpu_us_max = cpu_us;
+    }
+}
+
+/**
+ * @brief unpack a sample burst (big endian registers)
+ * @param[in] buf: accel, temperature and gyro registers
+ * @return none
+ */
+STATIC VOID_T __mpu6050_sample_unpack(_IN CONST UCHAR_T *buf)
+{
+    UCHAR_T i;
+
+    for (i = 0; i < 3; i++) {
+        sg_sample.accel[i] = ((SHORT_T)buf[2*i] << 8) | buf[2*i+1];
+        sg_sample.gyro[i] = ((SHORT_T)buf[8+2*i] << 8) | buf[8+2*i+1];
+    }
+    sg_sample.temp = ((SHORT_T)buf[6] << 8) | buf[7];
+}
+
+#if MPU_HW_I2C_EN
+/**
+ * @brief sample transfer end (called in I2C interrupt)
+ * @param[in] xfer: I2C transfer
+ * @return none
+ */
+STATIC VOID_T __mpu6050_sample_xfer_cb(i2c_xfer_t *xfer)
+{
+    MPU_RET ret = MPU_OK;
+
+    if (xfer->status == PPlus_SUCCESS) {
+        __mpu6050_sample_unpack(sg_sample_buf);
+    } else {
+        ret = MPU_ERR_XFER_FAILED;
+    }
+    __mpu6050_cpu_stat_update(xfer->cpu_us, ret);
+    if (sg_sample_cb != NULL) {
+        sg_sample_cb(ret);
+    }
+}
+#endif
+
+/**
+ * @brief start reading accel, temperature and gyro data in one burst
+ * @param[in] cb: called when the sample is ready, in interrupt context with hardware I2C
+ * @return MPU_OK, MPU_ERR_BUSY if the previous read is not over
+ */
+MPU_RET tuya_mpu6050_read_sample_async(_IN MPU_SAMPLE_CB cb)
+{
+#if MPU_HW_I2C_EN
+    if (sg_sample_xfer.status == PPlus_ERR_BUSY) {
+        return MPU_ERR_BUSY;
+    }
+    sg_sample_cb = cb;
+    sg_sample_xfer.slave_addr = MPU6050_DEV_ADDR;
+    sg_sample_xfer.reg = MPU6050_RA_ACCEL_XOUT_H;
+    sg_sample_xfer.dir = I2C_XFER_READ;
+    sg_sample_xfer.flags = 0;
+    sg_sample_xfer.data = sg_sample_buf;
+    sg_sample_xfer.size = MPU6050_SAMPLE_LEN;
+    sg_sample_xfer.cb = __mpu6050_sample_xfer_cb;
+    sg_sample_xfer.arg = NULL;
+    if (hal_i2c_xfer_async(sg_i2c, &sg_sample_xfer) != PPlus_SUCCESS) {
+        return MPU_ERR_BUSY;
+    }
+#else
+    UINT_T t0 = read_current_fine_time();
+
+    __mpu6050_read_data(MPU6050_RA_ACCEL_XOUT_H, MPU6050_SAMPLE_LEN, sg_sample_buf);
+    __mpu6050_sample_unpack(sg_sample_buf);
+    __mpu6050_cpu_stat_update(MPU_TIME_DELTA(t0, read_current_fine_time()), MPU_OK);
+    if (cb != NULL) {
+        cb(MPU_OK);
+    }
+#endif
+    return MPU_OK;
+}
+
+/**
+ * @brief get the last sample read (raw data)
+ * @param[out] sample: raw sample
+ * @return none
+ */
+VOID_T tuya_mpu6050_get_sample_raw(_OUT MPU_RAW_SAMPLE_T *sample)
+{
+    tuya_ble_device_enter_critical();
+    *sample = sg_sample;
+    tuya_ble_device_exit_critical();
+}
+
+/**
+ * @brief get the last sample read (specified unit)
+ * @param[out] gyro: gyroscope data of 3-axis
+ * @param[in] g_unit: gyroscope unit
+ * @param[out] accel: accelerometer data of 3-axis
+ * @param[in] a_unit: accelerometer unit
+ * @return none
+ */
+VOID_T tuya_mpu6050_get_sample_spec_unit(_OUT FLOAT_T *gyro, _IN CONST MPU_GYRO_DT_E g_unit,
+                                         _OUT FLOAT_T *accel, _IN CONST MPU_ACCEL_DT_E a_unit)
+{
+    MPU_RAW_SAMPLE_T sample;
+
+    tuya_mpu6050_get_sample_raw(&sample);
+    __cnv_gyro_unit(sample.gyro[0], sample.gyro[1], sample.gyro[2], gyro, gyro+1, gyro+2, g_unit);
+    __cnv_accel_unit(sample.accel[0], sample.accel[1], sample.accel[2], accel, accel+1, accel+2, a_unit);
+}
+
+/**
+ * @brief get CPU time statistics of sample reads
+ * @param[out] stat: statistics
+ * @param[in] reset: TRUE - clear statistics after reading
+ * @return none
+ */
+VOID_T tuya_mpu6050_get_cpu_stat(_OUT MPU_CPU_STAT_T *stat, _IN CONST BOOL_T reset)
+{
+    tuya_ble_device_enter_critical();
+    *stat = sg_cpu_stat;
+    if (reset) {
+        memset(&sg_cpu_stat, 0, SIZEOF(sg_cpu_stat));
+    }
+    tuya_ble_device_exit_critical();
+}
+
 /**
  * @brief read temperature data from MPU6050 (Celsius)
  * @param[in] none
@@ -858,9 +1066,7 @@ MPU_RET tuya_mpu6050_dmp_init(_IN CONST MPU_GYRO_FSR_E g_fsr, _IN CONST MPU_ACCE
                               _IN CONST gpio_pin_e pin, _IN CONST TY_GPIO_IRQ_TYPE_E type, _IN TY_GPIO_IRQ_CB int_cb)
 {
     /* I2C init */
-	  
-    i2c_soft_gpio_init();
-	  //ty_i2c_init();
+    __mpu6050_i2c_init();
     /* reset MPU6050 */
     __mpu6050_reset();
     /* check communication */
@@ -1013,12 +1219,16 @@ INT_T tuya_mpu6050_read_dmp_spec_unit(_IN CONST MPU_GYRO_DT_E g_unit, _OUT FLOAT
  */
 INT_T tuya_mpu6050_i2c_read(_IN CONST UCHAR_T dev_addr, _IN UCHAR_T reg_addr, _IN CONST UCHAR_T len, _OUT UCHAR_T *data)
 {
+#if MPU_HW_I2C_EN
+    return __mpu6050_i2c_xfer(I2C_XFER_READ, reg_addr, len, data);
+#else
     i2c_start();
     i2c_send_bytes(MPU6050_ADDR_CMD_WRITE, &reg_addr, 1);
     i2c_start();
     i2c_rcv_bytes(MPU6050_ADDR_CMD_READ, data, len);
     i2c_stop();
     return 0;
+#endif
 }
 
 /**
@@ -1031,11 +1241,15 @@ INT_T tuya_mpu6050_i2c_read(_IN CONST UCHAR_T dev_addr, _IN UCHAR_T reg_addr, _I
  */
 INT_T tuya_mpu6050_i2c_write(_IN CONST UCHAR_T dev_addr, _IN UCHAR_T reg_addr, _IN CONST UCHAR_T len, _IN UCHAR_T *data)
 {
+#if MPU_HW_I2C_EN
+    return __mpu6050_i2c_xfer(I2C_XFER_WRITE, reg_addr, len, data);
+#else
     i2c_start();
     i2c_send_bytes(MPU6050_ADDR_CMD_WRITE, &reg_addr, 1);
     i2c_send_bytes(data[0], data+1, len-1);
     i2c_stop();
     return 0;
+#endif
 }
 
 /**
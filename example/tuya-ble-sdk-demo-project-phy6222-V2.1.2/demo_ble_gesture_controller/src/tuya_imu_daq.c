@@ -20,6 +20,10 @@
 ***********************************************************/
 #define DAQ_TIME_MS         5
 
+/* log CPU time of sample reads every DAQ_STAT_SAMPLES samples */
+#define DAQ_CPU_STAT_EN     0
+#define DAQ_STAT_SAMPLES    1000
+
 #define MPU_CT_POW_PIN      GPIO_P07  //6050
 #define MPU_INT_PIN         GPIO_P11  //6050int
 
@@ -48,6 +52,42 @@ STATIC VOID_T __new_data_ready_cb(VOID_T)
     }
 }
 
+#if (INV_MOTION_DRIVER == 0)
+/**
+ * @brief sample read end callback (called in I2C interrupt with hardware I2C)
+ * @param[in] ret: result of the sample read
+ * @return none
+ */
+STATIC VOID_T __sample_ready_cb(MPU_RET ret)
+{
+    if ((MPU_OK == ret) && (sg_daq_end_cb != NULL)) {
+        sg_daq_end_cb();
+    }
+}
+
+/**
+ * @brief DAQ timer callback, starts the sample read
+ * @param[in] none
+ * @return none
+ */
+STATIC VOID_T __daq_timer_cb(VOID_T)
+{
+#if DAQ_CPU_STAT_EN
+    MPU_CPU_STAT_T stat;
+#endif
+
+    tuya_mpu6050_read_sample_async(__sample_ready_cb);
+#if DAQ_CPU_STAT_EN
+    tuya_mpu6050_get_cpu_stat(&stat, FALSE);
+    if (stat.samples >= DAQ_STAT_SAMPLES) {
+        tuya_mpu6050_get_cpu_stat(&stat, TRUE);
+        TUYA_APP_LOG_DEBUG("IMU CPU time per sample: avg %dus, max %dus, errors %d",
+                           stat.cpu_us / stat.samples, stat.cpu_us_max, stat.errors);
+    }
+#endif
+}
+#endif
+
 /**
  * @brief IMU DAQ module init  IMUݲɼģʼ
  * @param[in] daq_end_cb: data acquisition end callback ݲɼص
@@ -63,7 +103,7 @@ VOID_T tuya_imu_daq_init(DAQ_END_CB daq_end_cb)//ok
 #else
     MPU_RET ret = tuya_mpu6050_init(MPU_CLK_PLL_XGYRO, MPU_GYRO_FS_2000, MPU_ACCEL_FS_16, 1000/DAQ_TIME_MS, MPU_INT_PIN, TY_GPIO_IRQ_FALLING, __new_data_ready_cb);
 	  //TUYA_APP_LOG_DEBUG("tuya_mpu6050_init");
-    tuya_ble_timer_create(&daq_timer, 5, TUYA_BLE_TIMER_REPEATED, __new_data_ready_cb);
+    tuya_ble_timer_create(&daq_timer, DAQ_TIME_MS, TUYA_BLE_TIMER_REPEATED, __daq_timer_cb);
     tuya_ble_timer_start(daq_timer);
 	  
 #endif
@@ -101,12 +141,16 @@ BOOL_T tuya_get_imu_data(FLOAT_T *gyro, FLOAT_T *accel, FLOAT_T *imu_angle)
         return FALSE;
     }
 #else
-		//Ƕȡָ
-    tuya_mpu6050_read_gyro_spec_unit(gyro+1, gyro, gyro+2, MPU_GDT_DPS);
-		//ȡټ
-    tuya_mpu6050_read_accel_spec_unit(accel+1, accel, accel+2, MPU_ADT_MPS2);
-    gyro[1] = -gyro[1];
-    accel[1] = -accel[1];
+    FLOAT_T g[3], a[3];
+
+    /* sample read in the background, swap X and Y axis */
+    tuya_mpu6050_get_sample_spec_unit(g, MPU_GDT_DPS, a, MPU_ADT_MPS2);
+    gyro[0] = g[1];
+    gyro[1] = -g[0];
+    gyro[2] = g[2];
+    accel[0] = a[1];
+    accel[1] = -a[0];
+    accel[2] = a[2];
 #endif
     return TRUE;
 }